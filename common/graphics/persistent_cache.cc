@@ -340,6 +340,11 @@ sk_sp<SkData> PersistentCache::load(const SkData& key) {
   return result;
 }
 
+// Stores that have not run within this interval because the worker never
+// became idle are run anyway.
+static constexpr fml::TimeDelta kPersistentCacheStoreTimeout =
+    fml::TimeDelta::FromSeconds(1);
+
 static void PersistentCacheStore(fml::RefPtr<fml::TaskRunner> worker,
                                  std::shared_ptr<fml::UniqueFD> cache_directory,
                                  std::string key,
@@ -364,7 +369,9 @@ static void PersistentCacheStore(fml::RefPtr<fml::TaskRunner> worker,
            "frame workload.";
     task();
   } else {
-    worker->PostTask(std::move(task));
+    // Writing the cache is not urgent, so it waits for the worker to idle.
+    worker->PostIdleTask([task](fml::TimePoint deadline) { task(); },
+                         kPersistentCacheStoreTimeout);
   }
 }
 
@@ -53,6 +53,13 @@ std::string Settings::ToString() const {
   stream << "use_test_fonts: " << use_test_fonts << std::endl;
   stream << "enable_software_rendering: " << enable_software_rendering
          << std::endl;
+  stream << "enable_concurrent_raster_cache: "
+         << enable_concurrent_raster_cache << std::endl;
+  stream << "enable_adaptive_pipeline_depth: "
+         << enable_adaptive_pipeline_depth << std::endl;
+  stream << "raster_cache_max_bytes: " << raster_cache_max_bytes << std::endl;
+  stream << "image_decoder_cache_max_bytes: " << image_decoder_cache_max_bytes
+         << std::endl;
   stream << "log_tag: " << log_tag << std::endl;
   stream << "icu_initialization_required: " << icu_initialization_required
          << std::endl;
@@ -59,6 +59,21 @@ class FrameTiming {
     picture_cache_count_ = picture_cache_count;
     picture_cache_bytes_ = picture_cache_bytes;
   }
+  /// The moving average of the time from vsync to the end of rasterization of
+  /// the frames up to this one.
+  fml::TimeDelta GetAverageFrameLatency() const {
+    return average_frame_latency_;
+  }
+  /// The moving average of the time between the ends of rasterization of
+  /// consecutive frames up to this one. Its inverse is the frame throughput.
+  fml::TimeDelta GetAverageFrameInterval() const {
+    return average_frame_interval_;
+  }
+  void SetPipelineStatistics(fml::TimeDelta average_frame_latency,
+                             fml::TimeDelta average_frame_interval) {
+    average_frame_latency_ = average_frame_latency;
+    average_frame_interval_ = average_frame_interval;
+  }
 
  private:
   fml::TimePoint data_[kCount];
@@ -67,6 +82,8 @@ class FrameTiming {
   size_t layer_cache_bytes_;
   size_t picture_cache_count_;
   size_t picture_cache_bytes_;
+  fml::TimeDelta average_frame_latency_;
+  fml::TimeDelta average_frame_interval_;
 };
 
 using TaskObserverAdd =
@@ -139,6 +156,10 @@ struct Settings {
   std::optional<std::vector<std::string>> trace_skia_allowlist;
   bool trace_startup = false;
   bool trace_systrace = false;
+  // Record how long tasks wait in and run on the engine's message loops. The
+  // results are served by the _flutter.getTaskQueueStatistics service
+  // protocol extension and FlutterEngineGetTaskQueueStatistics.
+  bool record_task_queue_statistics = false;
   bool dump_skp_on_shader_compilation = false;
   bool cache_sksl = false;
   bool purge_persistent_cache = false;
@@ -252,6 +273,19 @@ struct Settings {
   // calls in this callback will cause applications to jank.
   LogMessageCallback log_message_callback;
   bool enable_software_rendering = false;
+  // Populate raster cache entries on the concurrent worker pool instead of
+  // the raster thread where the rendering backend allows it.
+  bool enable_concurrent_raster_cache = false;
+  // Adapt the number of frames in flight between the UI and raster threads to
+  // the measured build and raster times instead of always allowing two.
+  bool enable_adaptive_pipeline_depth = false;
+  // The maximum number of bytes of images held by the raster cache, or 0 for
+  // no limit.
+  size_t raster_cache_max_bytes = 0;
+  // The maximum number of bytes of decoded images, and of the bytes they were
+  // decoded from, kept by the image decoder so that repeated decodes of the
+  // same bytes to the same size are skipped. 0 disables the cache.
+  size_t image_decoder_cache_max_bytes = 0;
   bool skia_deterministic_rendering_on_cpu = false;
   bool verbose_logging = false;
   std::string log_tag = "flutter";
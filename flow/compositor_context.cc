@@ -7,6 +7,7 @@
 #include <optional>
 #include "flutter/flow/layers/layer_tree.h"
 #include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkPath.h"
 
 namespace flutter {
 
@@ -132,6 +133,17 @@ RasterStatus CompositorContext::ScopedFrame::Raster(
   if (canvas()) {
     if (clip_rect) {
       canvas()->clipRect(*clip_rect);
+
+      // If the damage consists of multiple disjoint rects, restrict painting
+      // to those rects rather than to their bounding box.
+      auto damage_rects = frame_damage->GetBufferDamageRects();
+      if (damage_rects && damage_rects->size() > 1) {
+        SkPath clip_path;
+        for (const auto& rect : *damage_rects) {
+          clip_path.addRect(SkRect::Make(rect));
+        }
+        canvas()->clipPath(clip_path);
+      }
     }
 
     if (needs_save_layer) {
@@ -7,6 +7,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "flutter/common/graphics/texture.h"
 #include "flutter/flow/diff_context.h"
@@ -86,6 +87,18 @@ class FrameDamage {
     return damage_ ? std::make_optional(damage_->buffer_damage) : std::nullopt;
   }
 
+  // See Damage::frame_damage_rects.
+  std::optional<std::vector<SkIRect>> GetFrameDamageRects() const {
+    return damage_ ? std::make_optional(damage_->frame_damage_rects)
+                   : std::nullopt;
+  }
+
+  // See Damage::buffer_damage_rects.
+  std::optional<std::vector<SkIRect>> GetBufferDamageRects() const {
+    return damage_ ? std::make_optional(damage_->buffer_damage_rects)
+                   : std::nullopt;
+  }
+
  private:
   SkIRect additional_damage_ = SkIRect::MakeEmpty();
   std::optional<Damage> damage_;
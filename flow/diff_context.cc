@@ -3,10 +3,104 @@
 // found in the LICENSE file.
 
 #include "flutter/flow/diff_context.h"
+
+#include <algorithm>
+
 #include "flutter/flow/layers/layer.h"
 
 namespace flutter {
 
+namespace {
+
+// Area that would be painted in addition to a and b if they were replaced by
+// their bounding box.
+SkScalar JoinCost(const SkRect& a, const SkRect& b) {
+  SkRect joined = a;
+  joined.join(b);
+  return joined.width() * joined.height() - a.width() * a.height() -
+         b.width() * b.height();
+}
+
+// Adds rect to list of non-overlapping rects. Rects that overlap the new rect
+// are merged with it. If the list grows beyond DiffContext::kMaxDamageRects,
+// the pair of rects with smallest join cost is merged.
+void AddDamageRect(std::vector<SkRect>& rects, SkRect rect) {
+  if (rect.isEmpty()) {
+    return;
+  }
+  for (auto i = rects.begin(); i != rects.end();) {
+    if (i->contains(rect)) {
+      return;
+    }
+    if (SkRect::Intersects(*i, rect)) {
+      // Joining may make the rect intersect rects already visited, so start
+      // over.
+      rect.join(*i);
+      rects.erase(i);
+      i = rects.begin();
+    } else {
+      ++i;
+    }
+  }
+  rects.push_back(rect);
+
+  if (rects.size() > DiffContext::kMaxDamageRects) {
+    size_t best_a = 0;
+    size_t best_b = 1;
+    SkScalar best_cost = JoinCost(rects[0], rects[1]);
+    for (size_t a = 0; a < rects.size(); ++a) {
+      for (size_t b = a + 1; b < rects.size(); ++b) {
+        SkScalar cost = JoinCost(rects[a], rects[b]);
+        if (cost < best_cost) {
+          best_cost = cost;
+          best_a = a;
+          best_b = b;
+        }
+      }
+    }
+    SkRect joined = rects[best_a];
+    joined.join(rects[best_b]);
+    rects.erase(rects.begin() + best_b);
+    rects.erase(rects.begin() + best_a);
+    AddDamageRect(rects, joined);
+  }
+}
+
+bool IntersectsAny(const std::vector<SkRect>& rects, const SkRect& rect) {
+  return std::any_of(rects.begin(), rects.end(), [&](const SkRect& r) {
+    return SkRect::Intersects(r, rect);
+  });
+}
+
+// Rounds out the rects, clips them to frame_clip and returns their bounds.
+// Rects that overlap once rounded out are merged, so that out stays
+// non-overlapping.
+SkIRect RoundOutAndClip(const std::vector<SkRect>& rects,
+                        const SkIRect& frame_clip,
+                        std::vector<SkIRect>& out) {
+  SkIRect bounds = SkIRect::MakeEmpty();
+  for (const auto& r : rects) {
+    SkIRect rect = r.roundOut();
+    if (!rect.intersect(frame_clip)) {
+      continue;
+    }
+    for (auto i = out.begin(); i != out.end();) {
+      if (SkIRect::Intersects(*i, rect)) {
+        rect.join(*i);
+        out.erase(i);
+        i = out.begin();
+      } else {
+        ++i;
+      }
+    }
+    out.push_back(rect);
+    bounds.join(rect);
+  }
+  return bounds;
+}
+
+}  // namespace
+
 DiffContext::DiffContext(SkISize frame_size,
                          double frame_device_pixel_ratio,
                          PaintRegionMap& this_frame_paint_region_map,
@@ -69,27 +163,26 @@ SkRect DiffContext::ApplyFilterBoundsAdjustment(SkRect rect) const {
 
 Damage DiffContext::ComputeDamage(
     const SkIRect& accumulated_buffer_damage) const {
-  SkRect buffer_damage = SkRect::Make(accumulated_buffer_damage);
-  buffer_damage.join(damage_);
-  SkRect frame_damage(damage_);
+  std::vector<SkRect> buffer_damage(damage_);
+  AddDamageRect(buffer_damage, SkRect::Make(accumulated_buffer_damage));
+  std::vector<SkRect> frame_damage(damage_);
 
   for (const auto& r : readbacks_) {
     SkRect rect = SkRect::Make(r.rect);
-    if (rect.intersects(frame_damage)) {
-      frame_damage.join(rect);
+    if (IntersectsAny(frame_damage, rect)) {
+      AddDamageRect(frame_damage, rect);
     }
-    if (rect.intersects(buffer_damage)) {
-      buffer_damage.join(rect);
+    if (IntersectsAny(buffer_damage, rect)) {
+      AddDamageRect(buffer_damage, rect);
     }
   }
 
   Damage res;
-  buffer_damage.roundOut(&res.buffer_damage);
-  frame_damage.roundOut(&res.frame_damage);
-
   SkIRect frame_clip = SkIRect::MakeSize(frame_size_);
-  res.buffer_damage.intersect(frame_clip);
-  res.frame_damage.intersect(frame_clip);
+  res.buffer_damage =
+      RoundOutAndClip(buffer_damage, frame_clip, res.buffer_damage_rects);
+  res.frame_damage =
+      RoundOutAndClip(frame_damage, frame_clip, res.frame_damage_rects);
   return res;
 }
 
@@ -181,12 +274,12 @@ PaintRegion DiffContext::CurrentSubtreeRegion() const {
 void DiffContext::AddDamage(const PaintRegion& damage) {
   FML_DCHECK(damage.is_valid());
   for (const auto& r : damage) {
-    damage_.join(r);
+    AddDamageRect(damage_, r);
   }
 }
 
 void DiffContext::AddDamage(const SkRect& rect) {
-  damage_.join(rect);
+  AddDamageRect(damage_, rect);
 }
 
 void DiffContext::SetLayerPaintRegion(const Layer* layer,
@@ -34,6 +34,15 @@ struct Damage {
   // upfront may be useful for tile based GPUs.
   // Corresponds to "buffer damage" from EGL_KHR_partial_update.
   SkIRect buffer_damage;
+
+  // Non-overlapping rectangles that make up frame_damage; frame_damage is the
+  // bounding box of these rects. At most DiffContext::kMaxDamageRects entries.
+  std::vector<SkIRect> frame_damage_rects;
+
+  // Non-overlapping rectangles that make up buffer_damage; buffer_damage is
+  // the bounding box of these rects. At most DiffContext::kMaxDamageRects
+  // entries.
+  std::vector<SkIRect> buffer_damage_rects;
 };
 
 // Layer Unique Id to PaintRegion
@@ -42,6 +51,11 @@ using PaintRegionMap = std::map<uint64_t, PaintRegion>;
 // Tracks state during tree diffing process and computes resulting damage
 class DiffContext {
  public:
+  // Maximum number of disjoint rectangles used to represent damage. When more
+  // rectangles are added the ones that waste the least area when joined are
+  // merged together.
+  static constexpr size_t kMaxDamageRects = 8;
+
   explicit DiffContext(SkISize frame_size,
                        double device_pixel_aspect_ratio,
                        PaintRegionMap& this_frame_paint_region_map,
@@ -223,7 +237,8 @@ class DiffContext {
   // Rect must be in device coordinates.
   SkRect ApplyFilterBoundsAdjustment(SkRect rect) const;
 
-  SkRect damage_ = SkRect::MakeEmpty();
+  // Non-overlapping damage rects, in screen coordinates.
+  std::vector<SkRect> damage_;
 
   PaintRegionMap& this_frame_paint_region_map_;
   const PaintRegionMap& last_frame_paint_region_map_;
@@ -2,11 +2,16 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
+#include <limits>
+#include <map>
 #include <type_traits>
+#include <vector>
 
 #include "flutter/flow/display_list.h"
 #include "flutter/flow/display_list_canvas.h"
 #include "flutter/flow/display_list_utils.h"
+#include "flutter/fml/hash_combine.h"
 
 #include "third_party/skia/include/core/SkPath.h"
 #include "third_party/skia/include/core/SkRSXform.h"
@@ -33,6 +38,11 @@ const SkSamplingOptions DisplayList::CubicSampling =
 //
 // Only a DLOp that wants to do a deep compare needs to override the
 // DLOp::equals() method and return a value of kEqual or kNotEqual.
+//
+// The content hash of a DisplayList follows the same rules. The bytes of
+// bulk compared ops are hashed as they are, while an op that overrides
+// equals() must also override DLOp::hash() to hash only the values that
+// its equals() method compares.
 enum class DisplayListCompare {
   // The Op is deferring comparisons to a bulk memcmp performed lazily
   // across all bulk-comparable ops.
@@ -64,8 +74,20 @@ struct DLOp {
   DisplayListCompare equals(const DLOp* other) const {
     return DisplayListCompare::kUseBulkCompare;
   }
+
+  // Returns false if the bytes of the op are to be hashed in bulk.
+  bool hash(size_t& seed) const { return false; }
 };
 
+// Hashes only what SkPath::operator== compares: equal paths have equal
+// fill types, verbs and points, and so equal bounds.
+static void HashPath(size_t& seed, const SkPath& path) {
+  const SkRect& bounds = path.getBounds();
+  fml::HashCombineSeed(seed, static_cast<int>(path.getFillType()),
+                       path.countVerbs(), path.countPoints(), bounds.fLeft,
+                       bounds.fTop, bounds.fRight, bounds.fBottom);
+}
+
 // 4 byte header + 4 byte payload packs into minimum 8 bytes
 #define DEFINE_SET_BOOL_OP(name)                             \
   struct Set##name##Op final : DLOp {                        \
@@ -398,6 +420,12 @@ DEFINE_CLIP_SHAPE_OP(RRect, Difference)
       return is_aa == other->is_aa && path == other->path                \
                  ? DisplayListCompare::kEqual                            \
                  : DisplayListCompare::kNotEqual;                        \
+    }                                                                    \
+                                                                         \
+    bool hash(size_t& seed) const {                                      \
+      fml::HashCombineSeed(seed, is_aa);                                 \
+      HashPath(seed, path);                                              \
+      return true;                                                       \
     }                                                                    \
   };
 DEFINE_CLIP_PATH_OP(Intersect)
@@ -464,6 +492,11 @@ struct DrawPathOp final : DLOp {
     return path == other->path ? DisplayListCompare::kEqual
                                : DisplayListCompare::kNotEqual;
   }
+
+  bool hash(size_t& seed) const {
+    HashPath(seed, path);
+    return true;
+  }
 };
 
 // The common data is a 4 byte header with an unused 4 bytes
@@ -858,12 +891,168 @@ DEFINE_DRAW_SHADOW_OP(ShadowTransparentOccluder, true)
 
 #pragma pack(pop, DLOp_Alignment)
 
+// Attribute setters that write the same field of the rendering state
+// belong to the same group. A setter is dead if it is followed by another
+// setter from its group before any op reads the rendering attributes.
+enum class AttributeGroup {
+  kAntiAlias,
+  kDither,
+  kInvertColors,
+  kStrokeCap,
+  kStrokeJoin,
+  kStyle,
+  kStrokeWidth,
+  kStrokeMiter,
+  kColor,
+  kBlend,
+  kShader,
+  kColorFilter,
+  kImageFilter,
+  kPathEffect,
+  kMaskFilter,
+
+  kNone,
+};
+static constexpr int kAttributeGroupCount =
+    static_cast<int>(AttributeGroup::kNone);
+
+static AttributeGroup GetAttributeGroup(DisplayListOpType type) {
+  switch (type) {
+    case DisplayListOpType::kSetAntiAlias:
+      return AttributeGroup::kAntiAlias;
+    case DisplayListOpType::kSetDither:
+      return AttributeGroup::kDither;
+    case DisplayListOpType::kSetInvertColors:
+      return AttributeGroup::kInvertColors;
+    case DisplayListOpType::kSetStrokeCap:
+      return AttributeGroup::kStrokeCap;
+    case DisplayListOpType::kSetStrokeJoin:
+      return AttributeGroup::kStrokeJoin;
+    case DisplayListOpType::kSetStyle:
+      return AttributeGroup::kStyle;
+    case DisplayListOpType::kSetStrokeWidth:
+      return AttributeGroup::kStrokeWidth;
+    case DisplayListOpType::kSetStrokeMiter:
+      return AttributeGroup::kStrokeMiter;
+    case DisplayListOpType::kSetColor:
+      return AttributeGroup::kColor;
+    case DisplayListOpType::kSetBlendMode:
+    case DisplayListOpType::kSetBlender:
+    case DisplayListOpType::kClearBlender:
+      return AttributeGroup::kBlend;
+    case DisplayListOpType::kSetShader:
+    case DisplayListOpType::kClearShader:
+      return AttributeGroup::kShader;
+    case DisplayListOpType::kSetColorFilter:
+    case DisplayListOpType::kClearColorFilter:
+      return AttributeGroup::kColorFilter;
+    case DisplayListOpType::kSetImageFilter:
+    case DisplayListOpType::kClearImageFilter:
+      return AttributeGroup::kImageFilter;
+    case DisplayListOpType::kSetPathEffect:
+    case DisplayListOpType::kClearPathEffect:
+      return AttributeGroup::kPathEffect;
+    case DisplayListOpType::kClearMaskFilter:
+    case DisplayListOpType::kSetMaskFilter:
+    case DisplayListOpType::kSetMaskBlurFilterNormal:
+    case DisplayListOpType::kSetMaskBlurFilterSolid:
+    case DisplayListOpType::kSetMaskBlurFilterOuter:
+    case DisplayListOpType::kSetMaskBlurFilterInner:
+      return AttributeGroup::kMaskFilter;
+    default:
+      return AttributeGroup::kNone;
+  }
+}
+
+// Ops that only modify the save stack, transform or clip. A run of them
+// between a |save| and its |restore| has no effect on the output.
+static bool IsSaveTransformOrClipOp(DisplayListOpType type) {
+  switch (type) {
+    case DisplayListOpType::kSave:
+    case DisplayListOpType::kSaveLayer:
+    case DisplayListOpType::kSaveLayerBounds:
+    case DisplayListOpType::kRestore:
+    case DisplayListOpType::kTranslate:
+    case DisplayListOpType::kScale:
+    case DisplayListOpType::kRotate:
+    case DisplayListOpType::kSkew:
+    case DisplayListOpType::kTransform2DAffine:
+    case DisplayListOpType::kTransformFullPerspective:
+    case DisplayListOpType::kClipIntersectRect:
+    case DisplayListOpType::kClipIntersectRRect:
+    case DisplayListOpType::kClipIntersectPath:
+    case DisplayListOpType::kClipDifferenceRect:
+    case DisplayListOpType::kClipDifferenceRRect:
+    case DisplayListOpType::kClipDifferencePath:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Ops that render to the destination, as opposed to the ops that modify
+// the attributes, save stack, transform or clip used by rendering ops.
+static bool IsRenderingOp(DisplayListOpType type) {
+  return GetAttributeGroup(type) == AttributeGroup::kNone &&
+         !IsSaveTransformOrClipOp(type);
+}
+
 void DisplayList::ComputeBounds() {
   DisplayListBoundsCalculator calculator(&bounds_cull_);
   Dispatch(calculator);
   bounds_ = calculator.bounds();
 }
 
+void DisplayList::ComputeRTree() {
+  DisplayListBoundsCalculator calculator(&bounds_cull_);
+  int rendering_op_count = 0;
+  uint8_t* ptr = storage_.get();
+  uint8_t* end = ptr + byte_count_;
+  while (ptr < end) {
+    uint8_t* next = ptr + reinterpret_cast<const DLOp*>(ptr)->size;
+    calculator.set_op_index(
+        IsRenderingOp(reinterpret_cast<const DLOp*>(ptr)->type)
+            ? rendering_op_count++
+            : -1);
+    Dispatch(calculator, ptr, next);
+    ptr = next;
+  }
+  std::vector<SkRect> op_bounds = calculator.TakeOpBounds(rendering_op_count);
+  rtree_ = sk_make_sp<RTree>();
+  rtree_->insert(op_bounds.data(), rendering_op_count);
+  // The same pass produced the overall bounds.
+  bounds_ = calculator.bounds();
+}
+
+void DisplayList::Dispatch(Dispatcher& dispatcher,
+                           const SkRect& cull_rect) const {
+  uint8_t* ptr = storage_.get();
+  uint8_t* end = ptr + byte_count_;
+  if (!rtree_ || cull_rect.contains(bounds_)) {
+    Dispatch(dispatcher, ptr, end);
+    return;
+  }
+  std::vector<int> hits;
+  rtree_->search(cull_rect, &hits);
+  if (static_cast<int>(hits.size()) == rtree_->getCount()) {
+    Dispatch(dispatcher, ptr, end);
+    return;
+  }
+  std::vector<bool> visible(rtree_->getCount(), false);
+  for (int index : hits) {
+    visible[index] = true;
+  }
+  int rendering_op_index = 0;
+  while (ptr < end) {
+    auto op = reinterpret_cast<const DLOp*>(ptr);
+    uint8_t* next = ptr + op->size;
+    if (!IsRenderingOp(op->type) || visible[rendering_op_index++]) {
+      Dispatch(dispatcher, ptr, next);
+    }
+    ptr = next;
+  }
+}
+
 void DisplayList::Dispatch(Dispatcher& dispatcher,
                            uint8_t* ptr,
                            uint8_t* end) const {
@@ -978,13 +1167,53 @@ static bool CompareOps(uint8_t* ptrA,
   return true;
 }
 
+static size_t HashOps(const uint8_t* ptr, const uint8_t* end) {
+  size_t seed = fml::HashCombine();
+  while (ptr < end) {
+    auto op = reinterpret_cast<const DLOp*>(ptr);
+    fml::HashCombineSeed(seed, static_cast<int>(op->type), op->size);
+    bool hashed;
+    switch (op->type) {
+#define DL_OP_HASH(name)                                   \
+  case DisplayListOpType::k##name:                         \
+    hashed = static_cast<const name##Op*>(op)->hash(seed); \
+    break;
+
+      FOR_EACH_DISPLAY_LIST_OP(DL_OP_HASH)
+
+#undef DL_OP_HASH
+
+      default:
+        FML_DCHECK(false);
+        return seed;
+    }
+    if (!hashed) {
+      // The header has already been hashed. It shares the first 8 bytes
+      // of the op with 4 bytes of payload, and the rest of the op is a
+      // whole number of zero-padded 8 byte words.
+      fml::HashCombineSeed(seed, reinterpret_cast<const uint32_t*>(op)[1]);
+      auto words = reinterpret_cast<const uint64_t*>(op);
+      for (size_t i = 1; i < op->size / sizeof(uint64_t); i++) {
+        fml::HashCombineSeed(seed, words[i]);
+      }
+    }
+    ptr += op->size;
+  }
+  return seed;
+}
+
 void DisplayList::RenderTo(SkCanvas* canvas) const {
   DisplayListCanvasDispatcher dispatcher(canvas);
-  Dispatch(dispatcher);
+  if (rtree_) {
+    Dispatch(dispatcher, canvas->getLocalClipBounds());
+  } else {
+    Dispatch(dispatcher);
+  }
 }
 
 bool DisplayList::Equals(const DisplayList& other) const {
-  if (byte_count_ != other.byte_count_ || op_count_ != other.op_count_) {
+  if (byte_count_ != other.byte_count_ || op_count_ != other.op_count_ ||
+      content_hash_ != other.content_hash_) {
     return false;
   }
   uint8_t* ptr = storage_.get();
@@ -1006,6 +1235,7 @@ DisplayList::DisplayList(uint8_t* ptr,
       op_count_(op_count),
       nested_byte_count_(nested_byte_count),
       nested_op_count_(nested_op_count),
+      content_hash_(HashOps(ptr, ptr + byte_count)),
       bounds_({0, 0, -1, -1}),
       bounds_cull_(cull_rect) {
   static std::atomic<uint32_t> nextID{1};
@@ -1060,6 +1290,9 @@ sk_sp<DisplayList> DisplayListBuilder::Build() {
   while (save_level_ > 0) {
     restore();
   }
+  if (optimize_on_build_) {
+    Optimize();
+  }
   size_t bytes = used_;
   int count = op_count_;
   size_t nested_bytes = nested_bytes_;
@@ -1067,9 +1300,429 @@ sk_sp<DisplayList> DisplayListBuilder::Build() {
   used_ = allocated_ = op_count_ = 0;
   nested_bytes_ = nested_op_count_ = 0;
   storage_.realloc(bytes);
-  return sk_sp<DisplayList>(new DisplayList(storage_.release(), bytes, count,
-                                            nested_bytes, nested_count,
-                                            cull_rect_));
+  sk_sp<DisplayList> display_list(new DisplayList(storage_.release(), bytes,
+                                                  count, nested_bytes,
+                                                  nested_count, cull_rect_));
+  if (build_rtree_) {
+    display_list->ComputeRTree();
+  }
+  return display_list;
+}
+
+// Translate, scale and 2D affine ops can be merged with their neighbours
+// into a single op of at most the size of a Transform2DAffineOp.
+static bool GetMergeableTransform(const DLOp* op, SkMatrix* matrix) {
+  switch (op->type) {
+    case DisplayListOpType::kTranslate: {
+      auto translate = static_cast<const TranslateOp*>(op);
+      matrix->setTranslate(translate->tx, translate->ty);
+      return true;
+    }
+    case DisplayListOpType::kScale: {
+      auto scale = static_cast<const ScaleOp*>(op);
+      matrix->setScale(scale->sx, scale->sy);
+      return true;
+    }
+    case DisplayListOpType::kTransform2DAffine: {
+      auto affine = static_cast<const Transform2DAffineOp*>(op);
+      matrix->setAll(affine->mxx, affine->mxy, affine->mxt,  //
+                     affine->myx, affine->myy, affine->myt,  //
+                     0, 0, 1);
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+// Computes the local bounds of the geometry of a rendering op before any
+// stroking is applied. Returns false for ops that are never culled, either
+// because they flood the clip or because their bounds are expensive or
+// impossible to compute here.
+static bool GetCullableOpBounds(const DLOp* op,
+                                SkRect* bounds,
+                                bool* always_stroked) {
+  *always_stroked = false;
+  switch (op->type) {
+    case DisplayListOpType::kDrawLine: {
+      auto line = static_cast<const DrawLineOp*>(op);
+      *bounds = SkRect::MakeLTRB(line->p0.fX, line->p0.fY,  //
+                                 line->p1.fX, line->p1.fY)
+                    .makeSorted();
+      *always_stroked = true;
+      return true;
+    }
+    case DisplayListOpType::kDrawRect:
+      *bounds = static_cast<const DrawRectOp*>(op)->rect.makeSorted();
+      return true;
+    case DisplayListOpType::kDrawOval:
+      *bounds = static_cast<const DrawOvalOp*>(op)->oval.makeSorted();
+      return true;
+    case DisplayListOpType::kDrawCircle: {
+      auto circle = static_cast<const DrawCircleOp*>(op);
+      SkScalar radius = SkScalarAbs(circle->radius);
+      *bounds = SkRect::MakeLTRB(circle->center.fX - radius,
+                                 circle->center.fY - radius,
+                                 circle->center.fX + radius,
+                                 circle->center.fY + radius);
+      return true;
+    }
+    case DisplayListOpType::kDrawRRect:
+      *bounds = static_cast<const DrawRRectOp*>(op)->rrect.getBounds();
+      return true;
+    case DisplayListOpType::kDrawDRRect:
+      *bounds = static_cast<const DrawDRRectOp*>(op)->outer.getBounds();
+      return true;
+    case DisplayListOpType::kDrawArc:
+      *bounds = static_cast<const DrawArcOp*>(op)->bounds.makeSorted();
+      return true;
+    case DisplayListOpType::kDrawPath: {
+      const SkPath& path = static_cast<const DrawPathOp*>(op)->path;
+      if (path.isInverseFillType()) {
+        return false;
+      }
+      *bounds = path.getBounds();
+      return true;
+    }
+    case DisplayListOpType::kDrawPoints:
+    case DisplayListOpType::kDrawLines:
+    case DisplayListOpType::kDrawPolygon: {
+      // All three point ops share the layout of DrawPointsOp.
+      auto points = static_cast<const DrawPointsOp*>(op);
+      bounds->setBounds(reinterpret_cast<const SkPoint*>(points + 1),
+                        static_cast<int>(points->count));
+      *always_stroked = true;
+      return true;
+    }
+    case DisplayListOpType::kDrawVertices:
+      *bounds = static_cast<const DrawVerticesOp*>(op)->vertices->bounds();
+      return true;
+    case DisplayListOpType::kDrawImage:
+    case DisplayListOpType::kDrawImageWithAttr: {
+      // Both image ops share the layout of DrawImageOp.
+      auto image = static_cast<const DrawImageOp*>(op);
+      *bounds = SkRect::MakeXYWH(image->point.fX, image->point.fY,
+                                 image->image->width(),
+                                 image->image->height());
+      return true;
+    }
+    case DisplayListOpType::kDrawImageRect:
+      *bounds = static_cast<const DrawImageRectOp*>(op)->dst.makeSorted();
+      return true;
+    case DisplayListOpType::kDrawImageNine:
+    case DisplayListOpType::kDrawImageNineWithAttr:
+      *bounds = static_cast<const DrawImageNineOp*>(op)->dst.makeSorted();
+      return true;
+    case DisplayListOpType::kDrawImageLattice:
+      *bounds = static_cast<const DrawImageLatticeOp*>(op)->dst.makeSorted();
+      return true;
+    case DisplayListOpType::kDrawTextBlob: {
+      auto text = static_cast<const DrawTextBlobOp*>(op);
+      *bounds = text->blob->bounds().makeOffset(text->x, text->y);
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+template <typename T, typename... Args>
+static uint8_t* EmitOp(uint8_t* dst, Args&&... args) {
+  size_t size = SkAlignPtr(sizeof(T));
+  // Padding bytes take part in the bulk comparisons of |Equals|.
+  memset(dst, 0, size);
+  auto op = reinterpret_cast<T*>(dst);
+  new (op) T{std::forward<Args>(args)...};
+  op->type = T::kType;
+  op->size = size;
+  return dst + size;
+}
+
+void DisplayListBuilder::Optimize() {
+  uint8_t* const start = storage_.get();
+  uint8_t* const end = start + used_;
+  std::vector<const DLOp*> ops;
+  for (uint8_t* ptr = start; ptr < end;) {
+    auto op = reinterpret_cast<const DLOp*>(ptr);
+    ops.push_back(op);
+    ptr += op->size;
+  }
+  std::vector<bool> keep(ops.size(), true);
+
+  // Merged transform runs, keyed by the index of the last op of the run.
+  // That op is rewritten with the combined matrix and the earlier ops of
+  // the run are dropped, so the rewritten op always has room to land in
+  // the bytes that the run used to occupy.
+  std::map<size_t, SkMatrix> merged_transforms;
+  constexpr size_t kNoTransformRun = std::numeric_limits<size_t>::max();
+  size_t transform_run = kNoTransformRun;
+  SkMatrix transform_run_matrix;
+
+  struct SaveInfo {
+    size_t index;
+    SkM44 matrix;
+    bool allows_culling;
+    // A |save|, or a |saveLayer| whose restore leaves the destination
+    // untouched when the layer is empty.
+    bool removable_if_empty;
+    bool has_content;
+  };
+  std::vector<SaveInfo> saves;
+  SkM44 matrix;
+  // Cleared inside of layers whose image filter may move content back
+  // inside of the cull rect.
+  bool allows_culling = true;
+
+  // The subset of the rendering attributes that decides whether a
+  // rendering op can be culled or a saveLayer can be removed.
+  SkPaint::Style style = SkPaint::kFill_Style;
+  SkScalar stroke_width = 0.0;
+  SkScalar stroke_miter = 4.0;
+  bool blends_src_over = true;
+  bool invert_colors = false;
+  bool has_color_filter = false;
+  bool has_image_filter = false;
+  bool has_mask_filter = false;
+  bool has_path_effect = false;
+
+  for (size_t i = 0; i < ops.size(); i++) {
+    const DLOp* op = ops[i];
+
+    SkMatrix op_matrix;
+    if (GetMergeableTransform(op, &op_matrix)) {
+      matrix.preConcat(SkM44(op_matrix));
+      if (transform_run != kNoTransformRun) {
+        keep[transform_run] = false;
+        merged_transforms.erase(transform_run);
+        transform_run_matrix.preConcat(op_matrix);
+        merged_transforms[i] = transform_run_matrix;
+      } else {
+        transform_run_matrix = op_matrix;
+      }
+      transform_run = i;
+      continue;
+    }
+
+    switch (op->type) {
+      case DisplayListOpType::kSetInvertColors:
+        invert_colors = static_cast<const SetInvertColorsOp*>(op)->value;
+        continue;
+      case DisplayListOpType::kSetStyle:
+        style = static_cast<const SetStyleOp*>(op)->style;
+        continue;
+      case DisplayListOpType::kSetStrokeWidth:
+        stroke_width = static_cast<const SetStrokeWidthOp*>(op)->width;
+        continue;
+      case DisplayListOpType::kSetStrokeMiter:
+        stroke_miter = static_cast<const SetStrokeMiterOp*>(op)->limit;
+        continue;
+      case DisplayListOpType::kSetBlendMode:
+        blends_src_over = static_cast<const SetBlendModeOp*>(op)->mode ==
+                          SkBlendMode::kSrcOver;
+        continue;
+      case DisplayListOpType::kSetBlender:
+        blends_src_over = false;
+        continue;
+      case DisplayListOpType::kClearBlender:
+        blends_src_over = true;
+        continue;
+      case DisplayListOpType::kSetColorFilter:
+      case DisplayListOpType::kClearColorFilter:
+        has_color_filter = op->type == DisplayListOpType::kSetColorFilter;
+        continue;
+      case DisplayListOpType::kSetImageFilter:
+      case DisplayListOpType::kClearImageFilter:
+        has_image_filter = op->type == DisplayListOpType::kSetImageFilter;
+        continue;
+      case DisplayListOpType::kSetPathEffect:
+      case DisplayListOpType::kClearPathEffect:
+        has_path_effect = op->type == DisplayListOpType::kSetPathEffect;
+        continue;
+      case DisplayListOpType::kClearMaskFilter:
+        has_mask_filter = false;
+        continue;
+      case DisplayListOpType::kSetMaskFilter:
+      case DisplayListOpType::kSetMaskBlurFilterNormal:
+      case DisplayListOpType::kSetMaskBlurFilterSolid:
+      case DisplayListOpType::kSetMaskBlurFilterOuter:
+      case DisplayListOpType::kSetMaskBlurFilterInner:
+        has_mask_filter = true;
+        continue;
+      default:
+        if (GetAttributeGroup(op->type) != AttributeGroup::kNone) {
+          // Setters never break up a run of transforms.
+          continue;
+        }
+        break;
+    }
+
+    switch (op->type) {
+      case DisplayListOpType::kSave:
+        saves.push_back({i, matrix, allows_culling, true, false});
+        break;
+      case DisplayListOpType::kSaveLayer:
+      case DisplayListOpType::kSaveLayerBounds: {
+        bool with_paint =
+            op->type == DisplayListOpType::kSaveLayer
+                ? static_cast<const SaveLayerOp*>(op)->with_paint
+                : static_cast<const SaveLayerBoundsOp*>(op)->with_paint;
+        bool empty_layer_is_nop =
+            !with_paint || (blends_src_over && !invert_colors &&
+                            !has_color_filter && !has_image_filter);
+        saves.push_back({i, matrix, allows_culling, empty_layer_is_nop, false});
+        if (with_paint && has_image_filter) {
+          allows_culling = false;
+        }
+        break;
+      }
+      case DisplayListOpType::kRestore: {
+        FML_DCHECK(!saves.empty());
+        SaveInfo info = saves.back();
+        saves.pop_back();
+        matrix = info.matrix;
+        allows_culling = info.allows_culling;
+        if (info.removable_if_empty && !info.has_content) {
+          // Attribute setters inside of the pair are not scoped by it
+          // and stay where they are.
+          for (size_t j = info.index; j <= i; j++) {
+            if (keep[j] && IsSaveTransformOrClipOp(ops[j]->type)) {
+              keep[j] = false;
+              merged_transforms.erase(j);
+            }
+          }
+        } else if (!saves.empty()) {
+          saves.back().has_content = true;
+        }
+        break;
+      }
+      case DisplayListOpType::kRotate: {
+        auto rotate = static_cast<const RotateOp*>(op);
+        matrix.preConcat(SkM44(SkMatrix::RotateDeg(rotate->degrees)));
+        break;
+      }
+      case DisplayListOpType::kSkew: {
+        auto skew = static_cast<const SkewOp*>(op);
+        matrix.preConcat(SkM44(SkMatrix::Skew(skew->sx, skew->sy)));
+        break;
+      }
+      case DisplayListOpType::kTransformFullPerspective: {
+        auto m = static_cast<const TransformFullPerspectiveOp*>(op);
+        // clang-format off
+        matrix.preConcat(SkM44(m->mxx, m->mxy, m->mxz, m->mxt,
+                               m->myx, m->myy, m->myz, m->myt,
+                               m->mzx, m->mzy, m->mzz, m->mzt,
+                               m->mwx, m->mwy, m->mwz, m->mwt));
+        // clang-format on
+        break;
+      }
+      case DisplayListOpType::kClipIntersectRect:
+      case DisplayListOpType::kClipIntersectRRect:
+      case DisplayListOpType::kClipIntersectPath:
+      case DisplayListOpType::kClipDifferenceRect:
+      case DisplayListOpType::kClipDifferenceRRect:
+      case DisplayListOpType::kClipDifferencePath:
+        break;
+      default: {
+        SkRect bounds;
+        bool always_stroked;
+        if (allows_culling && !has_image_filter && !has_mask_filter &&
+            !has_path_effect &&
+            GetCullableOpBounds(op, &bounds, &always_stroked)) {
+          SkMatrix matrix33 = matrix.asM33();
+          if (!matrix33.hasPerspective()) {
+            bool hairline = false;
+            if (always_stroked || style != SkPaint::kFill_Style) {
+              if (stroke_width > 0) {
+                // Covers miter joins and square caps at any angle.
+                SkScalar pad = stroke_width * 0.5f *
+                               std::max(stroke_miter, SK_ScalarSqrt2);
+                bounds.outset(pad, pad);
+              } else {
+                hairline = true;
+              }
+            }
+            SkRect device_bounds = matrix33.mapRect(bounds);
+            // Leave room for anti-aliasing and hairlines, which are one
+            // device pixel wide regardless of the transform.
+            device_bounds.outset(hairline ? 2 : 1, hairline ? 2 : 1);
+            if (!device_bounds.intersects(cull_rect_)) {
+              // A culled op neither reads the attributes nor breaks up a
+              // run of transforms.
+              keep[i] = false;
+              continue;
+            }
+          }
+        }
+        if (!saves.empty()) {
+          saves.back().has_content = true;
+        }
+        break;
+      }
+    }
+    transform_run = kNoTransformRun;
+  }
+  FML_DCHECK(saves.empty());
+
+  // Walk backwards to find setters that are overwritten before the next
+  // surviving op that reads the attributes. Setters at the end of the
+  // list are never read.
+  bool overwritten[kAttributeGroupCount];
+  std::fill(std::begin(overwritten), std::end(overwritten), true);
+  for (size_t i = ops.size(); i-- > 0;) {
+    if (!keep[i]) {
+      continue;
+    }
+    AttributeGroup group = GetAttributeGroup(ops[i]->type);
+    if (group != AttributeGroup::kNone) {
+      int index = static_cast<int>(group);
+      if (overwritten[index]) {
+        keep[i] = false;
+      }
+      overwritten[index] = true;
+    } else if (!IsSaveTransformOrClipOp(ops[i]->type) ||
+               ops[i]->type == DisplayListOpType::kSaveLayer ||
+               ops[i]->type == DisplayListOpType::kSaveLayerBounds) {
+      std::fill(std::begin(overwritten), std::end(overwritten), false);
+    }
+  }
+
+  // Compact the surviving ops towards the front of the buffer.
+  uint8_t* dst = start;
+  for (size_t i = 0; i < ops.size(); i++) {
+    uint8_t* ptr = reinterpret_cast<uint8_t*>(const_cast<DLOp*>(ops[i]));
+    size_t size = ops[i]->size;
+    int op_inc =
+        GetAttributeGroup(ops[i]->type) == AttributeGroup::kNone ? 1 : 0;
+    auto merged = merged_transforms.find(i);
+    if (!keep[i] || (merged != merged_transforms.end() &&
+                     merged->second.isIdentity())) {
+      DisposeOps(ptr, ptr + size);
+      op_count_ -= op_inc;
+      continue;
+    }
+    if (merged != merged_transforms.end()) {
+      const SkMatrix& m = merged->second;
+      if (m.isTranslate()) {
+        dst = EmitOp<TranslateOp>(dst, m.getTranslateX(), m.getTranslateY());
+      } else if (m.isScaleTranslate() && m.getTranslateX() == 0 &&
+                 m.getTranslateY() == 0) {
+        dst = EmitOp<ScaleOp>(dst, m.getScaleX(), m.getScaleY());
+      } else {
+        dst = EmitOp<Transform2DAffineOp>(
+            dst, m.getScaleX(), m.getSkewX(), m.getTranslateX(),  //
+            m.getSkewY(), m.getScaleY(), m.getTranslateY());
+      }
+      FML_DCHECK(dst <= ptr + size);
+      continue;
+    }
+    if (dst != ptr) {
+      memmove(dst, ptr, size);
+    }
+    dst += size;
+  }
+  used_ = dst - start;
+  // Keep the bytes past the end zeroed for any ops pushed after this.
+  memset(dst, 0, end - dst);
 }
 
 DisplayListBuilder::DisplayListBuilder(const SkRect& cull_rect)
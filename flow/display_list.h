@@ -19,6 +19,7 @@
 #include "third_party/skia/include/core/SkShader.h"
 #include "third_party/skia/include/core/SkVertices.h"
 
+#include "flutter/flow/rtree.h"
 #include "flutter/fml/logging.h"
 
 // The Flutter DisplayList mechanism encapsulates a persistent sequence of
@@ -176,6 +177,7 @@ class DisplayList : public SkRefCnt {
         op_count_(0),
         nested_byte_count_(0),
         nested_op_count_(0),
+        content_hash_(0),
         unique_id_(0),
         bounds_({0, 0, 0, 0}),
         bounds_cull_({0, 0, 0, 0}) {}
@@ -187,6 +189,15 @@ class DisplayList : public SkRefCnt {
     Dispatch(ctx, ptr, ptr + byte_count_);
   }
 
+  // Dispatches only the rendering ops whose bounds intersect |cull_rect|,
+  // along with every attribute, save, transform and clip op so that the
+  // dispatched rendering ops see the same state as in a full dispatch.
+  // Lists built without an RTree (see |DisplayListBuilder::setBuildRTree|)
+  // are dispatched in full.
+  void Dispatch(Dispatcher& ctx, const SkRect& cull_rect) const;
+
+  // Renders the list, culled to the local clip bounds of the canvas when
+  // the list has an RTree.
   void RenderTo(SkCanvas* canvas) const;
 
   // SkPicture always includes nested bytes, but nested ops are
@@ -212,6 +223,14 @@ class DisplayList : public SkRefCnt {
 
   bool Equals(const DisplayList& other) const;
 
+  // A hash of the ops computed when the list is built. Lists that are
+  // |Equals| have the same hash, regardless of their cull rects.
+  size_t content_hash() const { return content_hash_; }
+
+  // The spatial index of the rendering ops, or null if the list was built
+  // without one. Entry i holds the bounds of the i-th rendering op.
+  const sk_sp<RTree>& rtree() const { return rtree_; }
+
  private:
   DisplayList(uint8_t* ptr,
               size_t byte_count,
@@ -227,16 +246,22 @@ class DisplayList : public SkRefCnt {
   size_t nested_byte_count_;
   int nested_op_count_;
 
+  size_t content_hash_;
   uint32_t unique_id_;
   SkRect bounds_;
 
   // Only used for drawPaint() and drawColor()
   SkRect bounds_cull_;
 
+  sk_sp<RTree> rtree_;
+
   void ComputeBounds();
+  void ComputeRTree();
   void Dispatch(Dispatcher& ctx, uint8_t* ptr, uint8_t* end) const;
 
   friend class DisplayListBuilder;
+  friend class DisplayListInternTable;
+  friend class DisplayListSerializer;
 };
 
 // The pure virtual interface for interacting with a display list.
@@ -970,6 +995,22 @@ class DisplayListBuilder final : public virtual Dispatcher, public SkRefCnt {
                   bool transparent_occluder,
                   SkScalar dpr) override;
 
+  // When enabled, |Build| runs a pass over the recorded ops before
+  // handing them to the DisplayList. The pass removes attribute setters
+  // that are overwritten before any rendering op reads them, drops
+  // |save|/|restore| pairs and no-op |saveLayer|/|restore| pairs that
+  // contain no rendering, merges runs of translate and scale ops into a
+  // single transform and culls rendering ops that fall entirely outside
+  // of the cull rect. Disabled by default.
+  void setOptimizeOnBuild(bool optimize) { optimize_on_build_ = optimize; }
+  bool optimizeOnBuild() const { return optimize_on_build_; }
+
+  // When enabled, |Build| computes the bounds of every rendering op and
+  // indexes them in an RTree for |DisplayList::Dispatch| with a cull rect.
+  // Disabled by default.
+  void setBuildRTree(bool build_rtree) { build_rtree_ = build_rtree; }
+  bool buildRTree() const { return build_rtree_; }
+
   sk_sp<DisplayList> Build();
 
  private:
@@ -978,6 +1019,8 @@ class DisplayListBuilder final : public virtual Dispatcher, public SkRefCnt {
   size_t allocated_ = 0;
   int op_count_ = 0;
   int save_level_ = 0;
+  bool optimize_on_build_ = false;
+  bool build_rtree_ = false;
 
   // bytes and ops from |drawPicture| and |drawDisplayList|
   size_t nested_bytes_ = 0;
@@ -990,6 +1033,9 @@ class DisplayListBuilder final : public virtual Dispatcher, public SkRefCnt {
   template <typename T, typename... Args>
   void* Push(size_t extra, int op_inc, Args&&... args);
 
+  // Rewrites the recorded ops in place, see |setOptimizeOnBuild|.
+  void Optimize();
+
   // kInvalidSigma is used to indicate that no MaskBlur is currently set.
   static constexpr SkScalar kInvalidSigma = 0.0;
   static bool mask_sigma_valid(SkScalar sigma) {
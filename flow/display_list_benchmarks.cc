@@ -0,0 +1,180 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <vector>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/flow/display_list.h"
+#include "flutter/flow/display_list_canvas.h"
+#include "flutter/flow/display_list_utils.h"
+
+#include "third_party/skia/include/core/SkFont.h"
+#include "third_party/skia/include/core/SkRSXform.h"
+#include "third_party/skia/include/core/SkSurface.h"
+#include "third_party/skia/include/core/SkTextBlob.h"
+
+namespace flutter {
+namespace {
+
+constexpr int kSurfaceSize = 1024;
+
+// Each workload records a representative scene into the builder.
+using Workload = void (*)(DisplayListBuilder& builder);
+
+void DenseRects(DisplayListBuilder& builder) {
+  for (int i = 0; i < 10000; i++) {
+    builder.setColor(0xFF000000 | (i * 0x010203));
+    SkScalar x = (i * 37) % kSurfaceSize;
+    SkScalar y = (i * 91) % kSurfaceSize;
+    builder.drawRect(SkRect::MakeXYWH(x, y, 20, 12));
+  }
+}
+
+void Paths(DisplayListBuilder& builder) {
+  builder.setAntiAlias(true);
+  builder.setStyle(SkPaint::kStroke_Style);
+  builder.setStrokeWidth(2);
+  for (int i = 0; i < 1000; i++) {
+    SkScalar x = (i * 53) % kSurfaceSize;
+    SkScalar y = (i * 29) % kSurfaceSize;
+    SkPath path;
+    path.moveTo(x, y);
+    path.cubicTo(x + 20, y - 30, x + 40, y + 30, x + 60, y);
+    path.quadTo(x + 30, y + 40, x, y);
+    path.close();
+    builder.drawPath(path);
+  }
+}
+
+void TextBlobs(DisplayListBuilder& builder) {
+  static const std::string text = "The quick brown fox jumps over the dog";
+  sk_sp<SkTextBlob> blob = SkTextBlob::MakeFromText(
+      text.c_str(), text.size(), SkFont(nullptr, 14), SkTextEncoding::kUTF8);
+  for (int i = 0; i < 2000; i++) {
+    builder.setColor(i % 2 ? SK_ColorBLACK : SK_ColorBLUE);
+    builder.drawTextBlob(blob, (i * 17) % kSurfaceSize,
+                         (i * 16) % kSurfaceSize);
+  }
+}
+
+void NestedSaveLayers(DisplayListBuilder& builder) {
+  for (int i = 0; i < 100; i++) {
+    for (int depth = 0; depth < 8; depth++) {
+      builder.setColor(SkColorSetA(SK_ColorBLACK, 0x80));
+      builder.saveLayer(nullptr, true);
+      builder.translate(4, 4);
+      builder.setColor(SK_ColorGREEN);
+      builder.drawRect(SkRect::MakeXYWH((i * 9) % kSurfaceSize,
+                                        (i * 7) % kSurfaceSize, 64, 64));
+    }
+    for (int depth = 0; depth < 8; depth++) {
+      builder.restore();
+    }
+  }
+}
+
+sk_sp<SkImage> MakeAtlasImage() {
+  sk_sp<SkSurface> surface = SkSurface::MakeRasterN32Premul(256, 256);
+  SkCanvas* canvas = surface->getCanvas();
+  SkPaint paint;
+  for (int y = 0; y < 16; y++) {
+    for (int x = 0; x < 16; x++) {
+      paint.setColor(0xFF000000 | ((x * 16) << 16) | ((y * 16) << 8));
+      canvas->drawRect(SkRect::MakeXYWH(x * 16, y * 16, 16, 16), paint);
+    }
+  }
+  return surface->makeImageSnapshot();
+}
+
+void LargeAtlas(DisplayListBuilder& builder) {
+  static const sk_sp<SkImage> atlas = MakeAtlasImage();
+  constexpr int kSprites = 10000;
+  std::vector<SkRSXform> xforms(kSprites);
+  std::vector<SkRect> tex(kSprites);
+  std::vector<SkColor> colors(kSprites);
+  for (int i = 0; i < kSprites; i++) {
+    xforms[i] = SkRSXform::MakeFromRadians(1, i * 0.01f,
+                                           (i * 13) % kSurfaceSize,
+                                           (i * 31) % kSurfaceSize, 8, 8);
+    tex[i] = SkRect::MakeXYWH((i % 16) * 16, ((i / 16) % 16) * 16, 16, 16);
+    colors[i] = 0xFF000000 | (static_cast<uint32_t>(i) * 0x0F0F0Fu);
+  }
+  builder.drawAtlas(atlas, xforms.data(), tex.data(), colors.data(), kSprites,
+                    SkBlendMode::kModulate,
+                    SkSamplingOptions(SkFilterMode::kLinear), nullptr, false);
+}
+
+sk_sp<DisplayList> Record(Workload workload) {
+  DisplayListBuilder builder(SkRect::MakeWH(kSurfaceSize, kSurfaceSize));
+  workload(builder);
+  return builder.Build();
+}
+
+// Reports how many ops were processed per second and the average size of
+// an op in the recorded DisplayList.
+void ReportCounters(benchmark::State& state, const DisplayList& display_list) {
+  int ops = display_list.op_count(true);
+  state.SetItemsProcessed(state.iterations() * ops);
+  state.counters["ops/s"] = benchmark::Counter(
+      static_cast<double>(state.iterations()) * ops,
+      benchmark::Counter::kIsRate);
+  state.counters["bytes/op"] =
+      ops > 0 ? static_cast<double>(display_list.bytes()) / ops : 0;
+}
+
+void BM_DisplayListRecord(benchmark::State& state, Workload workload) {
+  sk_sp<DisplayList> display_list;
+  while (state.KeepRunning()) {
+    display_list = Record(workload);
+    benchmark::DoNotOptimize(display_list);
+  }
+  ReportCounters(state, *display_list);
+}
+
+void BM_DisplayListCanvasDispatch(benchmark::State& state,
+                                  Workload workload) {
+  sk_sp<DisplayList> display_list = Record(workload);
+  sk_sp<SkSurface> surface =
+      SkSurface::MakeRasterN32Premul(kSurfaceSize, kSurfaceSize);
+  SkCanvas* canvas = surface->getCanvas();
+  while (state.KeepRunning()) {
+    int save_count = canvas->save();
+    DisplayListCanvasDispatcher dispatcher(canvas);
+    display_list->Dispatch(dispatcher);
+    canvas->restoreToCount(save_count);
+    // Flush so that the deferred work of the raster backend is timed too.
+    surface->flushAndSubmit();
+  }
+  ReportCounters(state, *display_list);
+}
+
+void BM_DisplayListBounds(benchmark::State& state, Workload workload) {
+  sk_sp<DisplayList> display_list = Record(workload);
+  SkRect cull_rect = SkRect::MakeWH(kSurfaceSize, kSurfaceSize);
+  while (state.KeepRunning()) {
+    DisplayListBoundsCalculator calculator(&cull_rect);
+    display_list->Dispatch(calculator);
+    benchmark::DoNotOptimize(calculator.bounds());
+  }
+  ReportCounters(state, *display_list);
+}
+
+}  // namespace
+
+#define DISPLAY_LIST_BENCHMARKS(workload)                             \
+  BENCHMARK_CAPTURE(BM_DisplayListRecord, workload, workload)         \
+      ->Unit(benchmark::kMicrosecond);                                \
+  BENCHMARK_CAPTURE(BM_DisplayListCanvasDispatch, workload, workload) \
+      ->Unit(benchmark::kMicrosecond);                                \
+  BENCHMARK_CAPTURE(BM_DisplayListBounds, workload, workload)         \
+      ->Unit(benchmark::kMicrosecond)
+
+DISPLAY_LIST_BENCHMARKS(DenseRects);
+DISPLAY_LIST_BENCHMARKS(Paths);
+DISPLAY_LIST_BENCHMARKS(TextBlobs);
+DISPLAY_LIST_BENCHMARKS(NestedSaveLayers);
+DISPLAY_LIST_BENCHMARKS(LargeAtlas);
+
+}  // namespace flutter
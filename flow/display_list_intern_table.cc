@@ -0,0 +1,92 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/display_list_intern_table.h"
+
+#include <algorithm>
+
+#include "flutter/fml/trace_event.h"
+
+namespace flutter {
+
+// Purging walks the whole table, so it is only done once the table has
+// doubled in size since the last purge.
+static constexpr size_t kMinPurgeThreshold = 256;
+
+DisplayListInternTable::DisplayListInternTable(
+    fml::RefPtr<SkiaUnrefQueue> unref_queue)
+    : unref_queue_(std::move(unref_queue)),
+      purge_threshold_(kMinPurgeThreshold) {}
+
+DisplayListInternTable::~DisplayListInternTable() {
+  Clear();
+}
+
+sk_sp<DisplayList> DisplayListInternTable::Intern(
+    sk_sp<DisplayList> display_list) {
+  if (!display_list) {
+    return display_list;
+  }
+  std::scoped_lock lock(mutex_);
+  auto range = entries_.equal_range(display_list->content_hash());
+  for (auto it = range.first; it != range.second; ++it) {
+    const sk_sp<DisplayList>& candidate = it->second;
+    if (candidate->bounds_cull_ == display_list->bounds_cull_ &&
+        (candidate->rtree() == nullptr) == (display_list->rtree() == nullptr) &&
+        candidate->Equals(*display_list)) {
+      hit_count_++;
+      return candidate;
+    }
+  }
+  if (entries_.size() >= purge_threshold_) {
+    PurgeLocked();
+    purge_threshold_ = std::max(kMinPurgeThreshold, entries_.size() * 2);
+  }
+  entries_.emplace(display_list->content_hash(), display_list);
+  return display_list;
+}
+
+void DisplayListInternTable::Purge() {
+  std::scoped_lock lock(mutex_);
+  PurgeLocked();
+}
+
+void DisplayListInternTable::Clear() {
+  std::scoped_lock lock(mutex_);
+  for (auto& entry : entries_) {
+    Release(std::move(entry.second));
+  }
+  entries_.clear();
+  purge_threshold_ = kMinPurgeThreshold;
+}
+
+void DisplayListInternTable::PurgeLocked() {
+  TRACE_EVENT0("flutter", "DisplayListInternTable::Purge");
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second->unique()) {
+      Release(std::move(it->second));
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void DisplayListInternTable::Release(sk_sp<DisplayList> display_list) {
+  if (unref_queue_ && display_list) {
+    unref_queue_->Unref(display_list.release());
+  }
+}
+
+size_t DisplayListInternTable::size() const {
+  std::scoped_lock lock(mutex_);
+  return entries_.size();
+}
+
+size_t DisplayListInternTable::hit_count() const {
+  std::scoped_lock lock(mutex_);
+  return hit_count_;
+}
+
+}  // namespace flutter
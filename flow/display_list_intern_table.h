@@ -0,0 +1,69 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_DISPLAY_LIST_INTERN_TABLE_H_
+#define FLUTTER_FLOW_DISPLAY_LIST_INTERN_TABLE_H_
+
+#include <mutex>
+#include <unordered_map>
+
+#include "flutter/flow/display_list.h"
+#include "flutter/flow/skia_gpu_object.h"
+#include "flutter/fml/macros.h"
+
+namespace flutter {
+
+// Maps DisplayLists with equal content to a single shared instance.
+//
+// Frameworks often record many identical small pictures, such as the
+// tiles of a scrolling list. Sharing one instance between them also
+// shares its |unique_id|, and with it a single raster cache entry.
+//
+// Each engine has its own table. The table holds a reference to every list
+// it returns, and drops the lists that nothing else refers to anymore as it
+// grows, on |Purge| and on |Clear|. The lists may hold texture backed images,
+// so the table drops its references through the unref queue of the engine
+// rather than on the calling thread.
+class DisplayListInternTable {
+ public:
+  // Releases the lists dropped by the table on |unref_queue|, or right away if
+  // it is null.
+  explicit DisplayListInternTable(
+      fml::RefPtr<SkiaUnrefQueue> unref_queue = nullptr);
+
+  ~DisplayListInternTable();
+
+  // Returns an already interned list that |Equals| |display_list| and has
+  // the same cull rect and spatial index, or adds |display_list| to the
+  // table and returns it.
+  sk_sp<DisplayList> Intern(sk_sp<DisplayList> display_list);
+
+  // Drops the lists that are only referenced by the table.
+  void Purge();
+
+  // Drops every list, such as when the engine shuts down.
+  void Clear();
+
+  size_t size() const;
+
+  // The number of |Intern| calls that returned a shared list.
+  size_t hit_count() const;
+
+ private:
+  const fml::RefPtr<SkiaUnrefQueue> unref_queue_;
+  mutable std::mutex mutex_;
+  std::unordered_multimap<size_t, sk_sp<DisplayList>> entries_;
+  size_t purge_threshold_;
+  size_t hit_count_ = 0;
+
+  void PurgeLocked();
+
+  void Release(sk_sp<DisplayList> display_list);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DisplayListInternTable);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_DISPLAY_LIST_INTERN_TABLE_H_
@@ -0,0 +1,81 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/display_list_intern_table.h"
+
+#include "flutter/testing/post_task_sync.h"
+#include "flutter/testing/thread_test.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+static sk_sp<DisplayList> BuildTile(
+    SkColor color,
+    const SkRect& cull_rect = SkRect::MakeWH(1000, 1000)) {
+  DisplayListBuilder builder(cull_rect);
+  builder.setColor(color);
+  builder.drawRect(SkRect::MakeWH(100, 20));
+  return builder.Build();
+}
+
+TEST(DisplayListInternTable, EqualListsShareAnInstance) {
+  DisplayListInternTable table;
+  sk_sp<DisplayList> first = table.Intern(BuildTile(SK_ColorRED));
+  sk_sp<DisplayList> second = table.Intern(BuildTile(SK_ColorRED));
+  sk_sp<DisplayList> other = table.Intern(BuildTile(SK_ColorBLUE));
+
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(first->unique_id(), second->unique_id());
+  EXPECT_NE(first, other);
+  EXPECT_EQ(table.size(), 2u);
+  EXPECT_EQ(table.hit_count(), 1u);
+}
+
+TEST(DisplayListInternTable, ListsWithDifferentCullRectsAreNotShared) {
+  DisplayListInternTable table;
+  sk_sp<DisplayList> first =
+      table.Intern(BuildTile(SK_ColorRED, SkRect::MakeWH(100, 100)));
+  sk_sp<DisplayList> second =
+      table.Intern(BuildTile(SK_ColorRED, SkRect::MakeWH(200, 200)));
+
+  EXPECT_NE(first, second);
+  EXPECT_EQ(table.hit_count(), 0u);
+}
+
+TEST(DisplayListInternTable, PurgeDropsUnreferencedLists) {
+  DisplayListInternTable table;
+  sk_sp<DisplayList> kept = table.Intern(BuildTile(SK_ColorRED));
+  table.Intern(BuildTile(SK_ColorBLUE));
+  EXPECT_EQ(table.size(), 2u);
+
+  table.Purge();
+  EXPECT_EQ(table.size(), 1u);
+  EXPECT_EQ(table.Intern(BuildTile(SK_ColorRED)), kept);
+}
+
+using DisplayListInternTableTest = ThreadTest;
+
+TEST_F(DisplayListInternTableTest, ClearReleasesListsThroughTheUnrefQueue) {
+  auto unref_task_runner = CreateNewThread();
+  fml::RefPtr<SkiaUnrefQueue> unref_queue;
+  PostTaskSync(unref_task_runner, [&]() {
+    unref_queue = fml::MakeRefCounted<SkiaUnrefQueue>(
+        unref_task_runner, fml::TimeDelta::FromSeconds(0));
+  });
+
+  DisplayListInternTable table(unref_queue);
+  sk_sp<DisplayList> kept = table.Intern(BuildTile(SK_ColorRED));
+  ASSERT_FALSE(kept->unique());
+
+  table.Clear();
+  EXPECT_EQ(table.size(), 0u);
+
+  // The reference of the table is dropped once the queue has drained.
+  PostTaskSync(unref_task_runner, []() {});
+  EXPECT_TRUE(kept->unique());
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -0,0 +1,1377 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/display_list_serialization.h"
+
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+
+#include "flutter/fml/logging.h"
+
+#include "third_party/skia/include/core/SkColorSpace.h"
+#include "third_party/skia/include/core/SkFlattenable.h"
+#include "third_party/skia/include/core/SkRSXform.h"
+#include "third_party/skia/include/core/SkSerialProcs.h"
+
+namespace flutter {
+
+namespace {
+
+// Object payloads are aligned for the widest pixel format that a raster
+// image may use, and so is the start of the data itself.
+constexpr size_t kPayloadAlignment = 16;
+constexpr size_t kRecordAlignment = 8;
+
+constexpr uint32_t kNullObject = 0xFFFFFFFF;
+
+// Nested DisplayLists are deserialized recursively, so their depth is
+// bounded to keep malformed data from exhausting the stack.
+constexpr int kMaxNestingDepth = 64;
+
+struct Header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t header_size;
+  uint32_t record_count;
+  uint32_t object_count;
+  uint32_t reserved;
+  uint64_t records_offset;
+  uint64_t records_size;
+  SkRect cull_rect;
+};
+static_assert(sizeof(Header) % kRecordAlignment == 0,
+              "Header must keep the object table aligned");
+
+struct ObjectEntry {
+  uint32_t kind;
+  uint32_t reserved;
+  uint64_t offset;
+  uint64_t size;
+};
+
+struct RecordHeader {
+  uint16_t op;
+  uint16_t reserved;
+  uint32_t size;
+};
+static_assert(sizeof(RecordHeader) == kRecordAlignment,
+              "Record arguments must start aligned");
+
+struct RasterImageHeader {
+  int32_t width;
+  int32_t height;
+  uint32_t color_type;
+  uint32_t alpha_type;
+  uint64_t row_bytes;
+  uint32_t color_space_size;
+  uint32_t reserved;
+};
+static_assert(sizeof(RasterImageHeader) % kPayloadAlignment == 0,
+              "Pixels must start aligned");
+
+// The values below are part of the format and must never change meaning.
+// New kinds and ops get new values.
+enum class ObjectKind : uint32_t {
+  kPath = 1,
+  kRasterImage = 2,
+  kEncodedImage = 3,
+  kTextBlob = 4,
+  kShader = 5,
+  kColorFilter = 6,
+  kImageFilter = 7,
+  kMaskFilter = 8,
+  kPathEffect = 9,
+  kBlender = 10,
+  kPicture = 11,
+  kDisplayList = 12,
+};
+
+enum class SerializedOp : uint16_t {
+  kSetAntiAlias = 1,
+  kSetDither = 2,
+  kSetStyle = 3,
+  kSetColor = 4,
+  kSetStrokeWidth = 5,
+  kSetStrokeMiter = 6,
+  kSetStrokeCap = 7,
+  kSetStrokeJoin = 8,
+  kSetShader = 9,
+  kSetColorFilter = 10,
+  kSetInvertColors = 11,
+  kSetBlendMode = 12,
+  kSetBlender = 13,
+  kSetPathEffect = 14,
+  kSetMaskFilter = 15,
+  kSetMaskBlurFilter = 16,
+  kSetImageFilter = 17,
+
+  kSave = 32,
+  kSaveLayer = 33,
+  kRestore = 34,
+
+  kTranslate = 48,
+  kScale = 49,
+  kRotate = 50,
+  kSkew = 51,
+  kTransform2DAffine = 52,
+  kTransformFullPerspective = 53,
+
+  kClipRect = 64,
+  kClipRRect = 65,
+  kClipPath = 66,
+
+  kDrawColor = 80,
+  kDrawPaint = 81,
+  kDrawLine = 82,
+  kDrawRect = 83,
+  kDrawOval = 84,
+  kDrawCircle = 85,
+  kDrawRRect = 86,
+  kDrawDRRect = 87,
+  kDrawPath = 88,
+  kDrawArc = 89,
+  kDrawPoints = 90,
+  kDrawImage = 91,
+  kDrawImageRect = 92,
+  kDrawImageNine = 93,
+  kDrawImageLattice = 94,
+  kDrawAtlas = 95,
+  kDrawPicture = 96,
+  kDrawDisplayList = 97,
+  kDrawTextBlob = 98,
+  kDrawShadow = 99,
+};
+
+constexpr size_t Align(size_t value, size_t alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// SkSamplingOptions written field by field so that the format does not
+// depend on the in-memory layout of the Skia struct.
+struct SerializedSampling {
+  uint32_t use_cubic;
+  float cubic_b;
+  float cubic_c;
+  uint32_t filter;
+  uint32_t mipmap;
+};
+
+class DisplayListWriter final : public virtual Dispatcher {
+ public:
+  DisplayListWriter() = default;
+
+  bool failed() const { return failed_; }
+  uint32_t record_count() const { return record_count_; }
+  const std::vector<uint8_t>& records() const { return records_; }
+
+  struct Object {
+    ObjectKind kind;
+    sk_sp<SkData> data;
+  };
+  const std::vector<Object>& objects() const { return objects_; }
+
+  void setAntiAlias(bool aa) override {
+    Record(SerializedOp::kSetAntiAlias, static_cast<uint32_t>(aa));
+  }
+  void setDither(bool dither) override {
+    Record(SerializedOp::kSetDither, static_cast<uint32_t>(dither));
+  }
+  void setStyle(SkPaint::Style style) override {
+    Record(SerializedOp::kSetStyle, static_cast<uint32_t>(style));
+  }
+  void setColor(SkColor color) override {
+    Record(SerializedOp::kSetColor, color);
+  }
+  void setStrokeWidth(SkScalar width) override {
+    Record(SerializedOp::kSetStrokeWidth, width);
+  }
+  void setStrokeMiter(SkScalar limit) override {
+    Record(SerializedOp::kSetStrokeMiter, limit);
+  }
+  void setStrokeCap(SkPaint::Cap cap) override {
+    Record(SerializedOp::kSetStrokeCap, static_cast<uint32_t>(cap));
+  }
+  void setStrokeJoin(SkPaint::Join join) override {
+    Record(SerializedOp::kSetStrokeJoin, static_cast<uint32_t>(join));
+  }
+  void setShader(sk_sp<SkShader> shader) override {
+    Record(SerializedOp::kSetShader,
+           AddFlattenable(ObjectKind::kShader, shader.get()));
+  }
+  void setColorFilter(sk_sp<SkColorFilter> filter) override {
+    Record(SerializedOp::kSetColorFilter,
+           AddFlattenable(ObjectKind::kColorFilter, filter.get()));
+  }
+  void setInvertColors(bool invert) override {
+    Record(SerializedOp::kSetInvertColors, static_cast<uint32_t>(invert));
+  }
+  void setBlendMode(SkBlendMode mode) override {
+    Record(SerializedOp::kSetBlendMode, static_cast<uint32_t>(mode));
+  }
+  void setBlender(sk_sp<SkBlender> blender) override {
+    Record(SerializedOp::kSetBlender,
+           AddFlattenable(ObjectKind::kBlender, blender.get()));
+  }
+  void setPathEffect(sk_sp<SkPathEffect> effect) override {
+    Record(SerializedOp::kSetPathEffect,
+           AddFlattenable(ObjectKind::kPathEffect, effect.get()));
+  }
+  void setMaskFilter(sk_sp<SkMaskFilter> filter) override {
+    Record(SerializedOp::kSetMaskFilter,
+           AddFlattenable(ObjectKind::kMaskFilter, filter.get()));
+  }
+  void setMaskBlurFilter(SkBlurStyle style, SkScalar sigma) override {
+    Record(SerializedOp::kSetMaskBlurFilter, static_cast<uint32_t>(style),
+           sigma);
+  }
+  void setImageFilter(sk_sp<SkImageFilter> filter) override {
+    Record(SerializedOp::kSetImageFilter,
+           AddFlattenable(ObjectKind::kImageFilter, filter.get()));
+  }
+
+  void save() override { Record(SerializedOp::kSave); }
+  void saveLayer(const SkRect* bounds, bool restore_with_paint) override {
+    Record(SerializedOp::kSaveLayer, static_cast<uint32_t>(bounds != nullptr),
+           bounds ? *bounds : SkRect::MakeEmpty(),
+           static_cast<uint32_t>(restore_with_paint));
+  }
+  void restore() override { Record(SerializedOp::kRestore); }
+
+  void translate(SkScalar tx, SkScalar ty) override {
+    Record(SerializedOp::kTranslate, tx, ty);
+  }
+  void scale(SkScalar sx, SkScalar sy) override {
+    Record(SerializedOp::kScale, sx, sy);
+  }
+  void rotate(SkScalar degrees) override {
+    Record(SerializedOp::kRotate, degrees);
+  }
+  void skew(SkScalar sx, SkScalar sy) override {
+    Record(SerializedOp::kSkew, sx, sy);
+  }
+  // clang-format off
+  void transform2DAffine(SkScalar mxx, SkScalar mxy, SkScalar mxt,
+                         SkScalar myx, SkScalar myy, SkScalar myt) override {
+    Record(SerializedOp::kTransform2DAffine,
+           mxx, mxy, mxt,
+           myx, myy, myt);
+  }
+  void transformFullPerspective(
+      SkScalar mxx, SkScalar mxy, SkScalar mxz, SkScalar mxt,
+      SkScalar myx, SkScalar myy, SkScalar myz, SkScalar myt,
+      SkScalar mzx, SkScalar mzy, SkScalar mzz, SkScalar mzt,
+      SkScalar mwx, SkScalar mwy, SkScalar mwz, SkScalar mwt) override {
+    Record(SerializedOp::kTransformFullPerspective,
+           mxx, mxy, mxz, mxt,
+           myx, myy, myz, myt,
+           mzx, mzy, mzz, mzt,
+           mwx, mwy, mwz, mwt);
+  }
+  // clang-format on
+
+  void clipRect(const SkRect& rect, SkClipOp clip_op, bool is_aa) override {
+    Record(SerializedOp::kClipRect, rect, static_cast<uint32_t>(clip_op),
+           static_cast<uint32_t>(is_aa));
+  }
+  void clipRRect(const SkRRect& rrect, SkClipOp clip_op, bool is_aa) override {
+    Record(SerializedOp::kClipRRect, rrect, static_cast<uint32_t>(clip_op),
+           static_cast<uint32_t>(is_aa));
+  }
+  void clipPath(const SkPath& path, SkClipOp clip_op, bool is_aa) override {
+    Record(SerializedOp::kClipPath, AddPath(path),
+           static_cast<uint32_t>(clip_op), static_cast<uint32_t>(is_aa));
+  }
+
+  void drawColor(SkColor color, SkBlendMode mode) override {
+    Record(SerializedOp::kDrawColor, color, static_cast<uint32_t>(mode));
+  }
+  void drawPaint() override { Record(SerializedOp::kDrawPaint); }
+  void drawLine(const SkPoint& p0, const SkPoint& p1) override {
+    Record(SerializedOp::kDrawLine, p0, p1);
+  }
+  void drawRect(const SkRect& rect) override {
+    Record(SerializedOp::kDrawRect, rect);
+  }
+  void drawOval(const SkRect& bounds) override {
+    Record(SerializedOp::kDrawOval, bounds);
+  }
+  void drawCircle(const SkPoint& center, SkScalar radius) override {
+    Record(SerializedOp::kDrawCircle, center, radius);
+  }
+  void drawRRect(const SkRRect& rrect) override {
+    Record(SerializedOp::kDrawRRect, rrect);
+  }
+  void drawDRRect(const SkRRect& outer, const SkRRect& inner) override {
+    Record(SerializedOp::kDrawDRRect, outer, inner);
+  }
+  void drawPath(const SkPath& path) override {
+    Record(SerializedOp::kDrawPath, AddPath(path));
+  }
+  void drawArc(const SkRect& oval_bounds,
+               SkScalar start_degrees,
+               SkScalar sweep_degrees,
+               bool use_center) override {
+    Record(SerializedOp::kDrawArc, oval_bounds, start_degrees, sweep_degrees,
+           static_cast<uint32_t>(use_center));
+  }
+  void drawPoints(SkCanvas::PointMode mode,
+                  uint32_t count,
+                  const SkPoint points[]) override {
+    BeginRecord(SerializedOp::kDrawPoints);
+    Write(static_cast<uint32_t>(mode));
+    Write(count);
+    WriteArray(points, count);
+    EndRecord();
+  }
+  void drawVertices(const sk_sp<SkVertices> vertices,
+                    SkBlendMode mode) override {
+    // SkVertices does not expose its contents for serialization.
+    Fail("drawVertices");
+  }
+  void drawImage(const sk_sp<SkImage> image,
+                 const SkPoint point,
+                 const SkSamplingOptions& sampling,
+                 bool render_with_attributes) override {
+    Record(SerializedOp::kDrawImage, AddImage(image), point,
+           Sampling(sampling), static_cast<uint32_t>(render_with_attributes));
+  }
+  void drawImageRect(const sk_sp<SkImage> image,
+                     const SkRect& src,
+                     const SkRect& dst,
+                     const SkSamplingOptions& sampling,
+                     bool render_with_attributes,
+                     SkCanvas::SrcRectConstraint constraint) override {
+    Record(SerializedOp::kDrawImageRect, AddImage(image), src, dst,
+           Sampling(sampling), static_cast<uint32_t>(render_with_attributes),
+           static_cast<uint32_t>(constraint));
+  }
+  void drawImageNine(const sk_sp<SkImage> image,
+                     const SkIRect& center,
+                     const SkRect& dst,
+                     SkFilterMode filter,
+                     bool render_with_attributes) override {
+    Record(SerializedOp::kDrawImageNine, AddImage(image), center, dst,
+           static_cast<uint32_t>(filter),
+           static_cast<uint32_t>(render_with_attributes));
+  }
+  void drawImageLattice(const sk_sp<SkImage> image,
+                        const SkCanvas::Lattice& lattice,
+                        const SkRect& dst,
+                        SkFilterMode filter,
+                        bool render_with_attributes) override {
+    uint32_t cell_count = (lattice.fXCount + 1) * (lattice.fYCount + 1);
+    BeginRecord(SerializedOp::kDrawImageLattice);
+    Write(AddImage(image));
+    Write(dst);
+    Write(static_cast<uint32_t>(filter));
+    Write(static_cast<uint32_t>(render_with_attributes));
+    Write(static_cast<uint32_t>(lattice.fXCount));
+    Write(static_cast<uint32_t>(lattice.fYCount));
+    Write(static_cast<uint32_t>(lattice.fBounds != nullptr));
+    Write(lattice.fBounds ? *lattice.fBounds : SkIRect::MakeEmpty());
+    Write(static_cast<uint32_t>(lattice.fRectTypes != nullptr));
+    Write(static_cast<uint32_t>(lattice.fColors != nullptr));
+    WriteArray(lattice.fXDivs, lattice.fXCount);
+    WriteArray(lattice.fYDivs, lattice.fYCount);
+    if (lattice.fColors) {
+      WriteArray(lattice.fColors, cell_count);
+    }
+    if (lattice.fRectTypes) {
+      static_assert(sizeof(SkCanvas::Lattice::RectType) == 1,
+                    "RectType is stored as one byte per cell");
+      WriteArray(lattice.fRectTypes, cell_count);
+    }
+    EndRecord();
+  }
+  void drawAtlas(const sk_sp<SkImage> atlas,
+                 const SkRSXform xform[],
+                 const SkRect tex[],
+                 const SkColor colors[],
+                 int count,
+                 SkBlendMode mode,
+                 const SkSamplingOptions& sampling,
+                 const SkRect* cull_rect,
+                 bool render_with_attributes) override {
+    BeginRecord(SerializedOp::kDrawAtlas);
+    Write(AddImage(atlas));
+    Write(static_cast<uint32_t>(count));
+    Write(static_cast<uint32_t>(mode));
+    Write(Sampling(sampling));
+    Write(static_cast<uint32_t>(cull_rect != nullptr));
+    Write(cull_rect ? *cull_rect : SkRect::MakeEmpty());
+    Write(static_cast<uint32_t>(render_with_attributes));
+    Write(static_cast<uint32_t>(colors != nullptr));
+    WriteArray(xform, count);
+    WriteArray(tex, count);
+    if (colors) {
+      WriteArray(colors, count);
+    }
+    EndRecord();
+  }
+  void drawPicture(const sk_sp<SkPicture> picture,
+                   const SkMatrix* matrix,
+                   bool render_with_attributes) override {
+    SkScalar values[9];
+    (matrix ? *matrix : SkMatrix::I()).get9(values);
+    BeginRecord(SerializedOp::kDrawPicture);
+    Write(AddObject(ObjectKind::kPicture, picture.get(),
+                    [&picture]() { return picture->serialize(); }));
+    Write(static_cast<uint32_t>(matrix != nullptr));
+    WriteArray(values, 9);
+    Write(static_cast<uint32_t>(render_with_attributes));
+    EndRecord();
+  }
+  void drawDisplayList(const sk_sp<DisplayList> display_list) override {
+    Record(SerializedOp::kDrawDisplayList,
+           AddObject(ObjectKind::kDisplayList, display_list.get(),
+                     [&display_list]() {
+                       return DisplayListSerializer::Serialize(*display_list);
+                     }));
+  }
+  void drawTextBlob(const sk_sp<SkTextBlob> blob,
+                    SkScalar x,
+                    SkScalar y) override {
+    Record(SerializedOp::kDrawTextBlob,
+           AddObject(ObjectKind::kTextBlob, blob.get(),
+                     [&blob]() { return blob->serialize(SkSerialProcs()); }),
+           x, y);
+  }
+  void drawShadow(const SkPath& path,
+                  const SkColor color,
+                  const SkScalar elevation,
+                  bool transparent_occluder,
+                  SkScalar dpr) override {
+    Record(SerializedOp::kDrawShadow, AddPath(path), color, elevation,
+           static_cast<uint32_t>(transparent_occluder), dpr);
+  }
+
+ private:
+  std::vector<uint8_t> records_;
+  uint32_t record_count_ = 0;
+  size_t record_start_ = 0;
+  std::vector<Object> objects_;
+  uint32_t kind_counts_[static_cast<int>(ObjectKind::kDisplayList) + 1] = {};
+  // Shared objects are written once, keyed by their address.
+  std::unordered_map<const void*, uint32_t> object_indices_;
+  bool failed_ = false;
+
+  void Fail(const char* what) {
+    if (!failed_) {
+      FML_LOG(ERROR) << "DisplayList serialization failed: " << what;
+    }
+    failed_ = true;
+  }
+
+  template <typename T>
+  void Write(const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Only plain values can be written");
+    static_assert(sizeof(T) % 4 == 0, "Values must keep 4 byte alignment");
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    records_.insert(records_.end(), bytes, bytes + sizeof(T));
+  }
+
+  template <typename T>
+  void WriteArray(const T* values, size_t count) {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Only plain values can be written");
+    if (count > 0) {
+      const uint8_t* bytes = reinterpret_cast<const uint8_t*>(values);
+      records_.insert(records_.end(), bytes, bytes + count * sizeof(T));
+    }
+    records_.resize(Align(records_.size(), 4));
+  }
+
+  void BeginRecord(SerializedOp op) {
+    record_start_ = records_.size();
+    Write(RecordHeader{static_cast<uint16_t>(op), 0, 0});
+  }
+
+  void EndRecord() {
+    records_.resize(Align(records_.size(), kRecordAlignment));
+    auto header = reinterpret_cast<RecordHeader*>(&records_[record_start_]);
+    header->size = records_.size() - record_start_;
+    record_count_++;
+  }
+
+  template <typename... Args>
+  void Record(SerializedOp op, const Args&... args) {
+    BeginRecord(op);
+    (Write(args), ...);
+    EndRecord();
+  }
+
+  static SerializedSampling Sampling(const SkSamplingOptions& sampling) {
+    return {
+        static_cast<uint32_t>(sampling.useCubic),
+        sampling.cubic.B,
+        sampling.cubic.C,
+        static_cast<uint32_t>(sampling.filter),
+        static_cast<uint32_t>(sampling.mipmap),
+    };
+  }
+
+  // Raster and encoded images are both loaded into the same list of images,
+  // so they share their indices.
+  static int IndexSpace(ObjectKind kind) {
+    if (kind == ObjectKind::kEncodedImage) {
+      kind = ObjectKind::kRasterImage;
+    }
+    return static_cast<int>(kind);
+  }
+
+  template <typename Serializer>
+  uint32_t AddObject(ObjectKind kind,
+                     const void* object,
+                     const Serializer& serialize) {
+    if (!object) {
+      return kNullObject;
+    }
+    auto found = object_indices_.find(object);
+    if (found != object_indices_.end()) {
+      return found->second;
+    }
+    sk_sp<SkData> data = serialize();
+    if (!data) {
+      Fail("object could not be serialized");
+      return kNullObject;
+    }
+    uint32_t index = kind_counts_[IndexSpace(kind)]++;
+    objects_.push_back({kind, std::move(data)});
+    object_indices_[object] = index;
+    return index;
+  }
+
+  uint32_t AddFlattenable(ObjectKind kind, SkFlattenable* flattenable) {
+    return AddObject(kind, flattenable,
+                     [flattenable]() { return flattenable->serialize(); });
+  }
+
+  uint32_t AddPath(const SkPath& path) {
+    // Paths are values, so every use is written out.
+    uint32_t index = kind_counts_[IndexSpace(ObjectKind::kPath)]++;
+    objects_.push_back({ObjectKind::kPath, path.serialize()});
+    return index;
+  }
+
+  uint32_t AddImage(const sk_sp<SkImage>& image) {
+    if (!image) {
+      Fail("null image");
+      return kNullObject;
+    }
+    if (sk_sp<SkData> encoded = image->refEncodedData()) {
+      return AddObject(ObjectKind::kEncodedImage, image.get(),
+                       [&encoded]() { return encoded; });
+    }
+    if (image->isTextureBacked()) {
+      Fail("texture backed image");
+      return kNullObject;
+    }
+    return AddObject(ObjectKind::kRasterImage, image.get(),
+                     [&image]() { return SerializeRasterImage(image); });
+  }
+
+  static sk_sp<SkData> SerializeRasterImage(const sk_sp<SkImage>& image) {
+    const SkImageInfo& info = image->imageInfo();
+    if (info.colorType() == kUnknown_SkColorType) {
+      return nullptr;
+    }
+    size_t row_bytes = info.minRowBytes();
+    size_t pixel_bytes = info.computeByteSize(row_bytes);
+    sk_sp<SkData> color_space =
+        info.colorSpace() ? info.colorSpace()->serialize() : nullptr;
+    size_t color_space_size = color_space ? color_space->size() : 0;
+    size_t pixels_offset = sizeof(RasterImageHeader) +
+                           Align(color_space_size, kPayloadAlignment);
+    sk_sp<SkData> data =
+        SkData::MakeZeroInitialized(pixels_offset + pixel_bytes);
+    uint8_t* bytes = static_cast<uint8_t*>(data->writable_data());
+    RasterImageHeader header = {
+        info.width(),
+        info.height(),
+        static_cast<uint32_t>(info.colorType()),
+        static_cast<uint32_t>(info.alphaType()),
+        row_bytes,
+        static_cast<uint32_t>(color_space_size),
+        0,
+    };
+    memcpy(bytes, &header, sizeof(header));
+    if (color_space) {
+      memcpy(bytes + sizeof(header), color_space->data(), color_space_size);
+    }
+    if (!image->readPixels(nullptr, info, bytes + pixels_offset, row_bytes, 0,
+                           0)) {
+      return nullptr;
+    }
+    return data;
+  }
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DisplayListWriter);
+};
+
+// Reads the arguments of a single record. Any read past the end of the
+// record marks the reader as failed and yields zeroes or null.
+class RecordReader {
+ public:
+  RecordReader(const uint8_t* ptr, const uint8_t* end) : ptr_(ptr), end_(end) {}
+
+  bool ok() const { return ok_; }
+
+  template <typename T>
+  T Read() {
+    T value;
+    const T* ptr = ReadArray<T>(1);
+    if (ptr) {
+      memcpy(&value, ptr, sizeof(T));
+    } else {
+      memset(&value, 0, sizeof(T));
+    }
+    return value;
+  }
+
+  bool ReadBool() { return Read<uint32_t>() != 0; }
+
+  // Reads an enum stored as a uint32_t, rejecting values past |last|.
+  template <typename E>
+  E ReadEnum(E last) {
+    uint32_t value = Read<uint32_t>();
+    if (value > static_cast<uint32_t>(last)) {
+      ok_ = false;
+      return static_cast<E>(0);
+    }
+    return static_cast<E>(value);
+  }
+
+  // Returns a pointer into the record, without copying.
+  template <typename T>
+  const T* ReadArray(size_t count) {
+    size_t bytes = count * sizeof(T);
+    if (!ok_ || count > static_cast<size_t>(end_ - ptr_) / sizeof(T)) {
+      ok_ = false;
+      return nullptr;
+    }
+    const T* result = reinterpret_cast<const T*>(ptr_);
+    ptr_ += Align(bytes, 4);
+    if (ptr_ > end_) {
+      ptr_ = end_;
+    }
+    return count > 0 ? result : nullptr;
+  }
+
+  SkSamplingOptions ReadSampling() {
+    SerializedSampling sampling = Read<SerializedSampling>();
+    if (sampling.use_cubic) {
+      return SkSamplingOptions(SkCubicResampler{sampling.cubic_b,  //
+                                                sampling.cubic_c});
+    }
+    if (sampling.filter > static_cast<uint32_t>(SkFilterMode::kLast) ||
+        sampling.mipmap > static_cast<uint32_t>(SkMipmapMode::kLast)) {
+      ok_ = false;
+      return SkSamplingOptions();
+    }
+    return SkSamplingOptions(static_cast<SkFilterMode>(sampling.filter),
+                             static_cast<SkMipmapMode>(sampling.mipmap));
+  }
+
+ private:
+  const uint8_t* ptr_;
+  const uint8_t* end_;
+  bool ok_ = true;
+};
+
+// Looks up an object referenced from a record. Only attribute setters
+// accept |kNullObject|.
+template <typename T>
+bool LookupObject(const std::vector<T>& table,
+                  uint32_t index,
+                  bool allow_null,
+                  T* result) {
+  if (index == kNullObject && allow_null) {
+    *result = nullptr;
+    return true;
+  }
+  if (index >= table.size()) {
+    return false;
+  }
+  *result = table[index];
+  return true;
+}
+
+void ReleaseMapping(const void* ptr, void* context) {
+  delete static_cast<std::shared_ptr<const fml::Mapping>*>(context);
+}
+
+// Wraps a range of |mapping| in an SkData that keeps the mapping alive.
+sk_sp<SkData> MakeMappedData(const std::shared_ptr<const fml::Mapping>& mapping,
+                             const uint8_t* ptr,
+                             size_t size) {
+  return SkData::MakeWithProc(
+      ptr, size, ReleaseMapping,
+      new std::shared_ptr<const fml::Mapping>(mapping));
+}
+
+// A range of a parent mapping, used for nested DisplayLists.
+class SubMapping final : public fml::Mapping {
+ public:
+  SubMapping(std::shared_ptr<const fml::Mapping> parent,
+             const uint8_t* data,
+             size_t size)
+      : parent_(std::move(parent)), data_(data), size_(size) {}
+
+  size_t GetSize() const override { return size_; }
+  const uint8_t* GetMapping() const override { return data_; }
+  bool IsDontNeedSafe() const override { return parent_->IsDontNeedSafe(); }
+
+ private:
+  std::shared_ptr<const fml::Mapping> parent_;
+  const uint8_t* data_;
+  size_t size_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(SubMapping);
+};
+
+template <typename T>
+sk_sp<T> DeserializeFlattenable(SkFlattenable::Type type,
+                                const uint8_t* data,
+                                size_t size) {
+  sk_sp<SkFlattenable> flattenable =
+      SkFlattenable::Deserialize(type, data, size);
+  return sk_sp<T>(static_cast<T*>(flattenable.release()));
+}
+
+}  // namespace
+
+sk_sp<SkData> DisplayListSerializer::Serialize(
+    const DisplayList& display_list) {
+  DisplayListWriter writer;
+  display_list.Dispatch(writer);
+  if (writer.failed()) {
+    return nullptr;
+  }
+
+  const std::vector<uint8_t>& records = writer.records();
+  const std::vector<DisplayListWriter::Object>& objects = writer.objects();
+  size_t records_offset =
+      sizeof(Header) + objects.size() * sizeof(ObjectEntry);
+  size_t total_size = records_offset + records.size();
+  std::vector<ObjectEntry> entries;
+  entries.reserve(objects.size());
+  for (const DisplayListWriter::Object& object : objects) {
+    total_size = Align(total_size, kPayloadAlignment);
+    entries.push_back({static_cast<uint32_t>(object.kind), 0, total_size,
+                       object.data->size()});
+    total_size += object.data->size();
+  }
+
+  sk_sp<SkData> data = SkData::MakeZeroInitialized(total_size);
+  uint8_t* bytes = static_cast<uint8_t*>(data->writable_data());
+  Header header = {
+      kMagic,
+      kVersion,
+      sizeof(Header),
+      writer.record_count(),
+      static_cast<uint32_t>(objects.size()),
+      0,
+      records_offset,
+      records.size(),
+      display_list.bounds_cull_,
+  };
+  memcpy(bytes, &header, sizeof(header));
+  if (!entries.empty()) {
+    memcpy(bytes + sizeof(header), entries.data(),
+           entries.size() * sizeof(ObjectEntry));
+  }
+  if (!records.empty()) {
+    memcpy(bytes + records_offset, records.data(), records.size());
+  }
+  for (size_t i = 0; i < objects.size(); i++) {
+    memcpy(bytes + entries[i].offset, objects[i].data->data(),
+           entries[i].size);
+  }
+  return data;
+}
+
+SerializedDisplayList::SerializedDisplayList(
+    std::shared_ptr<const fml::Mapping> mapping,
+    const SkRect& cull_rect,
+    uint32_t record_count,
+    const uint8_t* records,
+    size_t records_size,
+    int depth)
+    : mapping_(std::move(mapping)),
+      cull_rect_(cull_rect),
+      record_count_(record_count),
+      records_(records),
+      records_size_(records_size),
+      depth_(depth) {}
+
+SerializedDisplayList::~SerializedDisplayList() = default;
+
+std::unique_ptr<SerializedDisplayList> SerializedDisplayList::Create(
+    std::shared_ptr<const fml::Mapping> mapping) {
+  return Create(std::move(mapping), 0);
+}
+
+std::unique_ptr<SerializedDisplayList> SerializedDisplayList::Create(
+    std::shared_ptr<const fml::Mapping> mapping,
+    int depth) {
+  if (depth > kMaxNestingDepth) {
+    FML_LOG(ERROR) << "DisplayLists are nested too deeply";
+    return nullptr;
+  }
+  if (!mapping || !mapping->GetMapping() ||
+      mapping->GetSize() < sizeof(Header)) {
+    return nullptr;
+  }
+  if (reinterpret_cast<uintptr_t>(mapping->GetMapping()) %
+          kPayloadAlignment !=
+      0) {
+    // Only possible for mappings of memory that was not allocated for
+    // this purpose. Files are mapped at page boundaries.
+    mapping = std::make_shared<fml::MallocMapping>(
+        fml::MallocMapping::Copy(mapping->GetMapping(), mapping->GetSize()));
+  }
+  const uint8_t* base = mapping->GetMapping();
+  size_t size = mapping->GetSize();
+
+  Header header;
+  memcpy(&header, base, sizeof(header));
+  if (header.magic != DisplayListSerializer::kMagic ||
+      header.version != DisplayListSerializer::kVersion ||
+      header.header_size != sizeof(Header)) {
+    FML_LOG(ERROR) << "Not a DisplayList of version "
+                   << DisplayListSerializer::kVersion;
+    return nullptr;
+  }
+  size_t table_end =
+      sizeof(Header) +
+      static_cast<uint64_t>(header.object_count) * sizeof(ObjectEntry);
+  if (table_end > size || header.records_offset < table_end ||
+      header.records_offset > size ||
+      header.records_offset % kRecordAlignment != 0 ||
+      header.records_size > size - header.records_offset) {
+    return nullptr;
+  }
+
+  std::unique_ptr<SerializedDisplayList> result(new SerializedDisplayList(
+      mapping, header.cull_rect, header.record_count,
+      base + header.records_offset, header.records_size, depth));
+  for (uint32_t i = 0; i < header.object_count; i++) {
+    ObjectEntry entry;
+    memcpy(&entry, base + sizeof(Header) + i * sizeof(ObjectEntry),
+           sizeof(entry));
+    if (entry.offset > size || entry.size > size - entry.offset ||
+        !result->LoadObject(entry.kind, base + entry.offset, entry.size)) {
+      FML_LOG(ERROR) << "Malformed DisplayList object " << i;
+      return nullptr;
+    }
+  }
+  return result;
+}
+
+bool SerializedDisplayList::LoadObject(uint32_t kind,
+                                       const uint8_t* data,
+                                       size_t size) {
+  switch (static_cast<ObjectKind>(kind)) {
+    case ObjectKind::kPath: {
+      SkPath path;
+      if (path.readFromMemory(data, size) == 0) {
+        return false;
+      }
+      paths_.push_back(std::move(path));
+      return true;
+    }
+    case ObjectKind::kRasterImage: {
+      RasterImageHeader header;
+      if (size < sizeof(header)) {
+        return false;
+      }
+      memcpy(&header, data, sizeof(header));
+      size_t pixels_offset =
+          sizeof(header) + Align(header.color_space_size, kPayloadAlignment);
+      if (header.color_space_size > size || pixels_offset > size ||
+          header.color_type > kLastEnum_SkColorType ||
+          header.alpha_type > kLastEnum_SkAlphaType) {
+        return false;
+      }
+      sk_sp<SkColorSpace> color_space;
+      if (header.color_space_size > 0) {
+        color_space = SkColorSpace::Deserialize(data + sizeof(header),
+                                                header.color_space_size);
+        if (!color_space) {
+          return false;
+        }
+      }
+      SkImageInfo info = SkImageInfo::Make(
+          header.width, header.height,
+          static_cast<SkColorType>(header.color_type),
+          static_cast<SkAlphaType>(header.alpha_type), std::move(color_space));
+      size_t pixel_bytes = info.computeByteSize(header.row_bytes);
+      if (SkImageInfo::ByteSizeOverflowed(pixel_bytes) ||
+          pixel_bytes > size - pixels_offset) {
+        return false;
+      }
+      sk_sp<SkImage> image = SkImage::MakeRasterData(
+          info, MakeMappedData(mapping_, data + pixels_offset, pixel_bytes),
+          header.row_bytes);
+      if (!image) {
+        return false;
+      }
+      images_.push_back(std::move(image));
+      return true;
+    }
+    case ObjectKind::kEncodedImage: {
+      sk_sp<SkImage> image =
+          SkImage::MakeFromEncoded(MakeMappedData(mapping_, data, size));
+      if (!image) {
+        return false;
+      }
+      images_.push_back(std::move(image));
+      return true;
+    }
+    case ObjectKind::kTextBlob: {
+      sk_sp<SkTextBlob> blob =
+          SkTextBlob::Deserialize(data, size, SkDeserialProcs());
+      if (!blob) {
+        return false;
+      }
+      text_blobs_.push_back(std::move(blob));
+      return true;
+    }
+    case ObjectKind::kShader: {
+      auto shader = DeserializeFlattenable<SkShader>(
+          SkFlattenable::kSkShader_Type, data, size);
+      shaders_.push_back(std::move(shader));
+      return shaders_.back() != nullptr;
+    }
+    case ObjectKind::kColorFilter: {
+      auto filter = DeserializeFlattenable<SkColorFilter>(
+          SkFlattenable::kSkColorFilter_Type, data, size);
+      color_filters_.push_back(std::move(filter));
+      return color_filters_.back() != nullptr;
+    }
+    case ObjectKind::kImageFilter: {
+      auto filter = DeserializeFlattenable<SkImageFilter>(
+          SkFlattenable::kSkImageFilter_Type, data, size);
+      image_filters_.push_back(std::move(filter));
+      return image_filters_.back() != nullptr;
+    }
+    case ObjectKind::kMaskFilter: {
+      auto filter = DeserializeFlattenable<SkMaskFilter>(
+          SkFlattenable::kSkMaskFilter_Type, data, size);
+      mask_filters_.push_back(std::move(filter));
+      return mask_filters_.back() != nullptr;
+    }
+    case ObjectKind::kPathEffect: {
+      auto effect = DeserializeFlattenable<SkPathEffect>(
+          SkFlattenable::kSkPathEffect_Type, data, size);
+      path_effects_.push_back(std::move(effect));
+      return path_effects_.back() != nullptr;
+    }
+    case ObjectKind::kBlender: {
+      auto blender = DeserializeFlattenable<SkBlender>(
+          SkFlattenable::kSkBlender_Type, data, size);
+      blenders_.push_back(std::move(blender));
+      return blenders_.back() != nullptr;
+    }
+    case ObjectKind::kPicture: {
+      sk_sp<SkPicture> picture = SkPicture::MakeFromData(data, size);
+      if (!picture) {
+        return false;
+      }
+      pictures_.push_back(std::move(picture));
+      return true;
+    }
+    case ObjectKind::kDisplayList: {
+      // A nested DisplayList lies within the payloads of its parent, so it
+      // is always smaller. Anything else refers back to an enclosing one.
+      if (size >= mapping_->GetSize()) {
+        return false;
+      }
+      std::unique_ptr<SerializedDisplayList> nested = Create(
+          std::make_shared<SubMapping>(mapping_, data, size), depth_ + 1);
+      sk_sp<DisplayList> display_list =
+          nested ? nested->Materialize() : nullptr;
+      if (!display_list) {
+        return false;
+      }
+      display_lists_.push_back(std::move(display_list));
+      return true;
+    }
+  }
+  return false;
+}
+
+bool SerializedDisplayList::Dispatch(Dispatcher& dispatcher) const {
+  const uint8_t* ptr = records_;
+  const uint8_t* end = records_ + records_size_;
+  for (uint32_t i = 0; i < record_count_; i++) {
+    if (end - ptr < static_cast<ptrdiff_t>(sizeof(RecordHeader))) {
+      return false;
+    }
+    RecordHeader header;
+    memcpy(&header, ptr, sizeof(header));
+    if (header.size < sizeof(RecordHeader) ||
+        header.size % kRecordAlignment != 0 ||
+        header.size > static_cast<size_t>(end - ptr)) {
+      return false;
+    }
+    RecordReader reader(ptr + sizeof(RecordHeader), ptr + header.size);
+    ptr += header.size;
+
+// Reads the arguments with |reader|, then calls the dispatcher only if
+// they were all present and valid.
+#define DL_DISPATCH(call) \
+  if (!reader.ok()) {     \
+    return false;         \
+  }                       \
+  dispatcher.call;        \
+  break;
+
+#define DL_OBJECT(table, allow_null, var)                            \
+  if (!LookupObject(table, reader.Read<uint32_t>(), allow_null, &var)) { \
+    return false;                                                    \
+  }
+
+    switch (static_cast<SerializedOp>(header.op)) {
+      case SerializedOp::kSetAntiAlias: {
+        bool aa = reader.ReadBool();
+        DL_DISPATCH(setAntiAlias(aa));
+      }
+      case SerializedOp::kSetDither: {
+        bool dither = reader.ReadBool();
+        DL_DISPATCH(setDither(dither));
+      }
+      case SerializedOp::kSetStyle: {
+        auto style = reader.ReadEnum(SkPaint::kStrokeAndFill_Style);
+        DL_DISPATCH(setStyle(style));
+      }
+      case SerializedOp::kSetColor: {
+        SkColor color = reader.Read<SkColor>();
+        DL_DISPATCH(setColor(color));
+      }
+      case SerializedOp::kSetStrokeWidth: {
+        SkScalar width = reader.Read<SkScalar>();
+        DL_DISPATCH(setStrokeWidth(width));
+      }
+      case SerializedOp::kSetStrokeMiter: {
+        SkScalar limit = reader.Read<SkScalar>();
+        DL_DISPATCH(setStrokeMiter(limit));
+      }
+      case SerializedOp::kSetStrokeCap: {
+        auto cap = reader.ReadEnum(SkPaint::kLast_Cap);
+        DL_DISPATCH(setStrokeCap(cap));
+      }
+      case SerializedOp::kSetStrokeJoin: {
+        auto join = reader.ReadEnum(SkPaint::kLast_Join);
+        DL_DISPATCH(setStrokeJoin(join));
+      }
+      case SerializedOp::kSetShader: {
+        sk_sp<SkShader> shader;
+        DL_OBJECT(shaders_, true, shader);
+        DL_DISPATCH(setShader(std::move(shader)));
+      }
+      case SerializedOp::kSetColorFilter: {
+        sk_sp<SkColorFilter> filter;
+        DL_OBJECT(color_filters_, true, filter);
+        DL_DISPATCH(setColorFilter(std::move(filter)));
+      }
+      case SerializedOp::kSetInvertColors: {
+        bool invert = reader.ReadBool();
+        DL_DISPATCH(setInvertColors(invert));
+      }
+      case SerializedOp::kSetBlendMode: {
+        auto mode = reader.ReadEnum(SkBlendMode::kLastMode);
+        DL_DISPATCH(setBlendMode(mode));
+      }
+      case SerializedOp::kSetBlender: {
+        sk_sp<SkBlender> blender;
+        DL_OBJECT(blenders_, true, blender);
+        DL_DISPATCH(setBlender(std::move(blender)));
+      }
+      case SerializedOp::kSetPathEffect: {
+        sk_sp<SkPathEffect> effect;
+        DL_OBJECT(path_effects_, true, effect);
+        DL_DISPATCH(setPathEffect(std::move(effect)));
+      }
+      case SerializedOp::kSetMaskFilter: {
+        sk_sp<SkMaskFilter> filter;
+        DL_OBJECT(mask_filters_, true, filter);
+        DL_DISPATCH(setMaskFilter(std::move(filter)));
+      }
+      case SerializedOp::kSetMaskBlurFilter: {
+        auto style = reader.ReadEnum(kLastEnum_SkBlurStyle);
+        SkScalar sigma = reader.Read<SkScalar>();
+        DL_DISPATCH(setMaskBlurFilter(style, sigma));
+      }
+      case SerializedOp::kSetImageFilter: {
+        sk_sp<SkImageFilter> filter;
+        DL_OBJECT(image_filters_, true, filter);
+        DL_DISPATCH(setImageFilter(std::move(filter)));
+      }
+
+      case SerializedOp::kSave: {
+        DL_DISPATCH(save());
+      }
+      case SerializedOp::kSaveLayer: {
+        bool has_bounds = reader.ReadBool();
+        SkRect bounds = reader.Read<SkRect>();
+        bool restore_with_paint = reader.ReadBool();
+        DL_DISPATCH(
+            saveLayer(has_bounds ? &bounds : nullptr, restore_with_paint));
+      }
+      case SerializedOp::kRestore: {
+        DL_DISPATCH(restore());
+      }
+
+      case SerializedOp::kTranslate: {
+        SkScalar tx = reader.Read<SkScalar>();
+        SkScalar ty = reader.Read<SkScalar>();
+        DL_DISPATCH(translate(tx, ty));
+      }
+      case SerializedOp::kScale: {
+        SkScalar sx = reader.Read<SkScalar>();
+        SkScalar sy = reader.Read<SkScalar>();
+        DL_DISPATCH(scale(sx, sy));
+      }
+      case SerializedOp::kRotate: {
+        SkScalar degrees = reader.Read<SkScalar>();
+        DL_DISPATCH(rotate(degrees));
+      }
+      case SerializedOp::kSkew: {
+        SkScalar sx = reader.Read<SkScalar>();
+        SkScalar sy = reader.Read<SkScalar>();
+        DL_DISPATCH(skew(sx, sy));
+      }
+      case SerializedOp::kTransform2DAffine: {
+        const SkScalar* m = reader.ReadArray<SkScalar>(6);
+        // clang-format off
+        DL_DISPATCH(transform2DAffine(m[0], m[1], m[2],
+                                      m[3], m[4], m[5]));
+        // clang-format on
+      }
+      case SerializedOp::kTransformFullPerspective: {
+        const SkScalar* m = reader.ReadArray<SkScalar>(16);
+        // clang-format off
+        DL_DISPATCH(transformFullPerspective(m[0],  m[1],  m[2],  m[3],
+                                             m[4],  m[5],  m[6],  m[7],
+                                             m[8],  m[9],  m[10], m[11],
+                                             m[12], m[13], m[14], m[15]));
+        // clang-format on
+      }
+
+      case SerializedOp::kClipRect: {
+        SkRect rect = reader.Read<SkRect>();
+        auto clip_op = reader.ReadEnum(SkClipOp::kMax_EnumValue);
+        bool is_aa = reader.ReadBool();
+        DL_DISPATCH(clipRect(rect, clip_op, is_aa));
+      }
+      case SerializedOp::kClipRRect: {
+        SkRRect rrect = reader.Read<SkRRect>();
+        auto clip_op = reader.ReadEnum(SkClipOp::kMax_EnumValue);
+        bool is_aa = reader.ReadBool();
+        DL_DISPATCH(clipRRect(rrect, clip_op, is_aa));
+      }
+      case SerializedOp::kClipPath: {
+        uint32_t path = reader.Read<uint32_t>();
+        auto clip_op = reader.ReadEnum(SkClipOp::kMax_EnumValue);
+        bool is_aa = reader.ReadBool();
+        if (path >= paths_.size()) {
+          return false;
+        }
+        DL_DISPATCH(clipPath(paths_[path], clip_op, is_aa));
+      }
+
+      case SerializedOp::kDrawColor: {
+        SkColor color = reader.Read<SkColor>();
+        auto mode = reader.ReadEnum(SkBlendMode::kLastMode);
+        DL_DISPATCH(drawColor(color, mode));
+      }
+      case SerializedOp::kDrawPaint: {
+        DL_DISPATCH(drawPaint());
+      }
+      case SerializedOp::kDrawLine: {
+        SkPoint p0 = reader.Read<SkPoint>();
+        SkPoint p1 = reader.Read<SkPoint>();
+        DL_DISPATCH(drawLine(p0, p1));
+      }
+      case SerializedOp::kDrawRect: {
+        SkRect rect = reader.Read<SkRect>();
+        DL_DISPATCH(drawRect(rect));
+      }
+      case SerializedOp::kDrawOval: {
+        SkRect bounds = reader.Read<SkRect>();
+        DL_DISPATCH(drawOval(bounds));
+      }
+      case SerializedOp::kDrawCircle: {
+        SkPoint center = reader.Read<SkPoint>();
+        SkScalar radius = reader.Read<SkScalar>();
+        DL_DISPATCH(drawCircle(center, radius));
+      }
+      case SerializedOp::kDrawRRect: {
+        SkRRect rrect = reader.Read<SkRRect>();
+        DL_DISPATCH(drawRRect(rrect));
+      }
+      case SerializedOp::kDrawDRRect: {
+        SkRRect outer = reader.Read<SkRRect>();
+        SkRRect inner = reader.Read<SkRRect>();
+        DL_DISPATCH(drawDRRect(outer, inner));
+      }
+      case SerializedOp::kDrawPath: {
+        uint32_t path = reader.Read<uint32_t>();
+        if (path >= paths_.size()) {
+          return false;
+        }
+        DL_DISPATCH(drawPath(paths_[path]));
+      }
+      case SerializedOp::kDrawArc: {
+        SkRect bounds = reader.Read<SkRect>();
+        SkScalar start = reader.Read<SkScalar>();
+        SkScalar sweep = reader.Read<SkScalar>();
+        bool use_center = reader.ReadBool();
+        DL_DISPATCH(drawArc(bounds, start, sweep, use_center));
+      }
+      case SerializedOp::kDrawPoints: {
+        auto mode = reader.ReadEnum(SkCanvas::kPolygon_PointMode);
+        uint32_t count = reader.Read<uint32_t>();
+        const SkPoint* points = reader.ReadArray<SkPoint>(count);
+        DL_DISPATCH(drawPoints(mode, count, points));
+      }
+      case SerializedOp::kDrawImage: {
+        sk_sp<SkImage> image;
+        DL_OBJECT(images_, false, image);
+        SkPoint point = reader.Read<SkPoint>();
+        SkSamplingOptions sampling = reader.ReadSampling();
+        bool render_with_attributes = reader.ReadBool();
+        DL_DISPATCH(
+            drawImage(image, point, sampling, render_with_attributes));
+      }
+      case SerializedOp::kDrawImageRect: {
+        sk_sp<SkImage> image;
+        DL_OBJECT(images_, false, image);
+        SkRect src = reader.Read<SkRect>();
+        SkRect dst = reader.Read<SkRect>();
+        SkSamplingOptions sampling = reader.ReadSampling();
+        bool render_with_attributes = reader.ReadBool();
+        auto constraint =
+            reader.ReadEnum(SkCanvas::kFast_SrcRectConstraint);
+        DL_DISPATCH(drawImageRect(image, src, dst, sampling,
+                                  render_with_attributes, constraint));
+      }
+      case SerializedOp::kDrawImageNine: {
+        sk_sp<SkImage> image;
+        DL_OBJECT(images_, false, image);
+        SkIRect center = reader.Read<SkIRect>();
+        SkRect dst = reader.Read<SkRect>();
+        auto filter = reader.ReadEnum(SkFilterMode::kLast);
+        bool render_with_attributes = reader.ReadBool();
+        DL_DISPATCH(
+            drawImageNine(image, center, dst, filter, render_with_attributes));
+      }
+      case SerializedOp::kDrawImageLattice: {
+        sk_sp<SkImage> image;
+        DL_OBJECT(images_, false, image);
+        SkRect dst = reader.Read<SkRect>();
+        auto filter = reader.ReadEnum(SkFilterMode::kLast);
+        bool render_with_attributes = reader.ReadBool();
+        uint32_t x_count = reader.Read<uint32_t>();
+        uint32_t y_count = reader.Read<uint32_t>();
+        bool has_bounds = reader.ReadBool();
+        SkIRect bounds = reader.Read<SkIRect>();
+        bool has_rect_types = reader.ReadBool();
+        bool has_colors = reader.ReadBool();
+        size_t cell_count = (static_cast<size_t>(x_count) + 1) *
+                            (static_cast<size_t>(y_count) + 1);
+        SkCanvas::Lattice lattice;
+        lattice.fXDivs = reader.ReadArray<int>(x_count);
+        lattice.fYDivs = reader.ReadArray<int>(y_count);
+        lattice.fColors =
+            has_colors ? reader.ReadArray<SkColor>(cell_count) : nullptr;
+        lattice.fRectTypes =
+            has_rect_types
+                ? reader.ReadArray<SkCanvas::Lattice::RectType>(cell_count)
+                : nullptr;
+        lattice.fXCount = x_count;
+        lattice.fYCount = y_count;
+        lattice.fBounds = has_bounds ? &bounds : nullptr;
+        DL_DISPATCH(drawImageLattice(image, lattice, dst, filter,
+                                     render_with_attributes));
+      }
+      case SerializedOp::kDrawAtlas: {
+        sk_sp<SkImage> atlas;
+        DL_OBJECT(images_, false, atlas);
+        uint32_t count = reader.Read<uint32_t>();
+        auto mode = reader.ReadEnum(SkBlendMode::kLastMode);
+        SkSamplingOptions sampling = reader.ReadSampling();
+        bool has_cull_rect = reader.ReadBool();
+        SkRect cull_rect = reader.Read<SkRect>();
+        bool render_with_attributes = reader.ReadBool();
+        bool has_colors = reader.ReadBool();
+        const SkRSXform* xform = reader.ReadArray<SkRSXform>(count);
+        const SkRect* tex = reader.ReadArray<SkRect>(count);
+        const SkColor* colors =
+            has_colors ? reader.ReadArray<SkColor>(count) : nullptr;
+        DL_DISPATCH(drawAtlas(atlas, xform, tex, colors, count, mode, sampling,
+                              has_cull_rect ? &cull_rect : nullptr,
+                              render_with_attributes));
+      }
+      case SerializedOp::kDrawPicture: {
+        sk_sp<SkPicture> picture;
+        DL_OBJECT(pictures_, false, picture);
+        bool has_matrix = reader.ReadBool();
+        const SkScalar* values = reader.ReadArray<SkScalar>(9);
+        bool render_with_attributes = reader.ReadBool();
+        SkMatrix matrix;
+        if (values) {
+          matrix.set9(values);
+        }
+        DL_DISPATCH(drawPicture(picture, has_matrix ? &matrix : nullptr,
+                                render_with_attributes));
+      }
+      case SerializedOp::kDrawDisplayList: {
+        sk_sp<DisplayList> display_list;
+        DL_OBJECT(display_lists_, false, display_list);
+        DL_DISPATCH(drawDisplayList(display_list));
+      }
+      case SerializedOp::kDrawTextBlob: {
+        sk_sp<SkTextBlob> blob;
+        DL_OBJECT(text_blobs_, false, blob);
+        SkScalar x = reader.Read<SkScalar>();
+        SkScalar y = reader.Read<SkScalar>();
+        DL_DISPATCH(drawTextBlob(blob, x, y));
+      }
+      case SerializedOp::kDrawShadow: {
+        uint32_t path = reader.Read<uint32_t>();
+        SkColor color = reader.Read<SkColor>();
+        SkScalar elevation = reader.Read<SkScalar>();
+        bool transparent_occluder = reader.ReadBool();
+        SkScalar dpr = reader.Read<SkScalar>();
+        if (path >= paths_.size()) {
+          return false;
+        }
+        DL_DISPATCH(drawShadow(paths_[path], color, elevation,
+                               transparent_occluder, dpr));
+      }
+
+      default:
+        FML_LOG(ERROR) << "Unknown DisplayList record " << header.op;
+        return false;
+    }
+
+#undef DL_OBJECT
+#undef DL_DISPATCH
+  }
+  return true;
+}
+
+sk_sp<DisplayList> SerializedDisplayList::Materialize() const {
+  DisplayListBuilder builder(cull_rect_);
+  if (!Dispatch(builder)) {
+    return nullptr;
+  }
+  return builder.Build();
+}
+
+}  // namespace flutter
@@ -0,0 +1,121 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_DISPLAY_LIST_SERIALIZATION_H_
+#define FLUTTER_FLOW_DISPLAY_LIST_SERIALIZATION_H_
+
+#include <memory>
+#include <vector>
+
+#include "flutter/flow/display_list.h"
+#include "flutter/fml/macros.h"
+#include "flutter/fml/mapping.h"
+
+#include "third_party/skia/include/core/SkData.h"
+#include "third_party/skia/include/core/SkTextBlob.h"
+
+// A versioned binary form of a DisplayList that can be written to disk and
+// dispatched again straight from a memory mapping of that file.
+//
+// The serialized form is laid out as follows, with all offsets counted in
+// bytes from the start of the data and all values in native byte order:
+//
+//   Header
+//   ObjectEntry[Header::object_count]
+//   op records
+//   object payloads
+//
+// Each op record starts with an 8-byte RecordHeader holding a stable op
+// code and the size of the record, followed by the arguments of the
+// corresponding Dispatcher method. Scalars, rects and arrays of points,
+// transforms and colors are stored inline and are handed to the Dispatcher
+// as pointers into the mapping. Shaders, filters, path effects, blenders,
+// paths, images, text blobs, pictures and nested DisplayLists are stored
+// once each in the object payloads and referenced from the records by
+// their index within their kind.
+//
+// Readers only accept data written with the same |kVersion|.
+
+namespace flutter {
+
+class DisplayListSerializer {
+ public:
+  static constexpr uint32_t kMagic = 0x4C444C46;  // "FLDL"
+  static constexpr uint32_t kVersion = 1;
+
+  // Returns null if |display_list| contains content that has no serialized
+  // form, which is currently texture-backed images and vertices.
+  static sk_sp<SkData> Serialize(const DisplayList& display_list);
+
+ private:
+  FML_DISALLOW_IMPLICIT_CONSTRUCTORS(DisplayListSerializer);
+};
+
+class SerializedDisplayList {
+ public:
+  // Validates the header and object table of |mapping| and deserializes
+  // the objects. Returns null if the data is not a DisplayList serialized
+  // with the current version or is malformed.
+  //
+  // The op records are not copied and are read from |mapping| on every
+  // |Dispatch|. Raster image pixels and encoded images also keep
+  // referring to |mapping|, which is kept alive for as long as any of
+  // those images is.
+  static std::unique_ptr<SerializedDisplayList> Create(
+      std::shared_ptr<const fml::Mapping> mapping);
+
+  ~SerializedDisplayList();
+
+  const SkRect& cull_rect() const { return cull_rect_; }
+
+  // The number of op records, which counts attribute ops too.
+  uint32_t record_count() const { return record_count_; }
+
+  // Dispatches the op records in order. Returns false and stops at the
+  // first malformed record.
+  bool Dispatch(Dispatcher& dispatcher) const;
+
+  // Replays the op records into a new DisplayList.
+  sk_sp<DisplayList> Materialize() const;
+
+ private:
+  SerializedDisplayList(std::shared_ptr<const fml::Mapping> mapping,
+                        const SkRect& cull_rect,
+                        uint32_t record_count,
+                        const uint8_t* records,
+                        size_t records_size,
+                        int depth);
+
+  // |depth| counts the DisplayLists that |mapping| is nested in.
+  static std::unique_ptr<SerializedDisplayList> Create(
+      std::shared_ptr<const fml::Mapping> mapping,
+      int depth);
+
+  std::shared_ptr<const fml::Mapping> mapping_;
+  SkRect cull_rect_;
+  uint32_t record_count_;
+  const uint8_t* records_;
+  size_t records_size_;
+  int depth_;
+
+  std::vector<SkPath> paths_;
+  std::vector<sk_sp<SkImage>> images_;
+  std::vector<sk_sp<SkTextBlob>> text_blobs_;
+  std::vector<sk_sp<SkShader>> shaders_;
+  std::vector<sk_sp<SkColorFilter>> color_filters_;
+  std::vector<sk_sp<SkImageFilter>> image_filters_;
+  std::vector<sk_sp<SkMaskFilter>> mask_filters_;
+  std::vector<sk_sp<SkPathEffect>> path_effects_;
+  std::vector<sk_sp<SkBlender>> blenders_;
+  std::vector<sk_sp<SkPicture>> pictures_;
+  std::vector<sk_sp<DisplayList>> display_lists_;
+
+  bool LoadObject(uint32_t kind, const uint8_t* data, size_t size);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(SerializedDisplayList);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_DISPLAY_LIST_SERIALIZATION_H_
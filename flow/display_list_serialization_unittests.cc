@@ -0,0 +1,243 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/display_list_serialization.h"
+
+#include <cstring>
+
+#include "third_party/skia/include/core/SkEncodedImageFormat.h"
+#include "third_party/skia/include/core/SkFont.h"
+#include "third_party/skia/include/core/SkSurface.h"
+#include "third_party/skia/include/effects/SkGradientShader.h"
+#include "third_party/skia/include/effects/SkImageFilters.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+static constexpr int kRenderSize = 100;
+
+static sk_sp<SkImage> MakeTestImage() {
+  sk_sp<SkSurface> surface = SkSurface::MakeRasterN32Premul(10, 10);
+  SkCanvas* canvas = surface->getCanvas();
+  canvas->clear(SK_ColorBLUE);
+  SkPaint paint;
+  paint.setColor(SK_ColorGREEN);
+  canvas->drawRect(SkRect::MakeLTRB(0, 0, 5, 5), paint);
+  return surface->makeImageSnapshot();
+}
+
+static sk_sp<DisplayList> MakeTestDisplayList() {
+  DisplayListBuilder nested_builder;
+  nested_builder.setColor(SK_ColorMAGENTA);
+  nested_builder.drawCircle({10, 10}, 8);
+  sk_sp<DisplayList> nested = nested_builder.Build();
+
+  SkPoint gradient_points[] = {{0, 0}, {50, 50}};
+  SkColor gradient_colors[] = {SK_ColorRED, SK_ColorYELLOW};
+
+  DisplayListBuilder builder(SkRect::MakeWH(kRenderSize, kRenderSize));
+  builder.setColor(SK_ColorRED);
+  builder.drawRect(SkRect::MakeLTRB(5, 5, 30, 30));
+  builder.setShader(SkGradientShader::MakeLinear(
+      gradient_points, gradient_colors, nullptr, 2, SkTileMode::kClamp));
+  builder.drawRect(SkRect::MakeLTRB(40, 5, 90, 30));
+  builder.setShader(nullptr);
+  SkPath path;
+  path.moveTo(10, 40);
+  path.lineTo(40, 70);
+  path.lineTo(10, 70);
+  path.close();
+  builder.setStyle(SkPaint::kStroke_Style);
+  builder.setStrokeWidth(3);
+  builder.drawPath(path);
+  builder.setStyle(SkPaint::kFill_Style);
+  builder.setImageFilter(SkImageFilters::Blur(2, 2, nullptr));
+  builder.saveLayer(nullptr, true);
+  builder.setImageFilter(nullptr);
+  builder.translate(50, 40);
+  builder.drawImage(MakeTestImage(), {0, 0}, SkSamplingOptions(), false);
+  builder.drawDisplayList(nested);
+  builder.restore();
+  return builder.Build();
+}
+
+static std::unique_ptr<SerializedDisplayList> Reload(sk_sp<SkData> data) {
+  EXPECT_NE(data, nullptr);
+  std::vector<uint8_t> bytes(data->bytes(), data->bytes() + data->size());
+  return SerializedDisplayList::Create(
+      std::make_shared<fml::DataMapping>(std::move(bytes)));
+}
+
+static std::vector<uint32_t> Render(const sk_sp<DisplayList>& display_list) {
+  sk_sp<SkSurface> surface =
+      SkSurface::MakeRasterN32Premul(kRenderSize, kRenderSize);
+  display_list->RenderTo(surface->getCanvas());
+  std::vector<uint32_t> pixels(kRenderSize * kRenderSize);
+  SkImageInfo info = SkImageInfo::MakeN32Premul(kRenderSize, kRenderSize);
+  EXPECT_TRUE(surface->readPixels(info, pixels.data(),
+                                  kRenderSize * sizeof(uint32_t), 0, 0));
+  return pixels;
+}
+
+TEST(DisplayListSerialization, RoundTripRendersIdentically) {
+  sk_sp<DisplayList> original = MakeTestDisplayList();
+  auto serialized = Reload(DisplayListSerializer::Serialize(*original));
+  ASSERT_NE(serialized, nullptr);
+  EXPECT_EQ(serialized->cull_rect(), SkRect::MakeWH(kRenderSize, kRenderSize));
+
+  sk_sp<DisplayList> copy = serialized->Materialize();
+  ASSERT_NE(copy, nullptr);
+  EXPECT_EQ(copy->op_count(), original->op_count());
+  EXPECT_EQ(copy->bounds(), original->bounds());
+  EXPECT_EQ(Render(copy), Render(original));
+}
+
+TEST(DisplayListSerialization, TextBlobRoundTrips) {
+  std::string text = "Serialized";
+  DisplayListBuilder builder;
+  builder.drawTextBlob(SkTextBlob::MakeFromText(text.c_str(), text.size(),
+                                                SkFont(), SkTextEncoding::kUTF8),
+                       10, 20);
+  sk_sp<DisplayList> original = builder.Build();
+
+  auto serialized = Reload(DisplayListSerializer::Serialize(*original));
+  ASSERT_NE(serialized, nullptr);
+  sk_sp<DisplayList> copy = serialized->Materialize();
+  ASSERT_NE(copy, nullptr);
+  EXPECT_EQ(copy->op_count(), 1);
+  EXPECT_EQ(copy->bounds(), original->bounds());
+}
+
+TEST(DisplayListSerialization, SharedObjectsAreWrittenOnce) {
+  sk_sp<SkImage> image = MakeTestImage();
+  DisplayListBuilder once_builder;
+  once_builder.drawImage(image, {0, 0}, SkSamplingOptions(), false);
+  DisplayListBuilder twice_builder;
+  twice_builder.drawImage(image, {0, 0}, SkSamplingOptions(), false);
+  twice_builder.drawImage(image, {20, 0}, SkSamplingOptions(), false);
+
+  sk_sp<SkData> once = DisplayListSerializer::Serialize(*once_builder.Build());
+  sk_sp<SkData> twice =
+      DisplayListSerializer::Serialize(*twice_builder.Build());
+  ASSERT_NE(once, nullptr);
+  ASSERT_NE(twice, nullptr);
+  // Only the second drawImage record is added, not a second copy of the
+  // pixels.
+  EXPECT_LT(twice->size(), once->size() + 100);
+}
+
+TEST(DisplayListSerialization, MixedImageKindsRoundTrip) {
+  sk_sp<SkImage> raster = MakeTestImage();
+  sk_sp<SkImage> encoded = SkImage::MakeFromEncoded(
+      MakeTestImage()->encodeToData(SkEncodedImageFormat::kPNG, 100));
+  ASSERT_NE(encoded, nullptr);
+  ASSERT_NE(encoded->refEncodedData(), nullptr);
+
+  sk_sp<SkSurface> surface = SkSurface::MakeRasterN32Premul(10, 10);
+  surface->getCanvas()->clear(SK_ColorRED);
+  sk_sp<SkImage> other_raster = surface->makeImageSnapshot();
+
+  // Encoded and raster images interleaved, so that the indices of both kinds
+  // have to line up for the copy to draw the right images.
+  DisplayListBuilder builder(SkRect::MakeWH(kRenderSize, kRenderSize));
+  builder.drawImage(encoded, {0, 0}, SkSamplingOptions(), false);
+  builder.drawImage(raster, {20, 0}, SkSamplingOptions(), false);
+  builder.drawImage(other_raster, {40, 0}, SkSamplingOptions(), false);
+  builder.drawImage(encoded, {60, 0}, SkSamplingOptions(), false);
+  sk_sp<DisplayList> original = builder.Build();
+
+  auto serialized = Reload(DisplayListSerializer::Serialize(*original));
+  ASSERT_NE(serialized, nullptr);
+  sk_sp<DisplayList> copy = serialized->Materialize();
+  ASSERT_NE(copy, nullptr);
+  EXPECT_EQ(Render(copy), Render(original));
+}
+
+TEST(DisplayListSerialization, RejectsMalformedData) {
+  sk_sp<SkData> data = DisplayListSerializer::Serialize(*MakeTestDisplayList());
+  ASSERT_NE(data, nullptr);
+  std::vector<uint8_t> good(data->bytes(), data->bytes() + data->size());
+
+  std::vector<uint8_t> bad_magic = good;
+  bad_magic[0] ^= 0xFF;
+  EXPECT_EQ(SerializedDisplayList::Create(
+                std::make_shared<fml::DataMapping>(std::move(bad_magic))),
+            nullptr);
+
+  std::vector<uint8_t> bad_version = good;
+  uint32_t version = DisplayListSerializer::kVersion + 1;
+  memcpy(bad_version.data() + sizeof(uint32_t), &version, sizeof(version));
+  EXPECT_EQ(SerializedDisplayList::Create(
+                std::make_shared<fml::DataMapping>(std::move(bad_version))),
+            nullptr);
+
+  std::vector<uint8_t> truncated(good.begin(), good.begin() + good.size() / 2);
+  EXPECT_EQ(SerializedDisplayList::Create(
+                std::make_shared<fml::DataMapping>(std::move(truncated))),
+            nullptr);
+
+  EXPECT_EQ(SerializedDisplayList::Create(nullptr), nullptr);
+
+  // The offset of the op records, past the end of the data.
+  std::vector<uint8_t> bad_records_offset = good;
+  uint64_t records_offset = good.size() + 8;
+  memcpy(bad_records_offset.data() + 6 * sizeof(uint32_t), &records_offset,
+         sizeof(records_offset));
+  EXPECT_EQ(SerializedDisplayList::Create(std::make_shared<fml::DataMapping>(
+                std::move(bad_records_offset))),
+            nullptr);
+}
+
+TEST(DisplayListSerialization, RejectsSelfReferencingDisplayList) {
+  DisplayListBuilder nested_builder;
+  nested_builder.drawRect(SkRect::MakeLTRB(0, 0, 10, 10));
+  DisplayListBuilder builder;
+  builder.drawDisplayList(nested_builder.Build());
+  sk_sp<SkData> data = DisplayListSerializer::Serialize(*builder.Build());
+  ASSERT_NE(data, nullptr);
+  std::vector<uint8_t> bytes(data->bytes(), data->bytes() + data->size());
+
+  // The only object is the nested DisplayList. Point its entry, which
+  // follows the 56-byte header, at the whole data.
+  const size_t kHeaderSize = 56;
+  const size_t kObjectCountOffset = 4 * sizeof(uint32_t);
+  const uint32_t kDisplayListKind = 12;
+  uint32_t object_count;
+  memcpy(&object_count, bytes.data() + kObjectCountOffset,
+         sizeof(object_count));
+  ASSERT_EQ(object_count, 1u);
+  uint32_t kind;
+  memcpy(&kind, bytes.data() + kHeaderSize, sizeof(kind));
+  ASSERT_EQ(kind, kDisplayListKind);
+  uint64_t range[] = {0, bytes.size()};
+  memcpy(bytes.data() + kHeaderSize + 2 * sizeof(uint32_t), range,
+         sizeof(range));
+
+  EXPECT_EQ(SerializedDisplayList::Create(
+                std::make_shared<fml::DataMapping>(std::move(bytes))),
+            nullptr);
+}
+
+TEST(DisplayListSerialization, RejectsDeeplyNestedDisplayLists) {
+  DisplayListBuilder innermost_builder;
+  innermost_builder.drawRect(SkRect::MakeLTRB(0, 0, 10, 10));
+  sk_sp<DisplayList> display_list = innermost_builder.Build();
+
+  auto nest = [&display_list](int levels) {
+    for (int i = 0; i < levels; i++) {
+      DisplayListBuilder builder;
+      builder.drawDisplayList(display_list);
+      display_list = builder.Build();
+    }
+  };
+
+  nest(8);
+  EXPECT_NE(Reload(DisplayListSerializer::Serialize(*display_list)), nullptr);
+  nest(100);
+  EXPECT_EQ(Reload(DisplayListSerializer::Serialize(*display_list)), nullptr);
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -1397,5 +1397,237 @@ TEST(DisplayList, SetMaskFilterNullResetsMaskFilter) {
   ASSERT_EQ(display_list->bytes(), sizeof(DisplayList) + 8u + 24u + 8u + 24u);
 }
 
+
+TEST(DisplayList, OptimizeRemovesEmptySaveRestore) {
+  DisplayListBuilder builder;
+  builder.setOptimizeOnBuild(true);
+  builder.save();
+  builder.translate(10, 10);
+  builder.save();
+  builder.clipRect({0, 0, 20, 20}, SkClipOp::kIntersect, false);
+  builder.restore();
+  builder.restore();
+  builder.drawRect({10, 10, 20, 20});
+  sk_sp<DisplayList> optimized = builder.Build();
+
+  DisplayListBuilder expected_builder;
+  expected_builder.drawRect({10, 10, 20, 20});
+  sk_sp<DisplayList> expected = expected_builder.Build();
+
+  ASSERT_EQ(optimized->op_count(), 1);
+  ASSERT_TRUE(optimized->Equals(*expected));
+}
+
+TEST(DisplayList, OptimizeRemovesOnlyNopEmptySaveLayers) {
+  DisplayListBuilder builder;
+  builder.setOptimizeOnBuild(true);
+  builder.saveLayer(nullptr, false);
+  builder.restore();
+  builder.setColor(SkColorSetARGB(0x80, 0, 0, 0));
+  builder.saveLayer(nullptr, true);
+  builder.restore();
+  sk_sp<DisplayList> nop_layers = builder.Build();
+  ASSERT_EQ(nop_layers->op_count(), 0);
+
+  // An empty layer restored with kSrc clears its bounds.
+  builder.setBlendMode(SkBlendMode::kSrc);
+  builder.saveLayer(nullptr, true);
+  builder.restore();
+  sk_sp<DisplayList> clearing_layer = builder.Build();
+  ASSERT_EQ(clearing_layer->op_count(), 2);
+}
+
+TEST(DisplayList, OptimizeMergesConsecutiveTranslateAndScale) {
+  DisplayListBuilder builder;
+  builder.setOptimizeOnBuild(true);
+  builder.translate(10, 10);
+  builder.setColor(SK_ColorBLUE);
+  builder.translate(5, 5);
+  builder.drawRect({0, 0, 10, 10});
+  builder.scale(2, 2);
+  builder.scale(3, 0.5);
+  builder.drawRect({0, 0, 10, 10});
+  builder.translate(7, 0);
+  builder.translate(-7, 0);
+  builder.drawRect({0, 0, 10, 10});
+  builder.translate(10, 20);
+  builder.scale(2, 4);
+  builder.drawRect({0, 0, 10, 10});
+  sk_sp<DisplayList> optimized = builder.Build();
+
+  DisplayListBuilder expected_builder;
+  expected_builder.setColor(SK_ColorBLUE);
+  expected_builder.translate(15, 15);
+  expected_builder.drawRect({0, 0, 10, 10});
+  expected_builder.scale(6, 1);
+  expected_builder.drawRect({0, 0, 10, 10});
+  expected_builder.drawRect({0, 0, 10, 10});
+  expected_builder.transform2DAffine(2, 0, 10,  //
+                                     0, 4, 20);
+  expected_builder.drawRect({0, 0, 10, 10});
+  sk_sp<DisplayList> expected = expected_builder.Build();
+
+  ASSERT_EQ(optimized->op_count(), 7);
+  ASSERT_TRUE(optimized->Equals(*expected));
+}
+
+TEST(DisplayList, OptimizeCullsOpsOutsideCullRect) {
+  DisplayListBuilder builder(SkRect::MakeWH(100, 100));
+  builder.setOptimizeOnBuild(true);
+  builder.setColor(SK_ColorRED);
+  builder.drawRect({200, 200, 300, 300});
+  builder.setColor(SK_ColorBLUE);
+  builder.drawRect({50, 50, 60, 60});
+  builder.save();
+  builder.translate(-150, -150);
+  builder.drawRect({200, 200, 300, 300});
+  builder.restore();
+  builder.setStyle(SkPaint::kStroke_Style);
+  builder.setStrokeWidth(20);
+  builder.drawRect({105, 105, 150, 150});
+  sk_sp<DisplayList> optimized = builder.Build();
+
+  DisplayListBuilder expected_builder(SkRect::MakeWH(100, 100));
+  expected_builder.setColor(SK_ColorBLUE);
+  expected_builder.drawRect({50, 50, 60, 60});
+  expected_builder.save();
+  expected_builder.translate(-150, -150);
+  expected_builder.drawRect({200, 200, 300, 300});
+  expected_builder.restore();
+  expected_builder.setStyle(SkPaint::kStroke_Style);
+  expected_builder.setStrokeWidth(20);
+  expected_builder.drawRect({105, 105, 150, 150});
+  sk_sp<DisplayList> expected = expected_builder.Build();
+
+  ASSERT_EQ(optimized->op_count(), 6);
+  ASSERT_TRUE(optimized->Equals(*expected));
+}
+
+TEST(DisplayList, OptimizeDoesNotCullInsideFilteredSaveLayer) {
+  DisplayListBuilder builder(SkRect::MakeWH(100, 100));
+  builder.setOptimizeOnBuild(true);
+  builder.setImageFilter(SkImageFilters::Offset(-200, -200, nullptr));
+  builder.saveLayer(nullptr, true);
+  builder.setImageFilter(nullptr);
+  builder.drawRect({200, 200, 300, 300});
+  builder.restore();
+  sk_sp<DisplayList> optimized = builder.Build();
+
+  ASSERT_EQ(optimized->op_count(), 3);
+}
+
+
+TEST(DisplayList, RTreeIsOnlyBuiltOnRequest) {
+  DisplayListBuilder builder;
+  builder.drawRect({10, 10, 20, 20});
+  ASSERT_EQ(builder.Build()->rtree(), nullptr);
+
+  builder.setBuildRTree(true);
+  builder.drawRect({10, 10, 20, 20});
+  builder.setColor(SK_ColorBLUE);
+  builder.drawRect({30, 30, 40, 40});
+  sk_sp<DisplayList> display_list = builder.Build();
+  ASSERT_NE(display_list->rtree(), nullptr);
+  // Attribute ops are not indexed.
+  ASSERT_EQ(display_list->rtree()->getCount(), 2);
+  ASSERT_EQ(display_list->bounds(), SkRect::MakeLTRB(10, 10, 40, 40));
+}
+
+TEST(DisplayList, CulledDispatchSkipsOpsOutsideCullRect) {
+  DisplayListBuilder builder;
+  builder.setBuildRTree(true);
+  builder.drawRect({0, 0, 10, 10});
+  builder.save();
+  builder.translate(100, 0);
+  builder.clipRect({0, 0, 50, 50}, SkClipOp::kIntersect, false);
+  builder.setColor(SK_ColorBLUE);
+  builder.drawRect({0, 0, 10, 10});
+  // Entirely clipped out.
+  builder.drawRect({60, 0, 70, 10});
+  builder.restore();
+  builder.drawRect({200, 0, 210, 10});
+  sk_sp<DisplayList> display_list = builder.Build();
+
+  DisplayListBuilder culled_builder;
+  display_list->Dispatch(culled_builder, SkRect::MakeLTRB(95, 0, 120, 20));
+  sk_sp<DisplayList> culled = culled_builder.Build();
+
+  DisplayListBuilder expected_builder;
+  expected_builder.save();
+  expected_builder.translate(100, 0);
+  expected_builder.clipRect({0, 0, 50, 50}, SkClipOp::kIntersect, false);
+  expected_builder.setColor(SK_ColorBLUE);
+  expected_builder.drawRect({0, 0, 10, 10});
+  expected_builder.restore();
+  sk_sp<DisplayList> expected = expected_builder.Build();
+
+  ASSERT_TRUE(culled->Equals(*expected));
+
+  DisplayListBuilder full_builder;
+  display_list->Dispatch(full_builder, SkRect::MakeLTRB(-10, -10, 300, 300));
+  ASSERT_TRUE(full_builder.Build()->Equals(*display_list));
+}
+
+TEST(DisplayList, CulledDispatchHonorsSaveLayerFilterBounds) {
+  DisplayListBuilder builder(SkRect::MakeWH(500, 500));
+  builder.setBuildRTree(true);
+  builder.setImageFilter(SkImageFilters::Offset(-200, 0, nullptr));
+  builder.saveLayer(nullptr, true);
+  builder.setImageFilter(nullptr);
+  builder.drawRect({200, 0, 210, 10});
+  builder.restore();
+  builder.drawPaint();
+  sk_sp<DisplayList> display_list = builder.Build();
+
+  // The filter moves the rect into the cull rect and drawPaint floods
+  // the whole cull rect of the list, so nothing may be culled.
+  DisplayListBuilder culled_builder;
+  display_list->Dispatch(culled_builder, SkRect::MakeLTRB(0, 0, 20, 20));
+  ASSERT_TRUE(culled_builder.Build()->Equals(*display_list));
+
+  // Outside of the filtered layer only drawPaint remains.
+  DisplayListBuilder far_builder;
+  display_list->Dispatch(far_builder, SkRect::MakeLTRB(300, 300, 320, 320));
+  ASSERT_EQ(far_builder.Build()->op_count(), 3);
+}
+
+
+TEST(DisplayList, SaveLayerBoundsUseLayerRelativeClip) {
+  DisplayListBuilder builder(SkRect::MakeLTRB(100, 0, 200, 100));
+  builder.setBuildRTree(true);
+  builder.translate(100, 0);
+  builder.saveLayer(nullptr, false);
+  builder.drawRect({0, 0, 10, 10});
+  builder.restore();
+  sk_sp<DisplayList> display_list = builder.Build();
+  ASSERT_EQ(display_list->bounds(), SkRect::MakeLTRB(100, 0, 110, 10));
+
+  DisplayListBuilder culled_builder;
+  display_list->Dispatch(culled_builder, SkRect::MakeLTRB(105, 5, 120, 20));
+  ASSERT_TRUE(culled_builder.Build()->Equals(*display_list));
+}
+
+TEST(DisplayList, EqualListsHaveEqualContentHashes) {
+  auto build = [](SkScalar x) {
+    SkPath path;
+    path.addCircle(x, 20, 10);
+    DisplayListBuilder builder;
+    builder.setColor(SK_ColorRED);
+    builder.drawRect(SkRect::MakeLTRB(x, 0, x + 10, 10));
+    builder.clipPath(path, SkClipOp::kIntersect, true);
+    builder.drawPath(path);
+    return builder.Build();
+  };
+  sk_sp<DisplayList> list1 = build(10);
+  sk_sp<DisplayList> list2 = build(10);
+  sk_sp<DisplayList> different = build(11);
+
+  // The paths are separate objects, but compare and hash by value.
+  ASSERT_TRUE(list1->Equals(*list2));
+  ASSERT_EQ(list1->content_hash(), list2->content_hash());
+  ASSERT_FALSE(list1->Equals(*different));
+  ASSERT_NE(list1->content_hash(), different->content_hash());
+}
+
 }  // namespace testing
 }  // namespace flutter
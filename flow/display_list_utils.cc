@@ -288,7 +288,20 @@ void DisplayListBoundsCalculator::saveLayer(const SkRect* bounds,
   accumulator_ = layer_infos_.back()->layer_accumulator();
   // Accumulate the layer in its own coordinate system and then
   // filter and transform its bounds on restore.
+  SkMatrix outer_matrix = matrix();
   SkMatrixDispatchHelper::reset();
+  // The clip must move into the same coordinate system. Without an
+  // affine inverse the layer is left unclipped and its contents are
+  // clipped by the outer clip on restore instead.
+  if (has_clip()) {
+    SkMatrix inverse;
+    if (!outer_matrix.hasPerspective() && outer_matrix.invert(&inverse)) {
+      SkRect local_clip = inverse.mapRect(clip_bounds());
+      ClipBoundsDispatchHelper::reset(&local_clip);
+    } else {
+      ClipBoundsDispatchHelper::reset(nullptr);
+    }
+  }
   if (bounds) {
     clipRect(*bounds, SkClipOp::kIntersect, false);
   }
@@ -301,8 +314,38 @@ void DisplayListBoundsCalculator::restore() {
     SkRect layer_bounds = layer_infos_.back()->layer_bounds();
     // Must read unbounded state after layer_bounds
     bool layer_unbounded = layer_infos_.back()->is_unbounded();
+    bool is_save_layer = layer_infos_.back()->is_save_layer();
+    std::vector<OpBounds> op_bounds =
+        std::move(layer_infos_.back()->op_bounds());
+    if (is_save_layer) {
+      for (OpBounds& op : op_bounds) {
+        if (!op.unbounded && !layer_infos_.back()->FilterOpBounds(op.rect)) {
+          op.unbounded = true;
+        }
+      }
+    }
     layer_infos_.pop_back();
 
+    // Ops from a |save| are already in the coordinate system of the outer
+    // layer and were clipped by a subset of its clip.
+    std::vector<OpBounds>& outer_op_bounds = layer_infos_.back()->op_bounds();
+    for (OpBounds& op : op_bounds) {
+      if (is_save_layer) {
+        if (op.unbounded) {
+          if (has_clip()) {
+            op.rect = clip_bounds();
+            op.unbounded = false;
+          }
+        } else {
+          matrix().mapRect(&op.rect);
+          if (has_clip() && !op.rect.intersect(clip_bounds())) {
+            op.rect.setEmpty();
+          }
+        }
+      }
+      outer_op_bounds.push_back(op);
+    }
+
     // We accumulate the bounds even if the layer was unbounded because
     // the unbounded state may be contained at a higher level, so we at
     // least accumulate our best estimate about what we have.
@@ -569,8 +612,10 @@ bool DisplayListBoundsCalculator::AdjustBoundsForPaint(
 void DisplayListBoundsCalculator::AccumulateUnbounded() {
   if (has_clip()) {
     accumulator_->accumulate(clip_bounds());
+    RecordOpBounds(clip_bounds(), false);
   } else {
     layer_infos_.back()->set_unbounded();
+    RecordOpBounds(SkRect::MakeEmpty(), true);
   }
 }
 void DisplayListBoundsCalculator::AccumulateRect(
@@ -580,11 +625,32 @@ void DisplayListBoundsCalculator::AccumulateRect(
     matrix().mapRect(&rect);
     if (!has_clip() || rect.intersect(clip_bounds())) {
       accumulator_->accumulate(rect);
+      RecordOpBounds(rect, false);
     }
   } else {
     AccumulateUnbounded();
   }
 }
+void DisplayListBoundsCalculator::RecordOpBounds(const SkRect& rect,
+                                                 bool unbounded) {
+  if (op_index_ >= 0) {
+    layer_infos_.back()->op_bounds().push_back({op_index_, rect, unbounded});
+  }
+}
+std::vector<SkRect> DisplayListBoundsCalculator::TakeOpBounds(int op_count) {
+  FML_DCHECK(layer_infos_.size() == 1);
+  std::vector<SkRect> result(op_count, SkRect::MakeEmpty());
+  for (const OpBounds& op : layer_infos_.front()->op_bounds()) {
+    FML_DCHECK(op.index < op_count);
+    if (op.unbounded) {
+      result[op.index] = SkRect::MakeLargest();
+    } else {
+      result[op.index].join(op.rect);
+    }
+  }
+  layer_infos_.front()->op_bounds().clear();
+  return result;
+}
 
 bool DisplayListBoundsCalculator::paint_nops_on_transparency() {
   // SkImageFilter::canComputeFastBounds tests for transparency behavior
@@ -384,10 +384,35 @@ class DisplayListBoundsCalculator final
     return accumulator_->bounds();
   }
 
+  // Tags the rendering calls that follow with an op index so that their
+  // individual bounds are recorded for |TakeOpBounds|. A negative index,
+  // which is the default, stops the recording, and should be set for all
+  // calls that do not render.
+  void set_op_index(int index) { op_index_ = index; }
+
+  // Returns the bounds of each op index from 0 to |op_count| - 1 in the
+  // coordinate space of the DisplayList, after the effects of the enclosing
+  // transforms, clips and saveLayer filters. Ops that were tagged but did
+  // not render get an empty rect and unbounded ops get
+  // |SkRect::MakeLargest()|. Should only be called after the stream is
+  // fully dispatched.
+  std::vector<SkRect> TakeOpBounds(int op_count);
+
  private:
   // current accumulator based on saveLayer history
   BoundsAccumulator* accumulator_;
 
+  // See |set_op_index|.
+  int op_index_ = -1;
+
+  // The bounds recorded for a single tagged op, relative to the layer
+  // that is current when they are recorded.
+  struct OpBounds {
+    int index;
+    SkRect rect;
+    bool unbounded;
+  };
+
   // A class that abstracts the information kept for a single
   // |save| or |saveLayer|, including the root information that
   // is kept as a base set of information for the DisplayList
@@ -454,9 +479,22 @@ class DisplayListBoundsCalculator final
     // the layer will have one last chance to flag an unbounded state.
     bool is_unbounded() const { return is_unbounded_; }
 
+    // The bounds of the tagged ops rendered while this layer was on the
+    // stack, see |DisplayListBoundsCalculator::set_op_index|.
+    std::vector<OpBounds>& op_bounds() { return op_bounds_; }
+
+    // Whether this layer accumulates in its own coordinate system that
+    // must be mapped into the coordinate system of the outer layer.
+    virtual bool is_save_layer() const { return false; }
+
+    // Applies the effects of the layer to op bounds recorded in its
+    // coordinate system. Returns false if the result is unbounded.
+    virtual bool FilterOpBounds(SkRect& bounds) { return true; }
+
    private:
     BoundsAccumulator* outer_;
     bool is_unbounded_;
+    std::vector<OpBounds> op_bounds_;
 
     FML_DISALLOW_COPY_AND_ASSIGN(LayerData);
   };
@@ -529,6 +567,12 @@ class DisplayListBoundsCalculator final
       return bounds;
     }
 
+    bool is_save_layer() const override { return true; }
+
+    bool FilterOpBounds(SkRect& bounds) override {
+      return ComputeFilteredBounds(bounds, layer_filter_.get());
+    }
+
    private:
     sk_sp<SkImageFilter> layer_filter_;
 
@@ -558,6 +602,7 @@ class DisplayListBoundsCalculator final
   bool AdjustBoundsForPaint(SkRect& bounds, DisplayListAttributeFlags flags);
 
   void AccumulateUnbounded();
+  void RecordOpBounds(const SkRect& rect, bool unbounded);
   void AccumulateRect(const SkRect& rect, DisplayListAttributeFlags flags) {
     SkRect bounds = rect;
     AccumulateRect(bounds, flags);
@@ -0,0 +1,43 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/layer_arena.h"
+
+#include <cstdint>
+
+#include "flutter/fml/logging.h"
+
+namespace flutter {
+
+LayerArena::LayerArena(size_t block_size) : block_size_(block_size) {}
+
+LayerArena::~LayerArena() = default;
+
+void* LayerArena::Allocate(size_t size, size_t alignment) {
+  FML_DCHECK(alignment > 0 && (alignment & (alignment - 1)) == 0);
+  FML_DCHECK(alignment <= alignof(std::max_align_t));
+
+  if (size > block_size_ / 4) {
+    // Large allocations get a block of their own so that they neither
+    // waste the rest of the current block nor need an oversized one.
+    blocks_.emplace_back(new std::byte[size]);
+    allocated_bytes_ += size;
+    return blocks_.back().get();
+  }
+
+  uintptr_t cursor = reinterpret_cast<uintptr_t>(cursor_);
+  size_t padding = (alignment - (cursor & (alignment - 1))) & (alignment - 1);
+  if (!cursor_ || padding + size > static_cast<size_t>(end_ - cursor_)) {
+    blocks_.emplace_back(new std::byte[block_size_]);
+    cursor_ = blocks_.back().get();
+    end_ = cursor_ + block_size_;
+    padding = 0;
+  }
+  void* result = cursor_ + padding;
+  cursor_ += padding + size;
+  allocated_bytes_ += size;
+  return result;
+}
+
+}  // namespace flutter
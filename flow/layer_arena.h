@@ -0,0 +1,106 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_LAYER_ARENA_H_
+#define FLUTTER_FLOW_LAYER_ARENA_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+
+namespace flutter {
+
+// A bump allocator for the layers of one frame.
+//
+// Layers created with |MakeShared| are placed in blocks owned by the
+// arena, together with the control block of their shared_ptr. Destroying
+// such a layer runs its destructor but frees no memory. Every layer keeps
+// the arena alive, and the blocks are all freed at once when the last
+// layer of the frame is destroyed, typically by the raster thread when it
+// drops the LayerTree.
+//
+// Layers retained by later frames keep their whole arena alive, so an
+// arena should hold the layers of a single frame only.
+//
+// Allocation is not thread safe. Layers are built on the UI thread.
+class LayerArena {
+ public:
+  static constexpr size_t kDefaultBlockSize = 16 * 1024;
+
+  explicit LayerArena(size_t block_size = kDefaultBlockSize);
+
+  ~LayerArena();
+
+  // Returns |size| bytes aligned to |alignment|, which must be a power of
+  // two no larger than alignof(std::max_align_t).
+  void* Allocate(size_t size, size_t alignment);
+
+  // The number of bytes handed out by |Allocate|.
+  size_t allocated_bytes() const { return allocated_bytes_; }
+
+  // The number of blocks obtained from the system allocator.
+  size_t block_count() const { return blocks_.size(); }
+
+  // A standard allocator that allocates from an arena. Deallocation is a
+  // no-op, and each copy holds a reference to the arena.
+  template <typename T>
+  class Allocator {
+   public:
+    using value_type = T;
+
+    explicit Allocator(std::shared_ptr<LayerArena> arena)
+        : arena_(std::move(arena)) {}
+
+    template <typename U>
+    Allocator(const Allocator<U>& other) : arena_(other.arena_) {}
+
+    T* allocate(size_t n) {
+      return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) {}
+
+    template <typename U>
+    bool operator==(const Allocator<U>& other) const {
+      return arena_ == other.arena_;
+    }
+
+    template <typename U>
+    bool operator!=(const Allocator<U>& other) const {
+      return arena_ != other.arena_;
+    }
+
+   private:
+    std::shared_ptr<LayerArena> arena_;
+
+    template <typename U>
+    friend class Allocator;
+  };
+
+  // Creates a |T| in |arena|, or on the heap if |arena| is null.
+  template <typename T, typename... Args>
+  static std::shared_ptr<T> MakeShared(const std::shared_ptr<LayerArena>& arena,
+                                       Args&&... args) {
+    if (!arena) {
+      return std::make_shared<T>(std::forward<Args>(args)...);
+    }
+    return std::allocate_shared<T>(Allocator<T>(arena),
+                                   std::forward<Args>(args)...);
+  }
+
+ private:
+  const size_t block_size_;
+  std::vector<std::unique_ptr<std::byte[]>> blocks_;
+  std::byte* cursor_ = nullptr;
+  std::byte* end_ = nullptr;
+  size_t allocated_bytes_ = 0;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(LayerArena);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_LAYER_ARENA_H_
@@ -0,0 +1,57 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/layer_arena.h"
+
+#include <cstdint>
+
+#include "flutter/flow/layers/container_layer.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+TEST(LayerArena, AllocationsAreAligned) {
+  LayerArena arena(256);
+  arena.Allocate(1, 1);
+  void* ptr = arena.Allocate(8, 8);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % 8, 0u);
+  ptr = arena.Allocate(3, 1);
+  ptr = arena.Allocate(16, alignof(std::max_align_t));
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % alignof(std::max_align_t), 0u);
+  EXPECT_EQ(arena.block_count(), 1u);
+}
+
+TEST(LayerArena, LargeAllocationsGetTheirOwnBlock) {
+  LayerArena arena(256);
+  void* small = arena.Allocate(16, 8);
+  arena.Allocate(200, 8);
+  void* next = arena.Allocate(16, 8);
+  EXPECT_EQ(arena.block_count(), 2u);
+  // The current block is still used after the large allocation.
+  EXPECT_EQ(static_cast<std::byte*>(next) - static_cast<std::byte*>(small),
+            16);
+}
+
+TEST(LayerArena, LayersKeepTheArenaAlive) {
+  auto arena = std::make_shared<LayerArena>();
+  std::weak_ptr<LayerArena> weak_arena = arena;
+
+  auto parent = LayerArena::MakeShared<ContainerLayer>(arena);
+  parent->Add(LayerArena::MakeShared<ContainerLayer>(arena));
+  EXPECT_GT(arena->allocated_bytes(), 2 * sizeof(ContainerLayer));
+
+  arena.reset();
+  EXPECT_FALSE(weak_arena.expired());
+  parent.reset();
+  EXPECT_TRUE(weak_arena.expired());
+}
+
+TEST(LayerArena, NullArenaUsesTheHeap) {
+  auto layer = LayerArena::MakeShared<ContainerLayer>(nullptr);
+  EXPECT_NE(layer, nullptr);
+}
+
+}  // namespace testing
+}  // namespace flutter
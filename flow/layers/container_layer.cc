@@ -4,8 +4,6 @@
 
 #include "flutter/flow/layers/container_layer.h"
 
-#include <optional>
-
 namespace flutter {
 
 ContainerLayer::ContainerLayer() {}
@@ -105,6 +103,7 @@ void ContainerLayer::DiffChildren(DiffContext* context,
 
 void ContainerLayer::Add(std::shared_ptr<Layer> layer) {
   layers_.emplace_back(std::move(layer));
+  preroll_cache_.reset();
 }
 
 void ContainerLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
@@ -121,12 +120,65 @@ void ContainerLayer::Paint(PaintContext& context) const {
   PaintChildren(context);
 }
 
+ContainerLayer::PrerollCache ContainerLayer::GetPrerollInputs(
+    const PrerollContext* context,
+    const SkMatrix& child_matrix) {
+  PrerollCache inputs;
+  inputs.matrix = child_matrix;
+  inputs.cull_rect = context->cull_rect;
+  inputs.raster_cache = context->raster_cache;
+  inputs.raster_cache_generation =
+      context->raster_cache ? context->raster_cache->generation() : 0;
+  inputs.gr_context = context->gr_context;
+  inputs.dst_color_space = context->dst_color_space;
+  inputs.checkerboard_offscreen_layers = context->checkerboard_offscreen_layers;
+  inputs.frame_device_pixel_ratio = context->frame_device_pixel_ratio;
+  inputs.surface_needs_readback = context->surface_needs_readback;
+  return inputs;
+}
+
+bool ContainerLayer::CanReusePreroll(const PrerollContext* context,
+                                     const SkMatrix& child_matrix) const {
+  if (!context->reuse_retained_preroll || !preroll_cache_) {
+    return false;
+  }
+  const PrerollCache& cache = *preroll_cache_;
+  PrerollCache inputs = GetPrerollInputs(context, child_matrix);
+  return inputs.matrix == cache.matrix &&
+         inputs.cull_rect == cache.cull_rect &&
+         inputs.raster_cache == cache.raster_cache &&
+         inputs.raster_cache_generation == cache.raster_cache_generation &&
+         inputs.gr_context == cache.gr_context &&
+         inputs.dst_color_space == cache.dst_color_space &&
+         inputs.checkerboard_offscreen_layers ==
+             cache.checkerboard_offscreen_layers &&
+         inputs.frame_device_pixel_ratio == cache.frame_device_pixel_ratio &&
+         inputs.surface_needs_readback == cache.surface_needs_readback;
+}
+
 void ContainerLayer::PrerollChildren(PrerollContext* context,
                                      const SkMatrix& child_matrix,
                                      SkRect* child_paint_bounds) {
   // Platform views have no children, so context->has_platform_view should
   // always be false.
   FML_DCHECK(!context->has_platform_view);
+
+  if (CanReusePreroll(context, child_matrix)) {
+    // The children keep the paint bounds and other state from their last
+    // preroll, and subtrees with platform views or textures are never
+    // reused, so only the results seen by this layer need restoring.
+    child_paint_bounds->join(preroll_cache_->child_paint_bounds);
+    context->surface_needs_readback =
+        preroll_cache_->child_surface_needs_readback;
+    set_subtree_has_platform_view(false);
+    return;
+  }
+
+  PrerollCache cache = GetPrerollInputs(context, child_matrix);
+  bool parent_preroll_is_unstable = context->preroll_is_unstable;
+  context->preroll_is_unstable = false;
+
+  SkRect bounds = SkRect::MakeEmpty();
   bool child_has_platform_view = false;
   bool child_has_texture_layer = false;
   for (auto& layer : layers_) {
@@ -136,13 +188,25 @@ void ContainerLayer::PrerollChildren(PrerollContext* context,
     context->has_platform_view = false;
 
     layer->Preroll(context, child_matrix);
-    child_paint_bounds->join(layer->paint_bounds());
+    bounds.join(layer->paint_bounds());
 
     child_has_platform_view =
         child_has_platform_view || context->has_platform_view;
     child_has_texture_layer =
         child_has_texture_layer || context->has_texture_layer;
   }
+  child_paint_bounds->join(bounds);
+
+  if (context->reuse_retained_preroll && !child_has_platform_view &&
+      !child_has_texture_layer && !context->preroll_is_unstable) {
+    cache.child_paint_bounds = bounds;
+    cache.child_surface_needs_readback = context->surface_needs_readback;
+    preroll_cache_ = cache;
+  } else {
+    preroll_cache_.reset();
+  }
+  context->preroll_is_unstable =
+      context->preroll_is_unstable || parent_preroll_is_unstable;
 
   context->has_platform_view = child_has_platform_view;
   context->has_texture_layer = child_has_texture_layer;
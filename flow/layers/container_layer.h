@@ -5,6 +5,7 @@
 #ifndef FLUTTER_FLOW_LAYERS_CONTAINER_LAYER_H_
 #define FLUTTER_FLOW_LAYERS_CONTAINER_LAYER_H_
 
+#include <optional>
 #include <vector>
 
 #include "flutter/flow/layers/layer.h"
@@ -25,6 +26,10 @@ class ContainerLayer : public Layer {
 
   const std::vector<std::shared_ptr<Layer>>& layers() const { return layers_; }
 
+  // Whether the next call to |PrerollChildren| with the same inputs as the
+  // last one may skip prerolling the children.
+  bool has_reusable_preroll() const { return preroll_cache_.has_value(); }
+
   virtual void DiffChildren(DiffContext* context,
                             const ContainerLayer* old_layer);
 
@@ -49,7 +54,31 @@ class ContainerLayer : public Layer {
                                       const SkMatrix& matrix);
 
  private:
+  // The inputs and results of the last preroll of the children. A retained
+  // layer is prerolled again in later frames, and as long as these inputs
+  // do not change, neither do the results.
+  struct PrerollCache {
+    SkMatrix matrix;
+    SkRect cull_rect;
+    const RasterCache* raster_cache;
+    uint64_t raster_cache_generation;
+    const GrDirectContext* gr_context;
+    const SkColorSpace* dst_color_space;
+    bool checkerboard_offscreen_layers;
+    float frame_device_pixel_ratio;
+    bool surface_needs_readback;
+
+    SkRect child_paint_bounds;
+    bool child_surface_needs_readback;
+  };
+
+  static PrerollCache GetPrerollInputs(const PrerollContext* context,
+                                       const SkMatrix& child_matrix);
+  bool CanReusePreroll(const PrerollContext* context,
+                       const SkMatrix& child_matrix) const;
+
   std::vector<std::shared_ptr<Layer>> layers_;
+  std::optional<PrerollCache> preroll_cache_;
 
   FML_DISALLOW_COPY_AND_ASSIGN(ContainerLayer);
 };
@@ -251,6 +251,73 @@ TEST_F(ContainerLayerTest, MergedMultipleChildren) {
                                                child_path2, child_paint2}}}));
 }
 
+TEST_F(ContainerLayerTest, RetainedPrerollIsReusedForSameInputs) {
+  SkPath child_path;
+  child_path.addRect(5.0f, 6.0f, 20.5f, 21.5f);
+  SkMatrix initial_transform = SkMatrix::Translate(-0.5f, -0.5f);
+  SkMatrix other_transform = SkMatrix::Translate(-1.5f, -0.5f);
+
+  auto mock_layer = std::make_shared<MockLayer>(child_path);
+  auto layer = std::make_shared<ContainerLayer>();
+  layer->Add(mock_layer);
+
+  preroll_context()->reuse_retained_preroll = true;
+  layer->Preroll(preroll_context(), initial_transform);
+  EXPECT_TRUE(layer->has_reusable_preroll());
+  EXPECT_EQ(mock_layer->parent_matrix(), initial_transform);
+
+  // The child is not prerolled again for the same inputs, so it does not
+  // see the new mutator, but the bounds of the container are restored.
+  layer->set_paint_bounds(SkRect::MakeEmpty());
+  preroll_context()->mutators_stack.PushOpacity(128);
+  layer->Preroll(preroll_context(), initial_transform);
+  preroll_context()->mutators_stack.Pop();
+  EXPECT_EQ(mock_layer->parent_mutators(), MutatorsStack());
+  EXPECT_EQ(layer->paint_bounds(), child_path.getBounds());
+
+  layer->Preroll(preroll_context(), other_transform);
+  EXPECT_EQ(mock_layer->parent_matrix(), other_transform);
+
+  // Adding a child invalidates the previous results.
+  auto mock_layer2 = std::make_shared<MockLayer>(child_path);
+  layer->Add(mock_layer2);
+  EXPECT_FALSE(layer->has_reusable_preroll());
+  layer->Preroll(preroll_context(), other_transform);
+  EXPECT_EQ(mock_layer2->parent_matrix(), other_transform);
+}
+
+TEST_F(ContainerLayerTest, PrerollWithPlatformViewIsNotReused) {
+  SkPath child_path;
+  child_path.addRect(5.0f, 6.0f, 20.5f, 21.5f);
+  auto mock_layer = std::make_shared<MockLayer>(child_path, SkPaint(),
+                                                /* fake_has_platform_view */
+                                                true);
+  auto layer = std::make_shared<ContainerLayer>();
+  layer->Add(mock_layer);
+
+  preroll_context()->reuse_retained_preroll = true;
+  layer->Preroll(preroll_context(), SkMatrix());
+  EXPECT_FALSE(layer->has_reusable_preroll());
+  EXPECT_TRUE(preroll_context()->has_platform_view);
+}
+
+TEST_F(ContainerLayerTest, UnstablePrerollIsNotReused) {
+  SkPath child_path;
+  child_path.addRect(5.0f, 6.0f, 20.5f, 21.5f);
+  auto inner = std::make_shared<ContainerLayer>();
+  inner->Add(std::make_shared<MockLayer>(child_path));
+  auto layer = std::make_shared<ContainerLayer>();
+  layer->Add(inner);
+
+  preroll_context()->reuse_retained_preroll = true;
+  preroll_context()->preroll_is_unstable = true;
+  layer->Preroll(preroll_context(), SkMatrix());
+  // Instability of the parent does not leak into the subtree, but is kept
+  // for the parent.
+  EXPECT_TRUE(layer->has_reusable_preroll());
+  EXPECT_TRUE(preroll_context()->preroll_is_unstable);
+}
+
 using ContainerLayerDiffTest = DiffContextTest;
 
 // Insert PictureLayer amongst container layers
@@ -454,5 +521,72 @@ TEST_F(ContainerLayerDiffTest, ReplaceLayer) {
   EXPECT_EQ(damage.frame_damage, SkIRect::MakeLTRB(200, 0, 250, 150));
 }
 
+TEST_F(ContainerLayerDiffTest, DisjointDamageRects) {
+  auto path1 = SkPath().addRect(SkRect::MakeLTRB(0, 0, 50, 50));
+  auto path1a = SkPath().addRect(SkRect::MakeLTRB(0, 0, 40, 50));
+  auto path2 = SkPath().addRect(SkRect::MakeLTRB(900, 900, 950, 950));
+  auto path2a = SkPath().addRect(SkRect::MakeLTRB(900, 900, 950, 960));
+
+  auto c1 = CreateContainerLayer(std::make_shared<MockLayer>(path1));
+  auto c2 = CreateContainerLayer(std::make_shared<MockLayer>(path2));
+
+  MockLayerTree t1;
+  t1.root()->Add(c1);
+  t1.root()->Add(c2);
+
+  auto damage = DiffLayerTree(t1, MockLayerTree());
+  EXPECT_EQ(damage.frame_damage, SkIRect::MakeLTRB(0, 0, 950, 950));
+
+  // Changes in opposite corners result in two separate damage rects.
+  MockLayerTree t2;
+  t2.root()->Add(CreateContainerLayer(std::make_shared<MockLayer>(path1a)));
+  t2.root()->Add(CreateContainerLayer(std::make_shared<MockLayer>(path2a)));
+
+  damage = DiffLayerTree(t2, t1);
+  EXPECT_EQ(damage.frame_damage, SkIRect::MakeLTRB(0, 0, 950, 960));
+  EXPECT_EQ(damage.frame_damage_rects,
+            std::vector<SkIRect>({SkIRect::MakeLTRB(0, 0, 50, 50),
+                                  SkIRect::MakeLTRB(900, 900, 950, 960)}));
+
+  // Additional damage overlapping one of the rects is merged with it.
+  damage = DiffLayerTree(t2, t1, SkIRect::MakeLTRB(40, 40, 60, 60));
+  EXPECT_EQ(damage.buffer_damage_rects,
+            std::vector<SkIRect>({SkIRect::MakeLTRB(900, 900, 950, 960),
+                                  SkIRect::MakeLTRB(0, 0, 60, 60)}));
+}
+
+TEST_F(ContainerLayerDiffTest, DamageRectsOverlappingOnceRoundedAreMerged) {
+  auto path1 = SkPath().addRect(SkRect::MakeLTRB(0, 0, 10.5, 10));
+  auto path2 = SkPath().addRect(SkRect::MakeLTRB(10.6, 0, 20, 10));
+
+  MockLayerTree t1;
+  t1.root()->Add(std::make_shared<MockLayer>(path1));
+  t1.root()->Add(std::make_shared<MockLayer>(path2));
+
+  auto damage = DiffLayerTree(t1, MockLayerTree());
+  EXPECT_EQ(damage.frame_damage_rects,
+            std::vector<SkIRect>({SkIRect::MakeLTRB(0, 0, 20, 10)}));
+  EXPECT_EQ(damage.buffer_damage_rects,
+            std::vector<SkIRect>({SkIRect::MakeLTRB(0, 0, 20, 10)}));
+}
+
+TEST_F(ContainerLayerDiffTest, DamageRectsAreBounded) {
+  MockLayerTree t1;
+  for (int i = 0; i < 20; ++i) {
+    auto path = SkPath().addRect(SkRect::MakeXYWH(i * 40, i * 40, 10, 10));
+    t1.root()->Add(std::make_shared<MockLayer>(path));
+  }
+
+  auto damage = DiffLayerTree(t1, MockLayerTree());
+  EXPECT_EQ(damage.frame_damage, SkIRect::MakeLTRB(0, 0, 770, 770));
+  EXPECT_LE(damage.frame_damage_rects.size(), DiffContext::kMaxDamageRects);
+  for (size_t i = 0; i < damage.frame_damage_rects.size(); ++i) {
+    for (size_t j = i + 1; j < damage.frame_damage_rects.size(); ++j) {
+      EXPECT_FALSE(SkIRect::Intersects(damage.frame_damage_rects[i],
+                                       damage.frame_damage_rects[j]));
+    }
+  }
+}
+
 }  // namespace testing
 }  // namespace flutter
@@ -69,6 +69,7 @@ void ImageFilterLayer::Preroll(PrerollContext* context,
     // increment the count to measure how many times it has been
     // seen from frame to frame.
     render_count_++;
+    context->preroll_is_unstable = true;
 
     // Now we will try to pre-render the children into the cache.
     // To apply the filter to pre-rendered children, we must first
@@ -61,6 +61,17 @@ struct PrerollContext {
   // These allow us to track properties like elevation, opacity, and the
   // prescence of a texture layer during Preroll.
   bool has_texture_layer = false;
+
+  // Whether a ContainerLayer that is prerolled again with the same inputs,
+  // as happens to retained layers, may reuse the results of the previous
+  // preroll of its children instead of prerolling them again.
+  bool reuse_retained_preroll = false;
+
+  // Set during Preroll by layers whose decisions may change in a later
+  // frame even though their inputs do not, such as while waiting for a
+  // raster cache entry to reach its access threshold. The preroll results
+  // of subtrees that set it are not reused.
+  bool preroll_is_unstable = false;
 };
 
 class PictureLayer;
@@ -50,6 +50,7 @@ bool LayerTree::Preroll(CompositorContext::ScopedFrame& frame,
       frame.context().texture_registry(),
       checkerboard_offscreen_layers_,
       device_pixel_ratio_};
+  context.reuse_retained_preroll = true;
 
   root_layer_->Preroll(&context, frame.root_surface_transformation());
   return context.surface_needs_readback;
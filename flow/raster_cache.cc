@@ -4,12 +4,15 @@
 
 #include "flutter/flow/raster_cache.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "flutter/common/constants.h"
 #include "flutter/flow/layers/layer.h"
 #include "flutter/flow/paint_utils.h"
 #include "flutter/fml/logging.h"
+#include "flutter/fml/synchronization/waitable_event.h"
+#include "flutter/fml/time/time_point.h"
 #include "flutter/fml/trace_event.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkImage.h"
@@ -38,6 +41,12 @@ void RasterCacheResult::draw(SkCanvas& canvas, const SkPaint* paint) const {
                    paint);
 }
 
+struct RasterCache::PendingResult {
+  fml::ManualResetWaitableEvent latch;
+  std::unique_ptr<RasterCacheResult> image;
+  fml::TimeDelta raster_time;
+};
+
 RasterCache::RasterCache(size_t access_threshold,
                          size_t picture_and_display_list_cache_limit_per_frame)
     : access_threshold_(access_threshold),
@@ -172,6 +181,36 @@ std::unique_ptr<RasterCacheResult> RasterCache::RasterizeDisplayList(
                    [=](SkCanvas* canvas) { display_list->RenderTo(canvas); });
 }
 
+bool RasterCache::ShouldRasterizeConcurrently(
+    const PrerollContext* context) const {
+  return concurrent_task_runner_ != nullptr && context->gr_context == nullptr;
+}
+
+std::shared_ptr<RasterCache::PendingResult> RasterCache::RasterizeConcurrently(
+    std::function<std::unique_ptr<RasterCacheResult>()> rasterize) const {
+  auto pending = std::make_shared<PendingResult>();
+  concurrent_task_runner_->PostTask([pending, rasterize]() {
+    auto start = fml::TimePoint::Now();
+    pending->image = rasterize();
+    pending->raster_time = fml::TimePoint::Now() - start;
+    pending->latch.Signal();
+  });
+  return pending;
+}
+
+void RasterCache::ResolvePendingResult(Entry& entry) {
+  if (!entry.pending) {
+    return;
+  }
+  {
+    TRACE_EVENT0("flutter", "RasterCache::WaitForConcurrentPopulate");
+    entry.pending->latch.Wait();
+  }
+  entry.image = std::move(entry.pending->image);
+  entry.raster_time = entry.pending->raster_time;
+  entry.pending.reset();
+}
+
 void RasterCache::Prepare(PrerollContext* context,
                           Layer* layer,
                           const SkMatrix& ctm) {
@@ -180,7 +219,9 @@ void RasterCache::Prepare(PrerollContext* context,
   entry.access_count++;
   entry.used_this_frame = true;
   if (!entry.image) {
+    auto start = fml::TimePoint::Now();
     entry.image = RasterizeLayer(context, layer, ctm, checkerboard_images_);
+    entry.raster_time = fml::TimePoint::Now() - start;
   }
 }
 
@@ -222,7 +263,9 @@ bool RasterCache::Prepare(PrerollContext* context,
                           bool will_change,
                           const SkMatrix& untranslated_matrix,
                           const SkPoint& offset) {
-  if (!GenerateNewCacheInThisFrame()) {
+  if (!GenerateNewCacheInThisFrame(context)) {
+    // The entry may be populated in a later frame.
+    context->preroll_is_unstable = true;
     return false;
   }
 
@@ -239,26 +282,47 @@ bool RasterCache::Prepare(PrerollContext* context,
     return false;
   }
 
+  if (!FitsInByteBudget(picture->cullRect(), transformation_matrix)) {
+    // The image would evict everything else from the cache.
+    return false;
+  }
+
   PictureRasterCacheKey cache_key(picture->uniqueID(), transformation_matrix);
 
   // Creates an entry, if not present prior.
   Entry& entry = picture_cache_[cache_key];
   if (entry.access_count < access_threshold_) {
     // Frame threshold has not yet been reached.
+    context->preroll_is_unstable = true;
     return false;
   }
 
-  if (!entry.image) {
+  if (!entry.image && !entry.pending) {
     // GetIntegralTransCTM effect for matrix which only contains scale,
     // translate, so it won't affect result of matrix decomposition and cache
     // key.
 #ifndef SUPPORT_FRACTIONAL_TRANSLATION
     transformation_matrix = GetIntegralTransCTM(transformation_matrix);
 #endif
-    entry.image =
-        RasterizePicture(picture, context->gr_context, transformation_matrix,
-                         context->dst_color_space, checkerboard_images_);
-    picture_cached_this_frame_++;
+    if (ShouldRasterizeConcurrently(context)) {
+      entry.pending = RasterizeConcurrently(
+          [picture = sk_ref_sp(picture), transformation_matrix,
+           dst_color_space = sk_ref_sp(context->dst_color_space),
+           checkerboard = checkerboard_images_]() {
+            return Rasterize(
+                nullptr, transformation_matrix, dst_color_space.get(),
+                checkerboard, picture->cullRect(), "RasterCacheFlow::SkPicture",
+                [&](SkCanvas* canvas) { canvas->drawPicture(picture); });
+          });
+    } else {
+      auto start = fml::TimePoint::Now();
+      entry.image =
+          RasterizePicture(picture, context->gr_context, transformation_matrix,
+                           context->dst_color_space, checkerboard_images_);
+      entry.raster_time = fml::TimePoint::Now() - start;
+      picture_cached_this_frame_++;
+    }
+    entry.op_count = picture->approximateOpCount(true);
   }
   return true;
 }
@@ -269,7 +333,9 @@ bool RasterCache::Prepare(PrerollContext* context,
                           bool will_change,
                           const SkMatrix& untranslated_matrix,
                           const SkPoint& offset) {
-  if (!GenerateNewCacheInThisFrame()) {
+  if (!GenerateNewCacheInThisFrame(context)) {
+    // The entry may be populated in a later frame.
+    context->preroll_is_unstable = true;
     return false;
   }
 
@@ -286,6 +352,11 @@ bool RasterCache::Prepare(PrerollContext* context,
     return false;
   }
 
+  if (!FitsInByteBudget(display_list->bounds(), transformation_matrix)) {
+    // The image would evict everything else from the cache.
+    return false;
+  }
+
   DisplayListRasterCacheKey cache_key(display_list->unique_id(),
                                       transformation_matrix);
 
@@ -293,20 +364,37 @@ bool RasterCache::Prepare(PrerollContext* context,
   Entry& entry = display_list_cache_[cache_key];
   if (entry.access_count < access_threshold_) {
     // Frame threshold has not yet been reached.
+    context->preroll_is_unstable = true;
     return false;
   }
 
-  if (!entry.image) {
+  if (!entry.image && !entry.pending) {
     // GetIntegralTransCTM effect for matrix which only contains scale,
     // translate, so it won't affect result of matrix decomposition and cache
     // key.
 #ifndef SUPPORT_FRACTIONAL_TRANSLATION
     transformation_matrix = GetIntegralTransCTM(transformation_matrix);
 #endif
-    entry.image = RasterizeDisplayList(
-        display_list, context->gr_context, transformation_matrix,
-        context->dst_color_space, checkerboard_images_);
-    display_list_cached_this_frame_++;
+    if (ShouldRasterizeConcurrently(context)) {
+      entry.pending = RasterizeConcurrently(
+          [display_list = sk_ref_sp(display_list), transformation_matrix,
+           dst_color_space = sk_ref_sp(context->dst_color_space),
+           checkerboard = checkerboard_images_]() {
+            return Rasterize(
+                nullptr, transformation_matrix, dst_color_space.get(),
+                checkerboard, display_list->bounds(),
+                "RasterCacheFlow::DisplayList",
+                [&](SkCanvas* canvas) { display_list->RenderTo(canvas); });
+          });
+    } else {
+      auto start = fml::TimePoint::Now();
+      entry.image = RasterizeDisplayList(
+          display_list, context->gr_context, transformation_matrix,
+          context->dst_color_space, checkerboard_images_);
+      entry.raster_time = fml::TimePoint::Now() - start;
+      display_list_cached_this_frame_++;
+    }
+    entry.op_count = display_list->op_count(true);
   }
   return true;
 }
@@ -343,63 +431,24 @@ void RasterCache::Touch(DisplayList* display_list,
 
 bool RasterCache::Draw(const SkPicture& picture, SkCanvas& canvas) const {
   PictureRasterCacheKey cache_key(picture.uniqueID(), canvas.getTotalMatrix());
-  auto it = picture_cache_.find(cache_key);
-  if (it == picture_cache_.end()) {
-    return false;
-  }
-
-  Entry& entry = it->second;
-  entry.access_count++;
-  entry.used_this_frame = true;
-
-  if (entry.image) {
-    entry.image->draw(canvas, nullptr);
-    return true;
-  }
-
-  return false;
+  return DrawEntry(picture_cache_, cache_key, canvas, nullptr,
+                   picture_access_counts_);
 }
 
 bool RasterCache::Draw(const DisplayList& display_list,
                        SkCanvas& canvas) const {
   DisplayListRasterCacheKey cache_key(display_list.unique_id(),
                                       canvas.getTotalMatrix());
-  auto it = display_list_cache_.find(cache_key);
-  if (it == display_list_cache_.end()) {
-    return false;
-  }
-
-  Entry& entry = it->second;
-  entry.access_count++;
-  entry.used_this_frame = true;
-
-  if (entry.image) {
-    entry.image->draw(canvas, nullptr);
-    return true;
-  }
-
-  return false;
+  return DrawEntry(display_list_cache_, cache_key, canvas, nullptr,
+                   picture_access_counts_);
 }
 
 bool RasterCache::Draw(const Layer* layer,
                        SkCanvas& canvas,
                        SkPaint* paint) const {
   LayerRasterCacheKey cache_key(layer->unique_id(), canvas.getTotalMatrix());
-  auto it = layer_cache_.find(cache_key);
-  if (it == layer_cache_.end()) {
-    return false;
-  }
-
-  Entry& entry = it->second;
-  entry.access_count++;
-  entry.used_this_frame = true;
-
-  if (entry.image) {
-    entry.image->draw(canvas, paint);
-    return true;
-  }
-
-  return false;
+  return DrawEntry(layer_cache_, cache_key, canvas, paint,
+                   layer_access_counts_);
 }
 
 void RasterCache::PrepareNewFrame() {
@@ -416,15 +465,82 @@ void RasterCache::CleanupAfterFrame() {
     SweepOneCacheAfterFrame(display_list_cache_, picture_metrics_);
     SweepOneCacheAfterFrame(layer_cache_, layer_metrics_);
   }
+  EvictToFitByteBudget();
+  if (picture_metrics_.eviction_count > 0 ||
+      layer_metrics_.eviction_count > 0) {
+    generation_++;
+  }
+  picture_metrics_.hit_count = picture_access_counts_.hits;
+  picture_metrics_.miss_count = picture_access_counts_.misses;
+  layer_metrics_.hit_count = layer_access_counts_.hits;
+  layer_metrics_.miss_count = layer_access_counts_.misses;
+  picture_access_counts_ = {};
+  layer_access_counts_ = {};
   TraceStatsToTimeline();
 }
 
+void RasterCache::EvictToFitByteBudget() {
+  if (max_bytes_ == 0) {
+    return;
+  }
+  size_t cache_bytes =
+      picture_metrics_.in_use_bytes + layer_metrics_.in_use_bytes;
+  if (cache_bytes <= max_bytes_) {
+    return;
+  }
+
+  TRACE_EVENT0("flutter", "RasterCache::EvictToFitByteBudget");
+  std::vector<EvictionCandidate> candidates;
+  CollectEvictionCandidates(picture_cache_, picture_metrics_, candidates);
+  CollectEvictionCandidates(display_list_cache_, picture_metrics_, candidates);
+  CollectEvictionCandidates(layer_cache_, layer_metrics_, candidates);
+  std::sort(candidates.begin(), candidates.end(),
+            [](const EvictionCandidate& a, const EvictionCandidate& b) {
+              return a.priority > b.priority;
+            });
+
+  for (auto& candidate : candidates) {
+    if (cache_bytes <= max_bytes_) {
+      break;
+    }
+    cache_bytes -= candidate.bytes;
+    RasterCacheMetrics& metrics = *candidate.metrics;
+    metrics.in_use_count--;
+    metrics.in_use_bytes -= candidate.bytes;
+    metrics.eviction_count++;
+    metrics.eviction_bytes += candidate.bytes;
+    metrics.budget_eviction_count++;
+    metrics.budget_eviction_bytes += candidate.bytes;
+    candidate.evict();
+  }
+}
+
+bool RasterCache::FitsInByteBudget(const SkRect& logical_rect,
+                                   const SkMatrix& ctm) const {
+  if (max_bytes_ == 0) {
+    return true;
+  }
+  SkIRect cache_rect = GetDeviceBounds(logical_rect, ctm);
+  const SkImageInfo image_info =
+      SkImageInfo::MakeN32Premul(cache_rect.width(), cache_rect.height());
+  return image_info.computeMinByteSize() <= max_bytes_;
+}
+
+void RasterCache::ReleaseEvictedImages() {
+  TRACE_EVENT0("flutter", "RasterCache::ReleaseEvictedImages");
+  evicted_images_.clear();
+}
+
 void RasterCache::Clear() {
+  generation_++;
+  evicted_images_.clear();
   picture_cache_.clear();
   display_list_cache_.clear();
   layer_cache_.clear();
   picture_metrics_ = {};
   layer_metrics_ = {};
+  picture_access_counts_ = {};
+  layer_access_counts_ = {};
 }
 
 size_t RasterCache::GetCachedEntriesCount() const {
@@ -452,6 +568,11 @@ void RasterCache::SetCheckboardCacheImages(bool checkerboard) {
   Clear();
 }
 
+void RasterCache::SetConcurrentTaskRunner(
+    std::shared_ptr<fml::ConcurrentTaskRunner> task_runner) {
+  concurrent_task_runner_ = std::move(task_runner);
+}
+
 void RasterCache::TraceStatsToTimeline() const {
 #if !FLUTTER_RELEASE
   FML_TRACE_COUNTER(
@@ -5,13 +5,18 @@
 #ifndef FLUTTER_FLOW_RASTER_CACHE_H_
 #define FLUTTER_FLOW_RASTER_CACHE_H_
 
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include "flutter/flow/display_list.h"
 #include "flutter/flow/raster_cache_key.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/weak_ptr.h"
+#include "flutter/fml/time/time_delta.h"
 #include "flutter/fml/trace_event.h"
 #include "third_party/skia/include/core/SkImage.h"
 #include "third_party/skia/include/core/SkSize.h"
@@ -65,6 +70,37 @@ struct RasterCacheMetrics {
    */
   size_t in_use_bytes = 0;
 
+  /**
+   * The number of cache entries with images evicted in this frame because
+   * the cache exceeded its byte budget. These are included in eviction_count.
+   */
+  size_t budget_eviction_count = 0;
+
+  /**
+   * The size of all of the images evicted in this frame because the cache
+   * exceeded its byte budget. These are included in eviction_bytes.
+   */
+  size_t budget_eviction_bytes = 0;
+
+  /**
+   * The number of draws in this frame that were served by a cached image.
+   */
+  size_t hit_count = 0;
+
+  /**
+   * The number of draws in this frame of cache entries that had no image yet.
+   */
+  size_t miss_count = 0;
+
+  /**
+   * The fraction of draws of cache entries in this frame that were served by
+   * a cached image, or 0 if no cache entries were drawn.
+   */
+  double hit_rate() const {
+    size_t draw_count = hit_count + miss_count;
+    return draw_count == 0 ? 0.0 : static_cast<double>(hit_count) / draw_count;
+  }
+
   /**
    * The total cache entries that had images during this frame whether
    * they were used in the frame or held memory during the frame and then
@@ -229,6 +265,36 @@ class RasterCache {
 
   void SetCheckboardCacheImages(bool checkerboard);
 
+  /**
+   * @brief Populate picture and display list cache entries concurrently on
+   * the workers of the given task runner instead of on the raster thread.
+   *
+   * Only entries rendered without a GrDirectContext (software surfaces) are
+   * populated concurrently, as GPU backed entries must be rendered with the
+   * context of the raster thread. The raster thread waits for a pending
+   * entry only when it is drawn. Entries populated concurrently do not count
+   * towards the per frame cache limit.
+   *
+   * @param task_runner the worker task runner, or nullptr to populate all
+   *        entries on the raster thread.
+   */
+  void SetConcurrentTaskRunner(
+      std::shared_ptr<fml::ConcurrentTaskRunner> task_runner);
+
+  /**
+   * @brief Limit the memory used by cached images.
+   *
+   * When the images held by the cache exceed the budget after a frame, the
+   * entries that hold the most bytes relative to the cost of re-rasterizing
+   * them are evicted first. Pictures and display lists that would not fit in
+   * the budget on their own are never cached.
+   *
+   * @param max_bytes the byte budget, or 0 for no limit.
+   */
+  void SetMaxBytes(size_t max_bytes) { max_bytes_ = max_bytes; }
+
+  size_t max_bytes() const { return max_bytes_; }
+
   const RasterCacheMetrics& picture_metrics() const { return picture_metrics_; }
   const RasterCacheMetrics& layer_metrics() const { return layer_metrics_; }
 
@@ -278,16 +344,141 @@ class RasterCache {
    */
   int access_threshold() const { return access_threshold_; }
 
+  /**
+   * @brief Changes whenever cached images are removed from the cache.
+   *
+   * Layers whose preroll results depend on cached images being present
+   * compare this against the value seen when the results were computed.
+   */
+  uint64_t generation() const { return generation_; }
+
+  /**
+   * @brief Whether images evicted by |CleanupAfterFrame| are waiting to be
+   * released by |ReleaseEvictedImages|.
+   */
+  bool HasEvictedImages() const { return !evicted_images_.empty(); }
+
+  /**
+   * @brief Frees the images evicted by previous calls to
+   * |CleanupAfterFrame|.
+   *
+   * Eviction only unlinks images from the cache so that freeing their GPU
+   * memory can be deferred out of the frame, typically to an idle task.
+   */
+  void ReleaseEvictedImages();
+
  private:
+  // A cache entry that is being rasterized on a concurrent worker.
+  struct PendingResult;
+
   struct Entry {
     bool used_this_frame = false;
     size_t access_count = 0;
     std::unique_ptr<RasterCacheResult> image;
+    // Set while the image is being rasterized on a concurrent worker.
+    std::shared_ptr<PendingResult> pending;
+    // How long it took to rasterize the image.
+    fml::TimeDelta raster_time;
+    // Op count of the cached picture or display list, 0 for layers.
+    size_t op_count = 0;
+  };
+
+  struct AccessCounts {
+    size_t hits = 0;
+    size_t misses = 0;
+  };
+
+  struct EvictionCandidate {
+    double priority;
+    size_t bytes;
+    RasterCacheMetrics* metrics;
+    std::function<void()> evict;
   };
 
+  // A rough estimate of how long rasterizing one op takes, which turns op
+  // counts into the microseconds that raster times are measured in.
+  static constexpr double kEstimatedRasterMicrosecondsPerOp = 0.5;
+
+  // The microseconds it would take to re-rasterize the entry. Raster times
+  // of cheap entries are mostly noise, so the estimate from the op count
+  // takes over when it is larger.
+  static double RasterCostMicroseconds(const Entry& entry) {
+    return std::max({1.0, entry.raster_time.ToMicrosecondsF(),
+                     entry.op_count * kEstimatedRasterMicrosecondsPerOp});
+  }
+
+  // Entries holding many bytes that are cheap to re-rasterize have the
+  // highest priority for eviction.
+  static double EvictionPriority(const Entry& entry) {
+    return entry.image->image_bytes() / RasterCostMicroseconds(entry);
+  }
+
+  template <class Cache>
+  void CollectEvictionCandidates(Cache& cache,
+                                 RasterCacheMetrics& metrics,
+                                 std::vector<EvictionCandidate>& candidates) {
+    for (auto it = cache.begin(); it != cache.end(); ++it) {
+      const Entry& entry = it->second;
+      if (entry.image) {
+        candidates.push_back({EvictionPriority(entry),
+                              static_cast<size_t>(entry.image->image_bytes()),
+                              &metrics, [this, &cache, it]() {
+                                evicted_images_.push_back(
+                                    std::move(it->second.image));
+                                cache.erase(it);
+                              }});
+      }
+    }
+  }
+
+  // Evicts entries until the images in the cache fit in max_bytes_. Must be
+  // called after the caches have been swept.
+  void EvictToFitByteBudget();
+
+  // Whether an image of the given bounds could be held by the cache.
+  bool FitsInByteBudget(const SkRect& logical_rect, const SkMatrix& ctm) const;
+
+  // Looks up the entry and draws its image. Records the access in counts.
   template <class Cache>
-  static void SweepOneCacheAfterFrame(Cache& cache,
-                                      RasterCacheMetrics& metrics) {
+  static bool DrawEntry(Cache& cache,
+                        const typename Cache::key_type& cache_key,
+                        SkCanvas& canvas,
+                        const SkPaint* paint,
+                        AccessCounts& counts) {
+    auto it = cache.find(cache_key);
+    if (it == cache.end()) {
+      return false;
+    }
+
+    Entry& entry = it->second;
+    entry.access_count++;
+    entry.used_this_frame = true;
+    ResolvePendingResult(entry);
+
+    if (entry.image) {
+      counts.hits++;
+      entry.image->draw(canvas, paint);
+      return true;
+    }
+
+    counts.misses++;
+    return false;
+  }
+
+  // Whether new cache entries for this preroll should be populated on the
+  // concurrent task runner.
+  bool ShouldRasterizeConcurrently(const PrerollContext* context) const;
+
+  // Runs rasterize on the concurrent task runner.
+  std::shared_ptr<PendingResult> RasterizeConcurrently(
+      std::function<std::unique_ptr<RasterCacheResult>()> rasterize) const;
+
+  // Waits for a pending entry to finish rasterizing and moves its result into
+  // the entry.
+  static void ResolvePendingResult(Entry& entry);
+
+  template <class Cache>
+  void SweepOneCacheAfterFrame(Cache& cache, RasterCacheMetrics& metrics) {
     std::vector<typename Cache::iterator> dead;
 
     for (auto it = cache.begin(); it != cache.end(); ++it) {
@@ -305,14 +496,19 @@ class RasterCache {
       if (it->second.image) {
         metrics.eviction_count++;
         metrics.eviction_bytes += it->second.image->image_bytes();
+        evicted_images_.push_back(std::move(it->second.image));
       }
       cache.erase(it);
     }
   }
 
-  bool GenerateNewCacheInThisFrame() const {
+  bool GenerateNewCacheInThisFrame(const PrerollContext* context) const {
     // Disabling caching when access_threshold is zero is historic behavior.
-    return access_threshold_ != 0 &&
+    if (access_threshold_ == 0) {
+      return false;
+    }
+    // Entries populated concurrently don't occupy the raster thread.
+    return ShouldRasterizeConcurrently(context) ||
            picture_cached_this_frame_ + display_list_cached_this_frame_ <
                picture_and_display_list_cache_limit_per_frame_;
   }
@@ -327,6 +523,12 @@ class RasterCache {
   mutable DisplayListRasterCacheKey::Map<Entry> display_list_cache_;
   mutable LayerRasterCacheKey::Map<Entry> layer_cache_;
   bool checkerboard_images_;
+  std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner_;
+  size_t max_bytes_ = 0;
+  uint64_t generation_ = 0;
+  std::vector<std::unique_ptr<RasterCacheResult>> evicted_images_;
+  mutable AccessCounts picture_access_counts_;
+  mutable AccessCounts layer_access_counts_;
 
   void TraceStatsToTimeline() const;
 
@@ -541,6 +541,109 @@ TEST(RasterCache, DisplayListWithSingularMatrixIsNotCached) {
   }
 }
 
+TEST(RasterCache, ConcurrentPopulationForDisplayList) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold, 0);
+  auto loop = fml::ConcurrentMessageLoop::Create(2);
+  cache.SetConcurrentTaskRunner(loop->GetTaskRunner());
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto display_list = GetSampleDisplayList();
+
+  SkCanvas dummy_canvas;
+
+  PrerollContextHolder preroll_context_holder = GetSamplePrerollContextHolder();
+
+  cache.PrepareNewFrame();
+
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             display_list.get(), true, false, matrix));
+  ASSERT_FALSE(cache.Draw(*display_list, dummy_canvas));
+
+  cache.CleanupAfterFrame();
+  cache.PrepareNewFrame();
+
+  // Concurrent population is not subject to the per frame limit.
+  ASSERT_TRUE(cache.Prepare(&preroll_context_holder.preroll_context,
+                            display_list.get(), true, false, matrix));
+  ASSERT_TRUE(cache.Draw(*display_list, dummy_canvas));
+
+  cache.CleanupAfterFrame();
+  ASSERT_EQ(cache.picture_metrics().in_use_count, 1u);
+  // 150w * 100h * 4bpp
+  ASSERT_EQ(cache.picture_metrics().in_use_bytes, 60000u);
+}
+
+TEST(RasterCache, ByteBudgetIsRespectedForSkPicture) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+  // Room for one 150x100 picture, but not two.
+  cache.SetMaxBytes(100000);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture1 = GetSamplePicture();
+  auto picture2 = GetSamplePicture();
+
+  SkCanvas dummy_canvas;
+
+  PrerollContextHolder preroll_context_holder = GetSamplePrerollContextHolder();
+
+  cache.PrepareNewFrame();
+
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             picture1.get(), true, false, matrix));
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             picture2.get(), true, false, matrix));
+  ASSERT_FALSE(cache.Draw(*picture1, dummy_canvas));
+  ASSERT_FALSE(cache.Draw(*picture2, dummy_canvas));
+
+  cache.CleanupAfterFrame();
+  ASSERT_EQ(cache.picture_metrics().miss_count, 2u);
+  ASSERT_EQ(cache.picture_metrics().hit_rate(), 0.0);
+  cache.PrepareNewFrame();
+
+  ASSERT_TRUE(cache.Prepare(&preroll_context_holder.preroll_context,
+                            picture1.get(), true, false, matrix));
+  ASSERT_TRUE(cache.Prepare(&preroll_context_holder.preroll_context,
+                            picture2.get(), true, false, matrix));
+  ASSERT_TRUE(cache.Draw(*picture1, dummy_canvas));
+  ASSERT_TRUE(cache.Draw(*picture2, dummy_canvas));
+
+  cache.CleanupAfterFrame();
+  ASSERT_EQ(cache.picture_metrics().hit_count, 2u);
+  ASSERT_EQ(cache.picture_metrics().hit_rate(), 1.0);
+  ASSERT_EQ(cache.picture_metrics().in_use_count, 1u);
+  ASSERT_EQ(cache.picture_metrics().eviction_count, 1u);
+  ASSERT_EQ(cache.picture_metrics().budget_eviction_count, 1u);
+  ASSERT_EQ(cache.picture_metrics().budget_eviction_bytes, 60000u);
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), 60000u);
+}
+
+TEST(RasterCache, DisplayListLargerThanByteBudgetIsNotCached) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+  cache.SetMaxBytes(1000);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto display_list = GetSampleDisplayList();
+
+  SkCanvas dummy_canvas;
+
+  PrerollContextHolder preroll_context_holder = GetSamplePrerollContextHolder();
+
+  for (int i = 0; i < 3; i++) {
+    cache.PrepareNewFrame();
+    ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                               display_list.get(), true, false, matrix));
+    ASSERT_FALSE(cache.Draw(*display_list, dummy_canvas));
+    cache.CleanupAfterFrame();
+  }
+  ASSERT_EQ(cache.GetPictureCachedEntriesCount(), 0u);
+}
+
 }  // namespace testing
 
 }  // namespace flutter
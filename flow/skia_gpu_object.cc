@@ -4,49 +4,151 @@
 
 #include "flutter/flow/skia_gpu_object.h"
 
+#include <algorithm>
+
 #include "flutter/fml/message_loop.h"
+#include "flutter/fml/thread_local.h"
 #include "flutter/fml/trace_event.h"
 
 namespace flutter {
 
+// The most nodes kept in the free list for reuse. Drained nodes past these
+// are freed so that a burst of releases does not pin memory.
+static constexpr size_t kMaxRecycledNodes = 1024;
+
 SkiaUnrefQueue::SkiaUnrefQueue(fml::RefPtr<fml::TaskRunner> task_runner,
                                fml::TimeDelta delay,
                                fml::WeakPtr<GrDirectContext> context)
     : task_runner_(std::move(task_runner)),
       drain_delay_(delay),
-      drain_pending_(false),
       context_(context) {}
 
 SkiaUnrefQueue::~SkiaUnrefQueue() {
-  FML_DCHECK(objects_.empty());
+  FML_DCHECK(objects_.load() == nullptr);
+  DeleteNodes(free_nodes_.load());
 }
 
 void SkiaUnrefQueue::Unref(SkRefCnt* object) {
-  std::scoped_lock lock(mutex_);
-  objects_.push_back(object);
-  if (!drain_pending_) {
-    drain_pending_ = true;
-    task_runner_->PostDelayedTask(
-        [strong = fml::Ref(this)]() { strong->Drain(); }, drain_delay_);
+  Node* node = AcquireNode();
+  node->object = object;
+  node->next = objects_.load(std::memory_order_relaxed);
+  // The push and the check of |drain_pending_| below, and the clear and the
+  // take in |Drain|, are sequentially consistent. With weaker orders both
+  // sides could miss the other's write, and the object would be left in the
+  // queue without a drain pending.
+  while (!objects_.compare_exchange_weak(node->next, node)) {
+  }
+  // Only the first object queued after a drain schedules the next one.
+  if (!drain_pending_.exchange(true)) {
+    // Draining may free GPU resources, so it is done when the thread idles,
+    // or once the drain delay has passed.
+    task_runner_->PostIdleTask(
+        [strong = fml::Ref(this)](fml::TimePoint deadline) { strong->Drain(); },
+        drain_delay_);
   }
 }
 
 void SkiaUnrefQueue::Drain() {
   TRACE_EVENT0("flutter", "SkiaUnrefQueue::Drain");
-  std::deque<SkRefCnt*> skia_objects;
-  {
-    std::scoped_lock lock(mutex_);
-    objects_.swap(skia_objects);
-    drain_pending_ = false;
+  // Clear the flag before taking the objects so that an object queued after
+  // they are taken schedules another drain instead of being left behind.
+  drain_pending_.store(false);
+  Node* node = objects_.exchange(nullptr);
+  if (node == nullptr) {
+    return;
   }
 
-  for (SkRefCnt* skia_object : skia_objects) {
-    skia_object->unref();
+  // The list is in the reverse order of the calls to |Unref|. Reverse it so
+  // that the objects are released in the order they were queued.
+  Node* last = node;
+  Node* first = nullptr;
+  size_t count = 0;
+  while (node) {
+    Node* next = node->next;
+    node->next = first;
+    first = node;
+    node = next;
+    count++;
   }
 
-  if (context_ && skia_objects.size() > 0) {
+  for (node = first; node; node = node->next) {
+    node->object->unref();
+    node->object = nullptr;
+  }
+  RecycleNodes(first, last, count);
+
+  if (context_) {
     context_->performDeferredCleanup(std::chrono::milliseconds(0));
   }
 }
 
+// The nodes of a thread are cached so that the shared free list is only
+// touched once per batch of nodes rather than once per object.
+struct SkiaUnrefQueue::NodeCache {
+  ~NodeCache() { DeleteNodes(nodes); }
+
+  Node* nodes = nullptr;
+};
+
+SkiaUnrefQueue::Node* SkiaUnrefQueue::AcquireNode() {
+  FML_THREAD_LOCAL fml::ThreadLocalUniquePtr<NodeCache> tls_node_cache;
+  NodeCache* cache = tls_node_cache.get();
+  if (cache == nullptr) {
+    cache = new NodeCache();
+    tls_node_cache.reset(cache);
+  }
+  if (cache->nodes == nullptr) {
+    cache->nodes = free_nodes_.exchange(nullptr, std::memory_order_acquire);
+    size_t count = 0;
+    for (Node* node = cache->nodes; node; node = node->next) {
+      count++;
+    }
+    free_node_count_.fetch_sub(count, std::memory_order_relaxed);
+  }
+  if (Node* node = cache->nodes) {
+    cache->nodes = node->next;
+    return node;
+  }
+  return new Node();
+}
+
+void SkiaUnrefQueue::RecycleNodes(Node* first, Node* last, size_t count) {
+  // Count the kept nodes before they are pushed, so that the count is never
+  // lower than the length of the free list.
+  size_t free_count = free_node_count_.load(std::memory_order_relaxed);
+  size_t kept_count = 0;
+  do {
+    kept_count = std::min(
+        count, kMaxRecycledNodes - std::min(free_count, kMaxRecycledNodes));
+  } while (!free_node_count_.compare_exchange_weak(
+      free_count, free_count + kept_count, std::memory_order_relaxed));
+
+  if (kept_count == 0) {
+    DeleteNodes(first);
+    return;
+  }
+  if (kept_count < count) {
+    Node* kept_last = first;
+    for (size_t i = 1; i < kept_count; i++) {
+      kept_last = kept_last->next;
+    }
+    DeleteNodes(kept_last->next);
+    kept_last->next = nullptr;
+    last = kept_last;
+  }
+  last->next = free_nodes_.load(std::memory_order_relaxed);
+  while (!free_nodes_.compare_exchange_weak(last->next, first,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+  }
+}
+
+void SkiaUnrefQueue::DeleteNodes(Node* node) {
+  while (node) {
+    Node* next = node->next;
+    delete node;
+    node = next;
+  }
+}
+
 }  // namespace flutter
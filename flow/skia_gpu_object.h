@@ -5,8 +5,7 @@
 #ifndef FLUTTER_FLOW_SKIA_GPU_OBJECT_H_
 #define FLUTTER_FLOW_SKIA_GPU_OBJECT_H_
 
-#include <mutex>
-#include <queue>
+#include <atomic>
 
 #include "flutter/fml/memory/ref_counted.h"
 #include "flutter/fml/memory/weak_ptr.h"
@@ -18,6 +17,10 @@ namespace flutter {
 
 // A queue that holds Skia objects that must be destructed on the given task
 // runner.
+//
+// Objects may be queued from any thread without taking a lock, and at most one
+// drain of the queue is pending on the task runner at any time however many
+// objects are queued.
 class SkiaUnrefQueue : public fml::RefCountedThreadSafe<SkiaUnrefQueue> {
  public:
   void Unref(SkRefCnt* object);
@@ -30,11 +33,26 @@ class SkiaUnrefQueue : public fml::RefCountedThreadSafe<SkiaUnrefQueue> {
   void Drain();
 
  private:
+  // A node of the list of queued objects. Drained nodes are recycled through
+  // |free_nodes_| rather than being freed.
+  struct Node {
+    SkRefCnt* object;
+    Node* next;
+  };
+  struct NodeCache;
+
   const fml::RefPtr<fml::TaskRunner> task_runner_;
   const fml::TimeDelta drain_delay_;
-  std::mutex mutex_;
-  std::deque<SkRefCnt*> objects_;
-  bool drain_pending_;
+  // The most recently queued object. Objects are pushed by any thread, and the
+  // drain takes the whole list at once, so the list is never popped from
+  // node by node and is not subject to ABA.
+  std::atomic<Node*> objects_ = nullptr;
+  // Nodes that can be reused by |Unref|. Like |objects_|, this list is only
+  // ever taken as a whole.
+  std::atomic<Node*> free_nodes_ = nullptr;
+  // An upper bound of the length of |free_nodes_|, which is kept under a cap.
+  std::atomic_size_t free_node_count_ = 0;
+  std::atomic_bool drain_pending_ = false;
   fml::WeakPtr<GrDirectContext> context_;
 
   // The `GrDirectContext* context` is only used for signaling Skia to
@@ -46,6 +64,15 @@ class SkiaUnrefQueue : public fml::RefCountedThreadSafe<SkiaUnrefQueue> {
 
   ~SkiaUnrefQueue();
 
+  // Returns a node for the calling thread to queue an object in.
+  Node* AcquireNode();
+
+  // Makes the |count| nodes of the list starting at |first| and ending at
+  // |last| available to |AcquireNode|.
+  void RecycleNodes(Node* first, Node* last, size_t count);
+
+  static void DeleteNodes(Node* node);
+
   FML_FRIEND_REF_COUNTED_THREAD_SAFE(SkiaUnrefQueue);
   FML_FRIEND_MAKE_REF_COUNTED(SkiaUnrefQueue);
   FML_DISALLOW_COPY_AND_ASSIGN(SkiaUnrefQueue);
@@ -75,8 +102,10 @@ class SkiaGPUObject {
     if (object_ && queue_) {
       queue_->Unref(object_.release());
     }
+    // Objects without a queue, such as the raster images made while the GPU
+    // is disabled, are not bound to a context and are released right away.
+    object_ = nullptr;
     queue_ = nullptr;
-    FML_DCHECK(object_ == nullptr);
   }
 
  private:
@@ -0,0 +1,100 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/skia_gpu_object.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/fml/synchronization/count_down_latch.h"
+#include "flutter/fml/synchronization/waitable_event.h"
+#include "flutter/fml/thread.h"
+
+namespace flutter {
+namespace {
+
+class CountedSkObject : public SkRefCnt {
+ public:
+  explicit CountedSkObject(std::atomic_size_t* destroyed_count)
+      : destroyed_count_(destroyed_count) {}
+
+  ~CountedSkObject() {
+    destroyed_count_->fetch_add(1, std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic_size_t* destroyed_count_;
+};
+
+}  // namespace
+
+// Measures how fast objects released from |state.range(0)| threads at once
+// make it through the queue and are unreffed on its task runner. Like the
+// engine threads that release objects, the releasing threads outlive the
+// benchmark iterations.
+static void BM_SkiaUnrefQueueRelease(benchmark::State& state) {  // NOLINT
+  const size_t thread_count = state.range(0);
+  constexpr size_t kObjectsPerThread = 1000;
+  fml::Thread unref_thread("unref");
+  auto queue = fml::MakeRefCounted<SkiaUnrefQueue>(
+      unref_thread.GetTaskRunner(), fml::TimeDelta::Zero());
+  std::vector<std::unique_ptr<fml::Thread>> release_threads;
+  for (size_t i = 0; i < thread_count; i++) {
+    release_threads.push_back(
+        std::make_unique<fml::Thread>("release" + std::to_string(i)));
+  }
+
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    std::atomic_size_t destroyed_count = 0;
+    std::vector<std::vector<SkRefCnt*>> objects(thread_count);
+    for (auto& thread_objects : objects) {
+      for (size_t i = 0; i < kObjectsPerThread; i++) {
+        thread_objects.push_back(new CountedSkObject(&destroyed_count));
+      }
+    }
+    fml::CountDownLatch ready(thread_count);
+    fml::CountDownLatch released(thread_count);
+    fml::ManualResetWaitableEvent start;
+    for (size_t i = 0; i < thread_count; i++) {
+      release_threads[i]->GetTaskRunner()->PostTask(
+          [&queue, &thread_objects = objects[i], &ready, &released, &start]() {
+            ready.CountDown();
+            start.Wait();
+            for (SkRefCnt* object : thread_objects) {
+              queue->Unref(object);
+            }
+            released.CountDown();
+          });
+    }
+    ready.Wait();
+    state.ResumeTiming();
+
+    start.Signal();
+    released.Wait();
+    while (destroyed_count.load() < thread_count * kObjectsPerThread) {
+      fml::AutoResetWaitableEvent drained;
+      unref_thread.GetTaskRunner()->PostTask([&queue, &drained]() {
+        queue->Drain();
+        drained.Signal();
+      });
+      drained.Wait();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * thread_count *
+                          kObjectsPerThread);
+}
+
+BENCHMARK(BM_SkiaUnrefQueueRelease)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+}  // namespace flutter
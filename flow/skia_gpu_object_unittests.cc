@@ -4,7 +4,10 @@
 
 #include "flutter/flow/skia_gpu_object.h"
 
+#include <atomic>
 #include <future>
+#include <thread>
+#include <vector>
 
 #include "flutter/fml/message_loop.h"
 #include "flutter/fml/synchronization/waitable_event.h"
@@ -34,6 +37,17 @@ class TestSkObject : public SkRefCnt {
   fml::TaskQueueId* dtor_task_queue_id_;
 };
 
+class CountedSkObject : public SkRefCnt {
+ public:
+  explicit CountedSkObject(std::atomic_size_t* destroyed_count)
+      : destroyed_count_(destroyed_count) {}
+
+  ~CountedSkObject() { (*destroyed_count_)++; }
+
+ private:
+  std::atomic_size_t* destroyed_count_;
+};
+
 class SkiaGpuObjectTest : public ThreadTest {
  public:
   SkiaGpuObjectTest()
@@ -127,5 +141,31 @@ TEST_F(SkiaGpuObjectTest, ObjectResetTwice) {
   ASSERT_EQ(dtor_task_queue_id, unref_task_runner()->GetTaskQueueId());
 }
 
+TEST_F(SkiaGpuObjectTest, ObjectsQueuedFromManyThreadsAreAllReleased) {
+  constexpr size_t kThreadCount = 4;
+  constexpr size_t kObjectsPerThread = 1000;
+  std::atomic_size_t destroyed_count = 0;
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < kThreadCount; i++) {
+    threads.emplace_back([&]() {
+      for (size_t j = 0; j < kObjectsPerThread; j++) {
+        unref_queue()->Unref(new CountedSkObject(&destroyed_count));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // A drain may already be pending, so drain again on the task runner to be
+  // sure that nothing is left behind.
+  fml::AutoResetWaitableEvent latch;
+  unref_task_runner()->PostTask([&]() {
+    unref_queue()->Drain();
+    latch.Signal();
+  });
+  latch.Wait();
+  ASSERT_EQ(destroyed_count, kThreadCount * kObjectsPerThread);
+}
+
 }  // namespace testing
 }  // namespace flutter
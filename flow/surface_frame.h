@@ -7,6 +7,7 @@
 
 #include <memory>
 #include <optional>
+#include <vector>
 
 #include "flutter/common/graphics/gl_context_switch.h"
 #include "flutter/fml/macros.h"
@@ -68,6 +69,14 @@ class SurfaceFrame {
     // Corresponds to EGL_KHR_partial_update
     std::optional<SkIRect> buffer_damage;
 
+    // Non-overlapping rects whose union is the frame damage. Backends that
+    // support multiple damage rectangles may use these instead of the
+    // frame_damage bounding box.
+    std::optional<std::vector<SkIRect>> frame_damage_rects;
+
+    // Non-overlapping rects whose union is the buffer damage.
+    std::optional<std::vector<SkIRect>> buffer_damage_rects;
+
     // The vsync target time.
     //
     // Backends may use this information to avoid overloading the GPU with
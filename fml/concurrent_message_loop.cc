@@ -5,9 +5,9 @@
 #include "flutter/fml/concurrent_message_loop.h"
 
 #include <algorithm>
+#include <deque>
 
 #include "flutter/fml/thread.h"
-#include "flutter/fml/trace_event.h"
 
 namespace fml {
 
@@ -17,19 +17,40 @@ std::shared_ptr<ConcurrentMessageLoop> ConcurrentMessageLoop::Create(
       new ConcurrentMessageLoop(worker_count)};
 }
 
+struct ConcurrentMessageLoop::WorkerQueue {
+  std::mutex mutex;
+  // The owning worker pushes and pops at the back. Other workers steal
+  // from the front, which holds the oldest tasks.
+  std::deque<fml::UniqueClosure> tasks;
+  // Tasks posted with |PostTaskToAllWorkers|. These may only be run by
+  // the owning worker.
+  std::vector<fml::closure> thread_tasks;
+  std::atomic<bool> has_thread_tasks = false;
+};
+
+namespace {
+
+// The loop and queue index of the worker running on the current thread,
+// used to keep the tasks posted by a worker on that worker.
+thread_local const ConcurrentMessageLoop* tls_worker_loop = nullptr;
+thread_local size_t tls_worker_index = 0;
+
+}  // namespace
+
 ConcurrentMessageLoop::ConcurrentMessageLoop(size_t worker_count)
     : worker_count_(std::max<size_t>(worker_count, 1ul)) {
+  // The queues must exist before any worker starts looking for tasks.
+  for (size_t i = 0; i < worker_count_; ++i) {
+    queues_.emplace_back(std::make_unique<WorkerQueue>());
+  }
+
   for (size_t i = 0; i < worker_count_; ++i) {
     workers_.emplace_back([i, this]() {
       fml::Thread::SetCurrentThreadName(
           std::string{"io.worker." + std::to_string(i + 1)});
-      WorkerMain();
+      WorkerMain(i);
     });
   }
-
-  for (const auto& worker : workers_) {
-    worker_thread_ids_.emplace_back(worker.get_id());
-  }
 }
 
 ConcurrentMessageLoop::~ConcurrentMessageLoop() {
@@ -47,80 +68,141 @@ std::shared_ptr<ConcurrentTaskRunner> ConcurrentMessageLoop::GetTaskRunner() {
   return std::make_shared<ConcurrentTaskRunner>(weak_from_this());
 }
 
-void ConcurrentMessageLoop::PostTask(const fml::closure& task) {
+void ConcurrentMessageLoop::PostTask(fml::UniqueClosure task) {
   if (!task) {
     return;
   }
 
-  std::unique_lock lock(tasks_mutex_);
-
   // Don't just drop tasks on the floor in case of shutdown.
   if (shutdown_) {
     FML_DLOG(WARNING)
         << "Tried to post a task to shutdown concurrent message "
            "loop. The task will be executed on the callers thread.";
-    lock.unlock();
     task();
     return;
   }
 
-  tasks_.push(task);
+  // Tasks posted by a worker stay on that worker, where the data they
+  // touch is likely still in cache. Everything else is spread round robin.
+  size_t index = tls_worker_loop == this
+                     ? tls_worker_index
+                     : next_queue_.fetch_add(1, std::memory_order_relaxed) %
+                           worker_count_;
+  // Count the task before queueing it so that the count never drops below
+  // zero when another worker takes the task right away.
+  pending_task_count_.fetch_add(1);
+  {
+    WorkerQueue& queue = *queues_[index];
+    std::unique_lock lock(queue.mutex);
+    // The loop may have been terminated since the check above.
+    if (shutdown_) {
+      lock.unlock();
+      pending_task_count_.fetch_sub(1);
+      task();
+      return;
+    }
+    queue.tasks.push_back(std::move(task));
+  }
+
+  WakeWorkers(false);
+}
+
+fml::UniqueClosure ConcurrentMessageLoop::TakeTask(size_t index) {
+  {
+    WorkerQueue& own = *queues_[index];
+    std::scoped_lock lock(own.mutex);
+    if (!own.tasks.empty()) {
+      fml::UniqueClosure task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      pending_task_count_.fetch_sub(1);
+      return task;
+    }
+  }
 
-  // Unlock the mutex before notifying the condition variable because that mutex
-  // has to be acquired on the other thread anyway. Waiting in this scope till
-  // it is acquired there is a pessimization.
-  lock.unlock();
+  for (size_t i = 1; i < worker_count_; ++i) {
+    WorkerQueue& victim = *queues_[(index + i) % worker_count_];
+    std::scoped_lock lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      fml::UniqueClosure task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      pending_task_count_.fetch_sub(1);
+      return task;
+    }
+  }
 
-  tasks_condition_.notify_one();
+  return nullptr;
 }
 
-void ConcurrentMessageLoop::WorkerMain() {
-  while (true) {
-    std::unique_lock lock(tasks_mutex_);
-    tasks_condition_.wait(lock, [&]() {
-      return tasks_.size() > 0 || shutdown_ || HasThreadTasksLocked();
-    });
+void ConcurrentMessageLoop::RunThreadTasks(WorkerQueue& queue) {
+  if (!queue.has_thread_tasks) {
+    return;
+  }
 
-    // Shutdown cannot be read with the task mutex unlocked.
-    bool shutdown_now = shutdown_;
-    fml::closure task;
-    std::vector<fml::closure> thread_tasks;
+  std::vector<fml::closure> thread_tasks;
+  {
+    std::scoped_lock lock(queue.mutex);
+    std::swap(thread_tasks, queue.thread_tasks);
+    queue.has_thread_tasks = false;
+  }
 
-    if (tasks_.size() != 0) {
-      task = tasks_.front();
-      tasks_.pop();
-    }
+  for (const auto& thread_task : thread_tasks) {
+    thread_task();
+  }
+}
 
-    if (HasThreadTasksLocked()) {
-      thread_tasks = GetThreadTasksLocked();
-      FML_DCHECK(!HasThreadTasksLocked());
-    }
+void ConcurrentMessageLoop::WakeWorkers(bool all) {
+  // Workers only go to sleep after announcing themselves as idle and
+  // checking for work, both under |idle_mutex_|. Briefly taking the mutex
+  // here ensures a worker is either already waiting or will see the work.
+  if (!all && idle_worker_count_ == 0) {
+    return;
+  }
+  { std::scoped_lock lock(idle_mutex_); }
+  if (all) {
+    idle_condition_.notify_all();
+  } else {
+    idle_condition_.notify_one();
+  }
+}
 
-    // Don't hold onto the mutex while tasks are being executed as they could
-    // themselves try to post more tasks to the message loop.
-    lock.unlock();
+void ConcurrentMessageLoop::WorkerMain(size_t index) {
+  tls_worker_loop = this;
+  tls_worker_index = index;
+  WorkerQueue& queue = *queues_[index];
 
-    TRACE_EVENT0("flutter", "ConcurrentWorkerWake");
-    // Execute the primary task we woke up for.
-    if (task) {
-      task();
+  while (true) {
+    RunThreadTasks(queue);
+
+    if (shutdown_) {
+      // Run what was queued before shutdown. Tasks posted after it has been
+      // seen under the queue lock are run by the poster instead.
+      while (fml::UniqueClosure task = TakeTask(index)) {
+        task();
+      }
+      break;
     }
 
-    // Execute any thread tasks.
-    for (const auto& thread_task : thread_tasks) {
-      thread_task();
+    if (fml::UniqueClosure task = TakeTask(index)) {
+      task();
+      continue;
     }
 
-    if (shutdown_now) {
-      break;
+    {
+      std::unique_lock lock(idle_mutex_);
+      idle_worker_count_++;
+      idle_condition_.wait(lock, [&]() {
+        return pending_task_count_ > 0 || shutdown_ || queue.has_thread_tasks;
+      });
+      idle_worker_count_--;
     }
   }
+
+  tls_worker_loop = nullptr;
 }
 
 void ConcurrentMessageLoop::Terminate() {
-  std::scoped_lock lock(tasks_mutex_);
   shutdown_ = true;
-  tasks_condition_.notify_all();
+  WakeWorkers(true);
 }
 
 void ConcurrentMessageLoop::PostTaskToAllWorkers(fml::closure task) {
@@ -128,24 +210,12 @@ void ConcurrentMessageLoop::PostTaskToAllWorkers(fml::closure task) {
     return;
   }
 
-  std::scoped_lock lock(tasks_mutex_);
-  for (const auto& worker_thread_id : worker_thread_ids_) {
-    thread_tasks_[worker_thread_id].emplace_back(task);
+  for (const auto& queue : queues_) {
+    std::scoped_lock lock(queue->mutex);
+    queue->thread_tasks.emplace_back(task);
+    queue->has_thread_tasks = true;
   }
-  tasks_condition_.notify_all();
-}
-
-bool ConcurrentMessageLoop::HasThreadTasksLocked() const {
-  return thread_tasks_.count(std::this_thread::get_id()) > 0;
-}
-
-std::vector<fml::closure> ConcurrentMessageLoop::GetThreadTasksLocked() {
-  auto found = thread_tasks_.find(std::this_thread::get_id());
-  FML_DCHECK(found != thread_tasks_.end());
-  std::vector<fml::closure> pending_tasks;
-  std::swap(pending_tasks, found->second);
-  thread_tasks_.erase(found);
-  return pending_tasks;
+  WakeWorkers(true);
 }
 
 ConcurrentTaskRunner::ConcurrentTaskRunner(
@@ -154,13 +224,13 @@ ConcurrentTaskRunner::ConcurrentTaskRunner(
 
 ConcurrentTaskRunner::~ConcurrentTaskRunner() = default;
 
-void ConcurrentTaskRunner::PostTask(const fml::closure& task) {
+void ConcurrentTaskRunner::PostTask(fml::UniqueClosure task) {
   if (!task) {
     return;
   }
 
   if (auto loop = weak_loop_.lock()) {
-    loop->PostTask(task);
+    loop->PostTask(std::move(task));
     return;
   }
 
@@ -170,4 +240,59 @@ void ConcurrentTaskRunner::PostTask(const fml::closure& task) {
   task();
 }
 
+size_t ConcurrentTaskRunner::GetWorkerCount() const {
+  auto loop = weak_loop_.lock();
+  return loop ? loop->GetWorkerCount() : 0;
+}
+
+void ConcurrentTaskRunner::RunInParallel(
+    size_t count,
+    const std::function<void(size_t)>& task) {
+  if (count == 0) {
+    return;
+  }
+
+  const size_t helper_count = std::min(count - 1, GetWorkerCount());
+  if (helper_count == 0) {
+    for (size_t i = 0; i < count; i++) {
+      task(i);
+    }
+    return;
+  }
+
+  // Helpers may only start running once every index has been claimed, and
+  // after this call has returned. They then find nothing to claim and must
+  // not touch |task| any more, so only this state is shared with them.
+  struct State {
+    std::atomic_size_t next_index = 0;
+    std::mutex mutex;
+    std::condition_variable done;
+    size_t done_count = 0;
+  };
+  auto state = std::make_shared<State>();
+
+  auto run = [state, count, task = &task]() {
+    size_t ran = 0;
+    for (size_t i = state->next_index++; i < count;
+         i = state->next_index++, ran++) {
+      (*task)(i);
+    }
+    if (ran > 0) {
+      std::scoped_lock lock(state->mutex);
+      state->done_count += ran;
+      if (state->done_count == count) {
+        state->done.notify_one();
+      }
+    }
+  };
+
+  for (size_t i = 0; i < helper_count; i++) {
+    PostTask(run);
+  }
+  run();
+
+  std::unique_lock lock(state->mutex);
+  state->done.wait(lock, [&]() { return state->done_count == count; });
+}
+
 }  // namespace fml
@@ -5,14 +5,18 @@
 #ifndef FLUTTER_FML_CONCURRENT_MESSAGE_LOOP_H_
 #define FLUTTER_FML_CONCURRENT_MESSAGE_LOOP_H_
 
+#include <atomic>
 #include <condition_variable>
-#include <map>
-#include <queue>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #include "flutter/fml/closure.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/task_runner.h"
+#include "flutter/fml/unique_closure.h"
 
 namespace fml {
 
@@ -37,24 +41,35 @@ class ConcurrentMessageLoop
  private:
   friend ConcurrentTaskRunner;
 
+  // The tasks of one worker. A worker runs the tasks in its own queue
+  // first and steals from the queues of the other workers when its own
+  // queue is empty.
+  struct WorkerQueue;
+
   size_t worker_count_ = 0;
   std::vector<std::thread> workers_;
-  std::mutex tasks_mutex_;
-  std::condition_variable tasks_condition_;
-  std::queue<fml::closure> tasks_;
-  std::vector<std::thread::id> worker_thread_ids_;
-  std::map<std::thread::id, std::vector<fml::closure>> thread_tasks_;
-  bool shutdown_ = false;
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+  // Where the next task posted from outside the workers goes.
+  std::atomic<size_t> next_queue_ = 0;
+  // The number of tasks in all queues, which any worker may run.
+  std::atomic<size_t> pending_task_count_ = 0;
+  // Idle workers wait on |idle_condition_|.
+  std::mutex idle_mutex_;
+  std::condition_variable idle_condition_;
+  std::atomic<size_t> idle_worker_count_ = 0;
+  std::atomic<bool> shutdown_ = false;
 
   explicit ConcurrentMessageLoop(size_t worker_count);
 
-  void WorkerMain();
+  void WorkerMain(size_t index);
+
+  void PostTask(fml::UniqueClosure task);
 
-  void PostTask(const fml::closure& task);
+  fml::UniqueClosure TakeTask(size_t index);
 
-  bool HasThreadTasksLocked() const;
+  void RunThreadTasks(WorkerQueue& queue);
 
-  std::vector<fml::closure> GetThreadTasksLocked();
+  void WakeWorkers(bool all);
 
   FML_DISALLOW_COPY_AND_ASSIGN(ConcurrentMessageLoop);
 };
@@ -65,7 +80,17 @@ class ConcurrentTaskRunner : public BasicTaskRunner {
 
   virtual ~ConcurrentTaskRunner();
 
-  void PostTask(const fml::closure& task) override;
+  void PostTask(fml::UniqueClosure task) override;
+
+  /// The number of workers of the loop, or zero if it has been terminated.
+  size_t GetWorkerCount() const;
+
+  /// Calls |task| once for every index in [0, count) and returns once all of
+  /// the calls have returned. The calls are spread over the workers of the
+  /// loop and the calling thread, which claims indices too, so this may be
+  /// called from a worker of the same loop without risking a deadlock even if
+  /// every other worker is busy.
+  void RunInParallel(size_t count, const std::function<void(size_t)>& task);
 
  private:
   friend ConcurrentMessageLoop;
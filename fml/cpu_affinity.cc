@@ -0,0 +1,98 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/cpu_affinity.h"
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include "flutter/fml/build_config.h"
+
+namespace fml {
+
+// The masks have a bit per core, so cores past the 64th are never picked.
+static constexpr size_t kMaxCpuCount = 64;
+
+CpuSpeedTracker::CpuSpeedTracker(std::vector<CpuIndexAndSpeed> data) {
+  data.erase(std::remove_if(data.begin(), data.end(),
+                            [](const CpuIndexAndSpeed& cpu) {
+                              return cpu.index >= kMaxCpuCount;
+                            }),
+             data.end());
+  if (data.empty()) {
+    return;
+  }
+  const auto [min, max] = std::minmax_element(
+      data.begin(), data.end(),
+      [](const CpuIndexAndSpeed& a, const CpuIndexAndSpeed& b) {
+        return a.speed < b.speed;
+      });
+  const int64_t min_speed = min->speed;
+  const int64_t max_speed = max->speed;
+  if (min_speed == max_speed) {
+    return;
+  }
+  valid_ = true;
+  for (const auto& cpu : data) {
+    const uint64_t bit = uint64_t{1} << cpu.index;
+    if (cpu.speed == max_speed) {
+      performance_ |= bit;
+    } else {
+      not_performance_ |= bit;
+    }
+    if (cpu.speed == min_speed) {
+      efficiency_ |= bit;
+    }
+  }
+}
+
+bool CpuSpeedTracker::IsValid() const {
+  return valid_;
+}
+
+uint64_t CpuSpeedTracker::GetMask(CpuAffinity affinity) const {
+  if (!valid_) {
+    return 0;
+  }
+  switch (affinity) {
+    case CpuAffinity::kAny:
+      return 0;
+    case CpuAffinity::kPerformance:
+      return performance_;
+    case CpuAffinity::kEfficiency:
+      return efficiency_;
+    case CpuAffinity::kNotPerformance:
+      return not_performance_;
+  }
+  return 0;
+}
+
+std::vector<CpuIndexAndSpeed> ReadCpuSpeeds() {
+  std::vector<CpuIndexAndSpeed> speeds;
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  const size_t cpu_count =
+      std::min<size_t>(std::thread::hardware_concurrency(), kMaxCpuCount);
+  for (size_t i = 0; i < cpu_count; i++) {
+    std::ifstream file("/sys/devices/system/cpu/cpu" + std::to_string(i) +
+                       "/cpufreq/cpuinfo_max_freq");
+    int64_t speed = 0;
+    if (file >> speed) {
+      speeds.push_back({.index = i, .speed = speed});
+    }
+  }
+#endif  // defined(OS_LINUX) || defined(OS_ANDROID)
+  return speeds;
+}
+
+uint64_t GetCpuAffinityMask(CpuAffinity affinity) {
+  if (affinity == CpuAffinity::kAny) {
+    return 0;
+  }
+  static const CpuSpeedTracker tracker(ReadCpuSpeeds());
+  return tracker.GetMask(affinity);
+}
+
+}  // namespace fml
@@ -0,0 +1,66 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FML_CPU_AFFINITY_H_
+#define FLUTTER_FML_CPU_AFFINITY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace fml {
+
+/// The kind of cores a thread should run on. Many mobile and embedded SoCs
+/// pair fast "big" cores with slower, more efficient "little" ones.
+enum class CpuAffinity {
+  /// Any core.
+  kAny,
+  /// Only the fastest cores.
+  kPerformance,
+  /// Only the slowest cores.
+  kEfficiency,
+  /// Any core but the fastest ones.
+  kNotPerformance,
+};
+
+struct CpuIndexAndSpeed {
+  // The index of the core, as used by the OS scheduler.
+  size_t index;
+  // The maximum frequency of the core. Only the order of the speeds matters.
+  int64_t speed;
+};
+
+/// Sorts the cores of the system by speed to find which of them have a given
+/// \p CpuAffinity.
+class CpuSpeedTracker {
+ public:
+  explicit CpuSpeedTracker(std::vector<CpuIndexAndSpeed> data);
+
+  /// Whether the cores differ in speed. If they don't, no core is preferred
+  /// over another and affinities other than \p CpuAffinity::kAny are not
+  /// honored.
+  bool IsValid() const;
+
+  /// The mask of the cores with \p affinity, with bit i set for core i, or
+  /// zero if \p affinity is \p CpuAffinity::kAny or the tracker is not valid.
+  uint64_t GetMask(CpuAffinity affinity) const;
+
+ private:
+  bool valid_ = false;
+  uint64_t performance_ = 0;
+  uint64_t efficiency_ = 0;
+  uint64_t not_performance_ = 0;
+};
+
+/// Reads the maximum frequency of each core. This is only supported on Linux
+/// and Android, and is empty elsewhere or if the frequencies are not exposed.
+std::vector<CpuIndexAndSpeed> ReadCpuSpeeds();
+
+/// The mask of the cores of this system with \p affinity, as returned by
+/// \p CpuSpeedTracker::GetMask. The speeds are only read once.
+uint64_t GetCpuAffinityMask(CpuAffinity affinity);
+
+}  // namespace fml
+
+#endif  // FLUTTER_FML_CPU_AFFINITY_H_
@@ -0,0 +1,49 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/cpu_affinity.h"
+
+#include "gtest/gtest.h"
+
+namespace fml {
+namespace testing {
+
+TEST(CpuAffinity, CoresAreGroupedBySpeed) {
+  CpuSpeedTracker tracker({
+      {.index = 0, .speed = 1000},
+      {.index = 1, .speed = 1000},
+      {.index = 2, .speed = 2000},
+      {.index = 3, .speed = 3000},
+  });
+  ASSERT_TRUE(tracker.IsValid());
+  EXPECT_EQ(tracker.GetMask(CpuAffinity::kAny), 0u);
+  EXPECT_EQ(tracker.GetMask(CpuAffinity::kPerformance), 0b1000u);
+  EXPECT_EQ(tracker.GetMask(CpuAffinity::kEfficiency), 0b0011u);
+  EXPECT_EQ(tracker.GetMask(CpuAffinity::kNotPerformance), 0b0111u);
+}
+
+TEST(CpuAffinity, CoresOfTheSameSpeedHaveNoAffinity) {
+  CpuSpeedTracker tracker({
+      {.index = 0, .speed = 1000},
+      {.index = 1, .speed = 1000},
+  });
+  ASSERT_FALSE(tracker.IsValid());
+  EXPECT_EQ(tracker.GetMask(CpuAffinity::kPerformance), 0u);
+
+  CpuSpeedTracker empty_tracker({});
+  ASSERT_FALSE(empty_tracker.IsValid());
+}
+
+TEST(CpuAffinity, CoresPastTheMaskAreIgnored) {
+  CpuSpeedTracker tracker({
+      {.index = 0, .speed = 1000},
+      {.index = 1, .speed = 2000},
+      {.index = 64, .speed = 3000},
+  });
+  ASSERT_TRUE(tracker.IsValid());
+  EXPECT_EQ(tracker.GetMask(CpuAffinity::kPerformance), 0b10u);
+}
+
+}  // namespace testing
+}  // namespace fml
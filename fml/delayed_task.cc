@@ -6,25 +6,39 @@
 
 #include "flutter/fml/delayed_task.h"
 
+#include <algorithm>
+#include <functional>
+#include <utility>
+
 namespace fml {
 
 DelayedTask::DelayedTask(size_t order,
-                         const fml::closure& task,
+                         fml::UniqueClosure task,
                          fml::TimePoint target_time,
-                         fml::TaskSourceGrade task_source_grade)
+                         fml::TaskSourceGrade task_source_grade,
+                         fml::TaskPriority priority,
+                         fml::TimePoint deadline)
     : order_(order),
-      task_(task),
+      task_(std::move(task)),
       target_time_(target_time),
-      task_source_grade_(task_source_grade) {}
+      task_source_grade_(task_source_grade),
+      priority_(priority),
+      deadline_(deadline) {}
 
 DelayedTask::~DelayedTask() = default;
 
-DelayedTask::DelayedTask(const DelayedTask& other) = default;
+DelayedTask::DelayedTask(DelayedTask&& other) = default;
+
+DelayedTask& DelayedTask::operator=(DelayedTask&& other) = default;
 
-const fml::closure& DelayedTask::GetTask() const {
+const fml::UniqueClosure& DelayedTask::GetTask() const {
   return task_;
 }
 
+fml::UniqueClosure DelayedTask::TakeTask() {
+  return std::move(task_);
+}
+
 fml::TimePoint DelayedTask::GetTargetTime() const {
   return target_time_;
 }
@@ -33,6 +47,14 @@ fml::TaskSourceGrade DelayedTask::GetTaskSourceGrade() const {
   return task_source_grade_;
 }
 
+fml::TaskPriority DelayedTask::GetPriority() const {
+  return priority_;
+}
+
+fml::TimePoint DelayedTask::GetDeadline() const {
+  return deadline_;
+}
+
 bool DelayedTask::operator>(const DelayedTask& other) const {
   if (target_time_ == other.target_time_) {
     return order_ > other.order_;
@@ -40,4 +62,16 @@ bool DelayedTask::operator>(const DelayedTask& other) const {
   return target_time_ > other.target_time_;
 }
 
+void DelayedTaskQueue::push(DelayedTask task) {
+  heap_.push_back(std::move(task));
+  std::push_heap(heap_.begin(), heap_.end(), std::greater<DelayedTask>());
+}
+
+DelayedTask DelayedTaskQueue::pop() {
+  std::pop_heap(heap_.begin(), heap_.end(), std::greater<DelayedTask>());
+  DelayedTask task = std::move(heap_.back());
+  heap_.pop_back();
+  return task;
+}
+
 }  // namespace fml
@@ -5,43 +5,76 @@
 #ifndef FLUTTER_FML_DELAYED_TASK_H_
 #define FLUTTER_FML_DELAYED_TASK_H_
 
-#include <queue>
+#include <vector>
 
-#include "flutter/fml/closure.h"
+#include "flutter/fml/task_priority.h"
 #include "flutter/fml/task_source_grade.h"
 #include "flutter/fml/time/time_point.h"
+#include "flutter/fml/unique_closure.h"
 
 namespace fml {
 
 class DelayedTask {
  public:
   DelayedTask(size_t order,
-              const fml::closure& task,
+              fml::UniqueClosure task,
               fml::TimePoint target_time,
-              fml::TaskSourceGrade task_source_grade);
+              fml::TaskSourceGrade task_source_grade,
+              fml::TaskPriority priority = fml::TaskPriority::kNormal,
+              fml::TimePoint deadline = fml::TimePoint::Max());
 
-  DelayedTask(const DelayedTask& other);
+  DelayedTask(DelayedTask&& other);
+
+  DelayedTask& operator=(DelayedTask&& other);
 
   ~DelayedTask();
 
-  const fml::closure& GetTask() const;
+  const fml::UniqueClosure& GetTask() const;
+
+  /// Moves the task out, leaving this \p DelayedTask without one.
+  fml::UniqueClosure TakeTask();
 
   fml::TimePoint GetTargetTime() const;
 
   fml::TaskSourceGrade GetTaskSourceGrade() const;
 
+  fml::TaskPriority GetPriority() const;
+
+  /// The time by which the task should have run. Once it has passed, the
+  /// tasks of its priority run before those of every other priority. It is
+  /// \p fml::TimePoint::Max() for tasks without a deadline.
+  fml::TimePoint GetDeadline() const;
+
   bool operator>(const DelayedTask& other) const;
 
  private:
   size_t order_;
-  fml::closure task_;
+  fml::UniqueClosure task_;
   fml::TimePoint target_time_;
   fml::TaskSourceGrade task_source_grade_;
+  fml::TaskPriority priority_;
+  fml::TimePoint deadline_;
 };
 
-using DelayedTaskQueue = std::priority_queue<DelayedTask,
-                                             std::deque<DelayedTask>,
-                                             std::greater<DelayedTask>>;
+/// A min-heap of \p DelayedTask ordered by target time and then by the order
+/// in which the tasks were posted. Unlike a \p std::priority_queue, it lets
+/// the top task be moved out as it is popped.
+class DelayedTaskQueue {
+ public:
+  void push(DelayedTask task);
+
+  const DelayedTask& top() const { return heap_.front(); }
+
+  /// Removes and returns the top task.
+  DelayedTask pop();
+
+  bool empty() const { return heap_.empty(); }
+
+  size_t size() const { return heap_.size(); }
+
+ private:
+  std::vector<DelayedTask> heap_;
+};
 
 }  // namespace fml
 
@@ -53,6 +53,9 @@ class CopyableLambda {
 // Notice that the return type of MakeCopyable is rarely used directly. Instead,
 // callers typically erase the type by implicitly converting the return value
 // to an std::function.
+//
+// Tasks posted to an fml::TaskRunner are fml::UniqueClosures, which accept
+// move-only lambdas as they are and need no wrapper.
 template <typename T>
 internal::CopyableLambda<T> MakeCopyable(T lambda) {
   return internal::CopyableLambda<T>(std::move(lambda));
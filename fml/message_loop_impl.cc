@@ -54,16 +54,32 @@ MessageLoopImpl::~MessageLoopImpl() {
   task_queue_->Dispose(queue_id_);
 }
 
-void MessageLoopImpl::PostTask(const fml::closure& task,
-                               fml::TimePoint target_time) {
-  FML_DCHECK(task != nullptr);
-  FML_DCHECK(task != nullptr);
+void MessageLoopImpl::PostTask(fml::UniqueClosure task,
+                               fml::TimePoint target_time,
+                               fml::TaskPriority priority,
+                               fml::TimePoint deadline) {
+  FML_DCHECK(task);
   if (terminated_) {
     // If the message loop has already been terminated, PostTask should destruct
     // |task| synchronously within this function.
     return;
   }
-  task_queue_->RegisterTask(queue_id_, task, target_time);
+  task_queue_->RegisterTask(queue_id_, std::move(task), target_time,
+                            fml::TaskSourceGrade::kUnspecified, priority,
+                            deadline);
+}
+
+void MessageLoopImpl::PostTasks(std::vector<fml::UniqueClosure> tasks,
+                                fml::TimePoint target_time,
+                                fml::TaskPriority priority) {
+  FML_DCHECK(std::all_of(tasks.begin(), tasks.end(), [](const auto& task) {
+    return static_cast<bool>(task);
+  }));
+  if (terminated_) {
+    return;
+  }
+  task_queue_->RegisterTasks(queue_id_, std::move(tasks), target_time,
+                             priority);
 }
 
 void MessageLoopImpl::AddTaskObserver(intptr_t key,
@@ -121,13 +137,22 @@ void MessageLoopImpl::FlushTasks(FlushType type) {
   TRACE_EVENT0("fml", "MessageLoop::FlushTasks");
 
   const auto now = fml::TimePoint::Now();
-  fml::closure invocation;
+  const bool record_statistics = TaskQueueStatistics::IsRecordingEnabled();
+  fml::UniqueClosure invocation;
   do {
-    invocation = task_queue_->GetNextTaskToRun(queue_id_, now);
+    fml::TimePoint target_time;
+    invocation = task_queue_->GetNextTaskToRun(queue_id_, now, &target_time);
     if (!invocation) {
       break;
     }
-    invocation();
+    if (record_statistics) {
+      const auto start_time = fml::TimePoint::Now();
+      invocation();
+      task_queue_statistics_.RecordTask(start_time - target_time,
+                                        fml::TimePoint::Now() - start_time);
+    } else {
+      invocation();
+    }
     std::vector<fml::closure> observers =
         task_queue_->GetObserversToNotify(queue_id_);
     for (const auto& observer : observers) {
@@ -151,4 +176,8 @@ TaskQueueId MessageLoopImpl::GetTaskQueueId() const {
   return queue_id_;
 }
 
+const TaskQueueStatistics& MessageLoopImpl::GetTaskQueueStatistics() const {
+  return task_queue_statistics_;
+}
+
 }  // namespace fml
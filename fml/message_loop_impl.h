@@ -11,6 +11,7 @@
 #include <mutex>
 #include <queue>
 #include <utility>
+#include <vector>
 
 #include "flutter/fml/closure.h"
 #include "flutter/fml/delayed_task.h"
@@ -18,7 +19,9 @@
 #include "flutter/fml/memory/ref_counted.h"
 #include "flutter/fml/message_loop.h"
 #include "flutter/fml/message_loop_task_queues.h"
+#include "flutter/fml/task_queue_statistics.h"
 #include "flutter/fml/time/time_point.h"
+#include "flutter/fml/unique_closure.h"
 #include "flutter/fml/wakeable.h"
 
 namespace fml {
@@ -39,7 +42,14 @@ class MessageLoopImpl : public Wakeable,
 
   virtual void Terminate() = 0;
 
-  void PostTask(const fml::closure& task, fml::TimePoint target_time);
+  void PostTask(fml::UniqueClosure task,
+                fml::TimePoint target_time,
+                fml::TaskPriority priority = fml::TaskPriority::kNormal,
+                fml::TimePoint deadline = fml::TimePoint::Max());
+
+  void PostTasks(std::vector<fml::UniqueClosure> tasks,
+                 fml::TimePoint target_time,
+                 fml::TaskPriority priority = fml::TaskPriority::kNormal);
 
   void AddTaskObserver(intptr_t key, const fml::closure& callback);
 
@@ -51,6 +61,10 @@ class MessageLoopImpl : public Wakeable,
 
   virtual TaskQueueId GetTaskQueueId() const;
 
+  /// How long the tasks of this loop waited and ran, while
+  /// \p fml::TaskQueueStatistics recording was enabled.
+  const TaskQueueStatistics& GetTaskQueueStatistics() const;
+
  protected:
   // Exposed for the embedder shell which allows clients to poll for events
   // instead of dedicating a thread to the message loop.
@@ -68,6 +82,7 @@ class MessageLoopImpl : public Wakeable,
   TaskQueueId queue_id_;
 
   std::atomic_bool terminated_;
+  TaskQueueStatistics task_queue_statistics_;
 
   void FlushTasks(FlushType type);
 
@@ -6,9 +6,11 @@
 
 #include "flutter/fml/message_loop_task_queues.h"
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <optional>
+#include <utility>
 
 #include "flutter/fml/make_copyable.h"
 #include "flutter/fml/task_source.h"
@@ -36,7 +38,6 @@ class TaskSourceGradeHolder {
 };
 }  // namespace
 
-// Guarded by creation_mutex_.
 FML_THREAD_LOCAL ThreadLocalUniquePtr<TaskSourceGradeHolder>
     tls_task_source_grade;
 
@@ -58,59 +59,166 @@ fml::RefPtr<MessageLoopTaskQueues> MessageLoopTaskQueues::GetInstance() {
 }
 
 TaskQueueId MessageLoopTaskQueues::CreateTaskQueue() {
-  std::lock_guard guard(queue_mutex_);
+  std::lock_guard guard(table_mutex_);
   TaskQueueId loop_id = TaskQueueId(task_queue_id_counter_);
+  size_t chunk_index = loop_id / kTaskQueueChunkSize;
+  TaskQueueChunkDirectory* directory =
+      chunk_directory_.load(std::memory_order_relaxed);
+  if (chunk_index >= directory->size) {
+    auto grown =
+        std::make_unique<TaskQueueChunkDirectory>(directory->size * 2);
+    for (size_t i = 0; i < directory->size; i++) {
+      grown->chunks[i].store(directory->chunks[i].load(),
+                             std::memory_order_relaxed);
+    }
+    directory = grown.get();
+    chunk_directories_.push_back(std::move(grown));
+    chunk_directory_.store(directory, std::memory_order_release);
+  }
+  TaskQueueChunk* chunk =
+      directory->chunks[chunk_index].load(std::memory_order_relaxed);
+  if (!chunk) {
+    chunk = new TaskQueueChunk();
+    directory->chunks[chunk_index].store(chunk, std::memory_order_release);
+  }
   ++task_queue_id_counter_;
-  queue_entries_[loop_id] = std::make_unique<TaskQueueEntry>(loop_id);
+  chunk->entries[loop_id % kTaskQueueChunkSize].store(
+      new TaskQueueEntry(loop_id), std::memory_order_release);
   return loop_id;
 }
 
+MessageLoopTaskQueues::TaskQueueChunkDirectory::TaskQueueChunkDirectory(
+    size_t size_arg)
+    : size(size_arg), chunks(new std::atomic<TaskQueueChunk*>[size_arg]) {
+  for (size_t i = 0; i < size; i++) {
+    chunks[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
 MessageLoopTaskQueues::MessageLoopTaskQueues()
-    : task_queue_id_counter_(0), order_(0) {}
+    : task_queue_id_counter_(0), order_(0) {
+  chunk_directories_.push_back(
+      std::make_unique<TaskQueueChunkDirectory>(kInitialTaskQueueChunkCount));
+  chunk_directory_.store(chunk_directories_.back().get());
+}
+
+MessageLoopTaskQueues::~MessageLoopTaskQueues() {
+  TaskQueueChunkDirectory* directory = chunk_directory_.load();
+  for (size_t i = 0; i < directory->size; i++) {
+    TaskQueueChunk* chunk = directory->chunks[i].load();
+    if (!chunk) {
+      break;
+    }
+    for (auto& entry : chunk->entries) {
+      delete entry.load();
+    }
+    delete chunk;
+  }
+}
+
+MessageLoopTaskQueues::TaskQueueChunk* MessageLoopTaskQueues::GetChunk(
+    TaskQueueId queue_id) const {
+  const TaskQueueChunkDirectory* directory =
+      chunk_directory_.load(std::memory_order_acquire);
+  size_t chunk_index = queue_id / kTaskQueueChunkSize;
+  FML_CHECK(chunk_index < directory->size)
+      << "Unknown task queue " << queue_id;
+  return directory->chunks[chunk_index].load(std::memory_order_acquire);
+}
+
+TaskQueueEntry* MessageLoopTaskQueues::GetEntry(TaskQueueId queue_id) const {
+  FML_DCHECK(queue_id != _kUnmerged);
+  TaskQueueChunk* chunk = GetChunk(queue_id);
+  FML_CHECK(chunk) << "Unknown task queue " << queue_id;
+  TaskQueueEntry* entry = chunk->entries[queue_id % kTaskQueueChunkSize].load(
+      std::memory_order_acquire);
+  FML_CHECK(entry) << "Unknown task queue " << queue_id;
+  return entry;
+}
+
+std::unique_ptr<TaskQueueEntry> MessageLoopTaskQueues::ReleaseEntry(
+    TaskQueueId queue_id) {
+  TaskQueueChunk* chunk = GetChunk(queue_id);
+  return std::unique_ptr<TaskQueueEntry>(
+      chunk->entries[queue_id % kTaskQueueChunkSize].exchange(nullptr));
+}
+
+std::unique_lock<std::mutex> MessageLoopTaskQueues::LockTaskQueue(
+    TaskQueueId queue_id) const {
+  TaskQueueEntry* entry = GetEntry(queue_id);
+  while (true) {
+    TaskQueueId owner = entry->subsumed_by.load();
+    TaskQueueEntry* guard = owner == _kUnmerged ? entry : GetEntry(owner);
+    std::unique_lock lock(guard->mutex);
+    // The queue may have been merged or unmerged before the lock was
+    // acquired. Both need the lock that is now held, so once the owner is
+    // seen unchanged it stays that way.
+    if (entry->subsumed_by.load() == owner) {
+      return lock;
+    }
+  }
+}
 
-MessageLoopTaskQueues::~MessageLoopTaskQueues() = default;
+std::pair<std::unique_lock<std::mutex>, std::unique_lock<std::mutex>>
+MessageLoopTaskQueues::LockTaskQueuePair(TaskQueueEntry* a, TaskQueueEntry* b) {
+  if (b->created_for < a->created_for) {
+    std::swap(a, b);
+  }
+  std::unique_lock first(a->mutex);
+  std::unique_lock second(b->mutex);
+  return {std::move(first), std::move(second)};
+}
 
 void MessageLoopTaskQueues::Dispose(TaskQueueId queue_id) {
-  std::lock_guard guard(queue_mutex_);
-  const auto& queue_entry = queue_entries_.at(queue_id);
-  FML_DCHECK(queue_entry->subsumed_by == _kUnmerged);
-  auto& subsumed_set = queue_entry->owner_of;
-  for (auto& subsumed : subsumed_set) {
-    queue_entries_.erase(subsumed);
+  std::vector<std::unique_ptr<TaskQueueEntry>> disposed;
+  {
+    auto lock = LockTaskQueue(queue_id);
+    const auto* queue_entry = GetEntry(queue_id);
+    FML_DCHECK(queue_entry->subsumed_by.load() == _kUnmerged);
+    for (auto& subsumed : queue_entry->owner_of) {
+      disposed.push_back(ReleaseEntry(subsumed));
+    }
   }
-  // Erase owner queue_id at last to avoid &subsumed_set from being invalid
-  queue_entries_.erase(queue_id);
+  // Release the owner last, its mutex had to be unlocked first.
+  disposed.push_back(ReleaseEntry(queue_id));
 }
 
 void MessageLoopTaskQueues::DisposeTasks(TaskQueueId queue_id) {
-  std::lock_guard guard(queue_mutex_);
-  const auto& queue_entry = queue_entries_.at(queue_id);
-  FML_DCHECK(queue_entry->subsumed_by == _kUnmerged);
+  auto lock = LockTaskQueue(queue_id);
+  auto* queue_entry = GetEntry(queue_id);
+  FML_DCHECK(queue_entry->subsumed_by.load() == _kUnmerged);
   auto& subsumed_set = queue_entry->owner_of;
   queue_entry->task_source->ShutDown();
+  queue_entry->idle_tasks.clear();
   for (auto& subsumed : subsumed_set) {
-    queue_entries_.at(subsumed)->task_source->ShutDown();
+    auto* subsumed_entry = GetEntry(subsumed);
+    subsumed_entry->task_source->ShutDown();
+    subsumed_entry->idle_tasks.clear();
   }
 }
 
 TaskSourceGrade MessageLoopTaskQueues::GetCurrentTaskSourceGrade() {
-  std::scoped_lock creation(creation_mutex_);
-  return tls_task_source_grade.get()->task_source_grade;
+  // The grade is thread local and needs no lock.
+  const auto* holder = tls_task_source_grade.get();
+  return holder ? holder->task_source_grade : TaskSourceGrade::kUnspecified;
 }
 
 void MessageLoopTaskQueues::RegisterTask(
     TaskQueueId queue_id,
-    const fml::closure& task,
+    fml::UniqueClosure task,
     fml::TimePoint target_time,
-    fml::TaskSourceGrade task_source_grade) {
-  std::lock_guard guard(queue_mutex_);
+    fml::TaskSourceGrade task_source_grade,
+    fml::TaskPriority priority,
+    fml::TimePoint deadline) {
+  auto lock = LockTaskQueue(queue_id);
   size_t order = order_++;
-  const auto& queue_entry = queue_entries_.at(queue_id);
+  const auto* queue_entry = GetEntry(queue_id);
   queue_entry->task_source->RegisterTask(
-      {order, task, target_time, task_source_grade});
+      {order, std::move(task), target_time, task_source_grade, priority,
+       deadline});
   TaskQueueId loop_to_wake = queue_id;
-  if (queue_entry->subsumed_by != _kUnmerged) {
-    loop_to_wake = queue_entry->subsumed_by;
+  if (queue_entry->subsumed_by.load() != _kUnmerged) {
+    loop_to_wake = queue_entry->subsumed_by.load();
   }
 
   // This can happen when the secondary tasks are paused.
@@ -119,18 +227,45 @@ void MessageLoopTaskQueues::RegisterTask(
   }
 }
 
+void MessageLoopTaskQueues::RegisterTasks(TaskQueueId queue_id,
+                                          std::vector<fml::UniqueClosure> tasks,
+                                          fml::TimePoint target_time,
+                                          fml::TaskPriority priority) {
+  if (tasks.empty()) {
+    return;
+  }
+  auto lock = LockTaskQueue(queue_id);
+  size_t order = order_.fetch_add(tasks.size());
+  const auto* queue_entry = GetEntry(queue_id);
+  for (auto& task : tasks) {
+    queue_entry->task_source->RegisterTask(
+        {order++, std::move(task), target_time,
+         fml::TaskSourceGrade::kUnspecified, priority});
+  }
+  TaskQueueId loop_to_wake = queue_id;
+  if (queue_entry->subsumed_by.load() != _kUnmerged) {
+    loop_to_wake = queue_entry->subsumed_by.load();
+  }
+
+  if (HasPendingTasksUnlocked(loop_to_wake)) {
+    WakeUpUnlocked(loop_to_wake, GetNextWakeTimeUnlocked(loop_to_wake));
+  }
+}
+
 bool MessageLoopTaskQueues::HasPendingTasks(TaskQueueId queue_id) const {
-  std::lock_guard guard(queue_mutex_);
+  auto lock = LockTaskQueue(queue_id);
   return HasPendingTasksUnlocked(queue_id);
 }
 
-fml::closure MessageLoopTaskQueues::GetNextTaskToRun(TaskQueueId queue_id,
-                                                     fml::TimePoint from_time) {
-  std::lock_guard guard(queue_mutex_);
+fml::UniqueClosure MessageLoopTaskQueues::GetNextTaskToRun(
+    TaskQueueId queue_id,
+    fml::TimePoint from_time,
+    fml::TimePoint* target_time) {
+  auto lock = LockTaskQueue(queue_id);
   if (!HasPendingTasksUnlocked(queue_id)) {
     return nullptr;
   }
-  TaskSource::TopTask top = PeekNextTaskUnlocked(queue_id);
+  TaskSource::TopTask top = PeekNextTaskUnlocked(queue_id, from_time);
 
   if (!HasPendingTasksUnlocked(queue_id)) {
     WakeUpUnlocked(queue_id, fml::TimePoint::Max());
@@ -141,12 +276,18 @@ fml::closure MessageLoopTaskQueues::GetNextTaskToRun(TaskQueueId queue_id,
   if (top.task.GetTargetTime() > from_time) {
     return nullptr;
   }
-  fml::closure invocation = top.task.GetTask();
-  queue_entries_.at(top.task_queue_id)
-      ->task_source->PopTask(top.task.GetTaskSourceGrade());
-  {
-    std::scoped_lock creation(creation_mutex_);
-    const auto task_source_grade = top.task.GetTaskSourceGrade();
+  if (target_time) {
+    *target_time = top.task.GetTargetTime();
+  }
+  const auto task_source_grade = top.task.GetTaskSourceGrade();
+  fml::UniqueClosure invocation =
+      GetEntry(top.task_queue_id)
+          ->task_source->PopTask(task_source_grade, top.task.GetPriority());
+  lock.unlock();
+
+  if (auto* holder = tls_task_source_grade.get()) {
+    holder->task_source_grade = task_source_grade;
+  } else {
     tls_task_source_grade.reset(new TaskSourceGradeHolder{task_source_grade});
   }
   return invocation;
@@ -154,15 +295,15 @@ fml::closure MessageLoopTaskQueues::GetNextTaskToRun(TaskQueueId queue_id,
 
 void MessageLoopTaskQueues::WakeUpUnlocked(TaskQueueId queue_id,
                                            fml::TimePoint time) const {
-  if (queue_entries_.at(queue_id)->wakeable) {
-    queue_entries_.at(queue_id)->wakeable->WakeUp(time);
+  if (auto* wakeable = GetEntry(queue_id)->wakeable) {
+    wakeable->WakeUp(time);
   }
 }
 
 size_t MessageLoopTaskQueues::GetNumPendingTasks(TaskQueueId queue_id) const {
-  std::lock_guard guard(queue_mutex_);
-  const auto& queue_entry = queue_entries_.at(queue_id);
-  if (queue_entry->subsumed_by != _kUnmerged) {
+  auto lock = LockTaskQueue(queue_id);
+  const auto* queue_entry = GetEntry(queue_id);
+  if (queue_entry->subsumed_by.load() != _kUnmerged) {
     return 0;
   }
 
@@ -171,42 +312,71 @@ size_t MessageLoopTaskQueues::GetNumPendingTasks(TaskQueueId queue_id) const {
 
   auto& subsumed_set = queue_entry->owner_of;
   for (auto& subsumed : subsumed_set) {
-    const auto& subsumed_entry = queue_entries_.at(subsumed);
+    const auto* subsumed_entry = GetEntry(subsumed);
     total_tasks += subsumed_entry->task_source->GetNumPendingTasks();
   }
   return total_tasks;
 }
 
+void MessageLoopTaskQueues::RegisterIdleTask(TaskQueueId queue_id,
+                                             const IdleTask& task,
+                                             fml::TimePoint timeout_time) {
+  auto lock = LockTaskQueue(queue_id);
+  GetEntry(queue_id)->idle_tasks.push_back({task, timeout_time});
+}
+
+bool MessageLoopTaskQueues::HasPendingIdleTasks(TaskQueueId queue_id) const {
+  auto lock = LockTaskQueue(queue_id);
+  return !GetEntry(queue_id)->idle_tasks.empty();
+}
+
+IdleTask MessageLoopTaskQueues::GetNextIdleTask(TaskQueueId queue_id,
+                                                fml::TimePoint timed_out_by) {
+  auto lock = LockTaskQueue(queue_id);
+  auto& idle_tasks = GetEntry(queue_id)->idle_tasks;
+  auto found = std::find_if(idle_tasks.begin(), idle_tasks.end(),
+                            [timed_out_by](const auto& idle_task) {
+                              return idle_task.timeout_time <= timed_out_by;
+                            });
+  if (found == idle_tasks.end()) {
+    return nullptr;
+  }
+  IdleTask task = std::move(found->task);
+  idle_tasks.erase(found);
+  return task;
+}
+
 void MessageLoopTaskQueues::AddTaskObserver(TaskQueueId queue_id,
                                             intptr_t key,
                                             const fml::closure& callback) {
-  std::lock_guard guard(queue_mutex_);
+  auto lock = LockTaskQueue(queue_id);
   FML_DCHECK(callback != nullptr) << "Observer callback must be non-null.";
-  queue_entries_.at(queue_id)->task_observers[key] = callback;
+  GetEntry(queue_id)->task_observers[key] = callback;
 }
 
 void MessageLoopTaskQueues::RemoveTaskObserver(TaskQueueId queue_id,
                                                intptr_t key) {
-  std::lock_guard guard(queue_mutex_);
-  queue_entries_.at(queue_id)->task_observers.erase(key);
+  auto lock = LockTaskQueue(queue_id);
+  GetEntry(queue_id)->task_observers.erase(key);
 }
 
 std::vector<fml::closure> MessageLoopTaskQueues::GetObserversToNotify(
     TaskQueueId queue_id) const {
-  std::lock_guard guard(queue_mutex_);
+  auto lock = LockTaskQueue(queue_id);
   std::vector<fml::closure> observers;
+  const auto* queue_entry = GetEntry(queue_id);
 
-  if (queue_entries_.at(queue_id)->subsumed_by != _kUnmerged) {
+  if (queue_entry->subsumed_by.load() != _kUnmerged) {
     return observers;
   }
 
-  for (const auto& observer : queue_entries_.at(queue_id)->task_observers) {
+  for (const auto& observer : queue_entry->task_observers) {
     observers.push_back(observer.second);
   }
 
-  auto& subsumed_set = queue_entries_.at(queue_id)->owner_of;
+  auto& subsumed_set = queue_entry->owner_of;
   for (auto& subsumed : subsumed_set) {
-    for (const auto& observer : queue_entries_.at(subsumed)->task_observers) {
+    for (const auto& observer : GetEntry(subsumed)->task_observers) {
       observers.push_back(observer.second);
     }
   }
@@ -216,19 +386,21 @@ std::vector<fml::closure> MessageLoopTaskQueues::GetObserversToNotify(
 
 void MessageLoopTaskQueues::SetWakeable(TaskQueueId queue_id,
                                         fml::Wakeable* wakeable) {
-  std::lock_guard guard(queue_mutex_);
-  FML_CHECK(!queue_entries_.at(queue_id)->wakeable)
-      << "Wakeable can only be set once.";
-  queue_entries_.at(queue_id)->wakeable = wakeable;
+  auto lock = LockTaskQueue(queue_id);
+  auto* queue_entry = GetEntry(queue_id);
+  FML_CHECK(!queue_entry->wakeable) << "Wakeable can only be set once.";
+  queue_entry->wakeable = wakeable;
 }
 
 bool MessageLoopTaskQueues::Merge(TaskQueueId owner, TaskQueueId subsumed) {
   if (owner == subsumed) {
     return true;
   }
-  std::lock_guard guard(queue_mutex_);
-  auto& owner_entry = queue_entries_.at(owner);
-  auto& subsumed_entry = queue_entries_.at(subsumed);
+  auto* owner_entry = GetEntry(owner);
+  auto* subsumed_entry = GetEntry(subsumed);
+  // Each entry is guarded by its own mutex unless it is subsumed, in which
+  // case the merge fails below without touching any state.
+  auto locks = LockTaskQueuePair(owner_entry, subsumed_entry);
   auto& subsumed_set = owner_entry->owner_of;
   if (subsumed_set.find(subsumed) != subsumed_set.end()) {
     return true;
@@ -238,11 +410,12 @@ bool MessageLoopTaskQueues::Merge(TaskQueueId owner, TaskQueueId subsumed) {
   // merged with other different queues.
 
   // Ensure owner_entry->subsumed_by being _kUnmerged
-  if (owner_entry->subsumed_by != _kUnmerged) {
+  if (owner_entry->subsumed_by.load() != _kUnmerged) {
     FML_LOG(WARNING) << "Thread merging failed: owner_entry was already "
                         "subsumed by others, owner="
                      << owner << ", subsumed=" << subsumed
-                     << ", owner->subsumed_by=" << owner_entry->subsumed_by;
+                     << ", owner->subsumed_by="
+                     << owner_entry->subsumed_by.load();
     return false;
   }
   // Ensure subsumed_entry->owner_of being empty
@@ -254,12 +427,12 @@ bool MessageLoopTaskQueues::Merge(TaskQueueId owner, TaskQueueId subsumed) {
     return false;
   }
   // Ensure subsumed_entry->subsumed_by being _kUnmerged
-  if (subsumed_entry->subsumed_by != _kUnmerged) {
+  if (subsumed_entry->subsumed_by.load() != _kUnmerged) {
     FML_LOG(WARNING) << "Thread merging failed: subsumed_entry was already "
                         "subsumed by others, owner="
                      << owner << ", subsumed=" << subsumed
                      << ", subsumed->subsumed_by="
-                     << subsumed_entry->subsumed_by;
+                     << subsumed_entry->subsumed_by.load();
     return false;
   }
   // All checking is OK, set merged state.
@@ -274,22 +447,23 @@ bool MessageLoopTaskQueues::Merge(TaskQueueId owner, TaskQueueId subsumed) {
 }
 
 bool MessageLoopTaskQueues::Unmerge(TaskQueueId owner, TaskQueueId subsumed) {
-  std::lock_guard guard(queue_mutex_);
-  const auto& owner_entry = queue_entries_.at(owner);
+  auto* owner_entry = GetEntry(owner);
+  auto* subsumed_entry = GetEntry(subsumed);
+  auto locks = LockTaskQueuePair(owner_entry, subsumed_entry);
   if (owner_entry->owner_of.empty()) {
     FML_LOG(WARNING)
         << "Thread unmerging failed: owner_entry doesn't own anyone, owner="
         << owner << ", subsumed=" << subsumed;
     return false;
   }
-  if (owner_entry->subsumed_by != _kUnmerged) {
+  if (owner_entry->subsumed_by.load() != _kUnmerged) {
     FML_LOG(WARNING)
         << "Thread unmerging failed: owner_entry was subsumed by others, owner="
         << owner << ", subsumed=" << subsumed
-        << ", owner_entry->subsumed_by=" << owner_entry->subsumed_by;
+        << ", owner_entry->subsumed_by=" << owner_entry->subsumed_by.load();
     return false;
   }
-  if (queue_entries_.at(subsumed)->subsumed_by == _kUnmerged) {
+  if (subsumed_entry->subsumed_by.load() == _kUnmerged) {
     FML_LOG(WARNING) << "Thread unmerging failed: subsumed_entry wasn't "
                         "subsumed by others, owner="
                      << owner << ", subsumed=" << subsumed;
@@ -302,7 +476,7 @@ bool MessageLoopTaskQueues::Unmerge(TaskQueueId owner, TaskQueueId subsumed) {
     return false;
   }
 
-  queue_entries_.at(subsumed)->subsumed_by = _kUnmerged;
+  subsumed_entry->subsumed_by = _kUnmerged;
   owner_entry->owner_of.erase(subsumed);
 
   if (HasPendingTasksUnlocked(owner)) {
@@ -318,28 +492,28 @@ bool MessageLoopTaskQueues::Unmerge(TaskQueueId owner, TaskQueueId subsumed) {
 
 bool MessageLoopTaskQueues::Owns(TaskQueueId owner,
                                  TaskQueueId subsumed) const {
-  std::lock_guard guard(queue_mutex_);
   if (owner == _kUnmerged || subsumed == _kUnmerged) {
     return false;
   }
-  auto& subsumed_set = queue_entries_.at(owner)->owner_of;
+  auto lock = LockTaskQueue(owner);
+  auto& subsumed_set = GetEntry(owner)->owner_of;
   return subsumed_set.find(subsumed) != subsumed_set.end();
 }
 
 std::set<TaskQueueId> MessageLoopTaskQueues::GetSubsumedTaskQueueId(
     TaskQueueId owner) const {
-  std::lock_guard guard(queue_mutex_);
-  return queue_entries_.at(owner)->owner_of;
+  auto lock = LockTaskQueue(owner);
+  return GetEntry(owner)->owner_of;
 }
 
 void MessageLoopTaskQueues::PauseSecondarySource(TaskQueueId queue_id) {
-  std::lock_guard guard(queue_mutex_);
-  queue_entries_.at(queue_id)->task_source->PauseSecondary();
+  auto lock = LockTaskQueue(queue_id);
+  GetEntry(queue_id)->task_source->PauseSecondary();
 }
 
 void MessageLoopTaskQueues::ResumeSecondarySource(TaskQueueId queue_id) {
-  std::lock_guard guard(queue_mutex_);
-  queue_entries_.at(queue_id)->task_source->ResumeSecondary();
+  auto lock = LockTaskQueue(queue_id);
+  GetEntry(queue_id)->task_source->ResumeSecondary();
   // Schedule a wake as needed.
   if (HasPendingTasksUnlocked(queue_id)) {
     WakeUpUnlocked(queue_id, GetNextWakeTimeUnlocked(queue_id));
@@ -350,8 +524,8 @@ void MessageLoopTaskQueues::ResumeSecondarySource(TaskQueueId queue_id) {
 // Owning queues will consider both their and their subsumed tasks.
 bool MessageLoopTaskQueues::HasPendingTasksUnlocked(
     TaskQueueId queue_id) const {
-  const auto& entry = queue_entries_.at(queue_id);
-  bool is_subsumed = entry->subsumed_by != _kUnmerged;
+  const auto* entry = GetEntry(queue_id);
+  bool is_subsumed = entry->subsumed_by.load() != _kUnmerged;
   if (is_subsumed) {
     return false;
   }
@@ -363,7 +537,7 @@ bool MessageLoopTaskQueues::HasPendingTasksUnlocked(
   auto& subsumed_set = entry->owner_of;
   return std::any_of(
       subsumed_set.begin(), subsumed_set.end(), [&](const auto& subsumed) {
-        return !queue_entries_.at(subsumed)->task_source->IsEmpty();
+        return !GetEntry(subsumed)->task_source->IsEmpty();
       });
 }
 
@@ -373,22 +547,23 @@ fml::TimePoint MessageLoopTaskQueues::GetNextWakeTimeUnlocked(
 }
 
 TaskSource::TopTask MessageLoopTaskQueues::PeekNextTaskUnlocked(
-    TaskQueueId owner) const {
+    TaskQueueId owner,
+    fml::TimePoint now) const {
   FML_DCHECK(HasPendingTasksUnlocked(owner));
-  const auto& entry = queue_entries_.at(owner);
+  const auto* entry = GetEntry(owner);
   if (entry->owner_of.empty()) {
     FML_CHECK(!entry->task_source->IsEmpty());
-    return entry->task_source->Top();
+    return entry->task_source->Top(now);
   }
 
   // Use optional for the memory of TopTask object.
   std::optional<TaskSource::TopTask> top_task;
 
   std::function<void(const TaskSource*)> top_task_updater =
-      [&top_task](const TaskSource* source) {
+      [&top_task, now](const TaskSource* source) {
         if (source && !source->IsEmpty()) {
-          TaskSource::TopTask other_task = source->Top();
-          if (!top_task.has_value() || top_task->task > other_task.task) {
+          TaskSource::TopTask other_task = source->Top(now);
+          if (!top_task.has_value() || other_task.RunsBefore(*top_task, now)) {
             top_task.emplace(other_task);
           }
         }
@@ -398,7 +573,7 @@ TaskSource::TopTask MessageLoopTaskQueues::PeekNextTaskUnlocked(
   top_task_updater(owner_tasks);
 
   for (TaskQueueId subsumed : entry->owner_of) {
-    TaskSource* subsumed_tasks = queue_entries_.at(subsumed)->task_source.get();
+    TaskSource* subsumed_tasks = GetEntry(subsumed)->task_source.get();
     top_task_updater(subsumed_tasks);
   }
   // At least one task at the top because PeekNextTaskUnlocked() is called after
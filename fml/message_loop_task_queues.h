@@ -5,9 +5,15 @@
 #ifndef FLUTTER_FML_MESSAGE_LOOP_TASK_QUEUES_H_
 #define FLUTTER_FML_MESSAGE_LOOP_TASK_QUEUES_H_
 
+#include <array>
+#include <atomic>
+#include <deque>
+#include <functional>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <set>
+#include <utility>
 #include <vector>
 
 #include "flutter/fml/closure.h"
@@ -17,31 +23,50 @@
 #include "flutter/fml/synchronization/shared_mutex.h"
 #include "flutter/fml/task_queue_id.h"
 #include "flutter/fml/task_source.h"
+#include "flutter/fml/unique_closure.h"
 #include "flutter/fml/wakeable.h"
 
 namespace fml {
 
 static const TaskQueueId _kUnmerged = TaskQueueId(TaskQueueId::kUnmerged);
 
+/// A task to run while its thread is idle. It is passed the time by which it
+/// should return, so that it can bound the work it does.
+using IdleTask = std::function<void(fml::TimePoint deadline)>;
+
 /// A collection of tasks and observers associated with one TaskQueue.
 ///
 /// Often a TaskQueue has a one-to-one relationship with a fml::MessageLoop,
 /// this isn't the case when TaskQueues are merged via
 /// \p fml::MessageLoopTaskQueues::Merge.
+///
+/// An entry is guarded by its own \p mutex while it is independent or owns
+/// other TaskQueues, and by the \p mutex of its owner while it is subsumed.
 class TaskQueueEntry {
  public:
   using TaskObservers = std::map<intptr_t, fml::closure>;
+  mutable std::mutex mutex;
   Wakeable* wakeable;
   TaskObservers task_observers;
   std::unique_ptr<TaskSource> task_source;
 
+  struct PendingIdleTask {
+    IdleTask task;
+    /// The time after which the task runs even if the thread was not idle.
+    fml::TimePoint timeout_time;
+  };
+  std::deque<PendingIdleTask> idle_tasks;
+
   /// Set of the TaskQueueIds which is owned by this TaskQueue. If the set is
   /// empty, this TaskQueue does not own any other TaskQueues.
   std::set<TaskQueueId> owner_of;
 
   /// Identifies the TaskQueue that subsumes this TaskQueue. If it is _kUnmerged
   /// it indicates that this TaskQueue is not owned by any other TaskQueue.
-  TaskQueueId subsumed_by;
+  ///
+  /// Only changed while holding the mutexes of both this entry and its
+  /// owner, but read without a lock to find the mutex guarding the entry.
+  std::atomic<TaskQueueId> subsumed_by;
 
   TaskQueueId created_for;
 
@@ -78,19 +103,46 @@ class MessageLoopTaskQueues
   // Tasks methods.
 
   void RegisterTask(TaskQueueId queue_id,
-                    const fml::closure& task,
+                    fml::UniqueClosure task,
                     fml::TimePoint target_time,
                     fml::TaskSourceGrade task_source_grade =
-                        fml::TaskSourceGrade::kUnspecified);
+                        fml::TaskSourceGrade::kUnspecified,
+                    fml::TaskPriority priority = fml::TaskPriority::kNormal,
+                    fml::TimePoint deadline = fml::TimePoint::Max());
+
+  /// Registers all of \p tasks, in order, with the same \p target_time and
+  /// \p priority. The queue is locked and its loop woken up only once.
+  void RegisterTasks(TaskQueueId queue_id,
+                     std::vector<fml::UniqueClosure> tasks,
+                     fml::TimePoint target_time,
+                     fml::TaskPriority priority = fml::TaskPriority::kNormal);
 
   bool HasPendingTasks(TaskQueueId queue_id) const;
 
-  fml::closure GetNextTaskToRun(TaskQueueId queue_id, fml::TimePoint from_time);
+  /// Returns the task to run at \p from_time, if any. Of the tasks that are
+  /// ready, the one with the highest \p fml::TaskPriority is returned. If
+  /// \p target_time is not null, it is set to the target time of the task.
+  fml::UniqueClosure GetNextTaskToRun(TaskQueueId queue_id,
+                                      fml::TimePoint from_time,
+                                      fml::TimePoint* target_time = nullptr);
 
   size_t GetNumPendingTasks(TaskQueueId queue_id) const;
 
   static TaskSourceGrade GetCurrentTaskSourceGrade();
 
+  // Idle tasks methods.
+
+  void RegisterIdleTask(TaskQueueId queue_id,
+                        const IdleTask& task,
+                        fml::TimePoint timeout_time);
+
+  bool HasPendingIdleTasks(TaskQueueId queue_id) const;
+
+  /// Removes and returns the oldest idle task of \p queue_id whose timeout
+  /// time is no later than \p timed_out_by, or null if there is none.
+  IdleTask GetNextIdleTask(TaskQueueId queue_id,
+                           fml::TimePoint timed_out_by = fml::TimePoint::Max());
+
   // Observers methods.
 
   void AddTaskObserver(TaskQueueId queue_id,
@@ -144,19 +196,61 @@ class MessageLoopTaskQueues
 
   ~MessageLoopTaskQueues();
 
+  // The entries are kept in a flat table indexed by TaskQueueId. The table
+  // is made of chunks that are allocated as ids are handed out and never
+  // move, so that looking up an entry takes no lock. The directory of chunks
+  // doubles in size when it is full. Directories that were replaced are kept
+  // until the table is destroyed, as lookups may still be reading them.
+  static constexpr size_t kTaskQueueChunkSize = 256;
+  static constexpr size_t kInitialTaskQueueChunkCount = 16;
+
+  struct TaskQueueChunk {
+    std::array<std::atomic<TaskQueueEntry*>, kTaskQueueChunkSize> entries = {};
+  };
+
+  struct TaskQueueChunkDirectory {
+    explicit TaskQueueChunkDirectory(size_t size);
+
+    const size_t size;
+    std::unique_ptr<std::atomic<TaskQueueChunk*>[]> chunks;
+  };
+
+  TaskQueueChunk* GetChunk(TaskQueueId queue_id) const;
+
+  TaskQueueEntry* GetEntry(TaskQueueId queue_id) const;
+
+  std::unique_ptr<TaskQueueEntry> ReleaseEntry(TaskQueueId queue_id);
+
+  // Locks the mutex that guards |queue_id|, which is the mutex of its owner
+  // if it is subsumed. The "Unlocked" methods below must be called with the
+  // lock of the queue they are passed held.
+  std::unique_lock<std::mutex> LockTaskQueue(TaskQueueId queue_id) const;
+
+  // Locks the mutexes of two entries in the order of their ids, so that
+  // merging and unmerging the same queues concurrently cannot deadlock.
+  static std::pair<std::unique_lock<std::mutex>, std::unique_lock<std::mutex>>
+  LockTaskQueuePair(TaskQueueEntry* a, TaskQueueEntry* b);
+
   void WakeUpUnlocked(TaskQueueId queue_id, fml::TimePoint time) const;
 
   bool HasPendingTasksUnlocked(TaskQueueId queue_id) const;
 
-  TaskSource::TopTask PeekNextTaskUnlocked(TaskQueueId owner) const;
+  // Returns the task to run at |now|, or the task with the earliest target
+  // time if |now| is fml::TimePoint::Min().
+  TaskSource::TopTask PeekNextTaskUnlocked(
+      TaskQueueId owner,
+      fml::TimePoint now = fml::TimePoint::Min()) const;
 
   fml::TimePoint GetNextWakeTimeUnlocked(TaskQueueId queue_id) const;
 
   static std::mutex creation_mutex_;
   static fml::RefPtr<MessageLoopTaskQueues> instance_;
 
-  mutable std::mutex queue_mutex_;
-  std::map<TaskQueueId, std::unique_ptr<TaskQueueEntry>> queue_entries_;
+  // Guards the allocation of ids, chunks and chunk directories.
+  std::mutex table_mutex_;
+  std::atomic<TaskQueueChunkDirectory*> chunk_directory_;
+  // Every directory that was ever in use, the current one last.
+  std::vector<std::unique_ptr<TaskQueueChunkDirectory>> chunk_directories_;
 
   size_t task_queue_id_counter_;
 
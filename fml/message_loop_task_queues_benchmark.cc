@@ -10,6 +10,7 @@
 #include <vector>
 
 #include "flutter/benchmarking/benchmarking.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/synchronization/count_down_latch.h"
 
 namespace fml {
@@ -44,7 +45,7 @@ static void BM_RegisterAndGetTasks(benchmark::State& state) {  // NOLINT
         const auto now = fml::TimePoint::Now();
         int num_invocations = 0;
         for (;;) {
-          fml::closure invocation =
+          fml::UniqueClosure invocation =
               task_queue->GetNextTaskToRun(TaskQueueId(task_runner_id), now);
           if (!invocation) {
             break;
@@ -66,5 +67,154 @@ static void BM_RegisterAndGetTasks(benchmark::State& state) {  // NOLINT
 
 BENCHMARK(BM_RegisterAndGetTasks);
 
+// Simulates |state.range(0)| engines running in the same process. Each
+// engine has a platform, UI, raster and IO queue and a thread that keeps
+// posting tasks to its own queues and running them, so the engines only
+// contend on the task queues if they share state.
+static void BM_MultiEngineContention(benchmark::State& state) {  // NOLINT
+  const int num_engines = state.range(0);
+  const int num_queues_per_engine = 4;
+  const int num_tasks_per_engine = 1000;
+  auto task_queues = fml::MessageLoopTaskQueues::GetInstance();
+
+  std::vector<std::vector<TaskQueueId>> engines;
+  for (int i = 0; i < num_engines; i++) {
+    std::vector<TaskQueueId> queues;
+    for (int j = 0; j < num_queues_per_engine; j++) {
+      queues.push_back(task_queues->CreateTaskQueue());
+    }
+    engines.push_back(std::move(queues));
+  }
+
+  while (state.KeepRunning()) {
+    std::vector<std::thread> threads;
+    CountDownLatch engines_done(num_engines);
+    for (const auto& queues : engines) {
+      threads.emplace_back([&task_queues, &queues, &engines_done]() {
+        const fml::TimePoint now = fml::TimePoint::Now();
+        for (int i = 0; i < num_tasks_per_engine; i++) {
+          TaskQueueId queue_id = queues[i % queues.size()];
+          task_queues->RegisterTask(
+              queue_id, [] {}, now);
+          fml::UniqueClosure invocation =
+              task_queues->GetNextTaskToRun(queue_id, now);
+          assert(invocation);
+        }
+        engines_done.CountDown();
+      });
+    }
+    engines_done.Wait();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  for (const auto& queues : engines) {
+    for (TaskQueueId queue_id : queues) {
+      task_queues->Dispose(queue_id);
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * num_engines *
+                          num_tasks_per_engine);
+}
+
+BENCHMARK(BM_MultiEngineContention)
+    ->RangeMultiplier(2)
+    ->Range(1, 16)
+    ->UseRealTime();
+
+// Measures the task throughput of a ConcurrentMessageLoop with
+// |state.range(0)| workers. Half of the tasks are posted from outside the
+// loop and each of them posts another task from its worker, so both the
+// round robin distribution and the stealing of worker-local tasks are
+// exercised.
+static void BM_ConcurrentMessageLoopScaling(  // NOLINT
+    benchmark::State& state) {
+  const size_t worker_count = state.range(0);
+  const size_t num_tasks = 10000;
+  auto loop = fml::ConcurrentMessageLoop::Create(worker_count);
+  auto task_runner = loop->GetTaskRunner();
+
+  while (state.KeepRunning()) {
+    CountDownLatch tasks_done(num_tasks * 2);
+    for (size_t i = 0; i < num_tasks; i++) {
+      task_runner->PostTask([&task_runner, &tasks_done]() {
+        task_runner->PostTask([&tasks_done]() { tasks_done.CountDown(); });
+        tasks_done.CountDown();
+      });
+    }
+    tasks_done.Wait();
+  }
+
+  state.SetItemsProcessed(state.iterations() * num_tasks * 2);
+}
+
+BENCHMARK(BM_ConcurrentMessageLoopScaling)
+    ->RangeMultiplier(2)
+    ->Range(1, 64)
+    ->UseRealTime();
+
+namespace {
+
+class CountingWakeable : public Wakeable {
+ public:
+  void WakeUp(fml::TimePoint time_point) override { wake_count++; }
+
+  size_t wake_count = 0;
+};
+
+}  // namespace
+
+// Simulates a frame that posts |state.range(0)| tasks to another thread, one
+// at a time or as a batch, and reports how often the target thread is woken
+// up per frame.
+static void PostFrameTasks(benchmark::State& state, bool batched) {
+  const size_t tasks_per_frame = state.range(0);
+  auto task_queues = fml::MessageLoopTaskQueues::GetInstance();
+  TaskQueueId queue_id = task_queues->CreateTaskQueue();
+  CountingWakeable wakeable;
+  task_queues->SetWakeable(queue_id, &wakeable);
+
+  size_t frame_wakeups = 0;
+  while (state.KeepRunning()) {
+    const fml::TimePoint now = fml::TimePoint::Now();
+    const size_t wakeups_before = wakeable.wake_count;
+    if (batched) {
+      std::vector<fml::UniqueClosure> tasks;
+      tasks.reserve(tasks_per_frame);
+      for (size_t i = 0; i < tasks_per_frame; i++) {
+        tasks.emplace_back([] {});
+      }
+      task_queues->RegisterTasks(queue_id, std::move(tasks), now);
+    } else {
+      for (size_t i = 0; i < tasks_per_frame; i++) {
+        task_queues->RegisterTask(
+            queue_id, [] {}, now);
+      }
+    }
+    frame_wakeups += wakeable.wake_count - wakeups_before;
+    while (task_queues->GetNextTaskToRun(queue_id, now)) {
+    }
+  }
+
+  task_queues->Dispose(queue_id);
+  state.counters["wakeups_per_frame"] =
+      static_cast<double>(frame_wakeups) / state.iterations();
+  state.SetItemsProcessed(state.iterations() * tasks_per_frame);
+}
+
+static void BM_PostFrameTasksIndividually(  // NOLINT
+    benchmark::State& state) {
+  PostFrameTasks(state, false);
+}
+
+static void BM_PostFrameTasksBatched(benchmark::State& state) {  // NOLINT
+  PostFrameTasks(state, true);
+}
+
+BENCHMARK(BM_PostFrameTasksIndividually)->RangeMultiplier(2)->Range(1, 32);
+BENCHMARK(BM_PostFrameTasksBatched)->RangeMultiplier(2)->Range(1, 32);
+
 }  // namespace benchmarking
 }  // namespace fml
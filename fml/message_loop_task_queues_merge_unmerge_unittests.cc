@@ -32,7 +32,7 @@ static int CountRemainingTasks(fml::RefPtr<MessageLoopTaskQueues> task_queue,
                                bool run_invocation = false) {
   const auto now = ChronoTicksSinceEpoch();
   int count = 0;
-  fml::closure invocation;
+  fml::UniqueClosure invocation;
   do {
     invocation = task_queue->GetNextTaskToRun(queue_id, now);
     if (!invocation) {
@@ -311,5 +311,36 @@ TEST(MessageLoopTaskQueueMergeUnmerge,
   latch.Wait();
 }
 
+TEST(MessageLoopTaskQueueMergeUnmerge, RegisterTaskRacesWithMergeAndUnmerge) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+
+  auto queue_id_1 = task_queue->CreateTaskQueue();
+  auto queue_id_2 = task_queue->CreateTaskQueue();
+
+  const int kIterations = 1000;
+
+  // Tasks registered on |queue_id_2| are guarded by the lock of
+  // |queue_id_1| while it is merged, and by its own lock otherwise.
+  std::thread merge_thread([&]() {
+    for (int i = 0; i < kIterations; i++) {
+      ASSERT_TRUE(task_queue->Merge(queue_id_1, queue_id_2));
+      ASSERT_TRUE(task_queue->Unmerge(queue_id_1, queue_id_2));
+    }
+  });
+  std::thread register_thread([&]() {
+    for (int i = 0; i < kIterations; i++) {
+      task_queue->RegisterTask(
+          queue_id_2, []() {}, ChronoTicksSinceEpoch());
+    }
+  });
+
+  merge_thread.join();
+  register_thread.join();
+
+  ASSERT_EQ(task_queue->GetNumPendingTasks(queue_id_2),
+            static_cast<size_t>(kIterations));
+  ASSERT_EQ(task_queue->GetNumPendingTasks(queue_id_1), 0u);
+}
+
 }  // namespace testing
 }  // namespace fml
@@ -7,6 +7,7 @@
 #include "flutter/fml/message_loop_task_queues.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <thread>
 
@@ -108,7 +109,7 @@ TEST(MessageLoopTaskQueue, PreserveTaskOrdering) {
   const auto now = ChronoTicksSinceEpoch();
   int expected_value = 1;
   while (true) {
-    fml::closure invocation = task_queue->GetNextTaskToRun(queue_id, now);
+    fml::UniqueClosure invocation = task_queue->GetNextTaskToRun(queue_id, now);
     if (!invocation) {
       break;
     }
@@ -118,6 +119,34 @@ TEST(MessageLoopTaskQueue, PreserveTaskOrdering) {
   }
 }
 
+TEST(MessageLoopTaskQueue, FrameCriticalTasksRunBeforeQueuedTasks) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  auto platform_queue = task_queue->CreateTaskQueue();
+  auto ui_queue = task_queue->CreateTaskQueue();
+  ASSERT_TRUE(task_queue->Merge(platform_queue, ui_queue));
+  int test_val = 0;
+
+  const auto time_stamp = ChronoTicksSinceEpoch();
+  task_queue->RegisterTask(
+      platform_queue, [&test_val]() { test_val = 1; }, time_stamp);
+  task_queue->RegisterTask(
+      ui_queue, [&test_val]() { test_val = 2; }, time_stamp,
+      fml::TaskSourceGrade::kUnspecified, fml::TaskPriority::kIdle);
+  task_queue->RegisterTask(
+      ui_queue, [&test_val]() { test_val = 3; }, time_stamp,
+      fml::TaskSourceGrade::kUnspecified, fml::TaskPriority::kFrameCritical);
+
+  const auto now = ChronoTicksSinceEpoch();
+  std::vector<int> expected_values = {3, 1, 2};
+  for (int expected_value : expected_values) {
+    fml::UniqueClosure invocation = task_queue->GetNextTaskToRun(platform_queue, now);
+    ASSERT_TRUE(invocation);
+    invocation();
+    ASSERT_EQ(test_val, expected_value);
+  }
+  ASSERT_FALSE(task_queue->HasPendingTasks(platform_queue));
+}
+
 TEST(MessageLoopTaskQueue, RegisterTasksOnMergedQueuesPreserveTaskOrdering) {
   auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
   auto platform_queue = task_queue->CreateTaskQueue();
@@ -148,7 +177,7 @@ TEST(MessageLoopTaskQueue, RegisterTasksOnMergedQueuesPreserveTaskOrdering) {
   // "test_val = 1" in platform_queue
   // "test_val = 2" in raster2_queue
   while (true) {
-    fml::closure invocation = task_queue->GetNextTaskToRun(platform_queue, now);
+    fml::UniqueClosure invocation = task_queue->GetNextTaskToRun(platform_queue, now);
     if (!invocation) {
       break;
     }
@@ -191,7 +220,7 @@ TEST(MessageLoopTaskQueue, UnmergeRespectTheOriginalTaskOrderingInQueues) {
   // "test_val = 1" in platform_queue
   // "test_val = 2" in raster_queue (running on platform)
   for (int i = 0; i < 3; i++) {
-    fml::closure invocation = task_queue->GetNextTaskToRun(platform_queue, now);
+    fml::UniqueClosure invocation = task_queue->GetNextTaskToRun(platform_queue, now);
     ASSERT_FALSE(!invocation);
     invocation();
     ASSERT_TRUE(test_val == i);
@@ -210,7 +239,7 @@ TEST(MessageLoopTaskQueue, UnmergeRespectTheOriginalTaskOrderingInQueues) {
   // platform_queue has 1 task left: "test_val = 4"
   {
     ASSERT_TRUE(task_queue->GetNumPendingTasks(platform_queue) == 1);
-    fml::closure invocation = task_queue->GetNextTaskToRun(platform_queue, now);
+    fml::UniqueClosure invocation = task_queue->GetNextTaskToRun(platform_queue, now);
     ASSERT_FALSE(!invocation);
     invocation();
     ASSERT_TRUE(test_val == 4);
@@ -220,14 +249,14 @@ TEST(MessageLoopTaskQueue, UnmergeRespectTheOriginalTaskOrderingInQueues) {
   // raster_queue has 2 tasks left: "test_val = 3" and "test_val = 5"
   {
     ASSERT_TRUE(task_queue->GetNumPendingTasks(raster_queue) == 2);
-    fml::closure invocation = task_queue->GetNextTaskToRun(raster_queue, now);
+    fml::UniqueClosure invocation = task_queue->GetNextTaskToRun(raster_queue, now);
     ASSERT_FALSE(!invocation);
     invocation();
     ASSERT_TRUE(test_val == 3);
   }
   {
     ASSERT_TRUE(task_queue->GetNumPendingTasks(raster_queue) == 1);
-    fml::closure invocation = task_queue->GetNextTaskToRun(raster_queue, now);
+    fml::UniqueClosure invocation = task_queue->GetNextTaskToRun(raster_queue, now);
     ASSERT_FALSE(!invocation);
     invocation();
     ASSERT_TRUE(test_val == 5);
@@ -411,6 +440,40 @@ TEST(MessageLoopTaskQueue, ConcurrentQueueAndTaskCreatingCounts) {
   ASSERT_EQ(pending_tasks, kThreadCount * kThreadTaskCount);
 }
 
+TEST(MessageLoopTaskQueue, QueuesKeepWorkingWhileTheTableGrows) {
+  auto task_queues = fml::MessageLoopTaskQueues::GetInstance();
+  auto first_queue = task_queues->CreateTaskQueue();
+
+  // Lookups of an existing queue race with the creation of enough queues
+  // for the table of queues to grow several times.
+  std::atomic_bool done = false;
+  std::thread reader([&]() {
+    size_t registered = 0;
+    while (!done) {
+      task_queues->RegisterTask(
+          first_queue, []() {}, ChronoTicksSinceEpoch());
+      registered++;
+      ASSERT_EQ(task_queues->GetNumPendingTasks(first_queue), registered);
+    }
+  });
+  TaskQueueId last_queue = first_queue;
+  for (size_t i = 0; i < 20000; i++) {
+    last_queue = task_queues->CreateTaskQueue();
+    if (i % 2 == 0) {
+      task_queues->Dispose(last_queue);
+    }
+  }
+  done = true;
+  reader.join();
+
+  ASSERT_FALSE(task_queues->HasPendingTasks(last_queue));
+  task_queues->RegisterTask(
+      last_queue, []() {}, ChronoTicksSinceEpoch());
+  ASSERT_TRUE(task_queues->HasPendingTasks(last_queue));
+  task_queues->Dispose(first_queue);
+  task_queues->Dispose(last_queue);
+}
+
 TEST(MessageLoopTaskQueue, RegisterTaskWakesUpOwnerQueue) {
   auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
   auto platform_queue = task_queue->CreateTaskQueue();
@@ -450,5 +513,59 @@ TEST(MessageLoopTaskQueue, RegisterTaskWakesUpOwnerQueue) {
   ASSERT_EQ(time1, wakes[2]);
 }
 
+TEST(MessageLoopTaskQueue, IdleTasksRunInOrderUnlessTimedOut) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  auto queue_id = task_queue->CreateTaskQueue();
+  const auto now = ChronoTicksSinceEpoch();
+
+  std::vector<int> run_order;
+  task_queue->RegisterIdleTask(
+      queue_id, [&run_order](fml::TimePoint) { run_order.push_back(1); },
+      now + fml::TimeDelta::FromMilliseconds(20));
+  task_queue->RegisterIdleTask(
+      queue_id, [&run_order](fml::TimePoint) { run_order.push_back(2); },
+      now + fml::TimeDelta::FromMilliseconds(10));
+  ASSERT_TRUE(task_queue->HasPendingIdleTasks(queue_id));
+
+  // Only the second task has timed out by then.
+  auto timed_out = task_queue->GetNextIdleTask(
+      queue_id, now + fml::TimeDelta::FromMilliseconds(15));
+  ASSERT_TRUE(timed_out);
+  timed_out(fml::TimePoint::Max());
+  ASSERT_FALSE(task_queue->GetNextIdleTask(
+      queue_id, now + fml::TimeDelta::FromMilliseconds(15)));
+
+  auto idle_task = task_queue->GetNextIdleTask(queue_id);
+  ASSERT_TRUE(idle_task);
+  idle_task(now);
+  ASSERT_FALSE(task_queue->HasPendingIdleTasks(queue_id));
+  ASSERT_EQ(run_order, std::vector<int>({2, 1}));
+}
+
+TEST(MessageLoopTaskQueue, RegisterTasksWakesUpOnce) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  auto queue_id = task_queue->CreateTaskQueue();
+  int wake_count = 0;
+  task_queue->SetWakeable(queue_id,
+                          new TestWakeable([&wake_count](fml::TimePoint) {
+                            wake_count++;
+                          }));
+
+  std::vector<int> run_order;
+  std::vector<fml::UniqueClosure> tasks;
+  for (int i = 0; i < 5; i++) {
+    tasks.push_back([&run_order, i]() { run_order.push_back(i); });
+  }
+  const auto now = ChronoTicksSinceEpoch();
+  task_queue->RegisterTasks(queue_id, std::move(tasks), now);
+  ASSERT_EQ(wake_count, 1);
+  ASSERT_EQ(task_queue->GetNumPendingTasks(queue_id), 5u);
+
+  while (auto invocation = task_queue->GetNextTaskToRun(queue_id, now)) {
+    invocation();
+  }
+  ASSERT_EQ(run_order, std::vector<int>({0, 1, 2, 3, 4}));
+}
+
 }  // namespace testing
 }  // namespace fml
@@ -6,8 +6,11 @@
 
 #include "flutter/fml/message_loop.h"
 
+#include <atomic>
 #include <iostream>
+#include <memory>
 #include <thread>
+#include <vector>
 
 #include "flutter/fml/build_config.h"
 #include "flutter/fml/concurrent_message_loop.h"
@@ -285,6 +288,63 @@ TEST(MessageLoop, TaskObserverFire) {
   ASSERT_TRUE(terminated);
 }
 
+TEST(MessageLoop, IdleTasksRunAfterReadyTasks) {
+  std::vector<int> run_order;
+  std::thread thread([&run_order]() {
+    fml::MessageLoop::EnsureInitializedForCurrentThread();
+    auto& loop = fml::MessageLoop::GetCurrent();
+    auto task_runner = loop.GetTaskRunner();
+    const auto deadline =
+        fml::TimePoint::Now() + fml::TimeDelta::FromSeconds(10);
+    task_runner->PostIdleTask(
+        [&run_order, deadline](fml::TimePoint idle_deadline) {
+          ASSERT_EQ(idle_deadline, deadline);
+          run_order.push_back(2);
+          fml::MessageLoop::GetCurrent().Terminate();
+        },
+        fml::TimeDelta::FromSeconds(60));
+    task_runner->RunIdleTasksUntil(deadline);
+    task_runner->PostTask([&run_order]() { run_order.push_back(1); });
+    loop.Run();
+  });
+  thread.join();
+  ASSERT_EQ(run_order, std::vector<int>({1, 2}));
+}
+
+TEST(MessageLoop, IdleTasksRunWhenTimedOut) {
+  bool terminated = false;
+  std::thread thread([&terminated]() {
+    fml::MessageLoop::EnsureInitializedForCurrentThread();
+    auto& loop = fml::MessageLoop::GetCurrent();
+    loop.GetTaskRunner()->PostIdleTask(
+        [&terminated](fml::TimePoint idle_deadline) {
+          ASSERT_EQ(idle_deadline, fml::TimePoint::Max());
+          fml::MessageLoop::GetCurrent().Terminate();
+          terminated = true;
+        },
+        fml::TimeDelta::FromMilliseconds(1));
+    loop.Run();
+  });
+  thread.join();
+  ASSERT_TRUE(terminated);
+}
+
+TEST(MessageLoop, CanPostMoveOnlyTasks) {
+  int result = 0;
+  std::thread thread([&result]() {
+    fml::MessageLoop::EnsureInitializedForCurrentThread();
+    auto& loop = fml::MessageLoop::GetCurrent();
+    auto value = std::make_unique<int>(42);
+    loop.GetTaskRunner()->PostTask([value = std::move(value), &result]() {
+      result = *value;
+      fml::MessageLoop::GetCurrent().Terminate();
+    });
+    loop.Run();
+  });
+  thread.join();
+  ASSERT_EQ(result, 42);
+}
+
 TEST(MessageLoop, ConcurrentMessageLoopHasNonZeroWorkers) {
   auto loop = fml::ConcurrentMessageLoop::Create(
       0u /* explicitly specify zero workers */);
@@ -317,3 +377,96 @@ TEST(MessageLoop, CanCreateConcurrentMessageLoop) {
   latch.Wait();
   ASSERT_GE(thread_ids.size(), 1u);
 }
+
+TEST(MessageLoop, ConcurrentMessageLoopRunsTasksPostedByWorkers) {
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  auto task_runner = loop->GetTaskRunner();
+  const size_t kCount = 1000;
+  fml::CountDownLatch latch(kCount * 2);
+  for (size_t i = 0; i < kCount; ++i) {
+    task_runner->PostTask([&]() {
+      // Tasks posted by a worker land in its own queue and may be stolen
+      // by the others.
+      task_runner->PostTask([&]() { latch.CountDown(); });
+      latch.CountDown();
+    });
+  }
+  latch.Wait();
+}
+
+TEST(MessageLoop, ConcurrentMessageLoopRunsTasksPostedDuringShutdown) {
+  const size_t kCount = 1000;
+  std::atomic_size_t ran = 0;
+  {
+    auto loop = fml::ConcurrentMessageLoop::Create(2);
+    auto task_runner = loop->GetTaskRunner();
+    std::thread poster([&]() {
+      for (size_t i = 0; i < kCount; ++i) {
+        task_runner->PostTask([&]() { ran++; });
+      }
+    });
+    loop->Terminate();
+    poster.join();
+  }
+  // Every task either made it into a queue before shutdown or was run on
+  // the posting thread.
+  ASSERT_EQ(ran, kCount);
+}
+
+TEST(MessageLoop, ConcurrentTaskRunnerRunsEveryIndexInParallel) {
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  auto task_runner = loop->GetTaskRunner();
+  const size_t kCount = 100;
+  std::vector<std::atomic_int> calls(kCount);
+  task_runner->RunInParallel(kCount, [&](size_t index) { calls[index]++; });
+  for (size_t i = 0; i < kCount; ++i) {
+    ASSERT_EQ(calls[i], 1);
+  }
+  task_runner->RunInParallel(0, [](size_t index) { FAIL(); });
+}
+
+TEST(MessageLoop, ConcurrentTaskRunnerRunsInParallelFromItsOwnWorkers) {
+  auto loop = fml::ConcurrentMessageLoop::Create(2);
+  auto task_runner = loop->GetTaskRunner();
+  const size_t kCount = 4;
+  fml::CountDownLatch latch(kCount);
+  std::atomic_size_t total = 0;
+  // Every worker blocks in a nested call, so the nested calls have to make
+  // progress on the calling threads alone.
+  for (size_t i = 0; i < kCount; ++i) {
+    task_runner->PostTask([&]() {
+      task_runner->RunInParallel(10, [&](size_t index) { total += index; });
+      latch.CountDown();
+    });
+  }
+  latch.Wait();
+  ASSERT_EQ(total, kCount * 45);
+}
+
+TEST(MessageLoop, ConcurrentMessageLoopRunsMoveOnlyTasks) {
+  auto loop = fml::ConcurrentMessageLoop::Create(2);
+  fml::AutoResetWaitableEvent latch;
+  int result = 0;
+  loop->GetTaskRunner()->PostTask(
+      [value = std::make_unique<int>(42), &result, &latch]() {
+        result = *value;
+        latch.Signal();
+      });
+  latch.Wait();
+  ASSERT_EQ(result, 42);
+}
+
+TEST(MessageLoop, PostTaskToAllWorkersRunsOnceOnEachWorker) {
+  const size_t kWorkerCount = 4;
+  auto loop = fml::ConcurrentMessageLoop::Create(kWorkerCount);
+  fml::CountDownLatch latch(kWorkerCount);
+  std::mutex thread_ids_mutex;
+  std::set<std::thread::id> thread_ids;
+  loop->PostTaskToAllWorkers([&]() {
+    std::scoped_lock lock(thread_ids_mutex);
+    thread_ids.insert(std::this_thread::get_id());
+    latch.CountDown();
+  });
+  latch.Wait();
+  ASSERT_EQ(thread_ids.size(), kWorkerCount);
+}
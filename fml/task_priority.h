@@ -0,0 +1,45 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FML_TASK_PRIORITY_H_
+#define FLUTTER_FML_TASK_PRIORITY_H_
+
+#include <cstddef>
+
+namespace fml {
+
+/**
+ * The priority of a task relative to the other tasks of its task queue.
+ * Among the tasks whose target time has passed, tasks of a higher priority
+ * run before tasks of a lower one. Tasks of the same priority run in the
+ * order of their target times, and then in the order they were posted.
+ *
+ * Task runners are therefore only first in, first out among the tasks of one
+ * priority. A task posted with a priority other than `kNormal` may run before
+ * tasks of a lower priority that were posted ahead of it, so it must not
+ * depend on them having run.
+ *
+ * Priorities are listed from the highest to the lowest.
+ */
+enum class TaskPriority {
+  /// Work the user is waiting on, such as dispatching pointer events.
+  kUserBlocking,
+  /// Work that produces the next frame, such as the vsync callback on the UI
+  /// thread and drawing the layer tree on the raster thread.
+  kFrameCritical,
+  /// The priority of tasks that don't specify one.
+  kNormal,
+  /// Work nothing is waiting on.
+  kBackground,
+  /// Work that should only run once nothing else is ready, such as notifying
+  /// the Dart VM of idle time.
+  kIdle,
+};
+
+constexpr size_t kTaskPriorityCount =
+    static_cast<size_t>(TaskPriority::kIdle) + 1;
+
+}  // namespace fml
+
+#endif  // FLUTTER_FML_TASK_PRIORITY_H_
@@ -0,0 +1,105 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/task_queue_statistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace fml {
+
+static std::atomic<bool> gTaskQueueStatisticsEnabled = false;
+
+fml::TimeDelta DurationHistogram::Snapshot::Percentile(
+    double percentile) const {
+  if (count == 0) {
+    return fml::TimeDelta::Zero();
+  }
+  const uint64_t rank = static_cast<uint64_t>(
+      std::ceil(std::clamp(percentile, 0.0, 100.0) / 100.0 * count));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBucketCount - 1; i++) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      return fml::TimeDelta::FromMicroseconds(
+          std::min<int64_t>(int64_t{1} << i, max_micros));
+    }
+  }
+  return fml::TimeDelta::FromMicroseconds(max_micros);
+}
+
+DurationHistogram::DurationHistogram()
+    : count_(0), total_micros_(0), max_micros_(0) {
+  for (auto& bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+DurationHistogram::~DurationHistogram() = default;
+
+size_t DurationHistogram::BucketForDuration(fml::TimeDelta duration) {
+  int64_t micros = duration.ToMicroseconds();
+  size_t bucket = 0;
+  while (micros > 0 && bucket < kBucketCount - 1) {
+    micros >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+void DurationHistogram::Record(fml::TimeDelta duration) {
+  const int64_t micros = std::max<int64_t>(duration.ToMicroseconds(), 0);
+  buckets_[BucketForDuration(duration)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  total_micros_.fetch_add(micros, std::memory_order_relaxed);
+  int64_t max = max_micros_.load(std::memory_order_relaxed);
+  while (micros > max && !max_micros_.compare_exchange_weak(
+                             max, micros, std::memory_order_relaxed)) {
+  }
+}
+
+DurationHistogram::Snapshot DurationHistogram::GetSnapshot() const {
+  Snapshot snapshot;
+  snapshot.count = count_.load(std::memory_order_relaxed);
+  snapshot.total_micros = total_micros_.load(std::memory_order_relaxed);
+  snapshot.max_micros = max_micros_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < kBucketCount; i++) {
+    snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+  }
+  return snapshot;
+}
+
+void DurationHistogram::Reset() {
+  for (auto& bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  total_micros_.store(0, std::memory_order_relaxed);
+  max_micros_.store(0, std::memory_order_relaxed);
+}
+
+TaskQueueStatistics::TaskQueueStatistics() = default;
+
+TaskQueueStatistics::~TaskQueueStatistics() = default;
+
+void TaskQueueStatistics::SetRecordingEnabled(bool enabled) {
+  gTaskQueueStatisticsEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool TaskQueueStatistics::IsRecordingEnabled() {
+  return gTaskQueueStatisticsEnabled.load(std::memory_order_relaxed);
+}
+
+void TaskQueueStatistics::RecordTask(fml::TimeDelta queue_latency,
+                                     fml::TimeDelta run_duration) {
+  queue_latency_.Record(queue_latency);
+  run_duration_.Record(run_duration);
+}
+
+void TaskQueueStatistics::Reset() {
+  queue_latency_.Reset();
+  run_duration_.Reset();
+}
+
+}  // namespace fml
@@ -0,0 +1,102 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FML_TASK_QUEUE_STATISTICS_H_
+#define FLUTTER_FML_TASK_QUEUE_STATISTICS_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/time/time_delta.h"
+
+namespace fml {
+
+/**
+ * A histogram of durations with power of two buckets. Durations may be
+ * recorded and read from any thread without taking locks.
+ */
+class DurationHistogram {
+ public:
+  /// Bucket 0 counts durations under a microsecond and bucket i counts
+  /// durations in [2^(i-1), 2^i) microseconds. The last bucket also counts
+  /// every longer duration, that is, those of more than about 4 seconds.
+  static constexpr size_t kBucketCount = 24;
+
+  struct Snapshot {
+    uint64_t count = 0;
+    int64_t total_micros = 0;
+    int64_t max_micros = 0;
+    std::array<uint64_t, kBucketCount> buckets = {};
+
+    /// An upper bound of the duration below which |percentile| percent of
+    /// the recorded durations fall, at the resolution of the buckets.
+    fml::TimeDelta Percentile(double percentile) const;
+  };
+
+  DurationHistogram();
+
+  ~DurationHistogram();
+
+  void Record(fml::TimeDelta duration);
+
+  /// The buckets are read one at a time, so a snapshot taken while
+  /// durations are being recorded may be off by those durations.
+  Snapshot GetSnapshot() const;
+
+  void Reset();
+
+  static size_t BucketForDuration(fml::TimeDelta duration);
+
+ private:
+  std::array<std::atomic<uint64_t>, kBucketCount> buckets_;
+  std::atomic<uint64_t> count_;
+  std::atomic<int64_t> total_micros_;
+  std::atomic<int64_t> max_micros_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DurationHistogram);
+};
+
+/**
+ * How long the tasks of a message loop waited to be run and how long they
+ * ran.
+ *
+ * Recording is opt-in and process wide, see |SetRecordingEnabled|. While it
+ * is disabled, message loops only pay for checking whether it is enabled.
+ */
+class TaskQueueStatistics {
+ public:
+  TaskQueueStatistics();
+
+  ~TaskQueueStatistics();
+
+  static void SetRecordingEnabled(bool enabled);
+
+  static bool IsRecordingEnabled();
+
+  /// Records a task that became ready to run at its target time, started
+  /// running |queue_latency| later, and ran for |run_duration|.
+  void RecordTask(fml::TimeDelta queue_latency, fml::TimeDelta run_duration);
+
+  /// How long tasks waited past their target time before they started.
+  /// For tasks that were not delayed, this is the time from posting the task
+  /// to running it.
+  const DurationHistogram& queue_latency() const { return queue_latency_; }
+
+  const DurationHistogram& run_duration() const { return run_duration_; }
+
+  void Reset();
+
+ private:
+  DurationHistogram queue_latency_;
+  DurationHistogram run_duration_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(TaskQueueStatistics);
+};
+
+}  // namespace fml
+
+#endif  // FLUTTER_FML_TASK_QUEUE_STATISTICS_H_
@@ -0,0 +1,90 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/task_queue_statistics.h"
+
+#include <thread>
+#include <vector>
+
+#include "flutter/fml/message_loop.h"
+#include "flutter/fml/task_runner.h"
+#include "gtest/gtest.h"
+
+namespace fml {
+namespace testing {
+
+TEST(DurationHistogram, DurationsAreBucketedByPowersOfTwo) {
+  EXPECT_EQ(DurationHistogram::BucketForDuration(TimeDelta::Zero()), 0u);
+  EXPECT_EQ(DurationHistogram::BucketForDuration(
+                TimeDelta::FromMicroseconds(1)),
+            1u);
+  EXPECT_EQ(DurationHistogram::BucketForDuration(
+                TimeDelta::FromMicroseconds(3)),
+            2u);
+  EXPECT_EQ(DurationHistogram::BucketForDuration(
+                TimeDelta::FromMicroseconds(4)),
+            3u);
+  EXPECT_EQ(DurationHistogram::BucketForDuration(TimeDelta::FromSeconds(60)),
+            DurationHistogram::kBucketCount - 1);
+}
+
+TEST(DurationHistogram, SnapshotSummarizesRecordedDurations) {
+  DurationHistogram histogram;
+  for (int i = 0; i < 9; i++) {
+    histogram.Record(TimeDelta::FromMicroseconds(10));
+  }
+  histogram.Record(TimeDelta::FromMilliseconds(5));
+
+  auto snapshot = histogram.GetSnapshot();
+  EXPECT_EQ(snapshot.count, 10u);
+  EXPECT_EQ(snapshot.total_micros, 5090);
+  EXPECT_EQ(snapshot.max_micros, 5000);
+  EXPECT_EQ(snapshot.buckets[4], 9u);
+  EXPECT_EQ(snapshot.Percentile(50), TimeDelta::FromMicroseconds(16));
+  EXPECT_EQ(snapshot.Percentile(100), TimeDelta::FromMicroseconds(5000));
+
+  histogram.Reset();
+  EXPECT_EQ(histogram.GetSnapshot().count, 0u);
+}
+
+TEST(DurationHistogram, CanRecordFromManyThreads) {
+  DurationHistogram histogram;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([&histogram, i]() {
+      for (int j = 0; j < 1000; j++) {
+        histogram.Record(TimeDelta::FromMicroseconds(i * 1000 + j));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto snapshot = histogram.GetSnapshot();
+  EXPECT_EQ(snapshot.count, 4000u);
+  EXPECT_EQ(snapshot.max_micros, 3999);
+}
+
+TEST(TaskQueueStatistics, MessageLoopRecordsTasksWhenEnabled) {
+  TaskQueueStatistics::SetRecordingEnabled(true);
+  fml::RefPtr<fml::TaskRunner> task_runner;
+  std::thread thread([&task_runner]() {
+    fml::MessageLoop::EnsureInitializedForCurrentThread();
+    auto& loop = fml::MessageLoop::GetCurrent();
+    task_runner = loop.GetTaskRunner();
+    task_runner->PostTask([]() {});
+    task_runner->PostTask([]() { fml::MessageLoop::GetCurrent().Terminate(); });
+    loop.Run();
+  });
+  thread.join();
+  TaskQueueStatistics::SetRecordingEnabled(false);
+
+  const TaskQueueStatistics* statistics = task_runner->GetTaskQueueStatistics();
+  ASSERT_NE(statistics, nullptr);
+  EXPECT_EQ(statistics->queue_latency().GetSnapshot().count, 2u);
+  EXPECT_EQ(statistics->run_duration().GetSnapshot().count, 2u);
+}
+
+}  // namespace testing
+}  // namespace fml
@@ -13,6 +13,7 @@
 #include "flutter/fml/message_loop.h"
 #include "flutter/fml/message_loop_impl.h"
 #include "flutter/fml/message_loop_task_queues.h"
+#include "flutter/fml/trace_event.h"
 
 namespace fml {
 
@@ -21,18 +22,75 @@ TaskRunner::TaskRunner(fml::RefPtr<MessageLoopImpl> loop)
 
 TaskRunner::~TaskRunner() = default;
 
-void TaskRunner::PostTask(const fml::closure& task) {
-  loop_->PostTask(task, fml::TimePoint::Now());
+void TaskRunner::PostTask(fml::UniqueClosure task) {
+  loop_->PostTask(std::move(task), fml::TimePoint::Now());
 }
 
-void TaskRunner::PostTaskForTime(const fml::closure& task,
+void TaskRunner::PostTaskForTime(fml::UniqueClosure task,
                                  fml::TimePoint target_time) {
-  loop_->PostTask(task, target_time);
+  loop_->PostTask(std::move(task), target_time);
 }
 
-void TaskRunner::PostDelayedTask(const fml::closure& task,
+void TaskRunner::PostTasks(std::vector<fml::UniqueClosure> tasks) {
+  loop_->PostTasks(std::move(tasks), fml::TimePoint::Now());
+}
+
+void TaskRunner::PostTasksForTime(std::vector<fml::UniqueClosure> tasks,
+                                  fml::TimePoint target_time) {
+  loop_->PostTasks(std::move(tasks), target_time);
+}
+
+void TaskRunner::PostDelayedTask(fml::UniqueClosure task,
                                  fml::TimeDelta delay) {
-  loop_->PostTask(task, fml::TimePoint::Now() + delay);
+  loop_->PostTask(std::move(task), fml::TimePoint::Now() + delay);
+}
+
+void TaskRunner::PostTaskWithPriority(fml::UniqueClosure task,
+                                      TaskPriority priority,
+                                      fml::TimePoint deadline) {
+  loop_->PostTask(std::move(task), fml::TimePoint::Now(), priority, deadline);
+}
+
+void TaskRunner::PostDelayedTaskWithPriority(fml::UniqueClosure task,
+                                             fml::TimeDelta delay,
+                                             TaskPriority priority) {
+  loop_->PostTask(std::move(task), fml::TimePoint::Now() + delay, priority);
+}
+
+void TaskRunner::PostIdleTask(const IdleTask& task, fml::TimeDelta timeout) {
+  TaskQueueId queue_id = GetTaskQueueId();
+  fml::TimePoint timeout_time = fml::TimePoint::Now() + timeout;
+  MessageLoopTaskQueues::GetInstance()->RegisterIdleTask(queue_id, task,
+                                                         timeout_time);
+  PostDelayedTaskWithPriority(
+      [queue_id, timeout_time]() {
+        auto task_queues = MessageLoopTaskQueues::GetInstance();
+        while (IdleTask idle_task =
+                   task_queues->GetNextIdleTask(queue_id, timeout_time)) {
+          idle_task(fml::TimePoint::Max());
+        }
+      },
+      timeout, TaskPriority::kBackground);
+}
+
+void TaskRunner::RunIdleTasksUntil(fml::TimePoint deadline) {
+  TaskQueueId queue_id = GetTaskQueueId();
+  if (!MessageLoopTaskQueues::GetInstance()->HasPendingIdleTasks(queue_id)) {
+    return;
+  }
+  PostTaskWithPriority(
+      [queue_id, deadline]() {
+        auto task_queues = MessageLoopTaskQueues::GetInstance();
+        while (fml::TimePoint::Now() < deadline) {
+          IdleTask idle_task = task_queues->GetNextIdleTask(queue_id);
+          if (!idle_task) {
+            break;
+          }
+          TRACE_EVENT0("flutter", "TaskRunner::RunIdleTask");
+          idle_task(deadline);
+        }
+      },
+      TaskPriority::kIdle);
 }
 
 TaskQueueId TaskRunner::GetTaskQueueId() {
@@ -40,6 +98,10 @@ TaskQueueId TaskRunner::GetTaskQueueId() {
   return loop_->GetTaskQueueId();
 }
 
+const TaskQueueStatistics* TaskRunner::GetTaskQueueStatistics() {
+  return loop_ ? &loop_->GetTaskQueueStatistics() : nullptr;
+}
+
 bool TaskRunner::RunsTasksOnCurrentThread() {
   if (!fml::MessageLoop::IsInitializedForCurrentThread()) {
     return false;
@@ -53,7 +115,7 @@ bool TaskRunner::RunsTasksOnCurrentThread() {
 }
 
 void TaskRunner::RunNowOrPostTask(fml::RefPtr<fml::TaskRunner> runner,
-                                  const fml::closure& task) {
+                                  fml::UniqueClosure task) {
   FML_DCHECK(runner);
   if (runner->RunsTasksOnCurrentThread()) {
     task();
@@ -5,12 +5,17 @@
 #ifndef FLUTTER_FML_TASK_RUNNER_H_
 #define FLUTTER_FML_TASK_RUNNER_H_
 
+#include <vector>
+
 #include "flutter/fml/closure.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/ref_counted.h"
 #include "flutter/fml/memory/ref_ptr.h"
 #include "flutter/fml/message_loop_task_queues.h"
+#include "flutter/fml/task_priority.h"
+#include "flutter/fml/task_queue_statistics.h"
 #include "flutter/fml/time/time_point.h"
+#include "flutter/fml/unique_closure.h"
 
 namespace fml {
 
@@ -21,7 +26,7 @@ class BasicTaskRunner {
  public:
   /// Schedules \p task to be executed on the TaskRunner's associated event
   /// loop.
-  virtual void PostTask(const fml::closure& task) = 0;
+  virtual void PostTask(fml::UniqueClosure task) = 0;
 };
 
 /// The object for scheduling tasks on a \p fml::MessageLoop.
@@ -36,18 +41,60 @@ class TaskRunner : public fml::RefCountedThreadSafe<TaskRunner>,
  public:
   virtual ~TaskRunner();
 
-  virtual void PostTask(const fml::closure& task) override;
+  virtual void PostTask(fml::UniqueClosure task) override;
 
-  virtual void PostTaskForTime(const fml::closure& task,
+  virtual void PostTaskForTime(fml::UniqueClosure task,
                                fml::TimePoint target_time);
 
+  /// Schedules all of \p tasks to be run, in order, as if by calling
+  /// \p PostTask for each of them. The task queue is locked and the thread of
+  /// the TaskRunner woken up only once, so this is cheaper than posting the
+  /// tasks one at a time.
+  virtual void PostTasks(std::vector<fml::UniqueClosure> tasks);
+
+  /// Schedules all of \p tasks to be run, in order, at \p target_time. See
+  /// \p PostTasks.
+  virtual void PostTasksForTime(std::vector<fml::UniqueClosure> tasks,
+                                fml::TimePoint target_time);
+
   /// Schedules a task to be run on the MessageLoop after the time \p delay has
   /// passed.
   /// \note There is latency between when the task is schedule and actually
   /// executed so that the actual execution time is: now + delay +
   /// message_loop_latency, where message_loop_latency is undefined and could be
   /// tens of milliseconds.
-  virtual void PostDelayedTask(const fml::closure& task, fml::TimeDelta delay);
+  virtual void PostDelayedTask(fml::UniqueClosure task, fml::TimeDelta delay);
+
+  /// Schedules \p task to be run with the given \p priority. Once they are
+  /// due, tasks of a higher priority run before the tasks of a lower one.
+  /// Tasks of the same priority still run in the order they were posted.
+  /// \p task must not rely on running after tasks of a lower priority that
+  /// were posted before it.
+  ///
+  /// If \p deadline passes before the task has run, the tasks of its
+  /// priority are run ahead of every other task until it has.
+  virtual void PostTaskWithPriority(
+      fml::UniqueClosure task,
+      TaskPriority priority,
+      fml::TimePoint deadline = fml::TimePoint::Max());
+
+  /// Schedules \p task to be run with the given \p priority after \p delay
+  /// has passed.
+  virtual void PostDelayedTaskWithPriority(fml::UniqueClosure task,
+                                           fml::TimeDelta delay,
+                                           TaskPriority priority);
+
+  /// Schedules \p task to run while the thread is idle, which is after
+  /// \p RunIdleTasksUntil has been called and before its deadline has passed,
+  /// once no other task is ready. If that has not happened within
+  /// \p timeout, the task is run anyway with a deadline of
+  /// \p fml::TimePoint::Max().
+  virtual void PostIdleTask(const IdleTask& task, fml::TimeDelta timeout);
+
+  /// Tells the TaskRunner that the thread is idle until \p deadline, typically
+  /// the target time of the next vsync. Pending idle tasks are run one after
+  /// another, at the lowest priority, until the deadline passes.
+  virtual void RunIdleTasksUntil(fml::TimePoint deadline);
 
   /// Returns \p true when the current executing thread's TaskRunner matches
   /// this instance.
@@ -57,10 +104,15 @@ class TaskRunner : public fml::RefCountedThreadSafe<TaskRunner>,
   /// \see fml::MessageLoopTaskQueues
   virtual TaskQueueId GetTaskQueueId();
 
+  /// Returns how long the tasks of the message loop of this TaskRunner waited
+  /// and ran, or null if its tasks are not run by an \p fml::MessageLoop.
+  /// \see fml::TaskQueueStatistics
+  virtual const TaskQueueStatistics* GetTaskQueueStatistics();
+
   /// Executes the \p task directly if the TaskRunner \p runner is the
   /// TaskRunner associated with the current executing thread.
   static void RunNowOrPostTask(fml::RefPtr<fml::TaskRunner> runner,
-                               const fml::closure& task);
+                               fml::UniqueClosure task);
 
  protected:
   explicit TaskRunner(fml::RefPtr<MessageLoopImpl> loop);
@@ -6,6 +6,8 @@
 
 #include "flutter/fml/task_source.h"
 
+#include <utility>
+
 namespace fml {
 
 TaskSource::TaskSource(TaskQueueId task_queue_id)
@@ -15,43 +17,64 @@ TaskSource::~TaskSource() {
   ShutDown();
 }
 
+bool TaskSource::TopTask::RunsBefore(const TopTask& other,
+                                     fml::TimePoint now) const {
+  bool ready = task.GetTargetTime() <= now;
+  bool other_ready = other.task.GetTargetTime() <= now;
+  if (ready != other_ready) {
+    return ready;
+  }
+  if (ready && priority != other.priority) {
+    return priority < other.priority;
+  }
+  return other.task > task;
+}
+
 void TaskSource::ShutDown() {
-  primary_task_queue_ = {};
-  secondary_task_queue_ = {};
+  primary_task_queues_ = {};
+  secondary_task_queues_ = {};
 }
 
-void TaskSource::RegisterTask(const DelayedTask& task) {
-  switch (task.GetTaskSourceGrade()) {
+TaskSource::TaskQueues& TaskSource::GetTaskQueues(TaskSourceGrade grade) {
+  switch (grade) {
     case TaskSourceGrade::kUserInteraction:
-      primary_task_queue_.push(task);
-      break;
+      return primary_task_queues_;
     case TaskSourceGrade::kUnspecified:
-      primary_task_queue_.push(task);
-      break;
+      return primary_task_queues_;
     case TaskSourceGrade::kDartMicroTasks:
-      secondary_task_queue_.push(task);
-      break;
+      return secondary_task_queues_;
   }
 }
 
-void TaskSource::PopTask(TaskSourceGrade grade) {
-  switch (grade) {
-    case TaskSourceGrade::kUserInteraction:
-      primary_task_queue_.pop();
-      break;
-    case TaskSourceGrade::kUnspecified:
-      primary_task_queue_.pop();
-      break;
-    case TaskSourceGrade::kDartMicroTasks:
-      secondary_task_queue_.pop();
-      break;
+void TaskSource::RegisterTask(DelayedTask task) {
+  auto& queue = GetTaskQueues(task.GetTaskSourceGrade())[static_cast<size_t>(
+      task.GetPriority())];
+  if (task.GetDeadline() != fml::TimePoint::Max()) {
+    queue.deadlines.insert(task.GetDeadline());
+  }
+  queue.tasks.push(std::move(task));
+}
+
+fml::UniqueClosure TaskSource::PopTask(TaskSourceGrade grade,
+                                       TaskPriority priority) {
+  auto& queue = GetTaskQueues(grade)[static_cast<size_t>(priority)];
+  DelayedTask task = queue.tasks.pop();
+  fml::TimePoint deadline = task.GetDeadline();
+  if (deadline != fml::TimePoint::Max()) {
+    queue.deadlines.erase(queue.deadlines.find(deadline));
   }
+  return task.TakeTask();
 }
 
 size_t TaskSource::GetNumPendingTasks() const {
-  size_t size = primary_task_queue_.size();
+  size_t size = 0;
+  for (const auto& queue : primary_task_queues_) {
+    size += queue.tasks.size();
+  }
   if (secondary_pause_requests_ == 0) {
-    size += secondary_task_queue_.size();
+    for (const auto& queue : secondary_task_queues_) {
+      size += queue.tasks.size();
+    }
   }
   return size;
 }
@@ -60,37 +83,42 @@ bool TaskSource::IsEmpty() const {
   return GetNumPendingTasks() == 0;
 }
 
-TaskSource::TopTask TaskSource::Top() const {
-  FML_CHECK(!IsEmpty());
-  if (secondary_pause_requests_ > 0 || secondary_task_queue_.empty()) {
-    const auto& primary_top = primary_task_queue_.top();
-    return {
-        .task_queue_id = task_queue_id_,
-        .task = primary_top,
-    };
-  } else if (primary_task_queue_.empty()) {
-    const auto& secondary_top = secondary_task_queue_.top();
-    return {
+void TaskSource::UpdateTopTask(const TaskQueues& queues,
+                               fml::TimePoint now,
+                               std::optional<TopTask>& top_task) const {
+  for (size_t i = 0; i < kTaskPriorityCount; i++) {
+    const auto& queue = queues[i];
+    if (queue.tasks.empty()) {
+      continue;
+    }
+    TaskPriority priority = static_cast<TaskPriority>(i);
+    if (!queue.deadlines.empty() && *queue.deadlines.begin() <= now) {
+      // The tasks of one priority run in order, so the task with the passed
+      // deadline only runs once the ones ahead of it have.
+      priority = TaskPriority::kUserBlocking;
+    }
+    TopTask candidate = {
         .task_queue_id = task_queue_id_,
-        .task = secondary_top,
+        .task = queue.tasks.top(),
+        .priority = priority,
     };
-  } else {
-    const auto& primary_top = primary_task_queue_.top();
-    const auto& secondary_top = secondary_task_queue_.top();
-    if (primary_top > secondary_top) {
-      return {
-          .task_queue_id = task_queue_id_,
-          .task = secondary_top,
-      };
-    } else {
-      return {
-          .task_queue_id = task_queue_id_,
-          .task = primary_top,
-      };
+    if (!top_task.has_value() || candidate.RunsBefore(*top_task, now)) {
+      top_task.emplace(candidate);
     }
   }
 }
 
+TaskSource::TopTask TaskSource::Top(fml::TimePoint now) const {
+  FML_CHECK(!IsEmpty());
+  std::optional<TopTask> top_task;
+  UpdateTopTask(primary_task_queues_, now, top_task);
+  if (secondary_pause_requests_ == 0) {
+    UpdateTopTask(secondary_task_queues_, now, top_task);
+  }
+  FML_CHECK(top_task.has_value());
+  return top_task.value();
+}
+
 void TaskSource::PauseSecondary() {
   secondary_pause_requests_++;
 }
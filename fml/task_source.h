@@ -5,6 +5,10 @@
 #ifndef FLUTTER_FML_TASK_SOURCE_H_
 #define FLUTTER_FML_TASK_SOURCE_H_
 
+#include <array>
+#include <optional>
+#include <set>
+
 #include "flutter/fml/delayed_task.h"
 #include "flutter/fml/task_queue_id.h"
 #include "flutter/fml/task_source_grade.h"
@@ -31,12 +35,29 @@ class MessageLoopTaskQueues;
  * Task dispatcher provides the event loop a way to acquire tasks to run via
  * `GetNextTaskToRun`. Task dispatcher asks the underlying `TaskSource` for the
  * next task.
+ *
+ * Priorities
+ * ----------
+ * Each task heap is split by `TaskPriority`. Of the tasks that are ready to
+ * run, the one with the highest priority is run first. Once the deadline of
+ * a task has passed, the tasks of its priority are treated as
+ * `TaskPriority::kUserBlocking` until that task has run. The tasks of one
+ * priority always run in order, so the order of tasks is only kept among
+ * the tasks of the same priority.
  */
 class TaskSource {
  public:
   struct TopTask {
     TaskQueueId task_queue_id;
     const DelayedTask& task;
+    /// The priority the task runs with, which is raised above that of the
+    /// task once a deadline of its priority has passed.
+    TaskPriority priority;
+
+    /// Returns true if this task should run before `other` at `now`. Ready
+    /// tasks run before those that are not, then by priority, then by
+    /// target time and posting order.
+    bool RunsBefore(const TopTask& other, fml::TimePoint now) const;
   };
 
   /// Construts a TaskSource with the given `task_queue_id`.
@@ -49,10 +70,12 @@ class TaskSource {
 
   /// Adds a task to the corresponding task heap as dictated by the
   /// `TaskSourceGrade` of the `DelayedTask`.
-  void RegisterTask(const DelayedTask& task);
+  void RegisterTask(DelayedTask task);
 
-  /// Pops the task heap corresponding to the `TaskSourceGrade`.
-  void PopTask(TaskSourceGrade grade);
+  /// Pops the task heap corresponding to the `TaskSourceGrade` and
+  /// `TaskPriority`, and returns the closure of the popped task.
+  fml::UniqueClosure PopTask(TaskSourceGrade grade,
+                             TaskPriority priority = TaskPriority::kNormal);
 
   /// Returns the number of pending tasks. Excludes the tasks from the secondary
   /// heap if it's paused.
@@ -61,9 +84,11 @@ class TaskSource {
   /// Returns true if `GetNumPendingTasks` is zero.
   bool IsEmpty() const;
 
-  /// Returns the top task based on scheduled time, taking into account whether
-  /// the secondary heap has been paused or not.
-  TopTask Top() const;
+  /// Returns the task to run at `now`, taking into account whether the
+  /// secondary heap has been paused or not. This is the highest priority task
+  /// that is ready to run at `now` or, if there is none, the task with the
+  /// earliest target time.
+  TopTask Top(fml::TimePoint now = fml::TimePoint::Min()) const;
 
   /// Pause providing tasks from secondary task heap.
   void PauseSecondary();
@@ -72,11 +97,24 @@ class TaskSource {
   void ResumeSecondary();
 
  private:
+  // The tasks of one priority, and the deadlines of those tasks.
+  struct PriorityTaskQueue {
+    fml::DelayedTaskQueue tasks;
+    std::multiset<fml::TimePoint> deadlines;
+  };
+  using TaskQueues = std::array<PriorityTaskQueue, kTaskPriorityCount>;
+
   const fml::TaskQueueId task_queue_id_;
-  fml::DelayedTaskQueue primary_task_queue_;
-  fml::DelayedTaskQueue secondary_task_queue_;
+  TaskQueues primary_task_queues_;
+  TaskQueues secondary_task_queues_;
   int secondary_pause_requests_ = 0;
 
+  TaskQueues& GetTaskQueues(TaskSourceGrade grade);
+
+  void UpdateTopTask(const TaskQueues& queues,
+                     fml::TimePoint now,
+                     std::optional<TopTask>& top_task) const;
+
   FML_DISALLOW_COPY_ASSIGN_AND_MOVE(TaskSource);
 };
 
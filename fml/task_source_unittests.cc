@@ -4,6 +4,7 @@
 
 #include <atomic>
 #include <thread>
+#include <vector>
 
 #include "flutter/fml/macros.h"
 #include "flutter/fml/task_source.h"
@@ -97,5 +98,86 @@ TEST(TaskSourceTests, OrderingMultiTaskHeapsSecondaryPaused) {
   ASSERT_EQ(value, 1);
 }
 
+// Runs and pops the task that |task_source| would run at |now|.
+static void RunTopTask(TaskSource& task_source, fml::TimePoint now) {
+  auto top_task = task_source.Top(now);
+  top_task.task.GetTask()();
+  task_source.PopTask(top_task.task.GetTaskSourceGrade(),
+                      top_task.task.GetPriority());
+}
+
+TEST(TaskSourceTests, ReadyTasksRunByPriority) {
+  TaskSource task_source = TaskSource(TaskQueueId(1));
+  auto time_stamp = ChronoTicksSinceEpoch();
+  int value = 0;
+  task_source.RegisterTask({1, [&] { value = 1; }, time_stamp,
+                            TaskSourceGrade::kUnspecified,
+                            TaskPriority::kIdle});
+  task_source.RegisterTask({2, [&] { value = 2; }, time_stamp,
+                            TaskSourceGrade::kUnspecified});
+  task_source.RegisterTask({3, [&] { value = 3; },
+                            time_stamp + fml::TimeDelta::FromMilliseconds(1),
+                            TaskSourceGrade::kUnspecified,
+                            TaskPriority::kFrameCritical});
+
+  // Before the frame critical task is due, the ready tasks run in order of
+  // priority.
+  RunTopTask(task_source, time_stamp);
+  ASSERT_EQ(value, 2);
+
+  auto now = time_stamp + fml::TimeDelta::FromMilliseconds(1);
+  RunTopTask(task_source, now);
+  ASSERT_EQ(value, 3);
+
+  RunTopTask(task_source, now);
+  ASSERT_EQ(value, 1);
+  ASSERT_TRUE(task_source.IsEmpty());
+}
+
+TEST(TaskSourceTests, TasksOfOnePriorityRunInOrder) {
+  TaskSource task_source = TaskSource(TaskQueueId(1));
+  auto time_stamp = ChronoTicksSinceEpoch();
+  std::vector<int> values;
+  for (int i = 0; i < 6; i++) {
+    // Frame critical tasks are interleaved with normal ones.
+    task_source.RegisterTask(
+        {static_cast<size_t>(i), [&values, i] { values.push_back(i); },
+         time_stamp + fml::TimeDelta::FromMilliseconds(i),
+         TaskSourceGrade::kUnspecified,
+         i % 2 ? TaskPriority::kFrameCritical : TaskPriority::kNormal});
+  }
+
+  // The frame critical tasks run ahead of the normal tasks posted before
+  // them, but the tasks of each priority keep their order.
+  auto now = time_stamp + fml::TimeDelta::FromMilliseconds(6);
+  while (!task_source.IsEmpty()) {
+    RunTopTask(task_source, now);
+  }
+  ASSERT_EQ(values, std::vector<int>({1, 3, 5, 0, 2, 4}));
+}
+
+TEST(TaskSourceTests, PassedDeadlineRaisesPriority) {
+  TaskSource task_source = TaskSource(TaskQueueId(1));
+  auto time_stamp = ChronoTicksSinceEpoch();
+  auto deadline = time_stamp + fml::TimeDelta::FromMilliseconds(2);
+  int value = 0;
+  task_source.RegisterTask({1, [&] { value = 1; }, time_stamp,
+                            TaskSourceGrade::kUnspecified,
+                            TaskPriority::kBackground, deadline});
+  task_source.RegisterTask({2, [&] { value = 2; }, time_stamp,
+                            TaskSourceGrade::kUnspecified,
+                            TaskPriority::kFrameCritical});
+
+  // Without a passed deadline, priority decides.
+  ASSERT_EQ(task_source.Top(time_stamp).priority,
+            TaskPriority::kFrameCritical);
+  ASSERT_EQ(task_source.Top(deadline).priority, TaskPriority::kUserBlocking);
+
+  RunTopTask(task_source, deadline);
+  ASSERT_EQ(value, 1);
+  RunTopTask(task_source, deadline);
+  ASSERT_EQ(value, 2);
+}
+
 }  // namespace testing
 }  // namespace fml
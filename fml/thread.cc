@@ -10,6 +10,7 @@
 #include <string>
 
 #include "flutter/fml/build_config.h"
+#include "flutter/fml/logging.h"
 #include "flutter/fml/message_loop.h"
 #include "flutter/fml/synchronization/waitable_event.h"
 
@@ -21,13 +22,22 @@
 #include <pthread.h>
 #endif
 
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 namespace fml {
 
-Thread::Thread(const std::string& name) : joined_(false) {
+Thread::Thread(const std::string& name) : Thread(ThreadConfig{name}) {}
+
+Thread::Thread(const ThreadConfig& config) : joined_(false) {
   fml::AutoResetWaitableEvent latch;
   fml::RefPtr<fml::TaskRunner> runner;
-  thread_ = std::make_unique<std::thread>([&latch, &runner, name]() -> void {
-    SetCurrentThreadName(name);
+  thread_ = std::make_unique<std::thread>([&latch, &runner, config]() -> void {
+    SetCurrentThreadConfig(config);
     fml::MessageLoop::EnsureInitializedForCurrentThread();
     auto& loop = MessageLoop::GetCurrent();
     runner = loop.GetTaskRunner();
@@ -94,4 +104,61 @@ void Thread::SetCurrentThreadName(const std::string& name) {
 #endif
 }
 
+bool Thread::SetCurrentThreadConfig(const ThreadConfig& config) {
+  SetCurrentThreadName(config.name);
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  bool applied = true;
+
+  uint64_t cpu_mask = config.cpu_mask;
+  const uint64_t affinity_mask = GetCpuAffinityMask(config.cpu_affinity);
+  if (cpu_mask == 0) {
+    cpu_mask = affinity_mask;
+  } else if ((cpu_mask & affinity_mask) != 0) {
+    // Only narrow an explicit mask down to the cores of the requested kind
+    // if that leaves the thread some core to run on.
+    cpu_mask &= affinity_mask;
+  }
+  if (cpu_mask != 0) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (size_t i = 0; i < 64; i++) {
+      if (cpu_mask & (uint64_t{1} << i)) {
+        CPU_SET(i, &cpu_set);
+      }
+    }
+    if (::sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0) {
+      FML_LOG(WARNING) << "Failed to set the CPU affinity of thread '"
+                       << config.name << "'.";
+      applied = false;
+    }
+  }
+
+  if (config.realtime_priority > 0) {
+    sched_param param = {};
+    param.sched_priority = config.realtime_priority;
+    if (::pthread_setschedparam(::pthread_self(), SCHED_FIFO, &param) != 0) {
+      FML_LOG(WARNING) << "Failed to schedule thread '" << config.name
+                       << "' with SCHED_FIFO priority "
+                       << config.realtime_priority << ".";
+      applied = false;
+    }
+  }
+
+  // Unlike POSIX prescribes, the nice value is per thread on Linux.
+  if (config.nice.has_value()) {
+    const auto tid = static_cast<id_t>(::syscall(SYS_gettid));
+    if (::setpriority(PRIO_PROCESS, tid, config.nice.value()) != 0) {
+      FML_LOG(WARNING) << "Failed to set the nice value of thread '"
+                       << config.name << "' to " << config.nice.value()
+                       << ".";
+      applied = false;
+    }
+  }
+  return applied;
+#else
+  return config.cpu_mask == 0 && config.cpu_affinity == CpuAffinity::kAny &&
+         !config.nice.has_value() && config.realtime_priority == 0;
+#endif  // defined(OS_LINUX) || defined(OS_ANDROID)
+}
+
 }  // namespace fml
@@ -6,9 +6,13 @@
 #define FLUTTER_FML_THREAD_H_
 
 #include <atomic>
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <string>
 #include <thread>
 
+#include "flutter/fml/cpu_affinity.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/task_runner.h"
 
@@ -16,8 +20,36 @@ namespace fml {
 
 class Thread {
  public:
+  /// The name of a thread and hints on how it should be scheduled. The hints
+  /// are only applied on Linux and Android and are ignored elsewhere.
+  struct ThreadConfig {
+    std::string name;
+
+    /// The cores the thread may run on, with bit i set for core i. Zero
+    /// leaves the thread on the cores it inherited.
+    uint64_t cpu_mask = 0;
+
+    /// The kind of cores the thread should run on. It is ignored on systems
+    /// whose cores all run at the same speed. If \p cpu_mask is also set,
+    /// the thread runs on the cores that both allow.
+    CpuAffinity cpu_affinity = CpuAffinity::kAny;
+
+    /// The nice value of the thread, from -20 for the most favorable
+    /// scheduling to 19 for the least. Values below zero usually require
+    /// CAP_SYS_NICE.
+    std::optional<int> nice;
+
+    /// If not zero, the thread is scheduled with the SCHED_FIFO real-time
+    /// policy at this priority, from 1 to 99. This usually requires
+    /// CAP_SYS_NICE or an RLIMIT_RTPRIO; if it is not granted, the thread
+    /// keeps the default policy and \p nice still applies.
+    int realtime_priority = 0;
+  };
+
   explicit Thread(const std::string& name = "");
 
+  explicit Thread(const ThreadConfig& config);
+
   ~Thread();
 
   fml::RefPtr<fml::TaskRunner> GetTaskRunner() const;
@@ -26,6 +58,10 @@ class Thread {
 
   static void SetCurrentThreadName(const std::string& name);
 
+  /// Names the calling thread and applies the scheduling hints of \p config
+  /// to it. Returns false if any of the hints could not be applied.
+  static bool SetCurrentThreadConfig(const ThreadConfig& config);
+
  private:
   std::unique_ptr<std::thread> thread_;
   fml::RefPtr<fml::TaskRunner> task_runner_;
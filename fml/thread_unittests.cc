@@ -4,8 +4,16 @@
 
 #include "flutter/fml/thread.h"
 
+#include "flutter/fml/build_config.h"
 #include "gtest/gtest.h"
 
+#if defined(OS_LINUX)
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 TEST(Thread, CanStartAndEnd) {
   fml::Thread thread;
   ASSERT_TRUE(thread.GetTaskRunner());
@@ -24,3 +32,27 @@ TEST(Thread, HasARunningMessageLoop) {
   thread.Join();
   ASSERT_TRUE(done);
 }
+
+#if defined(OS_LINUX)
+TEST(Thread, ThreadConfigIsAppliedToTheThread) {
+  fml::Thread::ThreadConfig config;
+  config.name = "config_test";
+  config.cpu_mask = 1;
+  // Raising the nice value needs no privileges.
+  config.nice = 5;
+  fml::Thread thread(config);
+
+  int nice = 0;
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  thread.GetTaskRunner()->PostTask([&nice, &cpu_set]() {
+    nice = ::getpriority(PRIO_PROCESS,
+                         static_cast<id_t>(::syscall(SYS_gettid)));
+    ::sched_getaffinity(0, sizeof(cpu_set), &cpu_set);
+  });
+  thread.Join();
+  ASSERT_EQ(nice, 5);
+  ASSERT_EQ(CPU_COUNT(&cpu_set), 1);
+  ASSERT_TRUE(CPU_ISSET(0, &cpu_set));
+}
+#endif  // defined(OS_LINUX)
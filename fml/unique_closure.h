@@ -0,0 +1,158 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FML_UNIQUE_CLOSURE_H_
+#define FLUTTER_FML_UNIQUE_CLOSURE_H_
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "flutter/fml/closure.h"
+#include "flutter/fml/logging.h"
+#include "flutter/fml/macros.h"
+
+namespace fml {
+
+//------------------------------------------------------------------------------
+/// @brief      A move-only `void()` callable, used for the tasks posted to task
+///             runners.
+///
+///             Unlike an `fml::closure`, the callable it wraps does not have
+///             to be copyable, so lambdas may capture move-only state such as
+///             `std::unique_ptr`s directly instead of through
+///             `fml::MakeCopyable`. Callables of up to `kInlineCapacity`
+///             bytes, which includes every `fml::closure`, are stored inline
+///             and do not allocate.
+///
+class UniqueClosure {
+ public:
+  static constexpr size_t kInlineCapacity = 12 * sizeof(void*);
+
+  UniqueClosure() = default;
+
+  UniqueClosure(std::nullptr_t) {}  // NOLINT(google-explicit-constructor)
+
+  template <typename Callable,
+            typename Target = std::decay_t<Callable>,
+            typename = std::enable_if_t<
+                !std::is_same_v<Target, UniqueClosure> &&
+                std::is_invocable_r_v<void, Target&>>>
+  UniqueClosure(Callable&& callable) {  // NOLINT(google-explicit-constructor)
+    if constexpr (std::is_pointer_v<Target> ||
+                  std::is_same_v<Target, fml::closure>) {
+      if (!callable) {
+        return;
+      }
+    }
+    if constexpr (IsStoredInline<Target>()) {
+      new (&storage_) Target(std::forward<Callable>(callable));
+      ops_ = &kInlineOps<Target>;
+    } else {
+      *reinterpret_cast<Target**>(&storage_) =
+          new Target(std::forward<Callable>(callable));
+      ops_ = &kHeapOps<Target>;
+    }
+  }
+
+  UniqueClosure(UniqueClosure&& other) noexcept { MoveFrom(other); }
+
+  UniqueClosure& operator=(UniqueClosure&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+
+  UniqueClosure& operator=(std::nullptr_t) {
+    Reset();
+    return *this;
+  }
+
+  ~UniqueClosure() { Reset(); }
+
+  /// Like `fml::closure`, the callable may be invoked through a const
+  /// reference even if it mutates its own state.
+  void operator()() const {
+    FML_DCHECK(ops_);
+    ops_->invoke(const_cast<Storage*>(&storage_));
+  }
+
+  explicit operator bool() const { return ops_ != nullptr; }
+
+  /// Whether the callable is stored inline rather than on the heap.
+  bool is_inline() const { return ops_ && ops_->is_inline; }
+
+ private:
+  using Storage =
+      std::aligned_storage_t<kInlineCapacity, alignof(std::max_align_t)>;
+
+  struct Ops {
+    void (*invoke)(Storage* storage);
+    // Move constructs the callable in |to| from that in |from| and destroys
+    // the one in |from|.
+    void (*relocate)(Storage* from, Storage* to);
+    void (*destroy)(Storage* storage);
+    bool is_inline;
+  };
+
+  template <typename Target>
+  static constexpr bool IsStoredInline() {
+    return sizeof(Target) <= sizeof(Storage) &&
+           alignof(Target) <= alignof(Storage) &&
+           std::is_nothrow_move_constructible_v<Target>;
+  }
+
+  template <typename Target>
+  static inline constexpr Ops kInlineOps = {
+      [](Storage* storage) {
+        (*std::launder(reinterpret_cast<Target*>(storage)))();
+      },
+      [](Storage* from, Storage* to) {
+        Target* target = std::launder(reinterpret_cast<Target*>(from));
+        new (to) Target(std::move(*target));
+        target->~Target();
+      },
+      [](Storage* storage) {
+        std::launder(reinterpret_cast<Target*>(storage))->~Target();
+      },
+      true,
+  };
+
+  template <typename Target>
+  static inline constexpr Ops kHeapOps = {
+      [](Storage* storage) { (**reinterpret_cast<Target**>(storage))(); },
+      [](Storage* from, Storage* to) {
+        *reinterpret_cast<Target**>(to) = *reinterpret_cast<Target**>(from);
+      },
+      [](Storage* storage) { delete *reinterpret_cast<Target**>(storage); },
+      false,
+  };
+
+  void MoveFrom(UniqueClosure& other) {
+    if (other.ops_) {
+      other.ops_->relocate(&other.storage_, &storage_);
+      ops_ = other.ops_;
+      other.ops_ = nullptr;
+    }
+  }
+
+  void Reset() {
+    if (ops_) {
+      ops_->destroy(&storage_);
+      ops_ = nullptr;
+    }
+  }
+
+  Storage storage_;
+  const Ops* ops_ = nullptr;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(UniqueClosure);
+};
+
+}  // namespace fml
+
+#endif  // FLUTTER_FML_UNIQUE_CLOSURE_H_
@@ -0,0 +1,85 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/unique_closure.h"
+
+#include <array>
+#include <memory>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+namespace fml {
+namespace testing {
+
+TEST(UniqueClosure, DefaultAndNullAreEmpty) {
+  UniqueClosure closure;
+  EXPECT_FALSE(closure);
+  UniqueClosure null_closure = nullptr;
+  EXPECT_FALSE(null_closure);
+  UniqueClosure empty_function = fml::closure();
+  EXPECT_FALSE(empty_function);
+}
+
+TEST(UniqueClosure, CanCaptureMoveOnlyState) {
+  auto value = std::make_unique<int>(7);
+  int result = 0;
+  UniqueClosure closure = [value = std::move(value), &result]() {
+    result = *value;
+  };
+  ASSERT_TRUE(closure);
+  EXPECT_TRUE(closure.is_inline());
+  closure();
+  EXPECT_EQ(result, 7);
+}
+
+TEST(UniqueClosure, SmallCallablesAndClosuresAreStoredInline) {
+  int count = 0;
+  UniqueClosure lambda = [&count]() { count++; };
+  EXPECT_TRUE(lambda.is_inline());
+  fml::closure function = [&count]() { count++; };
+  UniqueClosure from_function = function;
+  EXPECT_TRUE(from_function.is_inline());
+  lambda();
+  from_function();
+  EXPECT_EQ(count, 2);
+}
+
+TEST(UniqueClosure, LargeCallablesAreStoredOnTheHeap) {
+  std::array<char, UniqueClosure::kInlineCapacity + 1> data = {};
+  data[0] = 3;
+  int result = 0;
+  UniqueClosure closure = [data, &result]() { result = data[0]; };
+  EXPECT_FALSE(closure.is_inline());
+  UniqueClosure moved = std::move(closure);
+  EXPECT_FALSE(closure);  // NOLINT(bugprone-use-after-move)
+  moved();
+  EXPECT_EQ(result, 3);
+}
+
+TEST(UniqueClosure, MovingTransfersOwnership) {
+  auto shared = std::make_shared<int>(0);
+  std::weak_ptr<int> weak = shared;
+  UniqueClosure closure = [shared = std::move(shared)]() { (*shared)++; };
+  UniqueClosure moved = std::move(closure);
+  EXPECT_FALSE(closure);  // NOLINT(bugprone-use-after-move)
+  EXPECT_FALSE(weak.expired());
+  moved();
+  EXPECT_EQ(*weak.lock(), 1);
+  moved = nullptr;
+  EXPECT_TRUE(weak.expired());
+}
+
+TEST(UniqueClosure, MutableCallablesKeepTheirState) {
+  int result = 0;
+  UniqueClosure closure = [count = 0, &result]() mutable {
+    result = ++count;
+  };
+  closure();
+  closure();
+  EXPECT_EQ(result, 2);
+}
+
+}  // namespace testing
+}  // namespace fml
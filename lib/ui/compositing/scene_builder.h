@@ -9,6 +9,7 @@
 #include <memory>
 #include <vector>
 
+#include "flutter/flow/layer_arena.h"
 #include "flutter/flow/layers/container_layer.h"
 #include "flutter/lib/ui/compositing/scene.h"
 #include "flutter/lib/ui/dart_wrapper.h"
@@ -132,6 +133,13 @@ class SceneBuilder : public RefCountedDartWrappable<SceneBuilder> {
   void PushLayer(std::shared_ptr<ContainerLayer> layer);
   void PopLayer();
 
+  // Creates a layer of the scene in |arena_|.
+  template <typename T, typename... Args>
+  std::shared_ptr<T> MakeLayer(Args&&... args) {
+    return LayerArena::MakeShared<T>(arena_, std::forward<Args>(args)...);
+  }
+
+  std::shared_ptr<LayerArena> arena_ = std::make_shared<LayerArena>();
   std::vector<std::shared_ptr<ContainerLayer>> layer_stack_;
   int rasterizer_tracing_threshold_ = 0;
   bool checkerboard_raster_cache_images_ = false;
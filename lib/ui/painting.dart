@@ -5485,7 +5485,17 @@ class ImageDescriptor extends NativeFieldWrapperClass1 {
   ///
   /// If either targetWidth or targetHeight is less than or equal to zero, it
   /// will be treated as if it is null.
-  Future<Codec> instantiateCodec({int? targetWidth, int? targetHeight}) async {
+  ///
+  /// If `sourceRect` is specified, only the region of the image inside of it
+  /// is decoded, and `targetWidth` and `targetHeight` describe the size of
+  /// that region instead of the whole image. The rect is rounded out to whole
+  /// pixels. An [ArgumentError] is thrown if it is empty or does not overlap
+  /// the image. Decoders that support it, such as the JPEG decoder, skip most
+  /// of the work of decoding the rest of the image.
+  /// The `sourceRect` is ignored for animated images.
+  ///
+  /// On the Web, `sourceRect` is not supported.
+  Future<Codec> instantiateCodec({int? targetWidth, int? targetHeight, Rect? sourceRect}) async {
     if (targetWidth != null && targetWidth <= 0) {
       targetWidth = null;
     }
@@ -5493,24 +5503,44 @@ class ImageDescriptor extends NativeFieldWrapperClass1 {
       targetHeight = null;
     }
 
+    int sourceLeft = 0;
+    int sourceTop = 0;
+    int sourceRight = width;
+    int sourceBottom = height;
+    if (sourceRect != null) {
+      if (sourceRect.hasNaN || sourceRect.isEmpty) {
+        throw ArgumentError('"sourceRect" must not be empty, but was $sourceRect.');
+      }
+      // Clamp before rounding, the rect may be infinite.
+      sourceLeft = math.max(0.0, sourceRect.left).floor();
+      sourceTop = math.max(0.0, sourceRect.top).floor();
+      sourceRight = math.min(width.toDouble(), sourceRect.right).ceil();
+      sourceBottom = math.min(height.toDouble(), sourceRect.bottom).ceil();
+      if (sourceLeft >= sourceRight || sourceTop >= sourceBottom) {
+        throw ArgumentError('"sourceRect" must overlap the image, but $sourceRect does not.');
+      }
+    }
+    final int sourceWidth = sourceRight - sourceLeft;
+    final int sourceHeight = sourceBottom - sourceTop;
+
     if (targetWidth == null && targetHeight == null) {
-      targetWidth = width;
-      targetHeight = height;
+      targetWidth = sourceWidth;
+      targetHeight = sourceHeight;
     } else if (targetWidth == null && targetHeight != null) {
-      targetWidth = (targetHeight * (width / height)).round();
+      targetWidth = (targetHeight * (sourceWidth / sourceHeight)).round();
       targetHeight = targetHeight;
     } else if (targetHeight == null && targetWidth != null) {
       targetWidth = targetWidth;
-      targetHeight = targetWidth ~/ (width / height);
+      targetHeight = targetWidth ~/ (sourceWidth / sourceHeight);
     }
     assert(targetWidth != null);
     assert(targetHeight != null);
 
     final Codec codec = Codec._();
-    _instantiateCodec(codec, targetWidth!, targetHeight!);
+    _instantiateCodec(codec, targetWidth!, targetHeight!, sourceLeft, sourceTop, sourceRight, sourceBottom);
     return codec;
   }
-  void _instantiateCodec(Codec outCodec, int targetWidth, int targetHeight) native 'ImageDescriptor_instantiateCodec';
+  void _instantiateCodec(Codec outCodec, int targetWidth, int targetHeight, int sourceLeft, int sourceTop, int sourceRight, int sourceBottom) native 'ImageDescriptor_instantiateCodec';
 }
 
 /// Generic callback signature, used by [_futurize].
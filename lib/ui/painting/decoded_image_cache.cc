@@ -0,0 +1,147 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/decoded_image_cache.h"
+
+#include <iterator>
+#include <string_view>
+
+#include "flutter/fml/hash_combine.h"
+#include "flutter/fml/trace_event.h"
+#include "flutter/lib/ui/painting/image_descriptor.h"
+
+namespace flutter {
+
+DecodedImageCache::Key DecodedImageCache::Key::Make(
+    const ImageDescriptor& descriptor,
+    uint32_t target_width,
+    uint32_t target_height,
+    const std::optional<SkIRect>& subset) {
+  TRACE_EVENT0("flutter", "DecodedImageCache::Key::Make");
+  Key key;
+  if (sk_sp<SkData> data = descriptor.data()) {
+    key.content_hash = std::hash<std::string_view>{}(std::string_view(
+        static_cast<const char*>(data->data()), data->size()));
+    key.content_size = data->size();
+  }
+  key.width = descriptor.width();
+  key.height = descriptor.height();
+  key.color_type = descriptor.image_info().colorType();
+  key.row_bytes = descriptor.is_compressed() ? 0 : descriptor.row_bytes();
+  key.target_width = target_width;
+  key.target_height = target_height;
+  key.subset = subset.value_or(SkIRect::MakeEmpty());
+  return key;
+}
+
+bool DecodedImageCache::Key::operator==(const Key& other) const {
+  return content_hash == other.content_hash &&
+         content_size == other.content_size && width == other.width &&
+         height == other.height && color_type == other.color_type &&
+         row_bytes == other.row_bytes && target_width == other.target_width &&
+         target_height == other.target_height && subset == other.subset;
+}
+
+size_t DecodedImageCache::KeyHash::operator()(const Key& key) const {
+  return fml::HashCombine(key.content_hash, key.content_size, key.width,
+                          key.height, static_cast<int>(key.color_type),
+                          key.row_bytes, key.target_width, key.target_height,
+                          key.subset.left(), key.subset.top(),
+                          key.subset.right(), key.subset.bottom());
+}
+
+DecodedImageCache::DecodedImageCache(size_t max_bytes)
+    : max_bytes_(max_bytes) {}
+
+DecodedImageCache::~DecodedImageCache() = default;
+
+SkiaGPUObject<SkImage> DecodedImageCache::Get(const Key& key,
+                                              const sk_sp<SkData>& data) {
+  std::scoped_lock lock(mutex_);
+  auto found = index_.find(key);
+  const bool hit = found != index_.end() && data &&
+                   (found->second->data == data ||
+                    found->second->data->equals(data.get()));
+  if (!hit) {
+    statistics_.miss_count++;
+    TraceStatisticsLocked();
+    return {};
+  }
+  statistics_.hit_count++;
+  TraceStatisticsLocked();
+  entries_.splice(entries_.begin(), entries_, found->second);
+  const Entry& entry = entries_.front();
+  return {entry.image.skia_object(), entry.unref_queue};
+}
+
+void DecodedImageCache::Put(const Key& key,
+                            sk_sp<SkData> data,
+                            sk_sp<SkImage> image,
+                            fml::RefPtr<SkiaUnrefQueue> unref_queue) {
+  if (!data || !image) {
+    return;
+  }
+  const size_t byte_count =
+      image->imageInfo().computeMinByteSize() + data->size();
+  if (byte_count > max_bytes_) {
+    return;
+  }
+
+  std::scoped_lock lock(mutex_);
+  // The same image may have been decoded concurrently by another request.
+  auto found = index_.find(key);
+  if (found != index_.end()) {
+    EvictLocked(found->second);
+  }
+  while (statistics_.byte_count + byte_count > max_bytes_) {
+    EvictLocked(std::prev(entries_.end()));
+    statistics_.eviction_count++;
+  }
+  entries_.push_front({
+      .key = key,
+      .data = std::move(data),
+      .image = {std::move(image), unref_queue},
+      .unref_queue = unref_queue,
+      .byte_count = byte_count,
+  });
+  index_[key] = entries_.begin();
+  statistics_.entry_count++;
+  statistics_.byte_count += byte_count;
+  TraceStatisticsLocked();
+}
+
+void DecodedImageCache::Clear() {
+  std::scoped_lock lock(mutex_);
+  statistics_.eviction_count += entries_.size();
+  index_.clear();
+  entries_.clear();
+  statistics_.entry_count = 0;
+  statistics_.byte_count = 0;
+  TraceStatisticsLocked();
+}
+
+DecodedImageCache::Statistics DecodedImageCache::GetStatistics() const {
+  std::scoped_lock lock(mutex_);
+  return statistics_;
+}
+
+void DecodedImageCache::EvictLocked(EntryList::iterator entry) {
+  statistics_.entry_count--;
+  statistics_.byte_count -= entry->byte_count;
+  index_.erase(entry->key);
+  entries_.erase(entry);
+}
+
+void DecodedImageCache::TraceStatisticsLocked() const {
+#if !FLUTTER_RELEASE
+  FML_TRACE_COUNTER("flutter",                                           //
+                    "DecodedImageCache", reinterpret_cast<int64_t>(this),  //
+                    "HitCount", statistics_.hit_count,                     //
+                    "MissCount", statistics_.miss_count,                   //
+                    "EntryCount", statistics_.entry_count,                 //
+                    "KBytes", statistics_.byte_count / 1024);
+#endif  // !FLUTTER_RELEASE
+}
+
+}  // namespace flutter
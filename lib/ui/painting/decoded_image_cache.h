@@ -0,0 +1,130 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_LIB_UI_PAINTING_DECODED_IMAGE_CACHE_H_
+#define FLUTTER_LIB_UI_PAINTING_DECODED_IMAGE_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+#include "flutter/flow/skia_gpu_object.h"
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkData.h"
+#include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkImageInfo.h"
+#include "third_party/skia/include/core/SkRect.h"
+#include "third_party/skia/include/core/SkRefCnt.h"
+
+namespace flutter {
+
+class ImageDescriptor;
+
+//------------------------------------------------------------------------------
+/// @brief      A least recently used cache of the images produced by the
+///             |ImageDecoder|, so that decoding the same bytes to the same
+///             size again only costs a hash of the bytes.
+///
+///             Entries are keyed by a hash of the encoded (or raw) bytes, the
+///             size, color type and row bytes the descriptor reports, and the
+///             requested target size and region. The bytes themselves are
+///             retained and compared on lookup, so a hash collision is never
+///             mistaken for a hit.
+///
+///             The cache may be accessed from any thread. Textures of evicted
+///             entries are released through the unref queue they were
+///             uploaded with.
+///
+class DecodedImageCache {
+ public:
+  struct Key {
+    size_t content_hash = 0;
+    size_t content_size = 0;
+    int32_t width = 0;
+    int32_t height = 0;
+    SkColorType color_type = kUnknown_SkColorType;
+    size_t row_bytes = 0;
+    uint32_t target_width = 0;
+    uint32_t target_height = 0;
+    // The region of the image that is decoded, or empty for all of it.
+    SkIRect subset = SkIRect::MakeEmpty();
+
+    /// Hashes the bytes of the descriptor. This is linear in their size and
+    /// is meant to be done on a worker thread.
+    static Key Make(const ImageDescriptor& descriptor,
+                    uint32_t target_width,
+                    uint32_t target_height,
+                    const std::optional<SkIRect>& subset = std::nullopt);
+
+    bool operator==(const Key& other) const;
+  };
+
+  struct Statistics {
+    size_t hit_count = 0;
+    size_t miss_count = 0;
+    size_t eviction_count = 0;
+    size_t entry_count = 0;
+    size_t byte_count = 0;
+  };
+
+  /// Creates a cache holding at most |max_bytes| of decoded images and the
+  /// bytes they were decoded from.
+  explicit DecodedImageCache(size_t max_bytes);
+
+  ~DecodedImageCache();
+
+  /// Returns the image cached for |key| and |data|, or a null object if there
+  /// is none, and counts a hit or a miss accordingly.
+  SkiaGPUObject<SkImage> Get(const Key& key, const sk_sp<SkData>& data);
+
+  /// Caches |image|, decoded from |data|, and evicts the least recently used
+  /// entries until the cache fits its budget. Images larger than the budget
+  /// are not cached.
+  void Put(const Key& key,
+           sk_sp<SkData> data,
+           sk_sp<SkImage> image,
+           fml::RefPtr<SkiaUnrefQueue> unref_queue);
+
+  /// Evicts every entry.
+  void Clear();
+
+  size_t GetMaxBytes() const { return max_bytes_; }
+
+  Statistics GetStatistics() const;
+
+ private:
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+
+  struct Entry {
+    Key key;
+    sk_sp<SkData> data;
+    SkiaGPUObject<SkImage> image;
+    fml::RefPtr<SkiaUnrefQueue> unref_queue;
+    size_t byte_count;
+  };
+
+  using EntryList = std::list<Entry>;
+
+  const size_t max_bytes_;
+  mutable std::mutex mutex_;
+  // Ordered from the most to the least recently used.
+  EntryList entries_;
+  std::unordered_map<Key, EntryList::iterator, KeyHash> index_;
+  Statistics statistics_;
+
+  void EvictLocked(EntryList::iterator entry);
+
+  void TraceStatisticsLocked() const;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DecodedImageCache);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_LIB_UI_PAINTING_DECODED_IMAGE_CACHE_H_
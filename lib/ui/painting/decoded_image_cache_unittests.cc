@@ -0,0 +1,118 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/lib/ui/painting/decoded_image_cache.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+
+namespace flutter {
+namespace testing {
+
+// Each pixel is 4 bytes.
+static sk_sp<SkImage> MakeImage(int width, int height) {
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(width, height);
+  bitmap.eraseColor(SK_ColorRED);
+  bitmap.setImmutable();
+  return SkImage::MakeFromBitmap(bitmap);
+}
+
+static sk_sp<SkData> MakeData(const std::string& bytes) {
+  return SkData::MakeWithCopy(bytes.data(), bytes.size());
+}
+
+static DecodedImageCache::Key MakeKey(const sk_sp<SkData>& data,
+                                      uint32_t target_width,
+                                      uint32_t target_height) {
+  DecodedImageCache::Key key;
+  // Keys of different bytes are made to collide on purpose.
+  key.content_hash = 1;
+  key.content_size = data->size();
+  key.width = 10;
+  key.height = 10;
+  key.color_type = kN32_SkColorType;
+  key.target_width = target_width;
+  key.target_height = target_height;
+  return key;
+}
+
+TEST(DecodedImageCacheTest, ReturnsCachedImageForSameBytesAndSize) {
+  DecodedImageCache cache(1000);
+  auto data = MakeData("abcd");
+  auto image = MakeImage(10, 10);
+  cache.Put(MakeKey(data, 10, 10), data, image, nullptr);
+
+  // Equal bytes in another buffer hit too.
+  auto cached = cache.Get(MakeKey(data, 10, 10), MakeData("abcd"));
+  ASSERT_TRUE(cached.skia_object());
+  EXPECT_EQ(cached.skia_object().get(), image.get());
+
+  EXPECT_FALSE(cache.Get(MakeKey(data, 5, 5), data).skia_object());
+
+  const auto statistics = cache.GetStatistics();
+  EXPECT_EQ(statistics.hit_count, 1u);
+  EXPECT_EQ(statistics.miss_count, 1u);
+  EXPECT_EQ(statistics.entry_count, 1u);
+  EXPECT_EQ(statistics.byte_count, 404u);
+}
+
+TEST(DecodedImageCacheTest, HashCollisionsOfDifferentBytesMiss) {
+  DecodedImageCache cache(1000);
+  auto data = MakeData("abcd");
+  cache.Put(MakeKey(data, 10, 10), data, MakeImage(10, 10), nullptr);
+
+  auto other = MakeData("efgh");
+  EXPECT_FALSE(cache.Get(MakeKey(other, 10, 10), other).skia_object());
+  EXPECT_EQ(cache.GetStatistics().miss_count, 1u);
+}
+
+TEST(DecodedImageCacheTest, EvictsLeastRecentlyUsedOverBudget) {
+  // Room for two 10x10 images and their bytes.
+  DecodedImageCache cache(900);
+  auto data = MakeData("abcd");
+  cache.Put(MakeKey(data, 10, 10), data, MakeImage(10, 10), nullptr);
+  cache.Put(MakeKey(data, 11, 11), data, MakeImage(10, 10), nullptr);
+
+  // Makes the first image the most recently used.
+  ASSERT_TRUE(cache.Get(MakeKey(data, 10, 10), data).skia_object());
+  cache.Put(MakeKey(data, 12, 12), data, MakeImage(10, 10), nullptr);
+
+  EXPECT_TRUE(cache.Get(MakeKey(data, 10, 10), data).skia_object());
+  EXPECT_FALSE(cache.Get(MakeKey(data, 11, 11), data).skia_object());
+  EXPECT_TRUE(cache.Get(MakeKey(data, 12, 12), data).skia_object());
+
+  const auto statistics = cache.GetStatistics();
+  EXPECT_EQ(statistics.eviction_count, 1u);
+  EXPECT_EQ(statistics.entry_count, 2u);
+  EXPECT_EQ(statistics.byte_count, 808u);
+}
+
+TEST(DecodedImageCacheTest, DoesNotCacheImagesOverBudget) {
+  DecodedImageCache cache(100);
+  auto data = MakeData("abcd");
+  cache.Put(MakeKey(data, 10, 10), data, MakeImage(10, 10), nullptr);
+  EXPECT_FALSE(cache.Get(MakeKey(data, 10, 10), data).skia_object());
+  EXPECT_EQ(cache.GetStatistics().entry_count, 0u);
+}
+
+TEST(DecodedImageCacheTest, ClearEvictsEverything) {
+  DecodedImageCache cache(1000);
+  auto data = MakeData("abcd");
+  auto image = MakeImage(10, 10);
+  cache.Put(MakeKey(data, 10, 10), data, image, nullptr);
+  ASSERT_FALSE(image->unique());
+
+  cache.Clear();
+  EXPECT_TRUE(image->unique());
+  const auto statistics = cache.GetStatistics();
+  EXPECT_EQ(statistics.eviction_count, 1u);
+  EXPECT_EQ(statistics.entry_count, 0u);
+  EXPECT_EQ(statistics.byte_count, 0u);
+}
+
+}  // namespace testing
+}  // namespace flutter
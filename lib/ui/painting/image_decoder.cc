@@ -5,9 +5,15 @@
 #include "flutter/lib/ui/painting/image_decoder.h"
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <string>
 
 #include "flutter/fml/make_copyable.h"
 #include "third_party/skia/include/codec/SkCodec.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkMatrix.h"
+#include "third_party/skia/include/core/SkPaint.h"
 
 namespace flutter {
 
@@ -26,9 +32,152 @@ ImageDecoder::ImageDecoder(
 
 ImageDecoder::~ImageDecoder() = default;
 
-static sk_sp<SkImage> ResizeRasterImage(sk_sp<SkImage> image,
-                                        const SkISize& resized_dimensions,
-                                        const fml::tracing::TraceFlow& flow) {
+// Images with fewer pixels than this are decoded and resized in one piece.
+// Larger ones are split into strips of rows of at least this many pixels, at
+// most one per worker, that are processed in parallel.
+static constexpr int64_t kMinStripPixelCount = 512 * 1024;
+
+static size_t GetStripCount(
+    const SkISize& dimensions,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& concurrent_task_runner) {
+  if (!concurrent_task_runner) {
+    return 1;
+  }
+  const int64_t max_strip_count =
+      std::min<int64_t>(concurrent_task_runner->GetWorkerCount(),
+                        dimensions.height());
+  return std::clamp<int64_t>(dimensions.area() / kMinStripPixelCount, 1,
+                             std::max<int64_t>(max_strip_count, 1));
+}
+
+// Calls |process| with |strip_count| strips of rows that cover |dimensions|,
+// in parallel. Returns false if any of the calls did.
+static bool ForEachStrip(
+    const SkISize& dimensions,
+    size_t strip_count,
+    fml::ConcurrentTaskRunner& concurrent_task_runner,
+    const std::function<bool(const SkIRect& rows)>& process) {
+  const int32_t rows_per_strip =
+      (dimensions.height() + strip_count - 1) / strip_count;
+  std::atomic_bool success = true;
+  concurrent_task_runner.RunInParallel(strip_count, [&](size_t index) {
+    const int32_t top = index * rows_per_strip;
+    const SkIRect rows =
+        SkIRect::MakeLTRB(0, top, dimensions.width(),
+                          std::min(dimensions.height(), top + rows_per_strip));
+    if (!rows.isEmpty() && !process(rows)) {
+      success = false;
+    }
+  });
+  return success;
+}
+
+// Scales the |src| region of |image| to fill |pixmap|, in strips of rows on
+// the workers if the result is large enough. |src| may have fractional
+// bounds, which are kept rather than rounded to whole pixels.
+static bool ScalePixels(
+    const sk_sp<SkImage>& image,
+    const SkRect& src,
+    const SkPixmap& pixmap,
+    const SkSamplingOptions& sampling,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& concurrent_task_runner) {
+  const size_t strip_count =
+      GetStripCount(pixmap.dimensions(), concurrent_task_runner);
+  if (strip_count < 2 && src == SkRect::Make(image->bounds())) {
+    return image->scalePixels(pixmap, sampling,
+                              SkImage::kDisallow_CachingHint);
+  }
+
+  // Every strip draws the whole scaled region, clipped to its own rows.
+  const SkRect dst = SkRect::Make(pixmap.bounds());
+  auto draw_rows = [&](const SkIRect& rows) {
+    SkPixmap strip;
+    if (!pixmap.extractSubset(&strip, rows)) {
+      return false;
+    }
+    auto canvas = SkCanvas::MakeRasterDirect(
+        strip.info(), strip.writable_addr(), strip.rowBytes());
+    if (!canvas) {
+      return false;
+    }
+    canvas->translate(0, -rows.top());
+    SkPaint paint;
+    paint.setBlendMode(SkBlendMode::kSrc);
+    canvas->drawImageRect(image, src, dst, sampling, &paint,
+                          SkCanvas::kFast_SrcRectConstraint);
+    return true;
+  };
+
+  if (strip_count < 2) {
+    return draw_rows(pixmap.bounds());
+  }
+
+  std::string strip_count_string = std::to_string(strip_count);
+  TRACE_EVENT1("flutter", "ScalePixelsInStrips", "strip_count",
+               strip_count_string.c_str());
+  return ForEachStrip(pixmap.dimensions(), strip_count,
+                      *concurrent_task_runner, draw_rows);
+}
+
+// Decodes |subset| of the image decoded at |scaled_size| in strips of rows on
+// the workers. Returns null if the region is too small to be worth splitting,
+// if the generator of the image does not support it or if a strip failed to
+// decode. The caller then decodes the region in one piece instead.
+static sk_sp<SkImage> DecodeInStrips(
+    ImageDescriptor* descriptor,
+    const SkISize& scaled_size,
+    const SkIRect& subset,
+    const fml::tracing::TraceFlow& flow,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& concurrent_task_runner) {
+  if (!descriptor->supports_concurrent_subset_decoding()) {
+    return nullptr;
+  }
+  const size_t strip_count =
+      GetStripCount(subset.size(), concurrent_task_runner);
+  if (strip_count < 2) {
+    return nullptr;
+  }
+
+  TRACE_EVENT0("flutter", __FUNCTION__);
+  flow.Step(__FUNCTION__);
+
+  const auto image_info =
+      descriptor->image_info().makeDimensions(subset.size());
+  SkBitmap bitmap;
+  if (!bitmap.tryAllocPixels(image_info)) {
+    FML_LOG(ERROR) << "Failed to allocate memory for bitmap of size "
+                   << image_info.computeMinByteSize() << "B";
+    return nullptr;
+  }
+
+  const SkPixmap& pixmap = bitmap.pixmap();
+  const bool success = ForEachStrip(
+      subset.size(), strip_count, *concurrent_task_runner,
+      [&](const SkIRect& rows) {
+        SkPixmap strip;
+        return pixmap.extractSubset(&strip, rows) &&
+               descriptor->get_subset_pixels(
+                   strip, scaled_size, rows.makeOffset(subset.x(), subset.y()));
+      });
+  if (!success) {
+    FML_LOG(ERROR) << "Could not decode the image in strips.";
+    return nullptr;
+  }
+
+  // Marking this as immutable makes the MakeFromBitmap call share the pixels
+  // instead of copying.
+  bitmap.setImmutable();
+  return SkImage::MakeFromBitmap(bitmap);
+}
+
+// Resizes the |src| region of |image|, the whole image if it is null, to
+// |resized_dimensions|.
+static sk_sp<SkImage> ResizeRasterImage(
+    sk_sp<SkImage> image,
+    const SkISize& resized_dimensions,
+    const fml::tracing::TraceFlow& flow,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& concurrent_task_runner,
+    const SkRect* src = nullptr) {
   FML_DCHECK(!image->isTextureBacked());
 
   TRACE_EVENT0("flutter", __FUNCTION__);
@@ -39,7 +188,12 @@ static sk_sp<SkImage> ResizeRasterImage(sk_sp<SkImage> image,
     return nullptr;
   }
 
-  if (image->dimensions() == resized_dimensions) {
+  const SkRect image_bounds = SkRect::Make(image->bounds());
+  if (!src) {
+    src = &image_bounds;
+  }
+
+  if (*src == image_bounds && image->dimensions() == resized_dimensions) {
     return image->makeRasterImage();
   }
 
@@ -53,10 +207,9 @@ static sk_sp<SkImage> ResizeRasterImage(sk_sp<SkImage> image,
     return nullptr;
   }
 
-  if (!image->scalePixels(
-          scaled_bitmap.pixmap(),
-          SkSamplingOptions(SkFilterMode::kLinear, SkMipmapMode::kNone),
-          SkImage::kDisallow_CachingHint)) {
+  const SkSamplingOptions sampling(SkFilterMode::kLinear, SkMipmapMode::kNone);
+  if (!ScalePixels(image, *src, scaled_bitmap.pixmap(), sampling,
+                   concurrent_task_runner)) {
     FML_LOG(ERROR) << "Could not scale pixels";
     return nullptr;
   }
@@ -78,7 +231,9 @@ static sk_sp<SkImage> ImageFromDecompressedData(
     ImageDescriptor* descriptor,
     uint32_t target_width,
     uint32_t target_height,
-    const fml::tracing::TraceFlow& flow) {
+    const fml::tracing::TraceFlow& flow,
+    const std::optional<SkIRect>& subset,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& concurrent_task_runner) {
   TRACE_EVENT0("flutter", __FUNCTION__);
   flow.Step(__FUNCTION__);
   auto image = SkImage::MakeRasterData(
@@ -89,25 +244,130 @@ static sk_sp<SkImage> ImageFromDecompressedData(
     return nullptr;
   }
 
+  if (subset) {
+    image = image->makeSubset(*subset);
+    if (!image) {
+      FML_LOG(ERROR) << "Could not extract a region of the decompressed image.";
+      return nullptr;
+    }
+  }
+
   if (!target_width && !target_height) {
     // No resizing requested. Just rasterize the image.
     return image->makeRasterImage();
   }
 
   return ResizeRasterImage(std::move(image),
-                           SkISize::Make(target_width, target_height), flow);
+                           SkISize::Make(target_width, target_height), flow,
+                           concurrent_task_runner);
 }
 
-sk_sp<SkImage> ImageFromCompressedData(ImageDescriptor* descriptor,
-                                       uint32_t target_width,
-                                       uint32_t target_height,
-                                       const fml::tracing::TraceFlow& flow) {
+// Decodes only |subset| of the image, at the smallest size supported by the
+// codec that is not smaller than the target size, and then resizes it.
+static sk_sp<SkImage> ImageFromCompressedSubset(
+    ImageDescriptor* descriptor,
+    const SkIRect& subset,
+    uint32_t target_width,
+    uint32_t target_height,
+    const fml::tracing::TraceFlow& flow,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& concurrent_task_runner) {
   TRACE_EVENT0("flutter", __FUNCTION__);
   flow.Step(__FUNCTION__);
 
+  const SkISize source_dimensions = descriptor->image_info().dimensions();
+  const SkISize resized_dimensions =
+      target_width || target_height
+          ? SkISize::Make(static_cast<int32_t>(target_width),
+                          static_cast<int32_t>(target_height))
+          : subset.size();
+
+  const SkISize decode_dimensions = descriptor->get_scaled_dimensions(
+      std::max(static_cast<double>(resized_dimensions.width()) /
+                   subset.width(),
+               static_cast<double>(resized_dimensions.height()) /
+                   subset.height()));
+
+  // Map the subset to the coordinates of the image decoded at
+  // |decode_dimensions|. The decoded region is rounded out so that no source
+  // pixel is lost, and the exact region is cropped from it while resizing.
+  const SkRect scaled_subset = SkMatrix::Scale(
+      static_cast<SkScalar>(decode_dimensions.width()) /
+          source_dimensions.width(),
+      static_cast<SkScalar>(decode_dimensions.height()) /
+          source_dimensions.height())
+      .mapRect(SkRect::Make(subset));
+  SkIRect decode_subset = scaled_subset.roundOut();
+  if (!decode_subset.intersect(SkIRect::MakeSize(decode_dimensions))) {
+    FML_LOG(ERROR) << "The region to decode is outside of the image.";
+    return nullptr;
+  }
+  const SkRect src = scaled_subset.makeOffset(-decode_subset.x(),
+                                              -decode_subset.y());
+
+  if (auto decoded_image =
+          DecodeInStrips(descriptor, decode_dimensions, decode_subset, flow,
+                         concurrent_task_runner)) {
+    return ResizeRasterImage(std::move(decoded_image), resized_dimensions, flow,
+                             concurrent_task_runner, &src);
+  }
+
+  const auto subset_image_info =
+      descriptor->image_info().makeDimensions(decode_subset.size());
+
+  SkBitmap subset_bitmap;
+  if (!subset_bitmap.tryAllocPixels(subset_image_info)) {
+    FML_LOG(ERROR) << "Failed to allocate memory for bitmap of size "
+                   << subset_image_info.computeMinByteSize() << "B";
+    return nullptr;
+  }
+
+  if (!descriptor->get_subset_pixels(subset_bitmap.pixmap(), decode_dimensions,
+                                     decode_subset)) {
+    FML_LOG(ERROR) << "Could not decode the region of the image.";
+    return nullptr;
+  }
+
+  // Marking this as immutable makes the MakeFromBitmap call share the pixels
+  // instead of copying.
+  subset_bitmap.setImmutable();
+
+  auto decoded_image = SkImage::MakeFromBitmap(subset_bitmap);
+  if (!decoded_image) {
+    FML_LOG(ERROR) << "Could not create an image from the decoded region.";
+    return nullptr;
+  }
+
+  return ResizeRasterImage(std::move(decoded_image), resized_dimensions, flow,
+                           concurrent_task_runner, &src);
+}
+
+sk_sp<SkImage> ImageFromCompressedData(
+    ImageDescriptor* descriptor,
+    uint32_t target_width,
+    uint32_t target_height,
+    const fml::tracing::TraceFlow& flow,
+    const std::optional<SkIRect>& subset,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& concurrent_task_runner) {
+  TRACE_EVENT0("flutter", __FUNCTION__);
+  flow.Step(__FUNCTION__);
+
+  if (subset) {
+    return ImageFromCompressedSubset(descriptor, *subset, target_width,
+                                     target_height, flow,
+                                     concurrent_task_runner);
+  }
+
+  const SkIRect source_bounds =
+      SkIRect::MakeSize(descriptor->image_info().dimensions());
+
   if (!descriptor->should_resize(target_width, target_height)) {
     // No resizing requested. Just decode & rasterize the image.
-    sk_sp<SkImage> image = descriptor->image();
+    sk_sp<SkImage> image =
+        DecodeInStrips(descriptor, source_bounds.size(), source_bounds, flow,
+                       concurrent_task_runner);
+    if (!image) {
+      image = descriptor->image();
+    }
     return image ? image->makeRasterImage() : nullptr;
   }
 
@@ -124,6 +384,13 @@ sk_sp<SkImage> ImageFromCompressedData(ImageDescriptor* descriptor,
   // If the codec supports efficient sub-pixel decoding, decoded at a resolution
   // close to the target resolution before resizing.
   if (decode_dimensions != source_dimensions) {
+    if (auto decoded_image = DecodeInStrips(
+            descriptor, decode_dimensions, SkIRect::MakeSize(decode_dimensions),
+            flow, concurrent_task_runner)) {
+      return ResizeRasterImage(std::move(decoded_image), resized_dimensions,
+                               flow, concurrent_task_runner);
+    }
+
     auto scaled_image_info =
         descriptor->image_info().makeDimensions(decode_dimensions);
 
@@ -148,16 +415,21 @@ sk_sp<SkImage> ImageFromCompressedData(ImageDescriptor* descriptor,
         return nullptr;
       }
       return ResizeRasterImage(std::move(decoded_image), resized_dimensions,
-                               flow);
+                               flow, concurrent_task_runner);
     }
   }
 
-  auto image = descriptor->image();
+  auto image = DecodeInStrips(descriptor, source_bounds.size(), source_bounds,
+                              flow, concurrent_task_runner);
+  if (!image) {
+    image = descriptor->image();
+  }
   if (!image) {
     return nullptr;
   }
 
-  return ResizeRasterImage(std::move(image), resized_dimensions, flow);
+  return ResizeRasterImage(std::move(image), resized_dimensions, flow,
+                           concurrent_task_runner);
 }
 
 static SkiaGPUObject<SkImage> UploadRasterImage(
@@ -216,9 +488,18 @@ static SkiaGPUObject<SkImage> UploadRasterImage(
   return result;
 }
 
+void ImageDecoder::Decode(fml::RefPtr<ImageDescriptor> descriptor,
+                          uint32_t target_width,
+                          uint32_t target_height,
+                          const ImageResult& callback) {
+  Decode(std::move(descriptor), target_width, target_height, std::nullopt,
+         callback);
+}
+
 void ImageDecoder::Decode(fml::RefPtr<ImageDescriptor> descriptor_ref_ptr,
                           uint32_t target_width,
                           uint32_t target_height,
+                          const std::optional<SkIRect>& subset,
                           const ImageResult& callback) {
   TRACE_EVENT0("flutter", __FUNCTION__);
   fml::tracing::TraceFlow flow(__FUNCTION__);
@@ -267,23 +548,49 @@ void ImageDecoder::Decode(fml::RefPtr<ImageDescriptor> descriptor_ref_ptr,
       fml::MakeCopyable([raw_descriptor,                          //
                          io_manager = io_manager_,                //
                          io_runner = runners_.GetIOTaskRunner(),  //
+                         concurrent_task_runner =
+                             concurrent_task_runner_,  //
+                         cache = cache_,               //
                          result,                                  //
                          target_width = target_width,             //
                          target_height = target_height,           //
+                         subset = subset,                         //
                          flow = std::move(flow)                   //
   ]() mutable {
+        // Step 0: Look for an image decoded from the same bytes to the same
+        // size.
+        // On Worker.
+
+        DecodedImageCache::Key cache_key;
+        if (cache) {
+          cache_key = DecodedImageCache::Key::Make(*raw_descriptor,  //
+                                                   target_width,     //
+                                                   target_height,    //
+                                                   subset);
+          auto cached = cache->Get(cache_key, raw_descriptor->data());
+          if (cached.skia_object()) {
+            result(std::move(cached), std::move(flow));
+            return;
+          }
+        }
+
         // Step 1: Decompress the image.
         // On Worker.
 
-        auto decompressed = raw_descriptor->is_compressed()
-                                ? ImageFromCompressedData(raw_descriptor,  //
-                                                          target_width,    //
-                                                          target_height,   //
-                                                          flow)
-                                : ImageFromDecompressedData(raw_descriptor,  //
-                                                            target_width,    //
-                                                            target_height,   //
-                                                            flow);
+        auto decompressed =
+            raw_descriptor->is_compressed()
+                ? ImageFromCompressedData(raw_descriptor,  //
+                                          target_width,    //
+                                          target_height,   //
+                                          flow,            //
+                                          subset,          //
+                                          concurrent_task_runner)
+                : ImageFromDecompressedData(raw_descriptor,  //
+                                            target_width,    //
+                                            target_height,   //
+                                            flow,            //
+                                            subset,          //
+                                            concurrent_task_runner);
 
         if (!decompressed) {
           FML_DLOG(ERROR) << "Could not decompress image.";
@@ -295,6 +602,8 @@ void ImageDecoder::Decode(fml::RefPtr<ImageDescriptor> descriptor_ref_ptr,
         // On IO Thread.
 
         io_runner->PostTask(fml::MakeCopyable([io_manager, decompressed, result,
+                                               cache, cache_key,
+                                               data = raw_descriptor->data(),
                                                flow =
                                                    std::move(flow)]() mutable {
           if (!io_manager) {
@@ -307,6 +616,10 @@ void ImageDecoder::Decode(fml::RefPtr<ImageDescriptor> descriptor_ref_ptr,
           // might not have set one or a software backend could be in use.
           // Either way, just return the image as-is.
           if (!io_manager->GetResourceContext()) {
+            if (cache) {
+              cache->Put(cache_key, std::move(data), decompressed,
+                         io_manager->GetSkiaUnrefQueue());
+            }
             result({std::move(decompressed), io_manager->GetSkiaUnrefQueue()},
                    std::move(flow));
             return;
@@ -321,12 +634,30 @@ void ImageDecoder::Decode(fml::RefPtr<ImageDescriptor> descriptor_ref_ptr,
             return;
           }
 
+          if (cache) {
+            cache->Put(cache_key, std::move(data), uploaded.skia_object(),
+                       io_manager->GetSkiaUnrefQueue());
+          }
+
           // Finally, all done.
           result(std::move(uploaded), std::move(flow));
         }));
       }));
 }
 
+void ImageDecoder::SetCacheMaxBytes(size_t max_bytes) {
+  FML_DCHECK(runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
+  if (max_bytes == 0) {
+    cache_ = nullptr;
+  } else if (!cache_ || cache_->GetMaxBytes() != max_bytes) {
+    cache_ = std::make_shared<DecodedImageCache>(max_bytes);
+  }
+}
+
+DecodedImageCache::Statistics ImageDecoder::GetCacheStatistics() const {
+  return cache_ ? cache_->GetStatistics() : DecodedImageCache::Statistics{};
+}
+
 fml::WeakPtr<ImageDecoder> ImageDecoder::GetWeakPtr() const {
   return weak_factory_.GetWeakPtr();
 }
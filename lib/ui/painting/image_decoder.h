@@ -15,10 +15,12 @@
 #include "flutter/fml/mapping.h"
 #include "flutter/fml/trace_event.h"
 #include "flutter/lib/ui/io_manager.h"
+#include "flutter/lib/ui/painting/decoded_image_cache.h"
 #include "flutter/lib/ui/painting/image_descriptor.h"
 #include "third_party/skia/include/core/SkData.h"
 #include "third_party/skia/include/core/SkImage.h"
 #include "third_party/skia/include/core/SkImageInfo.h"
+#include "third_party/skia/include/core/SkRect.h"
 #include "third_party/skia/include/core/SkRefCnt.h"
 #include "third_party/skia/include/core/SkSize.h"
 
@@ -50,20 +52,45 @@ class ImageDecoder {
               uint32_t target_height,
               const ImageResult& result);
 
+  // Like the above, but if |subset| is set, only that region of the image is
+  // decoded and resized to the target size. Codecs that support it decode the
+  // region without decompressing the rest of the image.
+  void Decode(fml::RefPtr<ImageDescriptor> descriptor,
+              uint32_t target_width,
+              uint32_t target_height,
+              const std::optional<SkIRect>& subset,
+              const ImageResult& result);
+
+  // Caches up to |max_bytes| of decoded images, and the bytes they were
+  // decoded from, so that decoding the same bytes to the same size again
+  // skips decompression and upload. A budget of zero disables the cache,
+  // which is the default.
+  void SetCacheMaxBytes(size_t max_bytes);
+
+  // The hits and misses of the cache so far, and what it holds. Empty if the
+  // cache is disabled.
+  DecodedImageCache::Statistics GetCacheStatistics() const;
+
   fml::WeakPtr<ImageDecoder> GetWeakPtr() const;
 
  private:
   TaskRunners runners_;
   std::shared_ptr<fml::ConcurrentTaskRunner> concurrent_task_runner_;
   fml::WeakPtr<IOManager> io_manager_;
+  // Shared with the decodes in flight, which may outlive the decoder.
+  std::shared_ptr<DecodedImageCache> cache_;
   fml::WeakPtrFactory<ImageDecoder> weak_factory_;
   FML_DISALLOW_COPY_AND_ASSIGN(ImageDecoder);
 };
 
-sk_sp<SkImage> ImageFromCompressedData(ImageDescriptor* descriptor,
-                                       uint32_t target_width,
-                                       uint32_t target_height,
-                                       const fml::tracing::TraceFlow& flow);
+sk_sp<SkImage> ImageFromCompressedData(
+    ImageDescriptor* descriptor,
+    uint32_t target_width,
+    uint32_t target_height,
+    const fml::tracing::TraceFlow& flow,
+    const std::optional<SkIRect>& subset = std::nullopt,
+    const std::shared_ptr<fml::ConcurrentTaskRunner>& concurrent_task_runner =
+        nullptr);
 
 }  // namespace flutter
 
@@ -0,0 +1,78 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/fml/concurrent_message_loop.h"
+#include "flutter/lib/ui/painting/image_decoder.h"
+#include "flutter/lib/ui/painting/image_generator_registry.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+
+namespace flutter {
+
+// Encodes a |size| by |size| baseline JPEG of a gradient with some detail, so
+// that the decoder does not get through it unrealistically fast.
+static sk_sp<SkData> MakeJpeg(int size) {
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(size, size, true);
+  for (int y = 0; y < size; y++) {
+    uint32_t* row = bitmap.getAddr32(0, y);
+    for (int x = 0; x < size; x++) {
+      const U8CPU noise = (x * 7 + y * 13) % 32;
+      row[x] = SkColorSetRGB(x * 255 / size, y * 255 / size,
+                             (x + y) * 111 / size + noise);
+    }
+  }
+  bitmap.setImmutable();
+  return SkImage::MakeFromBitmap(bitmap)->encodeToData(
+      SkEncodedImageFormat::kJPEG, 90);
+}
+
+// Measures the time to pixels of a decode of a JPEG of size |state.range(0)|,
+// resized to |state.range(2)| percent of its size, with |state.range(1)|
+// workers. No workers decodes the image in one piece on the calling thread,
+// as before images were split into strips.
+static void BM_ImageDecodeInStrips(benchmark::State& state) {
+  const int size = state.range(0);
+  const size_t worker_count = state.range(1);
+  const uint32_t target_size = size * state.range(2) / 100;
+
+  ImageGeneratorRegistry registry;
+  auto data = MakeJpeg(size);
+  auto descriptor = fml::MakeRefCounted<ImageDescriptor>(
+      data, registry.CreateCompatibleGenerator(data));
+
+  std::shared_ptr<fml::ConcurrentMessageLoop> loop;
+  std::shared_ptr<fml::ConcurrentTaskRunner> runner;
+  if (worker_count > 0) {
+    loop = fml::ConcurrentMessageLoop::Create(worker_count);
+    runner = loop->GetTaskRunner();
+  }
+
+  while (state.KeepRunning()) {
+    auto image = ImageFromCompressedData(descriptor.get(), target_size,
+                                         target_size,
+                                         fml::tracing::TraceFlow(""),
+                                         std::nullopt, runner);
+    FML_CHECK(image);
+    benchmark::DoNotOptimize(image);
+  }
+  state.SetItemsProcessed(state.iterations() * size * size);
+}
+
+static void ImageDecodeInStripsArguments(benchmark::internal::Benchmark* b) {
+  for (int size : {1024, 2048, 4096}) {
+    for (int worker_count : {0, 1, 2, 4, 8}) {
+      for (int percent : {100, 75}) {
+        b->Args({size, worker_count, percent});
+      }
+    }
+  }
+}
+
+BENCHMARK(BM_ImageDecodeInStrips)
+    ->Apply(ImageDecodeInStripsArguments)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace flutter
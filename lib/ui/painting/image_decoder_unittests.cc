@@ -4,7 +4,10 @@
 
 #include "flutter/lib/ui/painting/image_decoder.h"
 
+#include <atomic>
+
 #include "flutter/common/task_runners.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/mapping.h"
 #include "flutter/fml/synchronization/waitable_event.h"
 #include "flutter/lib/ui/painting/multi_frame_codec.h"
@@ -17,6 +20,7 @@
 #include "flutter/testing/test_dart_native_resolver.h"
 #include "flutter/testing/test_gl_surface.h"
 #include "flutter/testing/testing.h"
+#include "third_party/skia/include/core/SkCanvas.h"
 
 namespace flutter {
 namespace testing {
@@ -173,6 +177,38 @@ class UnknownImageGenerator : public ImageGenerator {
   SkImageInfo info_;
 };
 
+/// A codec generator that counts its subset decodes and the decodes of the
+/// whole image, which subset decodes fall back to when they cannot use a
+/// codec of their own.
+class DecodeCountingImageGenerator : public BuiltinSkiaCodecImageGenerator {
+ public:
+  explicit DecodeCountingImageGenerator(sk_sp<SkData> data)
+      : BuiltinSkiaCodecImageGenerator(std::move(data)) {}
+
+  bool GetPixels(const SkImageInfo& info,
+                 void* pixels,
+                 size_t row_bytes,
+                 unsigned int frame_index,
+                 std::optional<unsigned int> prior_frame) override {
+    ++full_decodes;
+    return BuiltinSkiaCodecImageGenerator::GetPixels(
+        info, pixels, row_bytes, frame_index, prior_frame);
+  }
+
+  bool GetSubsetPixels(const SkImageInfo& info,
+                       void* pixels,
+                       size_t row_bytes,
+                       const SkISize& scaled_size,
+                       const SkIRect& subset) override {
+    ++subset_decodes;
+    return BuiltinSkiaCodecImageGenerator::GetSubsetPixels(
+        info, pixels, row_bytes, scaled_size, subset);
+  }
+
+  std::atomic<int> full_decodes = 0;
+  std::atomic<int> subset_decodes = 0;
+};
+
 TEST_F(ImageDecoderFixtureTest, InvalidImageResultsError) {
   auto loop = fml::ConcurrentMessageLoop::Create();
   auto thread_task_runner = CreateNewThread();
@@ -450,6 +486,77 @@ TEST_F(ImageDecoderFixtureTest, CanDecodeWithResizes) {
   PostTaskSync(runners.GetUITaskRunner(), [&]() { image_decoder.reset(); });
 }
 
+TEST_F(ImageDecoderFixtureTest, RepeatedDecodesHitTheCache) {
+  auto loop = fml::ConcurrentMessageLoop::Create();
+  TaskRunners runners(GetCurrentTestName(),         // label
+                      CreateNewThread("platform"),  // platform
+                      CreateNewThread("raster"),    // raster
+                      CreateNewThread("ui"),        // ui
+                      CreateNewThread("io")         // io
+  );
+
+  fml::AutoResetWaitableEvent latch;
+  std::unique_ptr<IOManager> io_manager;
+  std::unique_ptr<ImageDecoder> image_decoder;
+
+  PostTaskSync(runners.GetIOTaskRunner(), [&]() {
+    io_manager = std::make_unique<TestIOManager>(runners.GetIOTaskRunner());
+  });
+
+  PostTaskSync(runners.GetUITaskRunner(), [&]() {
+    image_decoder = std::make_unique<ImageDecoder>(
+        runners, loop->GetTaskRunner(), io_manager->GetWeakIOManager());
+    image_decoder->SetCacheMaxBytes(100 * 1024 * 1024);
+  });
+
+  // Each decode reads the fixture into a new buffer. The images are kept
+  // alive by the cache, so comparing their addresses is enough.
+  auto decode = [&](uint32_t target_width,
+                    uint32_t target_height) -> const SkImage* {
+    const SkImage* decoded = nullptr;
+    runners.GetUITaskRunner()->PostTask([&]() {
+      auto data = OpenFixtureAsSkData("DashInNooglerHat.jpg");
+      ASSERT_TRUE(data);
+
+      ImageGeneratorRegistry registry;
+      std::shared_ptr<ImageGenerator> generator =
+          registry.CreateCompatibleGenerator(data);
+      ASSERT_TRUE(generator);
+
+      auto descriptor = fml::MakeRefCounted<ImageDescriptor>(
+          std::move(data), std::move(generator));
+
+      ImageDecoder::ImageResult callback = [&](SkiaGPUObject<SkImage> image) {
+        decoded = image.skia_object().get();
+        latch.Signal();
+      };
+      image_decoder->Decode(descriptor, target_width, target_height, callback);
+    });
+    latch.Wait();
+    return decoded;
+  };
+
+  auto first = decode(100, 100);
+  ASSERT_TRUE(first);
+  ASSERT_EQ(decode(100, 100), first);
+  auto resized = decode(50, 50);
+  ASSERT_TRUE(resized);
+  ASSERT_NE(resized, first);
+
+  PostTaskSync(runners.GetUITaskRunner(), [&]() {
+    const auto statistics = image_decoder->GetCacheStatistics();
+    ASSERT_EQ(statistics.hit_count, 1u);
+    ASSERT_EQ(statistics.miss_count, 2u);
+    ASSERT_EQ(statistics.entry_count, 2u);
+  });
+
+  // The cached textures are released through the unref queue of the IO
+  // manager, so the decoder goes first.
+  PostTaskSync(runners.GetUITaskRunner(), [&]() { image_decoder.reset(); });
+
+  PostTaskSync(runners.GetIOTaskRunner(), [&]() { io_manager.reset(); });
+}
+
 // TODO(https://github.com/flutter/flutter/issues/81232) - disabled due to
 // flakiness
 TEST_F(ImageDecoderFixtureTest, DISABLED_CanResizeWithoutDecode) {
@@ -578,6 +685,173 @@ TEST(ImageDecoderTest, VerifySimpleDecoding) {
             SkISize::Make(6, 2));
 }
 
+TEST(ImageDecoderTest, VerifySubsetDecodingMatchesFullDecoding) {
+  auto data = OpenFixtureAsSkData("Horizontal.png");
+  auto image = SkImage::MakeFromEncoded(data);
+  ASSERT_TRUE(image != nullptr);
+
+  ImageGeneratorRegistry registry;
+  std::shared_ptr<ImageGenerator> generator =
+      registry.CreateCompatibleGenerator(data);
+  ASSERT_TRUE(generator);
+  auto descriptor = fml::MakeRefCounted<ImageDescriptor>(std::move(data),
+                                                         std::move(generator));
+
+  const SkIRect subset = SkIRect::MakeLTRB(100, 20, 200, 70);
+  auto decoded = ImageFromCompressedData(descriptor.get(), 0, 0,
+                                         fml::tracing::TraceFlow(""), subset);
+  ASSERT_TRUE(decoded != nullptr);
+  ASSERT_EQ(decoded->dimensions(), subset.size());
+
+  const auto info = SkImageInfo::MakeN32Premul(subset.size());
+  SkBitmap expected;
+  ASSERT_TRUE(expected.tryAllocPixels(info));
+  ASSERT_TRUE(image->readPixels(expected.pixmap(), subset.x(), subset.y()));
+  SkBitmap actual;
+  ASSERT_TRUE(actual.tryAllocPixels(info));
+  ASSERT_TRUE(decoded->readPixels(actual.pixmap(), 0, 0));
+  ASSERT_EQ(memcmp(expected.getPixels(), actual.getPixels(),
+                   info.computeMinByteSize()),
+            0);
+
+  // The target size applies to the subset.
+  ASSERT_EQ(ImageFromCompressedData(descriptor.get(), 10, 5,
+                                    fml::tracing::TraceFlow(""), subset)
+                ->dimensions(),
+            SkISize::Make(10, 5));
+}
+
+TEST(ImageDecoderTest, VerifySubsetDecodingOfScaledJpeg) {
+  auto data = OpenFixtureAsSkData("DashInNooglerHat.jpg");
+
+  ImageGeneratorRegistry registry;
+  std::shared_ptr<ImageGenerator> generator =
+      registry.CreateCompatibleGenerator(data);
+  ASSERT_TRUE(generator);
+  auto descriptor = fml::MakeRefCounted<ImageDescriptor>(std::move(data),
+                                                         std::move(generator));
+  ASSERT_EQ(descriptor->image_info().dimensions(), SkISize::Make(3024, 4032));
+
+  // The whole image at an eighth of its size, which the JPEG decoder
+  // produces without decoding the image at full size.
+  auto eighth = ImageFromCompressedData(descriptor.get(), 378, 504,
+                                        fml::tracing::TraceFlow(""));
+  ASSERT_TRUE(eighth != nullptr);
+  ASSERT_EQ(eighth->dimensions(), SkISize::Make(378, 504));
+
+  const auto info = SkImageInfo::MakeN32Premul(100, 100);
+  SkBitmap expected;
+  ASSERT_TRUE(expected.tryAllocPixels(info));
+  SkBitmap actual;
+  ASSERT_TRUE(actual.tryAllocPixels(info));
+
+  // A corner of the image that maps to whole pixels at an eighth of its size.
+  auto decoded =
+      ImageFromCompressedData(descriptor.get(), 100, 100,
+                              fml::tracing::TraceFlow(""),
+                              SkIRect::MakeLTRB(2224, 3232, 3024, 4032));
+  ASSERT_TRUE(decoded != nullptr);
+  ASSERT_EQ(decoded->dimensions(), SkISize::Make(100, 100));
+  ASSERT_TRUE(eighth->readPixels(expected.pixmap(), 278, 404));
+  ASSERT_TRUE(decoded->readPixels(actual.pixmap(), 0, 0));
+  ASSERT_EQ(memcmp(expected.getPixels(), actual.getPixels(),
+                   info.computeMinByteSize()),
+            0);
+
+  // A region that maps to fractional pixels is neither shifted nor
+  // stretched to whole ones.
+  decoded = ImageFromCompressedData(descriptor.get(), 100, 100,
+                                    fml::tracing::TraceFlow(""),
+                                    SkIRect::MakeLTRB(2220, 3228, 3020, 4028));
+  ASSERT_TRUE(decoded != nullptr);
+  ASSERT_EQ(decoded->dimensions(), SkISize::Make(100, 100));
+  auto canvas = SkCanvas::MakeRasterDirect(info, expected.getPixels(),
+                                           expected.rowBytes());
+  SkPaint paint;
+  paint.setBlendMode(SkBlendMode::kSrc);
+  canvas->drawImageRect(
+      eighth, SkRect::MakeLTRB(277.5, 403.5, 377.5, 503.5),
+      SkRect::MakeWH(100, 100),
+      SkSamplingOptions(SkFilterMode::kLinear, SkMipmapMode::kNone), &paint,
+      SkCanvas::kFast_SrcRectConstraint);
+  ASSERT_TRUE(decoded->readPixels(actual.pixmap(), 0, 0));
+  ASSERT_EQ(memcmp(expected.getPixels(), actual.getPixels(),
+                   info.computeMinByteSize()),
+            0);
+}
+
+TEST(ImageDecoderTest, VerifySubsetDecodingOfJpegDoesNotDecodeWholeImage) {
+  auto data = OpenFixtureAsSkData("DashInNooglerHat.jpg");
+  auto image = SkImage::MakeFromEncoded(data);
+  ASSERT_TRUE(image != nullptr);
+
+  DecodeCountingImageGenerator generator(data);
+  const SkIRect subset = SkIRect::MakeLTRB(1000, 2000, 1100, 2050);
+  const auto info = SkImageInfo::MakeN32Premul(subset.size());
+  SkBitmap actual;
+  ASSERT_TRUE(actual.tryAllocPixels(info));
+  ASSERT_TRUE(generator.GetSubsetPixels(info, actual.getPixels(),
+                                        actual.rowBytes(),
+                                        image->dimensions(), subset));
+  ASSERT_EQ(generator.full_decodes, 0);
+
+  SkBitmap expected;
+  ASSERT_TRUE(expected.tryAllocPixels(info));
+  ASSERT_TRUE(image->readPixels(expected.pixmap(), subset.x(), subset.y()));
+  ASSERT_EQ(memcmp(expected.getPixels(), actual.getPixels(),
+                   info.computeMinByteSize()),
+            0);
+}
+
+TEST(ImageDecoderTest, VerifyDecodingInStripsMatchesSequentialDecoding) {
+  auto data = OpenFixtureAsSkData("DashInNooglerHat.jpg");
+
+  auto generator = std::make_shared<DecodeCountingImageGenerator>(data);
+  auto* counts = generator.get();
+  auto descriptor = fml::MakeRefCounted<ImageDescriptor>(std::move(data),
+                                                         std::move(generator));
+  // A baseline JPEG without rotation, which can be decoded in strips.
+  ASSERT_TRUE(descriptor->supports_concurrent_subset_decoding());
+
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  auto runner = loop->GetTaskRunner();
+
+  auto sequential = ImageFromCompressedData(descriptor.get(), 0, 0,
+                                            fml::tracing::TraceFlow(""));
+  ASSERT_TRUE(sequential != nullptr);
+  const int full_decodes = counts->full_decodes;
+
+  // Each strip is decoded by a codec of its own, never by the generator.
+  auto parallel =
+      ImageFromCompressedData(descriptor.get(), 0, 0,
+                              fml::tracing::TraceFlow(""), std::nullopt,
+                              runner);
+  ASSERT_TRUE(parallel != nullptr);
+  ASSERT_GT(counts->subset_decodes, 1);
+  ASSERT_EQ(counts->full_decodes, full_decodes);
+  ASSERT_EQ(parallel->dimensions(), SkISize::Make(3024, 4032));
+
+  const auto info = SkImageInfo::MakeN32Premul(parallel->dimensions());
+  SkBitmap expected;
+  ASSERT_TRUE(expected.tryAllocPixels(info));
+  ASSERT_TRUE(sequential->readPixels(expected.pixmap(), 0, 0));
+  SkBitmap actual;
+  ASSERT_TRUE(actual.tryAllocPixels(info));
+  ASSERT_TRUE(parallel->readPixels(actual.pixmap(), 0, 0));
+  ASSERT_EQ(memcmp(expected.getPixels(), actual.getPixels(),
+                   info.computeMinByteSize()),
+            0);
+
+  // Large resizes are split into strips as well.
+  auto resized =
+      ImageFromCompressedData(descriptor.get(), 2000, 2700,
+                              fml::tracing::TraceFlow(""), std::nullopt,
+                              runner);
+  ASSERT_TRUE(resized != nullptr);
+  ASSERT_EQ(resized->dimensions(), SkISize::Make(2000, 2700));
+  ASSERT_EQ(counts->full_decodes, full_decodes);
+}
+
 TEST(ImageDecoderTest, VerifySubpixelDecodingPreservesExifOrientation) {
   auto data = OpenFixtureAsSkData("Horizontal.jpg");
 
@@ -765,5 +1039,90 @@ TEST_F(ImageDecoderFixtureTest, MultiFrameCodecDidAccessGpuDisabledSyncSwitch) {
   PostTaskSync(runners.GetIOTaskRunner(), [&]() { io_manager.reset(); });
 }
 
+TEST_F(ImageDecoderFixtureTest, MultiFrameCodecDecodesFramesAhead) {
+  auto settings = CreateSettingsForFixture();
+  auto vm_ref = DartVMRef::Create(settings);
+  auto vm_data = vm_ref.GetVMData();
+
+  auto gif_mapping = OpenFixtureAsSkData("hello_loop_2.gif");
+
+  ASSERT_TRUE(gif_mapping);
+
+  ImageGeneratorRegistry registry;
+
+  TaskRunners runners(GetCurrentTestName(),         // label
+                      CreateNewThread("platform"),  // platform
+                      CreateNewThread("raster"),    // raster
+                      CreateNewThread("ui"),        // ui
+                      CreateNewThread("io")         // io
+  );
+
+  std::unique_ptr<TestIOManager> io_manager;
+
+  // Setup the IO manager.
+  PostTaskSync(runners.GetIOTaskRunner(), [&]() {
+    io_manager = std::make_unique<TestIOManager>(runners.GetIOTaskRunner());
+  });
+
+  auto isolate = RunDartCodeInIsolate(vm_ref, settings, runners, "main", {},
+                                      GetDefaultKernelFilePath(),
+                                      io_manager->GetWeakIOManager());
+
+  // Requests a frame, then waits for it and for two frames to be decoded
+  // ahead of the next request, one per IO task.
+  auto get_next_frame = [&](const fml::RefPtr<MultiFrameCodec>& codec) {
+    PostTaskSync(runners.GetUITaskRunner(), [&]() {
+      EXPECT_TRUE(isolate->RunInIsolateScope([&]() -> bool {
+        Dart_Handle closure = Dart_GetField(
+            Dart_RootLibrary(), Dart_NewStringFromCString("frameCallback"));
+        if (Dart_IsError(closure) || !Dart_IsClosure(closure)) {
+          return false;
+        }
+        codec->getNextFrame(closure);
+        return true;
+      }));
+    });
+    for (int i = 0; i < 3; i++) {
+      PostTaskSync(runners.GetIOTaskRunner(), []() {});
+    }
+  };
+
+  fml::RefPtr<MultiFrameCodec> codec;
+  fml::RefPtr<MultiFrameCodec> codec_without_look_ahead;
+  PostTaskSync(runners.GetUITaskRunner(), [&]() {
+    codec = fml::MakeRefCounted<MultiFrameCodec>(
+        registry.CreateCompatibleGenerator(gif_mapping), 2);
+    // Not even a single frame fits this budget.
+    codec_without_look_ahead = fml::MakeRefCounted<MultiFrameCodec>(
+        registry.CreateCompatibleGenerator(gif_mapping), 2, 1);
+  });
+
+  for (int i = 0; i < 3; i++) {
+    get_next_frame(codec);
+    get_next_frame(codec_without_look_ahead);
+  }
+
+  // Only the first frame had to be decoded on demand.
+  auto statistics = codec->GetStatistics();
+  EXPECT_EQ(statistics.frame_count, 3u);
+  EXPECT_EQ(statistics.decoded_ahead_count, 2u);
+
+  statistics = codec_without_look_ahead->GetStatistics();
+  EXPECT_EQ(statistics.frame_count, 3u);
+  EXPECT_EQ(statistics.decoded_ahead_count, 0u);
+
+  // Destroy the Isolate
+  isolate = nullptr;
+
+  // Destroy the MultiFrameCodecs
+  PostTaskSync(runners.GetUITaskRunner(), [&]() {
+    codec = nullptr;
+    codec_without_look_ahead = nullptr;
+  });
+
+  // Destroy the IO manager
+  PostTaskSync(runners.GetIOTaskRunner(), [&]() { io_manager.reset(); });
+}
+
 }  // namespace testing
 }  // namespace flutter
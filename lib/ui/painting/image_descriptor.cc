@@ -127,12 +127,24 @@ void ImageDescriptor::initRaw(Dart_Handle descriptor_handle,
 
 void ImageDescriptor::instantiateCodec(Dart_Handle codec_handle,
                                        int target_width,
-                                       int target_height) {
+                                       int target_height,
+                                       int source_left,
+                                       int source_top,
+                                       int source_right,
+                                       int source_bottom) {
+  std::optional<SkIRect> subset;
+  SkIRect source =
+      SkIRect::MakeLTRB(source_left, source_top, source_right, source_bottom);
+  if (source.intersect(SkIRect::MakeSize(image_info_.dimensions())) &&
+      source != SkIRect::MakeSize(image_info_.dimensions())) {
+    subset = source;
+  }
+
   fml::RefPtr<Codec> ui_codec;
   if (!generator_ || generator_->GetFrameCount() == 1) {
     ui_codec = fml::MakeRefCounted<SingleFrameCodec>(
         static_cast<fml::RefPtr<ImageDescriptor>>(this), target_width,
-        target_height);
+        target_height, subset);
   } else {
     ui_codec = fml::MakeRefCounted<MultiFrameCodec>(generator_);
   }
@@ -149,4 +161,12 @@ bool ImageDescriptor::get_pixels(const SkPixmap& pixmap) const {
                                pixmap.rowBytes());
 }
 
+bool ImageDescriptor::get_subset_pixels(const SkPixmap& pixmap,
+                                        const SkISize& scaled_size,
+                                        const SkIRect& subset) const {
+  FML_DCHECK(generator_);
+  return generator_->GetSubsetPixels(pixmap.info(), pixmap.writable_addr(),
+                                     pixmap.rowBytes(), scaled_size, subset);
+}
+
 }  // namespace flutter
@@ -56,7 +56,16 @@ class ImageDescriptor : public RefCountedDartWrappable<ImageDescriptor> {
                       PixelFormat pixel_format);
 
   /// @brief  Associates a flutter::Codec object with the dart.ui Codec handle.
-  void instantiateCodec(Dart_Handle codec, int target_width, int target_height);
+  ///         If the source rect does not cover the whole image, only that
+  ///         region is decoded, and the target size is that of the region.
+  ///         Multi-frame images are always decoded whole.
+  void instantiateCodec(Dart_Handle codec,
+                        int target_width,
+                        int target_height,
+                        int source_left,
+                        int source_top,
+                        int source_right,
+                        int source_bottom);
 
   /// @brief  The width of this image, EXIF oriented if applicable.
   int width() const { return image_info_.width(); }
@@ -106,6 +115,21 @@ class ImageDescriptor : public RefCountedDartWrappable<ImageDescriptor> {
   ///         orientation tag, if applicable.
   bool get_pixels(const SkPixmap& pixmap) const;
 
+  /// @brief  Gets the pixels of a region of this image, decoded at
+  ///         `scaled_size`, transformed based on the EXIF orientation tag, if
+  ///         applicable.
+  /// @see    `ImageGenerator::GetSubsetPixels`
+  bool get_subset_pixels(const SkPixmap& pixmap,
+                         const SkISize& scaled_size,
+                         const SkIRect& subset) const;
+
+  /// @brief  Whether `get_subset_pixels` may be called from several threads
+  ///         at once to decode strips of this image in parallel.
+  /// @see    `ImageGenerator::SupportsConcurrentSubsetDecoding`
+  bool supports_concurrent_subset_decoding() const {
+    return generator_ && generator_->SupportsConcurrentSubsetDecoding();
+  }
+
   void dispose() {
     buffer_.reset();
     generator_.reset();
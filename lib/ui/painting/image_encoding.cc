@@ -121,43 +121,6 @@ void ConvertImageToRaster(
   });
 }
 
-sk_sp<SkData> CopyImageByteData(sk_sp<SkImage> raster_image,
-                                SkColorType color_type,
-                                SkAlphaType alpha_type) {
-  FML_DCHECK(raster_image);
-
-  SkPixmap pixmap;
-
-  if (!raster_image->peekPixels(&pixmap)) {
-    FML_LOG(ERROR) << "Could not copy pixels from the raster image.";
-    return nullptr;
-  }
-
-  // The color types already match. No need to swizzle. Return early.
-  if (pixmap.colorType() == color_type && pixmap.alphaType() == alpha_type) {
-    return SkData::MakeWithCopy(pixmap.addr(), pixmap.computeByteSize());
-  }
-
-  // Perform swizzle if the type doesnt match the specification.
-  auto surface = SkSurface::MakeRaster(
-      SkImageInfo::Make(raster_image->width(), raster_image->height(),
-                        color_type, alpha_type, nullptr));
-
-  if (!surface) {
-    FML_LOG(ERROR) << "Could not set up the surface for swizzle.";
-    return nullptr;
-  }
-
-  surface->writePixels(pixmap, 0, 0);
-
-  if (!surface->peekPixels(&pixmap)) {
-    FML_LOG(ERROR) << "Pixel address is not available.";
-    return nullptr;
-  }
-
-  return SkData::MakeWithCopy(pixmap.addr(), pixmap.computeByteSize());
-}
-
 sk_sp<SkData> EncodeImage(sk_sp<SkImage> raster_image, ImageByteFormat format) {
   TRACE_EVENT0("flutter", __FUNCTION__);
 
@@ -225,6 +188,37 @@ void EncodeImageAndInvokeDataCallback(
 
 }  // namespace
 
+sk_sp<SkData> CopyImageByteData(sk_sp<SkImage> raster_image,
+                                SkColorType color_type,
+                                SkAlphaType alpha_type) {
+  FML_DCHECK(raster_image);
+
+  SkPixmap pixmap;
+
+  if (!raster_image->peekPixels(&pixmap)) {
+    FML_LOG(ERROR) << "Could not copy pixels from the raster image.";
+    return nullptr;
+  }
+
+  // The color types already match. No need to swizzle. Return early.
+  if (pixmap.colorType() == color_type && pixmap.alphaType() == alpha_type) {
+    return SkData::MakeWithCopy(pixmap.addr(), pixmap.computeByteSize());
+  }
+
+  // Perform swizzle if the type doesnt match the specification. The pixels
+  // are converted straight into the returned buffer, in a single pass that
+  // Skia vectorizes for the common 8888 swizzles and (un)premultiplication.
+  const SkImageInfo info =
+      SkImageInfo::Make(pixmap.dimensions(), color_type, alpha_type, nullptr);
+  sk_sp<SkData> data = SkData::MakeUninitialized(info.computeMinByteSize());
+  if (!pixmap.readPixels(info, data->writable_data(), info.minRowBytes())) {
+    FML_LOG(ERROR) << "Could not convert the pixels of the raster image.";
+    return nullptr;
+  }
+
+  return data;
+}
+
 Dart_Handle EncodeImage(CanvasImage* canvas_image,
                         int format,
                         Dart_Handle callback_handle) {
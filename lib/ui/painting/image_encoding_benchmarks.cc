@@ -0,0 +1,99 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/lib/ui/painting/image_encoding_impl.h"
+#include "third_party/skia/include/core/SkBitmap.h"
+
+namespace flutter {
+
+// The source formats of the benchmarks.
+enum class SourceFormat {
+  kN32Premul,
+  kRGB565,
+  kF16Premul,
+};
+
+static sk_sp<SkImage> MakeSourceImage(SourceFormat format, int size) {
+  SkImageInfo info;
+  switch (format) {
+    case SourceFormat::kN32Premul:
+      info = SkImageInfo::MakeN32Premul(size, size);
+      break;
+    case SourceFormat::kRGB565:
+      info = SkImageInfo::Make(size, size, kRGB_565_SkColorType,
+                               kOpaque_SkAlphaType);
+      break;
+    case SourceFormat::kF16Premul:
+      info = SkImageInfo::Make(size, size, kRGBA_F16_SkColorType,
+                               kPremul_SkAlphaType);
+      break;
+  }
+  SkBitmap bitmap;
+  bitmap.allocPixels(info);
+  bitmap.eraseColor(SkColorSetARGB(200, 40, 120, 220));
+  bitmap.setImmutable();
+  return SkImage::MakeFromBitmap(bitmap);
+}
+
+// How CopyImageByteData converted pixels before it read them straight into
+// the returned buffer: through a raster surface, and then a copy of that.
+static sk_sp<SkData> CopyImageByteDataThroughSurface(
+    const sk_sp<SkImage>& raster_image,
+    SkColorType color_type,
+    SkAlphaType alpha_type) {
+  SkPixmap pixmap;
+  FML_CHECK(raster_image->peekPixels(&pixmap));
+  auto surface = SkSurface::MakeRaster(
+      SkImageInfo::Make(raster_image->width(), raster_image->height(),
+                        color_type, alpha_type, nullptr));
+  FML_CHECK(surface);
+  surface->writePixels(pixmap, 0, 0);
+  FML_CHECK(surface->peekPixels(&pixmap));
+  return SkData::MakeWithCopy(pixmap.addr(), pixmap.computeByteSize());
+}
+
+// Converts an image of size |state.range(1)| and format |state.range(0)| to
+// RGBA, premultiplied if |state.range(2)| is 1 and straight otherwise, like
+// Image.toByteData does.
+template <bool kThroughSurface>
+static void BM_CopyImageByteData(benchmark::State& state) {
+  const auto format = static_cast<SourceFormat>(state.range(0));
+  const int size = state.range(1);
+  const SkAlphaType alpha_type =
+      state.range(2) ? kPremul_SkAlphaType : kUnpremul_SkAlphaType;
+  auto image = MakeSourceImage(format, size);
+
+  while (state.KeepRunning()) {
+    sk_sp<SkData> data =
+        kThroughSurface
+            ? CopyImageByteDataThroughSurface(image, kRGBA_8888_SkColorType,
+                                              alpha_type)
+            : CopyImageByteData(image, kRGBA_8888_SkColorType, alpha_type);
+    FML_CHECK(data);
+    benchmark::DoNotOptimize(data);
+  }
+  state.SetItemsProcessed(state.iterations() * size * size);
+}
+
+static void CopyImageByteDataArguments(benchmark::internal::Benchmark* b) {
+  for (auto format : {SourceFormat::kN32Premul, SourceFormat::kRGB565,
+                      SourceFormat::kF16Premul}) {
+    for (int size : {256, 1024, 2048}) {
+      for (int premultiplied : {1, 0}) {
+        b->Args({static_cast<int>(format), size, premultiplied});
+      }
+    }
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_CopyImageByteData, false)
+    ->Apply(CopyImageByteDataArguments)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_TEMPLATE(BM_CopyImageByteData, true)
+    ->Apply(CopyImageByteDataArguments)
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace flutter
@@ -7,11 +7,18 @@
 
 #include "flutter/lib/ui/ui_dart_state.h"
 #include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkData.h"
 #include "third_party/skia/include/core/SkImage.h"
 #include "third_party/skia/include/core/SkSurface.h"
 
 namespace flutter {
 
+// Copies the pixels of |raster_image|, converted to |color_type| and
+// |alpha_type| if they differ, for the raw formats of Image.toByteData.
+sk_sp<SkData> CopyImageByteData(sk_sp<SkImage> raster_image,
+                                SkColorType color_type,
+                                SkAlphaType alpha_type);
+
 template <typename SyncSwitch>
 sk_sp<SkImage> ConvertToRasterUsingResourceContext(
     sk_sp<SkImage> image,
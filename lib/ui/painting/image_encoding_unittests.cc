@@ -5,6 +5,8 @@
 #include "flutter/lib/ui/painting/image_encoding.h"
 #include "flutter/lib/ui/painting/image_encoding_impl.h"
 
+#include <array>
+
 #include "flutter/common/task_runners.h"
 #include "flutter/fml/synchronization/waitable_event.h"
 #include "flutter/lib/ui/painting/image.h"
@@ -13,6 +15,7 @@
 #include "flutter/shell/common/thread_host.h"
 #include "flutter/testing/testing.h"
 #include "gmock/gmock.h"
+#include "third_party/skia/include/core/SkBitmap.h"
 
 namespace flutter {
 namespace testing {
@@ -165,5 +168,51 @@ TEST_F(ShellTest, EncodeImageAccessesSyncSwitch) {
   DestroyShell(std::move(shell), std::move(task_runners));
 }
 
+static sk_sp<SkImage> MakeFilledImage(SkColorType color_type,
+                                      SkAlphaType alpha_type,
+                                      SkColor color) {
+  SkBitmap bitmap;
+  bitmap.allocPixels(SkImageInfo::Make(3, 2, color_type, alpha_type));
+  bitmap.eraseColor(color);
+  return SkImage::MakeFromBitmap(bitmap);
+}
+
+static void ExpectEveryPixelIs(const sk_sp<SkData>& data,
+                               std::array<uint8_t, 4> rgba) {
+  ASSERT_TRUE(data);
+  ASSERT_EQ(data->size(), 3u * 2u * 4u);
+  const uint8_t* bytes = data->bytes();
+  for (size_t i = 0; i < data->size(); i += 4) {
+    EXPECT_EQ(bytes[i + 0], rgba[0]);
+    EXPECT_EQ(bytes[i + 1], rgba[1]);
+    EXPECT_EQ(bytes[i + 2], rgba[2]);
+    EXPECT_EQ(bytes[i + 3], rgba[3]);
+  }
+}
+
+TEST(ImageEncodingTest, CopyImageByteDataConvertsPixels) {
+  // Half transparent red, premultiplied in BGRA order.
+  auto bgra = MakeFilledImage(kBGRA_8888_SkColorType, kPremul_SkAlphaType,
+                              SkColorSetARGB(128, 255, 0, 0));
+  ExpectEveryPixelIs(
+      CopyImageByteData(bgra, kRGBA_8888_SkColorType, kPremul_SkAlphaType),
+      {128, 0, 0, 128});
+  ExpectEveryPixelIs(
+      CopyImageByteData(bgra, kRGBA_8888_SkColorType, kUnpremul_SkAlphaType),
+      {255, 0, 0, 128});
+
+  auto rgb565 = MakeFilledImage(kRGB_565_SkColorType, kOpaque_SkAlphaType,
+                                SK_ColorRED);
+  ExpectEveryPixelIs(
+      CopyImageByteData(rgb565, kRGBA_8888_SkColorType, kPremul_SkAlphaType),
+      {255, 0, 0, 255});
+
+  auto f16 = MakeFilledImage(kRGBA_F16_SkColorType, kPremul_SkAlphaType,
+                             SK_ColorGREEN);
+  ExpectEveryPixelIs(
+      CopyImageByteData(f16, kRGBA_8888_SkColorType, kUnpremul_SkAlphaType),
+      {0, 255, 0, 255});
+}
+
 }  // namespace testing
 }  // namespace flutter
@@ -4,6 +4,8 @@
 
 #include "flutter/lib/ui/painting/image_generator.h"
 
+#include <cstring>
+
 #include "flutter/fml/logging.h"
 
 namespace flutter {
@@ -29,6 +31,66 @@ sk_sp<SkImage> ImageGenerator::GetImage() {
   return SkImage::MakeFromBitmap(bitmap);
 }
 
+bool ImageGenerator::GetSubsetPixels(const SkImageInfo& info,
+                                     void* pixels,
+                                     size_t row_bytes,
+                                     const SkISize& scaled_size,
+                                     const SkIRect& subset) {
+  if (!SkIRect::MakeSize(scaled_size).contains(subset) ||
+      info.dimensions() != subset.size()) {
+    return false;
+  }
+
+  SkBitmap bitmap;
+  if (!bitmap.tryAllocPixels(info.makeDimensions(scaled_size))) {
+    FML_DLOG(ERROR) << "Failed to allocate memory for bitmap of size "
+                    << bitmap.info().computeMinByteSize() << "B";
+    return false;
+  }
+
+  const auto& pixmap = bitmap.pixmap();
+  if (!GetPixels(pixmap.info(), pixmap.writable_addr(), pixmap.rowBytes())) {
+    FML_DLOG(ERROR) << "Failed to get pixels for image.";
+    return false;
+  }
+  return pixmap.readPixels(info, pixels, row_bytes, subset.x(), subset.y());
+}
+
+bool ImageGenerator::SupportsConcurrentSubsetDecoding() const {
+  return false;
+}
+
+// Baseline and extended sequential JPEGs store their rows in order, so a
+// scanline decoder can skip to a strip without transforming the rows before
+// it. Progressive ones have to buffer the whole image first.
+static bool IsSequentialJpeg(const SkData& data) {
+  const uint8_t* bytes = data.bytes();
+  const size_t size = data.size();
+  if (size < 2 || bytes[0] != 0xFF || bytes[1] != 0xD8) {
+    return false;
+  }
+  size_t offset = 2;
+  while (offset + 4 <= size && bytes[offset] == 0xFF) {
+    const uint8_t marker = bytes[offset + 1];
+    if (marker == 0xFF) {
+      // A fill byte.
+      offset++;
+      continue;
+    }
+    // The start of frame markers, except for DHT, JPG and DAC.
+    if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 &&
+        marker != 0xC8 && marker != 0xCC) {
+      return marker == 0xC0 || marker == 0xC1;
+    }
+    if (marker == 0xDA) {
+      // The first scan starts before any frame header.
+      return false;
+    }
+    offset += 2 + ((bytes[offset + 2] << 8) | bytes[offset + 3]);
+  }
+  return false;
+}
+
 BuiltinSkiaImageGenerator::~BuiltinSkiaImageGenerator() = default;
 
 BuiltinSkiaImageGenerator::BuiltinSkiaImageGenerator(
@@ -78,14 +140,19 @@ std::unique_ptr<ImageGenerator> BuiltinSkiaImageGenerator::MakeFromGenerator(
 BuiltinSkiaCodecImageGenerator::~BuiltinSkiaCodecImageGenerator() = default;
 
 BuiltinSkiaCodecImageGenerator::BuiltinSkiaCodecImageGenerator(
-    std::unique_ptr<SkCodec> codec)
-    : codec_generator_(static_cast<SkCodecImageGenerator*>(
+    std::unique_ptr<SkCodec> codec,
+    sk_sp<SkData> data)
+    : concurrent_subsets_(
+          codec && codec->getEncodedFormat() == SkEncodedImageFormat::kJPEG &&
+          codec->getOrigin() == kTopLeft_SkEncodedOrigin && data &&
+          IsSequentialJpeg(*data)),
+      data_(std::move(data)),
+      codec_generator_(static_cast<SkCodecImageGenerator*>(
           SkCodecImageGenerator::MakeFromCodec(std::move(codec)).release())) {}
 
 BuiltinSkiaCodecImageGenerator::BuiltinSkiaCodecImageGenerator(
     sk_sp<SkData> buffer)
-    : codec_generator_(static_cast<SkCodecImageGenerator*>(
-          SkCodecImageGenerator::MakeFromEncodedCodec(buffer).release())) {}
+    : BuiltinSkiaCodecImageGenerator(SkCodec::MakeFromData(buffer), buffer) {}
 
 const SkImageInfo& BuiltinSkiaCodecImageGenerator::GetInfo() {
   return codec_generator_->getInfo();
@@ -131,13 +198,78 @@ bool BuiltinSkiaCodecImageGenerator::GetPixels(
   return codec_generator_->getPixels(info, pixels, row_bytes, &options);
 }
 
+bool BuiltinSkiaCodecImageGenerator::GetSubsetPixels(
+    const SkImageInfo& info,
+    void* pixels,
+    size_t row_bytes,
+    const SkISize& scaled_size,
+    const SkIRect& subset) {
+  if (!SkIRect::MakeSize(scaled_size).contains(subset) ||
+      info.dimensions() != subset.size()) {
+    return false;
+  }
+
+  // The generator applies the EXIF orientation, so only images that need none
+  // can be decoded with a scanline decoder of their own. The fallbacks use the
+  // generator, which must not be shared by concurrent decodes.
+  std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(data_);
+  if (!codec || codec->getOrigin() != kTopLeft_SkEncodedOrigin) {
+    return !concurrent_subsets_ &&
+           ImageGenerator::GetSubsetPixels(info, pixels, row_bytes,
+                                           scaled_size, subset);
+  }
+
+  const SkImageInfo scaled_info = info.makeDimensions(scaled_size);
+
+  // Scanline decoders only honor the horizontal extent of a subset. Those
+  // that support it, such as the JPEG one, then only decode those columns.
+  const SkIRect columns = SkIRect::MakeLTRB(subset.left(), 0, subset.right(),
+                                            scaled_size.height());
+  SkCodec::Options options;
+  options.fSubset = &columns;
+  if (codec->startScanlineDecode(scaled_info, &options) == SkCodec::kSuccess &&
+      codec->getScanlineOrder() == SkCodec::kTopDown_SkScanlineOrder) {
+    // Rows missing from incomplete images are filled in by the codec.
+    codec->skipScanlines(subset.top());
+    codec->getScanlines(pixels, subset.height(), row_bytes);
+    return true;
+  }
+
+  // Otherwise, decode whole rows one at a time and keep the columns of the
+  // subset, which still avoids holding the whole image in memory.
+  if (codec->startScanlineDecode(scaled_info) != SkCodec::kSuccess ||
+      codec->getScanlineOrder() != SkCodec::kTopDown_SkScanlineOrder) {
+    return !concurrent_subsets_ &&
+           ImageGenerator::GetSubsetPixels(info, pixels, row_bytes,
+                                           scaled_size, subset);
+  }
+
+  SkBitmap row;
+  if (!row.tryAllocPixels(scaled_info.makeWH(scaled_size.width(), 1))) {
+    return false;
+  }
+  const size_t bytes_per_pixel = info.bytesPerPixel();
+  codec->skipScanlines(subset.top());
+  for (int y = 0; y < subset.height(); y++) {
+    codec->getScanlines(row.getPixels(), 1, row.rowBytes());
+    memcpy(static_cast<uint8_t*>(pixels) + y * row_bytes,
+           row.getAddr(subset.left(), 0), subset.width() * bytes_per_pixel);
+  }
+  return true;
+}
+
+bool BuiltinSkiaCodecImageGenerator::SupportsConcurrentSubsetDecoding() const {
+  return concurrent_subsets_;
+}
+
 std::unique_ptr<ImageGenerator> BuiltinSkiaCodecImageGenerator::MakeFromData(
     sk_sp<SkData> data) {
   auto codec = SkCodec::MakeFromData(data);
   if (!codec) {
     return nullptr;
   }
-  return std::make_unique<BuiltinSkiaCodecImageGenerator>(std::move(codec));
+  return std::make_unique<BuiltinSkiaCodecImageGenerator>(std::move(codec),
+                                                          std::move(data));
 }
 
 }  // namespace flutter
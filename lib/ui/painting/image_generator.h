@@ -8,6 +8,8 @@
 #include <optional>
 #include "flutter/fml/macros.h"
 #include "third_party/skia/include/core/SkImageInfo.h"
+#include "third_party/skia/include/core/SkRect.h"
+#include "third_party/skia/include/core/SkSize.h"
 #include "third_party/skia/src/codec/SkCodecImageGenerator.h"
 
 namespace flutter {
@@ -123,6 +125,39 @@ class ImageGenerator {
       unsigned int frame_index = 0,
       std::optional<unsigned int> prior_frame = std::nullopt) = 0;
 
+  /// @brief      Decode a region of the first frame of the image into a given
+  ///             buffer. The default implementation decodes the whole image
+  ///             with `GetPixels` and copies the region out, so decoders that
+  ///             can skip the rows and columns outside of the region should
+  ///             override it.
+  /// @param[in]  info         The size and color info of the decoded region.
+  ///                          Its dimensions must be those of `subset`.
+  /// @param[in]  pixels       The location where the raw decoded image data
+  ///                          should be written.
+  /// @param[in]  row_bytes    The total number of bytes that should make up a
+  ///                          single row of decoded image data.
+  /// @param[in]  scaled_size  The size the whole image is decoded at. This
+  ///                          must be either the size of the image or one
+  ///                          returned by `GetScaledDimensions`.
+  /// @param[in]  subset       The region to decode, in the coordinates of the
+  ///                          image decoded at `scaled_size`.
+  /// @return     True if the region was successfully decoded.
+  /// @note       Like `GetPixels`, this method may perform long synchronous
+  ///             work and should never be executed on the UI thread.
+  /// @see        `GetScaledDimensions`
+  virtual bool GetSubsetPixels(const SkImageInfo& info,
+                               void* pixels,
+                               size_t row_bytes,
+                               const SkISize& scaled_size,
+                               const SkIRect& subset);
+
+  /// @brief   Whether `GetSubsetPixels` may be called from several threads at
+  ///          once, and costs much less for a strip of rows than for the
+  ///          whole image. Large images are then decoded in strips in
+  ///          parallel.
+  /// @return  False unless overridden.
+  virtual bool SupportsConcurrentSubsetDecoding() const;
+
   /// @brief   Creates an `SkImage` based on the current `ImageInfo` of this
   ///          `ImageGenerator`.
   /// @return  A new `SkImage` containing the decoded image data.
@@ -172,7 +207,10 @@ class BuiltinSkiaCodecImageGenerator : public ImageGenerator {
  public:
   ~BuiltinSkiaCodecImageGenerator();
 
-  explicit BuiltinSkiaCodecImageGenerator(std::unique_ptr<SkCodec> codec);
+  // |data| is the encoded image |codec| reads. Subset decodes create codecs
+  // of their own from it.
+  BuiltinSkiaCodecImageGenerator(std::unique_ptr<SkCodec> codec,
+                                 sk_sp<SkData> data);
 
   explicit BuiltinSkiaCodecImageGenerator(sk_sp<SkData> buffer);
 
@@ -200,10 +238,24 @@ class BuiltinSkiaCodecImageGenerator : public ImageGenerator {
       unsigned int frame_index = 0,
       std::optional<unsigned int> prior_frame = std::nullopt) override;
 
+  // |ImageGenerator|
+  bool GetSubsetPixels(const SkImageInfo& info,
+                       void* pixels,
+                       size_t row_bytes,
+                       const SkISize& scaled_size,
+                       const SkIRect& subset) override;
+
+  // |ImageGenerator|
+  bool SupportsConcurrentSubsetDecoding() const override;
+
   static std::unique_ptr<ImageGenerator> MakeFromData(sk_sp<SkData> data);
 
  private:
   FML_DISALLOW_COPY_ASSIGN_AND_MOVE(BuiltinSkiaCodecImageGenerator);
+  // Set for sequential JPEGs that need no EXIF reorientation, whose strips
+  // are decoded by scanline decoders of their own.
+  bool concurrent_subsets_ = false;
+  sk_sp<SkData> data_;
   std::unique_ptr<SkCodecImageGenerator> codec_generator_;
 };
 
@@ -4,7 +4,10 @@
 
 #include "flutter/lib/ui/painting/multi_frame_codec.h"
 
+#include <algorithm>
+
 #include "flutter/fml/make_copyable.h"
+#include "flutter/fml/trace_event.h"
 #include "flutter/lib/ui/painting/image.h"
 #include "third_party/dart/runtime/include/dart_api.h"
 #include "third_party/skia/include/core/SkPixelRef.h"
@@ -12,18 +15,51 @@
 
 namespace flutter {
 
-MultiFrameCodec::MultiFrameCodec(std::shared_ptr<ImageGenerator> generator)
-    : state_(new State(std::move(generator))) {}
+MultiFrameCodec::MultiFrameCodec(std::shared_ptr<ImageGenerator> generator,
+                                 int look_ahead_frame_count,
+                                 size_t look_ahead_max_bytes)
+    : state_(std::make_shared<State>(std::move(generator),
+                                     look_ahead_frame_count,
+                                     look_ahead_max_bytes)) {}
 
 MultiFrameCodec::~MultiFrameCodec() = default;
 
-MultiFrameCodec::State::State(std::shared_ptr<ImageGenerator> generator)
+// Frames are decoded to premultiplied N32 pixels, whatever the encoded format.
+static SkImageInfo MakeFrameInfo(const ImageGenerator& generator) {
+  SkImageInfo info = generator.GetInfo().makeColorType(kN32_SkColorType);
+  if (info.alphaType() == kUnpremul_SkAlphaType) {
+    info = info.makeAlphaType(kPremul_SkAlphaType);
+  }
+  return info;
+}
+
+static size_t GetMaxFramesAhead(const SkImageInfo& frame_info,
+                                int frame_count,
+                                int look_ahead_frame_count,
+                                size_t look_ahead_max_bytes) {
+  const size_t frame_bytes = frame_info.computeMinByteSize();
+  if (frame_bytes == 0 || frame_count <= 0 || look_ahead_frame_count <= 0) {
+    return 0;
+  }
+  return std::min({static_cast<size_t>(look_ahead_frame_count),
+                   static_cast<size_t>(frame_count),
+                   look_ahead_max_bytes / frame_bytes});
+}
+
+MultiFrameCodec::State::State(std::shared_ptr<ImageGenerator> generator,
+                              int look_ahead_frame_count,
+                              size_t look_ahead_max_bytes)
     : generator_(std::move(generator)),
       frameCount_(generator_->GetFrameCount()),
       repetitionCount_(generator_->GetPlayCount() ==
                                ImageGenerator::kInfinitePlayCount
                            ? -1
                            : generator_->GetPlayCount() - 1),
+      frameInfo_(MakeFrameInfo(*generator_)),
+      maxFramesAhead_(GetMaxFramesAhead(frameInfo_,
+                                        frameCount_,
+                                        look_ahead_frame_count,
+                                        look_ahead_max_bytes)),
       nextFrameIndex_(0) {}
 
 static void InvokeNextFrameCallback(
@@ -42,52 +78,16 @@ static void InvokeNextFrameCallback(
                     {tonic::ToDart(image), tonic::ToDart(duration)});
 }
 
-// Copied the source bitmap to the destination. If this cannot occur due to
-// running out of memory or the image info not being compatible, returns false.
-static bool CopyToBitmap(SkBitmap* dst,
-                         SkColorType dstColorType,
-                         const SkBitmap& src) {
-  SkPixmap srcPM;
-  if (!src.peekPixels(&srcPM)) {
-    return false;
-  }
-
-  SkBitmap tmpDst;
-  SkImageInfo dstInfo = srcPM.info().makeColorType(dstColorType);
-  if (!tmpDst.setInfo(dstInfo)) {
-    return false;
-  }
-
-  if (!tmpDst.tryAllocPixels()) {
-    return false;
-  }
-
-  SkPixmap dstPM;
-  if (!tmpDst.peekPixels(&dstPM)) {
-    return false;
-  }
-
-  if (!srcPM.readPixels(dstPM)) {
+bool MultiFrameCodec::State::DecodeFrame(int frameIndex, SkBitmap& bitmap) {
+  if (!bitmapPool_.empty()) {
+    bitmap = std::move(bitmapPool_.back());
+    bitmapPool_.pop_back();
+  } else if (!bitmap.tryAllocPixels(frameInfo_)) {
+    FML_LOG(ERROR) << "Failed to allocate memory for frame " << frameIndex;
     return false;
   }
 
-  dst->swap(tmpDst);
-  return true;
-}
-
-sk_sp<SkImage> MultiFrameCodec::State::GetNextFrameImage(
-    fml::WeakPtr<GrDirectContext> resourceContext,
-    const std::shared_ptr<const fml::SyncSwitch>& gpu_disable_sync_switch) {
-  SkBitmap bitmap = SkBitmap();
-  SkImageInfo info = generator_->GetInfo().makeColorType(kN32_SkColorType);
-  if (info.alphaType() == kUnpremul_SkAlphaType) {
-    SkImageInfo updated = info.makeAlphaType(kPremul_SkAlphaType);
-    info = updated;
-  }
-  bitmap.allocPixels(info);
-
-  ImageGenerator::FrameInfo frameInfo =
-      generator_->GetFrameInfo(nextFrameIndex_);
+  ImageGenerator::FrameInfo frameInfo = generator_->GetFrameInfo(frameIndex);
 
   const int requiredFrameIndex =
       frameInfo.required_frame.value_or(SkCodec::kNoFrame);
@@ -95,10 +95,11 @@ sk_sp<SkImage> MultiFrameCodec::State::GetNextFrameImage(
 
   if (requiredFrameIndex != SkCodec::kNoFrame) {
     if (lastRequiredFrame_ == nullptr) {
-      FML_LOG(ERROR) << "Frame " << nextFrameIndex_ << " depends on frame "
+      FML_LOG(ERROR) << "Frame " << frameIndex << " depends on frame "
                      << requiredFrameIndex
                      << " and no required frames are cached.";
-      return nullptr;
+      RecycleBitmap(std::move(bitmap));
+      return false;
     } else if (lastRequiredFrameIndex_ != requiredFrameIndex) {
       FML_DLOG(INFO) << "Required frame " << requiredFrameIndex
                      << " is not cached. Using " << lastRequiredFrameIndex_
@@ -106,23 +107,96 @@ sk_sp<SkImage> MultiFrameCodec::State::GetNextFrameImage(
     }
 
     if (lastRequiredFrame_->getPixels() &&
-        CopyToBitmap(&bitmap, lastRequiredFrame_->colorType(),
-                     *lastRequiredFrame_)) {
+        lastRequiredFrame_->readPixels(bitmap.pixmap())) {
       prior_frame_index = requiredFrameIndex;
     }
   }
 
-  if (!generator_->GetPixels(info, bitmap.getPixels(), bitmap.rowBytes(),
-                             nextFrameIndex_, requiredFrameIndex)) {
-    FML_LOG(ERROR) << "Could not getPixels for frame " << nextFrameIndex_;
-    return nullptr;
+  if (!generator_->GetPixels(frameInfo_, bitmap.getPixels(), bitmap.rowBytes(),
+                             frameIndex, requiredFrameIndex)) {
+    FML_LOG(ERROR) << "Could not getPixels for frame " << frameIndex;
+    RecycleBitmap(std::move(bitmap));
+    return false;
   }
 
   // Hold onto this if we need it to decode future frames.
   if (frameInfo.disposal_method == SkCodecAnimation::DisposalMethod::kKeep) {
     lastRequiredFrame_ = std::make_unique<SkBitmap>(bitmap);
-    lastRequiredFrameIndex_ = nextFrameIndex_;
+    lastRequiredFrameIndex_ = frameIndex;
+  }
+  return true;
+}
+
+void MultiFrameCodec::State::RecycleBitmap(SkBitmap bitmap) {
+  // Pixels still shared with the last required frame must not be reused, and
+  // the pool and the frames decoded ahead together stay within the budget.
+  if (bitmap.pixelRef() && bitmap.pixelRef()->unique() &&
+      decodedFrames_.size() + bitmapPool_.size() < maxFramesAhead_) {
+    bitmapPool_.push_back(std::move(bitmap));
+  }
+}
+
+void MultiFrameCodec::State::DecodeAhead(
+    fml::RefPtr<fml::TaskRunner> io_task_runner) {
+  decodingAhead_ = false;
+  if (decodedFrames_.size() >= maxFramesAhead_) {
+    return;
+  }
+
+  TRACE_EVENT0("flutter", "MultiFrameCodec::DecodeAhead");
+  SkBitmap bitmap;
+  if (!DecodeFrame(nextDecodeIndex_, bitmap)) {
+    // The frame is decoded again when it is requested.
+    return;
+  }
+  decodedFrames_.push_back(std::move(bitmap));
+  nextDecodeIndex_ = (nextDecodeIndex_ + 1) % frameCount_;
+
+  // One frame per task, so that requests for frames and other IO work are not
+  // held up by a whole batch of decodes.
+  ScheduleDecodeAhead(std::move(io_task_runner));
+}
+
+void MultiFrameCodec::State::ScheduleDecodeAhead(
+    fml::RefPtr<fml::TaskRunner> io_task_runner) {
+  if (decodingAhead_ || decodedFrames_.size() >= maxFramesAhead_) {
+    return;
+  }
+  decodingAhead_ = true;
+  io_task_runner->PostTask(
+      [weak_state = weak_from_this(), io_task_runner]() mutable {
+        if (auto state = weak_state.lock()) {
+          state->DecodeAhead(std::move(io_task_runner));
+        }
+      });
+}
+
+void MultiFrameCodec::State::TraceStatistics() const {
+#if !FLUTTER_RELEASE
+  FML_TRACE_COUNTER("flutter",                                               //
+                    "MultiFrameCodec", reinterpret_cast<int64_t>(this),      //
+                    "FrameCount", deliveredFrameCount_.load(),               //
+                    "DecodedAheadCount", decodedAheadCount_.load(),          //
+                    "DroppedFrameCount", droppedFrameCount_.load());
+#endif  // !FLUTTER_RELEASE
+}
+
+sk_sp<SkImage> MultiFrameCodec::State::GetNextFrameImage(
+    fml::WeakPtr<GrDirectContext> resourceContext,
+    const std::shared_ptr<const fml::SyncSwitch>& gpu_disable_sync_switch) {
+  SkBitmap bitmap;
+  if (!decodedFrames_.empty()) {
+    bitmap = std::move(decodedFrames_.front());
+    decodedFrames_.pop_front();
+    decodedAheadCount_++;
+  } else {
+    const bool decoded = DecodeFrame(nextFrameIndex_, bitmap);
+    nextDecodeIndex_ = (nextFrameIndex_ + 1) % frameCount_;
+    if (!decoded) {
+      return nullptr;
+    }
   }
+
   sk_sp<SkImage> result;
 
   gpu_disable_sync_switch->Execute(
@@ -146,15 +220,20 @@ sk_sp<SkImage> MultiFrameCodec::State::GetNextFrameImage(
               result = SkImage::MakeFromBitmap(bitmap);
             }
           }));
+
+  // Uploading the frame copied its pixels, so the next decode can reuse them.
+  RecycleBitmap(std::move(bitmap));
   return result;
 }
 
 void MultiFrameCodec::State::GetNextFrameAndInvokeCallback(
     std::unique_ptr<DartPersistentValue> callback,
     fml::RefPtr<fml::TaskRunner> ui_task_runner,
+    fml::RefPtr<fml::TaskRunner> io_task_runner,
     fml::WeakPtr<GrDirectContext> resourceContext,
     fml::RefPtr<flutter::SkiaUnrefQueue> unref_queue,
     const std::shared_ptr<const fml::SyncSwitch>& gpu_disable_sync_switch,
+    fml::TimePoint request_time,
     size_t trace_id) {
   fml::RefPtr<CanvasImage> image = nullptr;
   int duration = 0;
@@ -166,8 +245,20 @@ void MultiFrameCodec::State::GetNextFrameAndInvokeCallback(
     ImageGenerator::FrameInfo frameInfo =
         generator_->GetFrameInfo(nextFrameIndex_);
     duration = frameInfo.duration;
+
+    // The framework requests the next frame as soon as it receives one, and
+    // shows it once the one before has been displayed for its duration.
+    const fml::TimeDelta elapsed = fml::TimePoint::Now() - request_time;
+    if (lastFrameDuration_ > 0 &&
+        elapsed > fml::TimeDelta::FromMilliseconds(lastFrameDuration_)) {
+      droppedFrameCount_++;
+    }
+    lastFrameDuration_ = duration;
+    deliveredFrameCount_++;
+    TraceStatistics();
   }
   nextFrameIndex_ = (nextFrameIndex_ + 1) % frameCount_;
+  ScheduleDecodeAhead(io_task_runner);
 
   ui_task_runner->PostTask(fml::MakeCopyable([callback = std::move(callback),
                                               image = std::move(image),
@@ -180,6 +271,7 @@ void MultiFrameCodec::State::GetNextFrameAndInvokeCallback(
 Dart_Handle MultiFrameCodec::getNextFrame(Dart_Handle callback_handle) {
   static size_t trace_counter = 1;
   const size_t trace_id = trace_counter++;
+  const fml::TimePoint request_time = fml::TimePoint::Now();
 
   if (!Dart_IsClosure(callback_handle)) {
     return tonic::ToDart("Callback must be a function");
@@ -204,7 +296,8 @@ Dart_Handle MultiFrameCodec::getNextFrame(Dart_Handle callback_handle) {
       [callback = std::make_unique<DartPersistentValue>(
            tonic::DartState::Current(), callback_handle),
        weak_state = std::weak_ptr<MultiFrameCodec::State>(state_), trace_id,
-       ui_task_runner = task_runners.GetUITaskRunner(),
+       request_time, ui_task_runner = task_runners.GetUITaskRunner(),
+       io_task_runner = task_runners.GetIOTaskRunner(),
        io_manager = dart_state->GetIOManager()]() mutable {
         auto state = weak_state.lock();
         if (!state) {
@@ -214,8 +307,9 @@ Dart_Handle MultiFrameCodec::getNextFrame(Dart_Handle callback_handle) {
         }
         state->GetNextFrameAndInvokeCallback(
             std::move(callback), std::move(ui_task_runner),
-            io_manager->GetResourceContext(), io_manager->GetSkiaUnrefQueue(),
-            io_manager->GetIsGpuDisabledSyncSwitch(), trace_id);
+            std::move(io_task_runner), io_manager->GetResourceContext(),
+            io_manager->GetSkiaUnrefQueue(),
+            io_manager->GetIsGpuDisabledSyncSwitch(), request_time, trace_id);
       }));
 
   return Dart_Null();
@@ -229,4 +323,12 @@ int MultiFrameCodec::repetitionCount() const {
   return state_->repetitionCount_;
 }
 
+MultiFrameCodec::Statistics MultiFrameCodec::GetStatistics() const {
+  return {
+      .frame_count = state_->deliveredFrameCount_,
+      .decoded_ahead_count = state_->decodedAheadCount_,
+      .dropped_frame_count = state_->droppedFrameCount_,
+  };
+}
+
 }  // namespace flutter
@@ -5,7 +5,13 @@
 #ifndef FLUTTER_LIB_UI_PAINTING_MUTLI_FRAME_CODEC_H_
 #define FLUTTER_LIB_UI_PAINTING_MUTLI_FRAME_CODEC_H_
 
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
 #include "flutter/fml/macros.h"
+#include "flutter/fml/time/time_point.h"
 #include "flutter/lib/ui/painting/codec.h"
 #include "flutter/lib/ui/painting/image_generator.h"
 
@@ -13,7 +19,29 @@ namespace flutter {
 
 class MultiFrameCodec : public Codec {
  public:
-  explicit MultiFrameCodec(std::shared_ptr<ImageGenerator> generator);
+  // The number of frames decoded ahead of the requests for them, so that
+  // frames that take longer to decode than the previous frame is displayed
+  // do not stall the animation.
+  static constexpr int kDefaultLookAheadFrameCount = 2;
+
+  // The most memory the frames decoded ahead of time may use. Animations with
+  // frames so large that not even one fits are decoded on demand only.
+  static constexpr size_t kDefaultLookAheadMaxBytes = 8 * 1024 * 1024;
+
+  struct Statistics {
+    // The frames delivered to the framework.
+    size_t frame_count = 0;
+    // The frames that had been decoded ahead of the request for them.
+    size_t decoded_ahead_count = 0;
+    // The frames that took longer to deliver than the previous frame was
+    // meant to be displayed, which the animation shows late.
+    size_t dropped_frame_count = 0;
+  };
+
+  explicit MultiFrameCodec(
+      std::shared_ptr<ImageGenerator> generator,
+      int look_ahead_frame_count = kDefaultLookAheadFrameCount,
+      size_t look_ahead_max_bytes = kDefaultLookAheadMaxBytes);
 
   ~MultiFrameCodec() override;
 
@@ -26,6 +54,9 @@ class MultiFrameCodec : public Codec {
   // |Codec|
   Dart_Handle getNextFrame(Dart_Handle args) override;
 
+  // May be called on any thread.
+  Statistics GetStatistics() const;
+
  private:
   // Captures the state shared between the IO and UI task runners.
   //
@@ -36,12 +67,23 @@ class MultiFrameCodec : public Codec {
   // Instead, the MultiFrameCodec creates this object when it is constructed,
   // shares it with the IO task runner's decoding work, and sets the live_
   // member to false when it is destructed.
-  struct State {
-    explicit State(std::shared_ptr<ImageGenerator> generator);
+  struct State : public std::enable_shared_from_this<State> {
+    State(std::shared_ptr<ImageGenerator> generator,
+          int look_ahead_frame_count,
+          size_t look_ahead_max_bytes);
 
     const std::shared_ptr<ImageGenerator> generator_;
     const int frameCount_;
     const int repetitionCount_;
+    const SkImageInfo frameInfo_;
+    // The most frames that are decoded ahead of time, after applying the
+    // memory budget. Zero disables decoding ahead.
+    const size_t maxFramesAhead_;
+
+    // Counted on the IO thread and read by GetStatistics on any thread.
+    std::atomic<size_t> deliveredFrameCount_ = 0;
+    std::atomic<size_t> decodedAheadCount_ = 0;
+    std::atomic<size_t> droppedFrameCount_ = 0;
 
     // The non-const members and functions below here are only read or written
     // to on the IO thread. They are not safe to access or write on the UI
@@ -53,6 +95,29 @@ class MultiFrameCodec : public Codec {
     // The index of the last decoded required frame.
     int lastRequiredFrameIndex_ = -1;
 
+    // The frames from nextFrameIndex_ up to nextDecodeIndex_, decoded before
+    // they were requested.
+    std::deque<SkBitmap> decodedFrames_;
+    // The index of the next frame to decode.
+    int nextDecodeIndex_ = 0;
+    // Whether a task decoding frames ahead is posted to the IO task runner.
+    bool decodingAhead_ = false;
+    // The pixels of frames that were delivered, for the next decodes to reuse
+    // rather than allocate their own.
+    std::vector<SkBitmap> bitmapPool_;
+    // How long the last delivered frame is meant to be displayed.
+    int lastFrameDuration_ = 0;
+
+    bool DecodeFrame(int frameIndex, SkBitmap& bitmap);
+
+    void RecycleBitmap(SkBitmap bitmap);
+
+    void DecodeAhead(fml::RefPtr<fml::TaskRunner> io_task_runner);
+
+    void ScheduleDecodeAhead(fml::RefPtr<fml::TaskRunner> io_task_runner);
+
+    void TraceStatistics() const;
+
     sk_sp<SkImage> GetNextFrameImage(
         fml::WeakPtr<GrDirectContext> resourceContext,
         const std::shared_ptr<const fml::SyncSwitch>& gpu_disable_sync_switch);
@@ -60,9 +125,11 @@ class MultiFrameCodec : public Codec {
     void GetNextFrameAndInvokeCallback(
         std::unique_ptr<DartPersistentValue> callback,
         fml::RefPtr<fml::TaskRunner> ui_task_runner,
+        fml::RefPtr<fml::TaskRunner> io_task_runner,
         fml::WeakPtr<GrDirectContext> resourceContext,
         fml::RefPtr<flutter::SkiaUnrefQueue> unref_queue,
         const std::shared_ptr<const fml::SyncSwitch>& gpu_disable_sync_switch,
+        fml::TimePoint request_time,
         size_t trace_id);
   };
 
@@ -4,6 +4,7 @@
 
 #include "flutter/lib/ui/painting/picture_recorder.h"
 
+#include "flutter/flow/display_list_intern_table.h"
 #include "flutter/lib/ui/painting/canvas.h"
 #include "flutter/lib/ui/painting/picture.h"
 #include "third_party/tonic/converter/dart_converter.h"
@@ -56,9 +57,13 @@ fml::RefPtr<Picture> PictureRecorder::endRecording(Dart_Handle dart_picture) {
   fml::RefPtr<Picture> picture;
 
   if (display_list_recorder_) {
+    sk_sp<DisplayList> display_list = display_list_recorder_->Build();
+    // Identical pictures share a DisplayList, and so a raster cache entry.
+    if (auto table = UIDartState::Current()->GetDisplayListInternTable()) {
+      display_list = table->Intern(std::move(display_list));
+    }
     picture = Picture::Create(
-        dart_picture,
-        UIDartState::CreateGPUObject(display_list_recorder_->Build()));
+        dart_picture, UIDartState::CreateGPUObject(std::move(display_list)));
     display_list_recorder_ = nullptr;
   } else {
     picture = Picture::Create(
@@ -17,7 +17,8 @@ class SingleFrameCodec : public Codec {
  public:
   SingleFrameCodec(fml::RefPtr<ImageDescriptor> descriptor,
                    uint32_t target_width,
-                   uint32_t target_height);
+                   uint32_t target_height,
+                   std::optional<SkIRect> subset = std::nullopt);
 
   ~SingleFrameCodec() override;
 
@@ -39,6 +40,7 @@ class SingleFrameCodec : public Codec {
   fml::RefPtr<ImageDescriptor> descriptor_;
   uint32_t target_width_;
   uint32_t target_height_;
+  std::optional<SkIRect> subset_;
   fml::RefPtr<CanvasImage> cached_image_;
   std::vector<DartPersistentValue> pending_callbacks_;
 
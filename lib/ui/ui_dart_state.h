@@ -27,6 +27,7 @@
 #include "third_party/tonic/dart_state.h"
 
 namespace flutter {
+class DisplayListInternTable;
 class FontSelector;
 class ImageGeneratorRegistry;
 class PlatformConfiguration;
@@ -51,7 +52,9 @@ class UIDartState : public tonic::DartState {
             fml::WeakPtr<ImageGeneratorRegistry> image_generator_registry,
             std::string advisory_script_uri,
             std::string advisory_script_entrypoint,
-            std::shared_ptr<VolatilePathTracker> volatile_path_tracker);
+            std::shared_ptr<VolatilePathTracker> volatile_path_tracker,
+            std::shared_ptr<DisplayListInternTable> display_list_intern_table =
+                nullptr);
 
     /// The task runners used by the shell hosting this runtime controller. This
     /// may be used by the isolate to scheduled asynchronous texture uploads or
@@ -89,6 +92,9 @@ class UIDartState : public tonic::DartState {
 
     /// Cache for tracking path volatility.
     std::shared_ptr<VolatilePathTracker> volatile_path_tracker;
+
+    /// The table that display lists with the same content are shared through.
+    std::shared_ptr<DisplayListInternTable> display_list_intern_table;
   };
 
   Dart_Port main_port() const { return main_port_; }
@@ -118,6 +124,8 @@ class UIDartState : public tonic::DartState {
 
   std::shared_ptr<VolatilePathTracker> GetVolatilePathTracker() const;
 
+  std::shared_ptr<DisplayListInternTable> GetDisplayListInternTable() const;
+
   fml::WeakPtr<SnapshotDelegate> GetSnapshotDelegate() const;
 
   fml::WeakPtr<GrDirectContext> GetResourceContext() const;
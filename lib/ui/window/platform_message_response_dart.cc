@@ -7,7 +7,6 @@
 #include <utility>
 
 #include "flutter/common/task_runners.h"
-#include "flutter/fml/make_copyable.h"
 #include "third_party/tonic/dart_state.h"
 #include "third_party/tonic/logging/dart_invoke.h"
 #include "third_party/tonic/typed_data/dart_byte_data.h"
@@ -22,8 +21,8 @@ PlatformMessageResponseDart::PlatformMessageResponseDart(
 
 PlatformMessageResponseDart::~PlatformMessageResponseDart() {
   if (!callback_.is_empty()) {
-    ui_task_runner_->PostTask(fml::MakeCopyable(
-        [callback = std::move(callback_)]() mutable { callback.Clear(); }));
+    ui_task_runner_->PostTask(
+        [callback = std::move(callback_)]() mutable { callback.Clear(); });
   }
 }
 
@@ -33,7 +32,7 @@ void PlatformMessageResponseDart::Complete(std::unique_ptr<fml::Mapping> data) {
   }
   FML_DCHECK(!is_complete_);
   is_complete_ = true;
-  ui_task_runner_->PostTask(fml::MakeCopyable(
+  ui_task_runner_->PostTask(
       [callback = std::move(callback_), data = std::move(data)]() mutable {
         std::shared_ptr<tonic::DartState> dart_state =
             callback.dart_state().lock();
@@ -45,7 +44,7 @@ void PlatformMessageResponseDart::Complete(std::unique_ptr<fml::Mapping> data) {
         Dart_Handle byte_buffer =
             tonic::DartByteData::Create(data->GetMapping(), data->GetSize());
         tonic::DartInvoke(callback.Release(), {byte_buffer});
-      }));
+      });
 }
 
 void PlatformMessageResponseDart::CompleteEmpty() {
@@ -55,7 +54,7 @@ void PlatformMessageResponseDart::CompleteEmpty() {
   FML_DCHECK(!is_complete_);
   is_complete_ = true;
   ui_task_runner_->PostTask(
-      fml::MakeCopyable([callback = std::move(callback_)]() mutable {
+      [callback = std::move(callback_)]() mutable {
         std::shared_ptr<tonic::DartState> dart_state =
             callback.dart_state().lock();
         if (!dart_state) {
@@ -63,7 +62,7 @@ void PlatformMessageResponseDart::CompleteEmpty() {
         }
         tonic::DartState::Scope scope(dart_state);
         tonic::DartInvoke(callback.Release(), {Dart_Null()});
-      }));
+      });
 }
 
 }  // namespace flutter
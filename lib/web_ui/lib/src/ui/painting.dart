@@ -783,10 +783,13 @@ class ImageDescriptor {
   int get bytesPerPixel =>
       throw UnsupportedError('ImageDescriptor.bytesPerPixel is not supported on web.');
   void dispose() => _data = null;
-  Future<Codec> instantiateCodec({int? targetWidth, int? targetHeight}) async {
+  Future<Codec> instantiateCodec({int? targetWidth, int? targetHeight, Rect? sourceRect}) async {
     if (_data == null) {
       throw StateError('Object is disposed');
     }
+    if (sourceRect != null) {
+      _throw('instantiateCodec(sourceRect)');
+    }
     if (_width == null) {
       return instantiateImageCodec(
         _data!,
@@ -96,27 +96,28 @@ std::weak_ptr<DartIsolate> DartIsolate::SpawnIsolate(
     const std::vector<std::string>& dart_entrypoint_args,
     std::unique_ptr<IsolateConfiguration> isolate_configuration) const {
   return CreateRunningRootIsolate(
-      settings,                                          //
-      GetIsolateGroupData().GetIsolateSnapshot(),        //
-      std::move(platform_configuration),                 //
-      flags,                                             //
-      nullptr,                                           //
-      isolate_create_callback,                           //
-      isolate_shutdown_callback,                         //
-      dart_entrypoint,                                   //
-      dart_entrypoint_library,                           //
-      dart_entrypoint_args,                              //
-      std::move(isolate_configuration),                  //
-      UIDartState::Context{GetTaskRunners(),             //
-                           snapshot_delegate,            //
-                           GetIOManager(),               //
-                           GetSkiaUnrefQueue(),          //
-                           GetImageDecoder(),            //
-                           GetImageGeneratorRegistry(),  //
-                           advisory_script_uri,          //
-                           advisory_script_entrypoint,   //
-                           GetVolatilePathTracker()},    //
-      this                                               //
+      settings,                                           //
+      GetIsolateGroupData().GetIsolateSnapshot(),         //
+      std::move(platform_configuration),                  //
+      flags,                                              //
+      nullptr,                                            //
+      isolate_create_callback,                            //
+      isolate_shutdown_callback,                          //
+      dart_entrypoint,                                    //
+      dart_entrypoint_library,                            //
+      dart_entrypoint_args,                               //
+      std::move(isolate_configuration),                   //
+      UIDartState::Context{GetTaskRunners(),              //
+                           snapshot_delegate,             //
+                           GetIOManager(),                //
+                           GetSkiaUnrefQueue(),           //
+                           GetImageDecoder(),             //
+                           GetImageGeneratorRegistry(),   //
+                           advisory_script_uri,           //
+                           advisory_script_entrypoint,    //
+                           GetVolatilePathTracker(),      //
+                           GetDisplayListInternTable()},  //
+      this                                                //
   );
 }
 
@@ -154,8 +154,9 @@ void Animator::BeginFrame(
     // producing a frame next vsync (it will be scheduled once we receive the
     // viewport event).  Because of this, we hold off on calling
     // |OnAnimatorNotifyIdle| for a little bit, as that could cause garbage
-    // collection to trigger at a highly undesirable time.
-    task_runners_.GetUITaskRunner()->PostDelayedTask(
+    // collection to trigger at a highly undesirable time. The task is also
+    // posted with the lowest priority so that it never delays other work.
+    task_runners_.GetUITaskRunner()->PostDelayedTaskWithPriority(
         [self = weak_factory_.GetWeakPtr(),
          notify_idle_task_id = notify_idle_task_id_]() {
           if (!self) {
@@ -172,7 +173,7 @@ void Animator::BeginFrame(
                                                  100000);
           }
         },
-        kNotifyIdleTaskWaitTime);
+        kNotifyIdleTaskWaitTime, fml::TaskPriority::kIdle);
   }
 }
 
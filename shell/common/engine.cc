@@ -63,6 +63,7 @@ Engine::Engine(
       task_runners_(std::move(task_runners)),
       weak_factory_(this) {
   pointer_data_dispatcher_ = dispatcher_maker(*this);
+  image_decoder_.SetCacheMaxBytes(settings_.image_decoder_cache_max_bytes);
 }
 
 Engine::Engine(Delegate& delegate,
@@ -86,6 +87,8 @@ Engine::Engine(Delegate& delegate,
              io_manager,
              std::make_shared<FontCollection>(),
              nullptr) {
+  display_list_intern_table_ =
+      std::make_shared<DisplayListInternTable>(unref_queue);
   runtime_controller_ = std::make_unique<RuntimeController>(
       *this,                                 // runtime delegate
       &vm,                                   // VM
@@ -105,6 +108,7 @@ Engine::Engine(Delegate& delegate,
           settings_.advisory_script_uri,           // advisory script uri
           settings_.advisory_script_entrypoint,    // advisory script entrypoint
           std::move(volatile_path_tracker),        // volatile path tracker
+          display_list_intern_table_,              // display list intern table
       });
 }
 
@@ -138,7 +142,13 @@ std::unique_ptr<Engine> Engine::Spawn(
   return result;
 }
 
-Engine::~Engine() = default;
+Engine::~Engine() {
+  // The interned lists may hold images that are released through the unref
+  // queue, which must happen before the IO manager goes away.
+  if (display_list_intern_table_) {
+    display_list_intern_table_->Clear();
+  }
+}
 
 fml::WeakPtr<Engine> Engine::GetWeakPtr() const {
   return weak_factory_.GetWeakPtr();
@@ -256,6 +266,9 @@ void Engine::NotifyIdle(int64_t deadline) {
   TRACE_EVENT1("flutter", "Engine::NotifyIdle", "deadline_now_delta",
                trace_event.c_str());
   runtime_controller_->NotifyIdle(deadline);
+  if (display_list_intern_table_) {
+    display_list_intern_table_->Purge();
+  }
 }
 
 std::optional<uint32_t> Engine::GetUIIsolateReturnCode() {
@@ -10,6 +10,7 @@
 
 #include "flutter/assets/asset_manager.h"
 #include "flutter/common/task_runners.h"
+#include "flutter/flow/display_list_intern_table.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/mapping.h"
 #include "flutter/fml/memory/weak_ptr.h"
@@ -971,6 +972,9 @@ class Engine final : public RuntimeDelegate, PointerDataDispatcher::Delegate {
   std::shared_ptr<FontCollection> font_collection_;
   ImageDecoder image_decoder_;
   ImageGeneratorRegistry image_generator_registry_;
+  // Shared with the isolates of this engine. Null for spawned engines, which
+  // use the table of the engine they were spawned from.
+  std::shared_ptr<DisplayListInternTable> display_list_intern_table_;
   TaskRunners task_runners_;
   fml::WeakPtrFactory<Engine> weak_factory_;  // Must be the last member.
   FML_DISALLOW_COPY_AND_ASSIGN(Engine);
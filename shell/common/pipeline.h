@@ -5,6 +5,8 @@
 #ifndef FLUTTER_SHELL_COMMON_PIPELINE_H_
 #define FLUTTER_SHELL_COMMON_PIPELINE_H_
 
+#include <algorithm>
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <mutex>
@@ -26,6 +28,11 @@ size_t GetNextPipelineTraceID();
 
 /// A thread-safe queue of resources for a single consumer and a single
 /// producer.
+///
+/// The depth of the pipeline is the number of resources that may be in flight,
+/// that is, being produced or waiting to be consumed, at once. It can be
+/// lowered and raised again at runtime, up to the depth the pipeline was
+/// created with.
 template <class R>
 class Pipeline {
  public:
@@ -91,17 +98,34 @@ class Pipeline {
   };
 
   explicit Pipeline(uint32_t depth)
-      : depth_(depth), empty_(depth), available_(0), inflight_(0) {}
+      : max_depth_(depth), depth_(depth), available_(0), inflight_(0) {}
 
   ~Pipeline() = default;
 
-  bool IsValid() const { return empty_.IsValid() && available_.IsValid(); }
+  bool IsValid() const { return available_.IsValid(); }
+
+  uint32_t GetMaxDepth() const { return max_depth_; }
+
+  uint32_t GetDepth() const { return depth_.load(); }
+
+  /// Sets the depth of the pipeline, clamped to at least one and at most the
+  /// depth it was created with. Resources already in flight are not dropped
+  /// when the depth is lowered, but no more are produced until enough of them
+  /// have been consumed.
+  void SetDepth(uint32_t depth) {
+    depth = std::clamp<uint32_t>(depth, 1, max_depth_);
+    if (depth_.exchange(depth) != depth) {
+      FML_TRACE_COUNTER("flutter", "Pipeline Depth",
+                        reinterpret_cast<int64_t>(this),  //
+                        "depth", depth                    //
+      );
+    }
+  }
 
   ProducerContinuation Produce() {
-    if (!empty_.TryWait()) {
+    if (!TryReserve()) {
       return {};
     }
-    ++inflight_;
     FML_TRACE_COUNTER("flutter", "Pipeline Depth",
                       reinterpret_cast<int64_t>(this),      //
                       "frames in flight", inflight_.load()  //
@@ -117,10 +141,10 @@ class Pipeline {
   // is empty.
   // Prefer using |Produce|. ProducerContinuation returned by this method
   // doesn't guarantee that the frame will be rendered.
+  // This is used to resubmit a resource that was just consumed, so it is not
+  // subject to the depth of the pipeline. Otherwise a producer holding the
+  // only spot of a pipeline of depth one would make the resubmission fail.
   ProducerContinuation ProduceIfEmpty() {
-    if (!empty_.TryWait()) {
-      return {};
-    }
     ++inflight_;
     FML_TRACE_COUNTER("flutter", "Pipeline Depth",
                       reinterpret_cast<int64_t>(this),      //
@@ -161,7 +185,6 @@ class Pipeline {
       consumer(std::move(resource));
     }
 
-    empty_.Signal();
     --inflight_;
 
     TRACE_FLOW_END("flutter", "PipelineItem", trace_id);
@@ -172,13 +195,25 @@ class Pipeline {
   }
 
  private:
-  const uint32_t depth_;
-  fml::Semaphore empty_;
+  const uint32_t max_depth_;
+  std::atomic<uint32_t> depth_;
   fml::Semaphore available_;
   std::atomic<int> inflight_;
   std::mutex queue_mutex_;
   std::deque<std::pair<ResourcePtr, size_t>> queue_;
 
+  // Reserves a spot in the pipeline for a resource to be produced, if fewer
+  // than |depth_| resources are in flight.
+  bool TryReserve() {
+    int inflight = inflight_.load();
+    do {
+      if (inflight >= static_cast<int>(depth_.load())) {
+        return false;
+      }
+    } while (!inflight_.compare_exchange_weak(inflight, inflight + 1));
+    return true;
+  }
+
   bool ProducerCommit(ResourcePtr resource, size_t trace_id) {
     {
       std::scoped_lock lock(queue_mutex_);
@@ -196,7 +231,7 @@ class Pipeline {
       if (!queue_.empty()) {
         // Bail if the queue is not empty, opens up spaces to produce other
         // frames.
-        empty_.Signal();
+        --inflight_;
         return false;
       }
       queue_.emplace_back(std::move(resource), trace_id);
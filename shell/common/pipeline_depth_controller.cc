@@ -0,0 +1,104 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/pipeline_depth_controller.h"
+
+namespace flutter {
+
+namespace {
+
+// The weight of the latest frame in the moving averages.
+constexpr int64_t kAverageWeightDivisor = 8;
+
+// Frames whose build and raster times add up to less than this fraction of
+// the frame budget are built with a single frame in flight. Between this and
+// the full budget, the depth is left as is so that it doesn't flip back and
+// forth around the threshold.
+constexpr double kSingleBufferingBudgetFraction = 0.75;
+
+// The number of consecutive frames that must call for another depth before
+// the recommended depth changes.
+constexpr uint32_t kFramesBeforeDepthChange = 8;
+
+// Gaps between frames longer than this many frame budgets are idle time
+// rather than slow frames, and are left out of the frame interval.
+constexpr int64_t kIdleGapInFrameBudgets = 4;
+
+fml::TimeDelta MovingAverage(fml::TimeDelta average,
+                             fml::TimeDelta sample,
+                             bool has_samples) {
+  if (!has_samples) {
+    return sample;
+  }
+  return average + (sample - average) / kAverageWeightDivisor;
+}
+
+}  // namespace
+
+PipelineDepthController::PipelineDepthController() = default;
+
+PipelineDepthController::~PipelineDepthController() = default;
+
+void PipelineDepthController::RecordFrame(
+    const FrameTimingsRecorder& recorder) {
+  const fml::TimeDelta frame_budget =
+      recorder.GetVsyncTargetTime() - recorder.GetVsyncStartTime();
+  if (frame_budget <= fml::TimeDelta::Zero()) {
+    return;
+  }
+  const fml::TimePoint raster_end = recorder.GetRasterEndTime();
+
+  if (has_frames_) {
+    const fml::TimeDelta interval = raster_end - last_raster_end_;
+    if (interval <= average_frame_budget_ * kIdleGapInFrameBudgets) {
+      average_frame_interval_ = MovingAverage(average_frame_interval_,
+                                              interval, has_frame_interval_);
+      has_frame_interval_ = true;
+    }
+  }
+  last_raster_end_ = raster_end;
+
+  average_build_duration_ = MovingAverage(
+      average_build_duration_, recorder.GetBuildDuration(), has_frames_);
+  average_raster_duration_ = MovingAverage(
+      average_raster_duration_, raster_end - recorder.GetRasterStartTime(),
+      has_frames_);
+  average_frame_budget_ =
+      MovingAverage(average_frame_budget_, frame_budget, has_frames_);
+  average_frame_latency_ = MovingAverage(
+      average_frame_latency_, raster_end - recorder.GetVsyncStartTime(),
+      has_frames_);
+  has_frames_ = true;
+
+  const fml::TimeDelta frame_work =
+      average_build_duration_ + average_raster_duration_;
+  uint32_t depth = recommended_depth_;
+  if (frame_work.ToSecondsF() <=
+      average_frame_budget_.ToSecondsF() * kSingleBufferingBudgetFraction) {
+    depth = 1;
+  } else if (frame_work > average_frame_budget_) {
+    depth = 2;
+  }
+
+  if (depth == recommended_depth_) {
+    frames_against_depth_ = 0;
+  } else if (++frames_against_depth_ >= kFramesBeforeDepthChange) {
+    recommended_depth_ = depth;
+    frames_against_depth_ = 0;
+  }
+}
+
+uint32_t PipelineDepthController::GetRecommendedDepth() const {
+  return recommended_depth_;
+}
+
+fml::TimeDelta PipelineDepthController::GetAverageFrameLatency() const {
+  return average_frame_latency_;
+}
+
+fml::TimeDelta PipelineDepthController::GetAverageFrameInterval() const {
+  return average_frame_interval_;
+}
+
+}  // namespace flutter
@@ -0,0 +1,67 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_SHELL_COMMON_PIPELINE_DEPTH_CONTROLLER_H_
+#define FLUTTER_SHELL_COMMON_PIPELINE_DEPTH_CONTROLLER_H_
+
+#include <cstdint>
+
+#include "flutter/flow/frame_timings.h"
+#include "flutter/fml/macros.h"
+#include "flutter/fml/time/time_delta.h"
+#include "flutter/fml/time/time_point.h"
+
+namespace flutter {
+
+//------------------------------------------------------------------------------
+/// @brief      Chooses the depth of the layer tree pipeline from the build and
+///             raster times of recent frames, and keeps the frame latency and
+///             throughput statistics reported in `FrameTiming`.
+///
+///             When building and rasterizing a frame both fit in a frame
+///             budget, a single frame in flight gives the lowest latency. When
+///             they don't, building the next frame while the current one is
+///             rasterized (double buffering) keeps up the frame rate instead.
+///
+///             This is only used on the raster thread.
+///
+class PipelineDepthController {
+ public:
+  PipelineDepthController();
+
+  ~PipelineDepthController();
+
+  /// Accounts for a frame that has been rasterized.
+  void RecordFrame(const FrameTimingsRecorder& recorder);
+
+  /// The depth the pipeline should have, either one or two.
+  uint32_t GetRecommendedDepth() const;
+
+  /// The moving average of the time from the vsync of a frame to the end of
+  /// its rasterization.
+  fml::TimeDelta GetAverageFrameLatency() const;
+
+  /// The moving average of the time between the ends of the rasterization of
+  /// consecutive frames, ignoring the gaps in which no frames were produced.
+  fml::TimeDelta GetAverageFrameInterval() const;
+
+ private:
+  fml::TimeDelta average_build_duration_;
+  fml::TimeDelta average_raster_duration_;
+  fml::TimeDelta average_frame_budget_;
+  fml::TimeDelta average_frame_latency_;
+  fml::TimeDelta average_frame_interval_;
+  fml::TimePoint last_raster_end_;
+  bool has_frames_ = false;
+  bool has_frame_interval_ = false;
+  uint32_t recommended_depth_ = 2;
+  // The number of consecutive frames that called for the other depth.
+  uint32_t frames_against_depth_ = 0;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(PipelineDepthController);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_COMMON_PIPELINE_DEPTH_CONTROLLER_H_
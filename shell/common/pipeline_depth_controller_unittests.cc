@@ -0,0 +1,99 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/common/pipeline_depth_controller.h"
+
+#include <memory>
+
+#include "flutter/flow/frame_timings.h"
+#include "flutter/fml/time/time_delta.h"
+#include "flutter/fml/time/time_point.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+constexpr fml::TimeDelta kFrameBudget = fml::TimeDelta::FromMilliseconds(16);
+
+// Records a frame that ends now and took |build| and |raster| to build and
+// rasterize.
+void RecordFrame(PipelineDepthController& controller,
+                 fml::TimeDelta build,
+                 fml::TimeDelta raster) {
+  FrameTimingsRecorder recorder;
+  const fml::TimePoint raster_start = fml::TimePoint::Now() - raster;
+  const fml::TimePoint vsync_start = raster_start - build;
+  recorder.RecordVsync(vsync_start, vsync_start + kFrameBudget);
+  recorder.RecordBuildStart(vsync_start);
+  recorder.RecordBuildEnd(raster_start);
+  recorder.RecordRasterStart(raster_start);
+  recorder.RecordRasterEnd();
+  controller.RecordFrame(recorder);
+}
+
+void RecordFrames(PipelineDepthController& controller,
+                  int count,
+                  fml::TimeDelta build,
+                  fml::TimeDelta raster) {
+  for (int i = 0; i < count; i++) {
+    RecordFrame(controller, build, raster);
+  }
+}
+
+}  // namespace
+
+TEST(PipelineDepthControllerTest, StartsWithTwoFramesInFlight) {
+  PipelineDepthController controller;
+  ASSERT_EQ(controller.GetRecommendedDepth(), 2u);
+}
+
+TEST(PipelineDepthControllerTest, FramesThatFitInTheBudgetLowerTheDepth) {
+  PipelineDepthController controller;
+  const auto duration = fml::TimeDelta::FromMilliseconds(2);
+  RecordFrames(controller, 7, duration, duration);
+  ASSERT_EQ(controller.GetRecommendedDepth(), 2u);
+  RecordFrame(controller, duration, duration);
+  ASSERT_EQ(controller.GetRecommendedDepth(), 1u);
+}
+
+TEST(PipelineDepthControllerTest, FramesOverTheBudgetRaiseTheDepth) {
+  PipelineDepthController controller;
+  RecordFrames(controller, 8, fml::TimeDelta::FromMilliseconds(2),
+               fml::TimeDelta::FromMilliseconds(2));
+  ASSERT_EQ(controller.GetRecommendedDepth(), 1u);
+  // Rasterization is the bottleneck.
+  RecordFrames(controller, 30, fml::TimeDelta::FromMilliseconds(4),
+               fml::TimeDelta::FromMilliseconds(14));
+  ASSERT_EQ(controller.GetRecommendedDepth(), 2u);
+}
+
+TEST(PipelineDepthControllerTest, FramesCloseToTheBudgetKeepTheDepth) {
+  PipelineDepthController controller;
+  const auto build = fml::TimeDelta::FromMilliseconds(6);
+  const auto raster = fml::TimeDelta::FromMilliseconds(8);
+  RecordFrames(controller, 30, build, raster);
+  ASSERT_EQ(controller.GetRecommendedDepth(), 2u);
+
+  RecordFrames(controller, 30, fml::TimeDelta::FromMilliseconds(2),
+               fml::TimeDelta::FromMilliseconds(2));
+  ASSERT_EQ(controller.GetRecommendedDepth(), 1u);
+  RecordFrames(controller, 30, build, raster);
+  ASSERT_EQ(controller.GetRecommendedDepth(), 1u);
+}
+
+TEST(PipelineDepthControllerTest, TracksTheAverageFrameLatency) {
+  PipelineDepthController controller;
+  const auto build = fml::TimeDelta::FromMilliseconds(5);
+  const auto raster = fml::TimeDelta::FromMilliseconds(7);
+  RecordFrames(controller, 4, build, raster);
+  ASSERT_GE(controller.GetAverageFrameLatency(), build + raster);
+  ASSERT_LT(controller.GetAverageFrameLatency(),
+            build + raster + fml::TimeDelta::FromMilliseconds(10));
+  ASSERT_GT(controller.GetAverageFrameInterval(), fml::TimeDelta::Zero());
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -131,5 +131,91 @@ TEST(PipelineTest, ProduceIfEmptySuccessfulIfQueueIsEmpty) {
   ASSERT_EQ(consume_result_1, PipelineConsumeResult::Done);
 }
 
+TEST(PipelineTest, ProduceIfEmptyIsNotLimitedByTheDepth) {
+  const int depth = 1;
+  std::shared_ptr<IntPipeline> pipeline = std::make_shared<IntPipeline>(depth);
+
+  // The producer holds the only spot while a resource is resubmitted.
+  Continuation continuation_1 = pipeline->Produce();
+  ASSERT_TRUE(continuation_1);
+  ASSERT_FALSE(pipeline->Produce());
+  Continuation continuation_2 = pipeline->ProduceIfEmpty();
+  ASSERT_TRUE(continuation_2);
+
+  const int test_val_1 = 1, test_val_2 = 2;
+  ASSERT_TRUE(continuation_2.Complete(std::make_unique<int>(test_val_2)));
+  ASSERT_TRUE(continuation_1.Complete(std::make_unique<int>(test_val_1)));
+
+  PipelineConsumeResult consume_result_1 = pipeline->Consume(
+      [&test_val_2](std::unique_ptr<int> v) { ASSERT_EQ(*v, test_val_2); });
+  ASSERT_EQ(consume_result_1, PipelineConsumeResult::MoreAvailable);
+  PipelineConsumeResult consume_result_2 = pipeline->Consume(
+      [&test_val_1](std::unique_ptr<int> v) { ASSERT_EQ(*v, test_val_1); });
+  ASSERT_EQ(consume_result_2, PipelineConsumeResult::Done);
+  ASSERT_TRUE(pipeline->Produce());
+}
+
+TEST(PipelineTest, DepthLimitsTheResourcesInFlight) {
+  const int depth = 2;
+  std::shared_ptr<IntPipeline> pipeline = std::make_shared<IntPipeline>(depth);
+  pipeline->SetDepth(1);
+  ASSERT_EQ(pipeline->GetDepth(), 1u);
+
+  Continuation continuation_1 = pipeline->Produce();
+  ASSERT_TRUE(continuation_1);
+  Continuation continuation_2 = pipeline->Produce();
+  ASSERT_FALSE(continuation_2);
+
+  const int test_val_1 = 1;
+  bool result = continuation_1.Complete(std::make_unique<int>(test_val_1));
+  ASSERT_EQ(result, true);
+  PipelineConsumeResult consume_result_1 = pipeline->Consume(
+      [&test_val_1](std::unique_ptr<int> v) { ASSERT_EQ(*v, test_val_1); });
+  ASSERT_EQ(consume_result_1, PipelineConsumeResult::Done);
+
+  Continuation continuation_3 = pipeline->Produce();
+  ASSERT_TRUE(continuation_3);
+}
+
+TEST(PipelineTest, DepthIsClampedToTheInitialDepth) {
+  const int depth = 2;
+  std::shared_ptr<IntPipeline> pipeline = std::make_shared<IntPipeline>(depth);
+  pipeline->SetDepth(0);
+  ASSERT_EQ(pipeline->GetDepth(), 1u);
+  pipeline->SetDepth(3);
+  ASSERT_EQ(pipeline->GetDepth(), 2u);
+
+  Continuation continuation_1 = pipeline->Produce();
+  Continuation continuation_2 = pipeline->Produce();
+  Continuation continuation_3 = pipeline->Produce();
+  ASSERT_TRUE(continuation_1);
+  ASSERT_TRUE(continuation_2);
+  ASSERT_FALSE(continuation_3);
+}
+
+TEST(PipelineTest, LoweringTheDepthKeepsResourcesInFlight) {
+  const int depth = 2;
+  std::shared_ptr<IntPipeline> pipeline = std::make_shared<IntPipeline>(depth);
+
+  Continuation continuation_1 = pipeline->Produce();
+  Continuation continuation_2 = pipeline->Produce();
+  pipeline->SetDepth(1);
+
+  const int test_val_1 = 1, test_val_2 = 2;
+  ASSERT_TRUE(continuation_1.Complete(std::make_unique<int>(test_val_1)));
+  ASSERT_TRUE(continuation_2.Complete(std::make_unique<int>(test_val_2)));
+
+  PipelineConsumeResult consume_result_1 = pipeline->Consume(
+      [&test_val_1](std::unique_ptr<int> v) { ASSERT_EQ(*v, test_val_1); });
+  ASSERT_EQ(consume_result_1, PipelineConsumeResult::MoreAvailable);
+  // One resource is still in flight, which is all the new depth allows.
+  ASSERT_FALSE(pipeline->Produce());
+
+  PipelineConsumeResult consume_result_2 = pipeline->Consume(
+      [&test_val_2](std::unique_ptr<int> v) { ASSERT_EQ(*v, test_val_2); });
+  ASSERT_EQ(consume_result_2, PipelineConsumeResult::Done);
+  ASSERT_TRUE(pipeline->Produce());
+}
+
 }  // namespace testing
 }  // namespace flutter
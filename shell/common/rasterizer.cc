@@ -13,7 +13,6 @@
 #include "flutter/fml/time/time_delta.h"
 #include "flutter/fml/time/time_point.h"
 #include "flutter/shell/common/serialization_callbacks.h"
-#include "fml/make_copyable.h"
 #include "third_party/skia/include/core/SkEncodedImageFormat.h"
 #include "third_party/skia/include/core/SkImageEncoder.h"
 #include "third_party/skia/include/core/SkPictureRecorder.h"
@@ -28,6 +27,25 @@ namespace flutter {
 // used within this interval.
 static constexpr std::chrono::milliseconds kSkiaCleanupExpiration(15000);
 
+// Images evicted from the raster cache are freed at the latest this long
+// after the frame that evicted them, even if the raster thread never idles.
+static constexpr fml::TimeDelta kEvictedImagesReleaseTimeout =
+    fml::TimeDelta::FromMilliseconds(100);
+
+// Returns the first vsync at or after |now| that starts a frame, based on the
+// vsync interval of the frame that |recorder| timed. Frames that are late
+// have a target time in the past, which would leave no time for idle work.
+static fml::TimePoint NextFrameStartTime(const FrameTimingsRecorder& recorder,
+                                         fml::TimePoint now) {
+  const fml::TimePoint frame_end = recorder.GetVsyncTargetTime();
+  const fml::TimeDelta interval = frame_end - recorder.GetVsyncStartTime();
+  if (frame_end >= now || interval <= fml::TimeDelta::Zero()) {
+    return frame_end;
+  }
+  const int64_t intervals_missed = (now - frame_end) / interval;
+  return frame_end + interval * (intervals_missed + 1);
+}
+
 Rasterizer::Rasterizer(Delegate& delegate)
     : delegate_(delegate),
       compositor_context_(std::make_unique<flutter::CompositorContext>(
@@ -115,6 +133,10 @@ void Rasterizer::DisableThreadMergerIfNeeded() {
   }
 }
 
+void Rasterizer::SetAdaptivePipelineDepth(bool enabled) {
+  adaptive_pipeline_depth_ = enabled;
+}
+
 void Rasterizer::NotifyLowMemoryWarning() const {
   if (!surface_) {
     FML_DLOG(INFO)
@@ -181,6 +203,9 @@ RasterStatus Rasterizer::Draw(
       };
 
   PipelineConsumeResult consume_result = pipeline->Consume(consumer);
+  if (adaptive_pipeline_depth_) {
+    pipeline->SetDepth(pipeline_depth_controller_.GetRecommendedDepth());
+  }
   // if the raster status is to resubmit the frame, we push the frame to the
   // front of the queue and also change the consume status to more available.
 
@@ -208,15 +233,14 @@ RasterStatus Rasterizer::Draw(
   switch (consume_result) {
     case PipelineConsumeResult::MoreAvailable: {
       delegate_.GetTaskRunners().GetRasterTaskRunner()->PostTask(
-          fml::MakeCopyable(
-              [weak_this = weak_factory_.GetWeakPtr(), pipeline,
-               resubmit_recorder = std::move(resubmit_recorder),
-               discard_callback = std::move(discard_callback)]() mutable {
-                if (weak_this) {
-                  weak_this->Draw(std::move(resubmit_recorder), pipeline,
-                                  std::move(discard_callback));
-                }
-              }));
+          [weak_this = weak_factory_.GetWeakPtr(), pipeline,
+           resubmit_recorder = std::move(resubmit_recorder),
+           discard_callback = std::move(discard_callback)]() mutable {
+            if (weak_this) {
+              weak_this->Draw(std::move(resubmit_recorder), pipeline,
+                              std::move(discard_callback));
+            }
+          });
       break;
     }
     default:
@@ -405,7 +429,12 @@ RasterStatus Rasterizer::DoDraw(
   // TODO(liyuqian): in Fuchsia, the rasterization doesn't finish when
   // Rasterizer::DoDraw finishes. Future work is needed to adapt the timestamp
   // for Fuchsia to capture SceneUpdateContext::ExecutePaintTasks.
-  delegate_.OnFrameRasterized(frame_timings_recorder->GetRecordedTime());
+  pipeline_depth_controller_.RecordFrame(*frame_timings_recorder);
+  FrameTiming timing = frame_timings_recorder->GetRecordedTime();
+  timing.SetPipelineStatistics(
+      pipeline_depth_controller_.GetAverageFrameLatency(),
+      pipeline_depth_controller_.GetAverageFrameInterval());
+  delegate_.OnFrameRasterized(timing);
 
 // SceneDisplayLag events are disabled on Fuchsia.
 // see: https://github.com/flutter/flutter/issues/56598
@@ -441,6 +470,15 @@ RasterStatus Rasterizer::DoDraw(
   }
 #endif
 
+  // The time until the next frame starts is free for idle work.
+  const fml::TimePoint idle_deadline =
+      NextFrameStartTime(*frame_timings_recorder, fml::TimePoint::Now());
+  delegate_.GetTaskRunners().GetRasterTaskRunner()->RunIdleTasksUntil(
+      idle_deadline);
+  if (auto io_task_runner = delegate_.GetTaskRunners().GetIOTaskRunner()) {
+    io_task_runner->RunIdleTasksUntil(idle_deadline);
+  }
+
   // Pipeline pressure is applied from a couple of places:
   // rasterizer: When there are more items as of the time of Consume.
   // animator (via shell): Frame gets produces every vsync.
@@ -568,6 +606,8 @@ RasterStatus Rasterizer::DrawToSurfaceUnsafe(
   SurfaceFrame::SubmitInfo submit_info;
   submit_info.frame_damage = damage.GetFrameDamage();
   submit_info.buffer_damage = damage.GetBufferDamage();
+  submit_info.frame_damage_rects = damage.GetFrameDamageRects();
+  submit_info.buffer_damage_rects = damage.GetBufferDamageRects();
   submit_info.target_time = frame_timings_recorder.GetVsyncTargetTime();
 
   frame->set_submit_info(submit_info);
@@ -582,6 +622,18 @@ RasterStatus Rasterizer::DrawToSurfaceUnsafe(
   }
 
   compositor_context_->raster_cache().CleanupAfterFrame();
+  if (compositor_context_->raster_cache().HasEvictedImages()) {
+    // Freeing the evicted images can take a while, so it is done once the
+    // frame has been submitted and the raster thread is idle.
+    delegate_.GetTaskRunners().GetRasterTaskRunner()->PostIdleTask(
+        [weak_this = weak_factory_.GetWeakPtr()](fml::TimePoint deadline) {
+          if (weak_this) {
+            weak_this->compositor_context_->raster_cache()
+                .ReleaseEvictedImages();
+          }
+        },
+        kEvictedImagesReleaseTimeout);
+  }
   frame_timings_recorder.RecordRasterEnd(&compositor_context_->raster_cache());
   FireNextFrameCallbackIfPresent();
 
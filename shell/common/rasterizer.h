@@ -24,6 +24,7 @@
 #include "flutter/fml/time/time_point.h"
 #include "flutter/lib/ui/snapshot_delegate.h"
 #include "flutter/shell/common/pipeline.h"
+#include "flutter/shell/common/pipeline_depth_controller.h"
 #include "flutter/shell/common/snapshot_surface_producer.h"
 
 namespace flutter {
@@ -447,6 +448,20 @@ class Rasterizer final : public SnapshotDelegate {
   ///
   void DisableThreadMergerIfNeeded();
 
+  //----------------------------------------------------------------------------
+  /// @brief      Sets whether the depth of the pipelines drawn by this
+  ///             rasterizer adapts to the build and raster times of the frames.
+  ///             When it does, the pipeline depth is lowered to a single frame
+  ///             in flight while frames fit in the frame budget, and raised
+  ///             back up to the depth the pipeline was created with when they
+  ///             don't.
+  ///
+  /// @see        `PipelineDepthController`
+  ///
+  /// @param[in]  enabled  Whether the pipeline depth adapts to frame times.
+  ///
+  void SetAdaptivePipelineDepth(bool enabled);
+
  private:
   // |SnapshotDelegate|
   sk_sp<SkImage> MakeRasterSnapshot(
@@ -499,6 +514,8 @@ class Rasterizer final : public SnapshotDelegate {
   std::optional<size_t> max_cache_bytes_;
   fml::RefPtr<fml::RasterThreadMerger> raster_thread_merger_;
   std::shared_ptr<ExternalViewEmbedder> external_view_embedder_;
+  PipelineDepthController pipeline_depth_controller_;
+  bool adaptive_pipeline_depth_ = false;
 
   // WeakPtrFactory must be the last member.
   fml::TaskRunnerAffineWeakPtrFactory<Rasterizer> weak_factory_;
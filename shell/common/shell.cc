@@ -5,6 +5,7 @@
 #define RAPIDJSON_HAS_STDSTRING 1
 #include "flutter/shell/common/shell.h"
 
+#include <algorithm>
 #include <memory>
 #include <sstream>
 #include <vector>
@@ -19,6 +20,7 @@
 #include "flutter/fml/make_copyable.h"
 #include "flutter/fml/message_loop.h"
 #include "flutter/fml/paths.h"
+#include "flutter/fml/task_queue_statistics.h"
 #include "flutter/fml/trace_event.h"
 #include "flutter/fml/unique_fd.h"
 #include "flutter/runtime/dart_vm.h"
@@ -40,6 +42,11 @@ constexpr char kSystemChannel[] = "flutter/system";
 constexpr char kTypeKey[] = "type";
 constexpr char kFontChange[] = "fontsChange";
 
+// Paths are marked non-volatile at the latest this long after a frame, if the
+// UI thread has no idle time before then.
+constexpr fml::TimeDelta kVolatilePathTrackerTimeout =
+    fml::TimeDelta::FromMilliseconds(100);
+
 namespace {
 
 std::unique_ptr<Engine> CreateEngine(
@@ -119,6 +126,10 @@ void PerformInitializationTasks(Settings& settings) {
   });
 
   PersistentCache::SetCacheSkSL(settings.cache_sksl);
+
+  if (settings.record_task_queue_statistics) {
+    fml::TaskQueueStatistics::SetRecordingEnabled(true);
+  }
 }
 
 }  // namespace
@@ -195,6 +206,16 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
   ]() {
         TRACE_EVENT0("flutter", "ShellSetupGPUSubsystem");
         std::unique_ptr<Rasterizer> rasterizer(on_create_rasterizer(*shell));
+        rasterizer->compositor_context()->raster_cache().SetMaxBytes(
+            shell->GetSettings().raster_cache_max_bytes);
+        rasterizer->SetAdaptivePipelineDepth(
+            shell->GetSettings().enable_adaptive_pipeline_depth);
+        if (shell->GetSettings().enable_concurrent_raster_cache) {
+          rasterizer->compositor_context()
+              ->raster_cache()
+              .SetConcurrentTaskRunner(
+                  shell->GetDartVM()->GetConcurrentWorkerTaskRunner());
+        }
         snapshot_delegate_promise.set_value(rasterizer->GetSnapshotDelegate());
         rasterizer_promise.set_value(std::move(rasterizer));
       });
@@ -257,16 +278,16 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
   auto engine_future = engine_promise.get_future();
   fml::TaskRunner::RunNowOrPostTask(
       shell->GetTaskRunners().GetUITaskRunner(),
-      fml::MakeCopyable([&engine_promise,                                 //
-                         shell = shell.get(),                             //
-                         &dispatcher_maker,                               //
-                         &platform_data,                                  //
-                         isolate_snapshot = std::move(isolate_snapshot),  //
-                         vsync_waiter = std::move(vsync_waiter),          //
-                         &weak_io_manager_future,                         //
-                         &snapshot_delegate_future,                       //
-                         &unref_queue_future,                             //
-                         &on_create_engine]() mutable {
+      [&engine_promise,                                 //
+       shell = shell.get(),                             //
+       &dispatcher_maker,                               //
+       &platform_data,                                  //
+       isolate_snapshot = std::move(isolate_snapshot),  //
+       vsync_waiter = std::move(vsync_waiter),          //
+       &weak_io_manager_future,                         //
+       &snapshot_delegate_future,                       //
+       &unref_queue_future,                             //
+       &on_create_engine]() mutable {
         TRACE_EVENT0("flutter", "ShellSetupUISubsystem");
         const auto& task_runners = shell->GetTaskRunners();
 
@@ -288,7 +309,7 @@ std::unique_ptr<Shell> Shell::CreateShellOnPlatformThread(
                              unref_queue_future.get(),        //
                              snapshot_delegate_future.get(),  //
                              shell->volatile_path_tracker_));
-      }));
+      });
 
   if (!shell->Setup(std::move(platform_view),  //
                     engine_future.get(),       //
@@ -327,31 +348,30 @@ std::unique_ptr<Shell> Shell::CreateWithSnapshot(
   std::unique_ptr<Shell> shell;
   fml::TaskRunner::RunNowOrPostTask(
       task_runners.GetPlatformTaskRunner(),
-      fml::MakeCopyable(
-          [&latch,                                                        //
-           &shell,                                                        //
-           parent_thread_merger,                                          //
-           task_runners = std::move(task_runners),                        //
-           platform_data = std::move(platform_data),                      //
-           settings = std::move(settings),                                //
-           vm = std::move(vm),                                            //
-           isolate_snapshot = std::move(isolate_snapshot),                //
-           on_create_platform_view = std::move(on_create_platform_view),  //
-           on_create_rasterizer = std::move(on_create_rasterizer),        //
-           on_create_engine = std::move(on_create_engine),
-           is_gpu_disabled]() mutable {
-            shell = CreateShellOnPlatformThread(
-                std::move(vm),                       //
-                parent_thread_merger,                //
-                std::move(task_runners),             //
-                std::move(platform_data),            //
-                std::move(settings),                 //
-                std::move(isolate_snapshot),         //
-                std::move(on_create_platform_view),  //
-                std::move(on_create_rasterizer),     //
-                std::move(on_create_engine), is_gpu_disabled);
-            latch.Signal();
-          }));
+      [&latch,                                                        //
+       &shell,                                                        //
+       parent_thread_merger,                                          //
+       task_runners = std::move(task_runners),                        //
+       platform_data = std::move(platform_data),                      //
+       settings = std::move(settings),                                //
+       vm = std::move(vm),                                            //
+       isolate_snapshot = std::move(isolate_snapshot),                //
+       on_create_platform_view = std::move(on_create_platform_view),  //
+       on_create_rasterizer = std::move(on_create_rasterizer),        //
+       on_create_engine = std::move(on_create_engine),
+       is_gpu_disabled]() mutable {
+        shell = CreateShellOnPlatformThread(
+            std::move(vm),                       //
+            parent_thread_merger,                //
+            std::move(task_runners),             //
+            std::move(platform_data),            //
+            std::move(settings),                 //
+            std::move(isolate_snapshot),         //
+            std::move(on_create_platform_view),  //
+            std::move(on_create_rasterizer),     //
+            std::move(on_create_engine), is_gpu_disabled);
+        latch.Signal();
+      });
   latch.Wait();
   return shell;
 }
@@ -380,10 +400,10 @@ Shell::Shell(DartVMRef vm,
   // need to wait on a latch because it can only ever be used from the raster
   // thread from this class, so we have ordering guarantees.
   fml::TaskRunner::RunNowOrPostTask(
-      task_runners_.GetRasterTaskRunner(), fml::MakeCopyable([this]() mutable {
+      task_runners_.GetRasterTaskRunner(), [this]() {
         this->weak_factory_gpu_ =
             std::make_unique<fml::TaskRunnerAffineWeakPtrFactory<Shell>>(this);
-      }));
+      });
 
   // Install service protocol handlers.
 
@@ -423,6 +443,11 @@ Shell::Shell(DartVMRef vm,
           task_runners_.GetRasterTaskRunner(),
           std::bind(&Shell::OnServiceProtocolEstimateRasterCacheMemory, this,
                     std::placeholders::_1, std::placeholders::_2)};
+  service_protocol_handlers_
+      [ServiceProtocol::kGetTaskQueueStatisticsExtensionName] = {
+          task_runners_.GetUITaskRunner(),
+          std::bind(&Shell::OnServiceProtocolGetTaskQueueStatistics, this,
+                    std::placeholders::_1, std::placeholders::_2)};
 }
 
 Shell::~Shell() {
@@ -435,33 +460,31 @@ Shell::~Shell() {
 
   fml::TaskRunner::RunNowOrPostTask(
       task_runners_.GetUITaskRunner(),
-      fml::MakeCopyable([this, &ui_latch]() mutable {
+      [this, &ui_latch]() {
         engine_.reset();
         ui_latch.Signal();
-      }));
+      });
   ui_latch.Wait();
 
   fml::TaskRunner::RunNowOrPostTask(
       task_runners_.GetRasterTaskRunner(),
-      fml::MakeCopyable(
-          [this, rasterizer = std::move(rasterizer_), &gpu_latch]() mutable {
-            rasterizer.reset();
-            this->weak_factory_gpu_.reset();
-            gpu_latch.Signal();
-          }));
+      [this, rasterizer = std::move(rasterizer_), &gpu_latch]() mutable {
+        rasterizer.reset();
+        this->weak_factory_gpu_.reset();
+        gpu_latch.Signal();
+      });
   gpu_latch.Wait();
 
   fml::TaskRunner::RunNowOrPostTask(
       task_runners_.GetIOTaskRunner(),
-      fml::MakeCopyable([io_manager = std::move(io_manager_),
-                         platform_view = platform_view_.get(),
-                         &io_latch]() mutable {
+      [io_manager = std::move(io_manager_),
+       platform_view = platform_view_.get(), &io_latch]() mutable {
         io_manager.reset();
         if (platform_view) {
           platform_view->ReleaseResourceContext();
         }
         io_latch.Signal();
-      }));
+      });
 
   io_latch.Wait();
 
@@ -470,11 +493,10 @@ Shell::~Shell() {
   // example, the NSOpenGLContext on the Mac.
   fml::TaskRunner::RunNowOrPostTask(
       task_runners_.GetPlatformTaskRunner(),
-      fml::MakeCopyable([platform_view = std::move(platform_view_),
-                         &platform_latch]() mutable {
+      [platform_view = std::move(platform_view_), &platform_latch]() mutable {
         platform_view.reset();
         platform_latch.Signal();
-      }));
+      });
   platform_latch.Wait();
 }
 
@@ -558,21 +580,20 @@ void Shell::RunEngine(
 
   fml::TaskRunner::RunNowOrPostTask(
       task_runners_.GetUITaskRunner(),
-      fml::MakeCopyable(
-          [run_configuration = std::move(run_configuration),
-           weak_engine = weak_engine_, result]() mutable {
-            if (!weak_engine) {
-              FML_LOG(ERROR)
-                  << "Could not launch engine with configuration - no engine.";
-              result(Engine::RunStatus::Failure);
-              return;
-            }
-            auto run_result = weak_engine->Run(std::move(run_configuration));
-            if (run_result == flutter::Engine::RunStatus::Failure) {
-              FML_LOG(ERROR) << "Could not launch engine with configuration.";
-            }
-            result(run_result);
-          }));
+      [run_configuration = std::move(run_configuration),
+       weak_engine = weak_engine_, result]() mutable {
+        if (!weak_engine) {
+          FML_LOG(ERROR)
+              << "Could not launch engine with configuration - no engine.";
+          result(Engine::RunStatus::Failure);
+          return;
+        }
+        auto run_result = weak_engine->Run(std::move(run_configuration));
+        if (run_result == flutter::Engine::RunStatus::Failure) {
+          FML_LOG(ERROR) << "Could not launch engine with configuration.";
+        }
+        result(run_result);
+      });
 }
 
 std::optional<DartErrorCode> Shell::GetUIIsolateLastError() const {
@@ -917,12 +938,12 @@ void Shell::OnPlatformViewDispatchPlatformMessage(
   FML_DCHECK(is_setup_);
   FML_DCHECK(task_runners_.GetPlatformTaskRunner()->RunsTasksOnCurrentThread());
 
-  task_runners_.GetUITaskRunner()->PostTask(fml::MakeCopyable(
+  task_runners_.GetUITaskRunner()->PostTask(
       [engine = engine_->GetWeakPtr(), message = std::move(message)]() mutable {
         if (engine) {
           engine->DispatchPlatformMessage(std::move(message));
         }
-      }));
+      });
 }
 
 // |PlatformView::Delegate|
@@ -933,12 +954,12 @@ void Shell::OnPlatformViewDispatchPointerDataPacket(
   FML_DCHECK(is_setup_);
   FML_DCHECK(task_runners_.GetPlatformTaskRunner()->RunsTasksOnCurrentThread());
   task_runners_.GetUITaskRunner()->PostTask(
-      fml::MakeCopyable([engine = weak_engine_, packet = std::move(packet),
-                         flow_id = next_pointer_flow_id_]() mutable {
+      [engine = weak_engine_, packet = std::move(packet),
+       flow_id = next_pointer_flow_id_]() mutable {
         if (engine) {
           engine->DispatchPointerDataPacket(std::move(packet), flow_id);
         }
-      }));
+      });
   next_pointer_flow_id_++;
 }
 
@@ -950,12 +971,12 @@ void Shell::OnPlatformViewDispatchSemanticsAction(int32_t id,
   FML_DCHECK(task_runners_.GetPlatformTaskRunner()->RunsTasksOnCurrentThread());
 
   task_runners_.GetUITaskRunner()->PostTask(
-      fml::MakeCopyable([engine = engine_->GetWeakPtr(), id, action,
-                         args = std::move(args)]() mutable {
+      [engine = engine_->GetWeakPtr(), id, action,
+       args = std::move(args)]() mutable {
         if (engine) {
           engine->DispatchSemanticsAction(id, action, std::move(args));
         }
-      }));
+      });
 }
 
 // |PlatformView::Delegate|
@@ -1082,8 +1103,30 @@ void Shell::OnAnimatorNotifyIdle(int64_t deadline) {
 
   if (engine_) {
     engine_->NotifyIdle(deadline);
-    volatile_path_tracker_->OnFrame();
+    // One idle task reports all the frames drawn until it runs.
+    if ((*volatile_path_tracker_pending_frames_)++ == 0) {
+      task_runners_.GetUITaskRunner()->PostIdleTask(
+          [tracker = volatile_path_tracker_,
+           pending_frames = volatile_path_tracker_pending_frames_](
+              fml::TimePoint idle_deadline) {
+            // Paths are no longer volatile after |kFramesOfVolatility|
+            // frames, so reporting more than that changes nothing.
+            const int frames = std::min(
+                *pending_frames, VolatilePathTracker::kFramesOfVolatility);
+            *pending_frames = 0;
+            for (int i = 0; i < frames; i++) {
+              tracker->OnFrame();
+            }
+          },
+          kVolatilePathTrackerTimeout);
+    }
   }
+
+  // |deadline| is on the Dart timeline clock.
+  const fml::TimeDelta time_until_deadline =
+      fml::TimeDelta::FromMicroseconds(deadline - Dart_TimelineGetMicros());
+  task_runners_.GetUITaskRunner()->RunIdleTasksUntil(fml::TimePoint::Now() +
+                                                     time_until_deadline);
 }
 
 // |Animator::Delegate|
@@ -1110,7 +1153,7 @@ void Shell::OnAnimatorDraw(
            tree.frame_size() != expected_frame_size_;
   };
 
-  task_runners_.GetRasterTaskRunner()->PostTask(fml::MakeCopyable(
+  auto task =
       [&waiting_for_first_frame = waiting_for_first_frame_,
        &waiting_for_first_frame_condition = waiting_for_first_frame_condition_,
        rasterizer = rasterizer_->GetWeakPtr(),
@@ -1129,7 +1172,13 @@ void Shell::OnAnimatorDraw(
             waiting_for_first_frame_condition.notify_all();
           }
         }
-      }));
+      };
+
+  // Drawing may run ahead of raster tasks posted before it at a lower
+  // priority. Those come from other threads, or are snapshots that do not
+  // depend on the frame, so their order relative to it was never fixed.
+  task_runners_.GetRasterTaskRunner()->PostTaskWithPriority(
+      std::move(task), fml::TaskPriority::kFrameCritical);
 }
 
 // |Animator::Delegate|
@@ -1137,15 +1186,16 @@ void Shell::OnAnimatorDrawLastLayerTree(
     std::unique_ptr<FrameTimingsRecorder> frame_timings_recorder) {
   FML_DCHECK(is_setup_);
 
-  auto task = fml::MakeCopyable(
+  auto task =
       [rasterizer = rasterizer_->GetWeakPtr(),
        frame_timings_recorder = std::move(frame_timings_recorder)]() mutable {
         if (rasterizer) {
           rasterizer->DrawLastLayerTree(std::move(frame_timings_recorder));
         }
-      });
+      };
 
-  task_runners_.GetRasterTaskRunner()->PostTask(task);
+  task_runners_.GetRasterTaskRunner()->PostTaskWithPriority(
+      std::move(task), fml::TaskPriority::kFrameCritical);
 }
 
 // |Engine::Delegate|
@@ -1178,12 +1228,12 @@ void Shell::OnEngineHandlePlatformMessage(
     platform_message_handler_->HandlePlatformMessage(std::move(message));
   } else {
     task_runners_.GetPlatformTaskRunner()->PostTask(
-        fml::MakeCopyable([view = platform_view_->GetWeakPtr(),
-                           message = std::move(message)]() mutable {
+        [view = platform_view_->GetWeakPtr(),
+         message = std::move(message)]() mutable {
           if (view) {
             view->HandlePlatformMessage(std::move(message));
           }
-        }));
+        });
   }
 }
 
@@ -1280,7 +1330,7 @@ void Shell::LoadDartDeferredLibrary(
     intptr_t loading_unit_id,
     std::unique_ptr<const fml::Mapping> snapshot_data,
     std::unique_ptr<const fml::Mapping> snapshot_instructions) {
-  task_runners_.GetUITaskRunner()->PostTask(fml::MakeCopyable(
+  task_runners_.GetUITaskRunner()->PostTask(
       [engine = engine_->GetWeakPtr(), loading_unit_id,
        data = std::move(snapshot_data),
        instructions = std::move(snapshot_instructions)]() mutable {
@@ -1288,7 +1338,7 @@ void Shell::LoadDartDeferredLibrary(
           engine->LoadDartDeferredLibrary(loading_unit_id, std::move(data),
                                           std::move(instructions));
         }
-      }));
+      });
 }
 
 void Shell::LoadDartDeferredLibraryError(intptr_t loading_unit_id,
@@ -1688,6 +1738,64 @@ bool Shell::OnServiceProtocolEstimateRasterCacheMemory(
   return true;
 }
 
+static rapidjson::Value DurationHistogramToJSON(
+    const fml::DurationHistogram& histogram,
+    rapidjson::Document::AllocatorType& allocator) {
+  const auto snapshot = histogram.GetSnapshot();
+  rapidjson::Value value(rapidjson::kObjectType);
+  value.AddMember<uint64_t>("count", snapshot.count, allocator);
+  value.AddMember<int64_t>("totalMicros", snapshot.total_micros, allocator);
+  value.AddMember<int64_t>("maxMicros", snapshot.max_micros, allocator);
+  value.AddMember<int64_t>("p50Micros",
+                           snapshot.Percentile(50).ToMicroseconds(), allocator);
+  value.AddMember<int64_t>("p90Micros",
+                           snapshot.Percentile(90).ToMicroseconds(), allocator);
+  value.AddMember<int64_t>("p99Micros",
+                           snapshot.Percentile(99).ToMicroseconds(), allocator);
+  rapidjson::Value buckets(rapidjson::kArrayType);
+  for (uint64_t bucket : snapshot.buckets) {
+    buckets.PushBack(bucket, allocator);
+  }
+  value.AddMember("buckets", buckets, allocator);
+  return value;
+}
+
+bool Shell::OnServiceProtocolGetTaskQueueStatistics(
+    const ServiceProtocol::Handler::ServiceProtocolMap& params,
+    rapidjson::Document* response) {
+  FML_DCHECK(task_runners_.GetUITaskRunner()->RunsTasksOnCurrentThread());
+  auto& allocator = response->GetAllocator();
+  response->SetObject();
+  response->AddMember("type", "TaskQueueStatistics", allocator);
+  response->AddMember("recording",
+                      fml::TaskQueueStatistics::IsRecordingEnabled(),
+                      allocator);
+  const std::pair<const char*, fml::RefPtr<fml::TaskRunner>> task_runners[] = {
+      {"platform", task_runners_.GetPlatformTaskRunner()},
+      {"ui", task_runners_.GetUITaskRunner()},
+      {"raster", task_runners_.GetRasterTaskRunner()},
+      {"io", task_runners_.GetIOTaskRunner()},
+  };
+  for (const auto& [name, task_runner] : task_runners) {
+    // Task runners provided by embedders don't run their tasks on an
+    // fml::MessageLoop, so there is nothing to report for them.
+    const fml::TaskQueueStatistics* statistics =
+        task_runner ? task_runner->GetTaskQueueStatistics() : nullptr;
+    if (!statistics) {
+      continue;
+    }
+    rapidjson::Value queue_latency =
+        DurationHistogramToJSON(statistics->queue_latency(), allocator);
+    rapidjson::Value run_duration =
+        DurationHistogramToJSON(statistics->run_duration(), allocator);
+    rapidjson::Value queue(rapidjson::kObjectType);
+    queue.AddMember("queueLatency", queue_latency, allocator);
+    queue.AddMember("runDuration", run_duration, allocator);
+    response->AddMember(rapidjson::StringRef(name), queue, allocator);
+  }
+  return true;
+}
+
 // Service protocol handler
 bool Shell::OnServiceProtocolSetAssetBundlePath(
     const ServiceProtocol::Handler::ServiceProtocolMap& params,
@@ -418,6 +418,10 @@ class Shell final : public PlatformView::Delegate,
   std::unique_ptr<ShellIOManager> io_manager_;   // on IO task runner
   std::shared_ptr<fml::SyncSwitch> is_gpu_disabled_sync_switch_;
   std::shared_ptr<VolatilePathTracker> volatile_path_tracker_;
+  // The frames not yet reported to |volatile_path_tracker_|, shared with the
+  // idle task that reports them. Only accessed on the UI task runner.
+  std::shared_ptr<int> volatile_path_tracker_pending_frames_ =
+      std::make_shared<int>(0);
   std::shared_ptr<PlatformMessageHandler> platform_message_handler_;
 
   fml::WeakPtr<Engine> weak_engine_;  // to be shared across threads
@@ -679,6 +683,15 @@ class Shell final : public PlatformView::Delegate,
       const ServiceProtocol::Handler::ServiceProtocolMap& params,
       rapidjson::Document* response);
 
+  // Service protocol handler
+  //
+  // Returns histograms of how long tasks waited and ran on each of the
+  // shell's task runners. They are only recorded while
+  // |Settings::record_task_queue_statistics| is set.
+  bool OnServiceProtocolGetTaskQueueStatistics(
+      const ServiceProtocol::Handler::ServiceProtocolMap& params,
+      rapidjson::Document* response);
+
   // Creates an asset bundle from the original settings asset path or
   // directory.
   std::unique_ptr<DirectoryAssetBundle> RestoreOriginalAssetResolver();
@@ -268,6 +268,9 @@ void ShellTest::OnServiceProtocol(
           case ServiceProtocolEnum::kRunInView:
             shell->OnServiceProtocolRunInView(params, response);
             break;
+          case ServiceProtocolEnum::kGetTaskQueueStatistics:
+            shell->OnServiceProtocolGetTaskQueueStatistics(params, response);
+            break;
         }
         finished.set_value(true);
       });
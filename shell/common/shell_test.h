@@ -105,6 +105,7 @@ class ShellTest : public FixtureTest {
     kEstimateRasterCacheMemory,
     kSetAssetBundlePath,
     kRunInView,
+    kGetTaskQueueStatistics,
   };
 
   // Helper method to test private method Shell::OnServiceProtocolGetSkSLs.
@@ -23,6 +23,7 @@
 #include "flutter/fml/message_loop.h"
 #include "flutter/fml/synchronization/count_down_latch.h"
 #include "flutter/fml/synchronization/waitable_event.h"
+#include "flutter/fml/task_queue_statistics.h"
 #include "flutter/runtime/dart_vm.h"
 #include "flutter/shell/common/platform_view.h"
 #include "flutter/shell/common/rasterizer.h"
@@ -2305,6 +2306,34 @@ TEST_F(ShellTest, OnServiceProtocolEstimateRasterCacheMemoryWorks) {
   DestroyShell(std::move(shell));
 }
 
+TEST_F(ShellTest, OnServiceProtocolGetTaskQueueStatisticsWorks) {
+  Settings settings = CreateSettingsForFixture();
+  settings.record_task_queue_statistics = true;
+  std::unique_ptr<Shell> shell = CreateShell(settings);
+
+  fml::AutoResetWaitableEvent latch;
+  shell->GetTaskRunners().GetUITaskRunner()->PostTask(
+      [&latch]() { latch.Signal(); });
+  latch.Wait();
+
+  ServiceProtocol::Handler::ServiceProtocolMap empty_params;
+  rapidjson::Document document;
+  OnServiceProtocol(shell.get(), ServiceProtocolEnum::kGetTaskQueueStatistics,
+                    shell->GetTaskRunners().GetUITaskRunner(), empty_params,
+                    &document);
+  ASSERT_TRUE(document.IsObject());
+  EXPECT_STREQ(document["type"].GetString(), "TaskQueueStatistics");
+  EXPECT_TRUE(document["recording"].GetBool());
+  const auto& ui_statistics = document["ui"];
+  EXPECT_GT(ui_statistics["queueLatency"]["count"].GetUint64(), 0u);
+  EXPECT_GT(ui_statistics["runDuration"]["count"].GetUint64(), 0u);
+  EXPECT_EQ(ui_statistics["runDuration"]["buckets"].Size(),
+            fml::DurationHistogram::kBucketCount);
+
+  DestroyShell(std::move(shell));
+  fml::TaskQueueStatistics::SetRecordingEnabled(false);
+}
+
 TEST_F(ShellTest, DiscardLayerTreeOnResize) {
   auto settings = CreateSettingsForFixture();
 
@@ -290,6 +290,12 @@ Settings SettingsFromCommandLine(const fml::CommandLine& command_line) {
   settings.enable_software_rendering =
       command_line.HasOption(FlagForSwitch(Switch::EnableSoftwareRendering));
 
+  settings.enable_concurrent_raster_cache = command_line.HasOption(
+      FlagForSwitch(Switch::EnableConcurrentRasterCache));
+
+  settings.enable_adaptive_pipeline_depth = command_line.HasOption(
+      FlagForSwitch(Switch::EnableAdaptivePipelineDepth));
+
   settings.endless_trace_buffer =
       command_line.HasOption(FlagForSwitch(Switch::EndlessTraceBuffer));
 
@@ -322,6 +328,9 @@ Settings SettingsFromCommandLine(const fml::CommandLine& command_line) {
   settings.trace_systrace =
       command_line.HasOption(FlagForSwitch(Switch::TraceSystrace));
 
+  settings.record_task_queue_statistics =
+      command_line.HasOption(FlagForSwitch(Switch::RecordTaskQueueStatistics));
+
   settings.skia_deterministic_rendering_on_cpu =
       command_line.HasOption(FlagForSwitch(Switch::SkiaDeterministicRendering));
 
@@ -451,6 +460,23 @@ Settings SettingsFromCommandLine(const fml::CommandLine& command_line) {
                                 &old_gen_heap_size);
     settings.old_gen_heap_size = std::stoi(old_gen_heap_size);
   }
+
+  if (command_line.HasOption(FlagForSwitch(Switch::RasterCacheMaxBytes))) {
+    std::string raster_cache_max_bytes;
+    command_line.GetOptionValue(FlagForSwitch(Switch::RasterCacheMaxBytes),
+                                &raster_cache_max_bytes);
+    settings.raster_cache_max_bytes = std::stoull(raster_cache_max_bytes);
+  }
+
+  if (command_line.HasOption(
+          FlagForSwitch(Switch::ImageDecoderCacheMaxBytes))) {
+    std::string image_decoder_cache_max_bytes;
+    command_line.GetOptionValue(
+        FlagForSwitch(Switch::ImageDecoderCacheMaxBytes),
+        &image_decoder_cache_max_bytes);
+    settings.image_decoder_cache_max_bytes =
+        std::stoull(image_decoder_cache_max_bytes);
+  }
   return settings;
 }
 
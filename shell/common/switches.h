@@ -105,6 +105,28 @@ DEF_SWITCH(EnableSoftwareRendering,
            "Enable rendering using the Skia software backend. This is useful "
            "when testing Flutter on emulators. By default, Flutter will "
            "attempt to either use OpenGL, Metal, or Vulkan.")
+DEF_SWITCH(EnableConcurrentRasterCache,
+           "enable-concurrent-raster-cache",
+           "Rasterize new raster cache entries on the concurrent worker pool "
+           "instead of the raster thread when using the Skia software "
+           "backend.")
+DEF_SWITCH(EnableAdaptivePipelineDepth,
+           "enable-adaptive-pipeline-depth",
+           "Choose between one and two frames in flight between the UI and "
+           "raster threads from the measured build and raster times, "
+           "favoring latency when both fit in a frame.")
+DEF_SWITCH(RasterCacheMaxBytes,
+           "raster-cache-max-bytes",
+           "The maximum number of bytes of images held by the raster cache. "
+           "Entries that are cheapest to re-rasterize relative to their size "
+           "are evicted first when the budget is exceeded. Defaults to no "
+           "limit.")
+DEF_SWITCH(ImageDecoderCacheMaxBytes,
+           "image-decoder-cache-max-bytes",
+           "The maximum number of bytes of decoded images kept by the image "
+           "decoder, so that decoding the same bytes to the same size again "
+           "reuses the previous result. The least recently used images are "
+           "evicted first. Defaults to 0, which disables the cache.")
 DEF_SWITCH(SkiaDeterministicRendering,
            "skia-deterministic-rendering",
            "Skips the call to SkGraphics::Init(), thus avoiding swapping out "
@@ -166,6 +188,11 @@ DEF_SWITCH(
     "Trace to the system tracer (instead of the timeline) on platforms where "
     "such a tracer is available. Currently only supported on Android and "
     "Fuchsia.")
+DEF_SWITCH(RecordTaskQueueStatistics,
+           "record-task-queue-statistics",
+           "Record histograms of how long tasks wait in the queues of the "
+           "engine's threads and how long they run. These are available "
+           "through the service protocol.")
 DEF_SWITCH(UseTestFonts,
            "use-test-fonts",
            "Running tests that layout and measure text will not yield "
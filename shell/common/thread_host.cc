@@ -4,33 +4,47 @@
 
 #include "flutter/shell/common/thread_host.h"
 
-namespace flutter {
+#include <utility>
 
-ThreadHost::ThreadHost() = default;
+namespace flutter {
 
-ThreadHost::ThreadHost(ThreadHost&&) = default;
+namespace {
 
-ThreadHost::ThreadHost(std::string name_prefix_arg, uint64_t mask)
-    : name_prefix(name_prefix_arg) {
-  if (mask & ThreadHost::Type::Platform) {
-    platform_thread = std::make_unique<fml::Thread>(name_prefix + ".platform");
+std::unique_ptr<fml::Thread> CreateThread(
+    const ThreadHost::ThreadHostConfig& host_config,
+    ThreadHost::Type type,
+    const char* suffix) {
+  if (!(host_config.type_mask & type)) {
+    return nullptr;
   }
-
-  if (mask & ThreadHost::Type::UI) {
-    ui_thread = std::make_unique<fml::Thread>(name_prefix + ".ui");
+  fml::Thread::ThreadConfig config;
+  auto found = host_config.type_configs.find(type);
+  if (found != host_config.type_configs.end()) {
+    config = found->second;
   }
-
-  if (mask & ThreadHost::Type::RASTER) {
-    raster_thread = std::make_unique<fml::Thread>(name_prefix + ".raster");
+  if (config.name.empty()) {
+    config.name = host_config.name_prefix + suffix;
   }
+  return std::make_unique<fml::Thread>(config);
+}
 
-  if (mask & ThreadHost::Type::IO) {
-    io_thread = std::make_unique<fml::Thread>(name_prefix + ".io");
-  }
+}  // namespace
 
-  if (mask & ThreadHost::Type::Profiler) {
-    profiler_thread = std::make_unique<fml::Thread>(name_prefix + ".profiler");
-  }
+ThreadHost::ThreadHost() = default;
+
+ThreadHost::ThreadHost(ThreadHost&&) = default;
+
+ThreadHost::ThreadHost(std::string name_prefix_arg, uint64_t mask)
+    : ThreadHost(ThreadHostConfig{.name_prefix = std::move(name_prefix_arg),
+                                  .type_mask = mask}) {}
+
+ThreadHost::ThreadHost(const ThreadHostConfig& config)
+    : name_prefix(config.name_prefix) {
+  platform_thread = CreateThread(config, Type::Platform, ".platform");
+  ui_thread = CreateThread(config, Type::UI, ".ui");
+  raster_thread = CreateThread(config, Type::RASTER, ".raster");
+  io_thread = CreateThread(config, Type::IO, ".io");
+  profiler_thread = CreateThread(config, Type::Profiler, ".profiler");
 }
 
 ThreadHost::~ThreadHost() = default;
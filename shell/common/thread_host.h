@@ -5,7 +5,9 @@
 #ifndef FLUTTER_SHELL_COMMON_THREAD_HOST_H_
 #define FLUTTER_SHELL_COMMON_THREAD_HOST_H_
 
+#include <map>
 #include <memory>
+#include <string>
 
 #include "flutter/fml/macros.h"
 #include "flutter/fml/thread.h"
@@ -22,6 +24,16 @@ struct ThreadHost {
     Profiler = 1 << 4,
   };
 
+  /// The threads to create and how to configure each of them.
+  struct ThreadHostConfig {
+    std::string name_prefix;
+    uint64_t type_mask = 0;
+    /// The configuration of the threads of each type. Threads without one,
+    /// or whose configuration has no name, are named after the prefix and
+    /// their type (for example, "io.flutter.ui").
+    std::map<Type, fml::Thread::ThreadConfig> type_configs;
+  };
+
   std::string name_prefix;
   std::unique_ptr<fml::Thread> platform_thread;
   std::unique_ptr<fml::Thread> ui_thread;
@@ -37,6 +49,8 @@ struct ThreadHost {
 
   ThreadHost(std::string name_prefix, uint64_t type_mask);
 
+  explicit ThreadHost(const ThreadHostConfig& config);
+
   ~ThreadHost();
 };
 
@@ -100,7 +100,7 @@ void VsyncWaiter::FireCallback(fml::TimePoint frame_start_time,
   FML_DCHECK(fml::TimePoint::Now() >= frame_start_time);
 
   Callback callback;
-  std::vector<fml::closure> secondary_callbacks;
+  std::vector<fml::UniqueClosure> secondary_callbacks;
 
   {
     std::scoped_lock lock(callback_mutex_);
@@ -136,9 +136,13 @@ void VsyncWaiter::FireCallback(fml::TimePoint frame_start_time,
     fml::TaskQueueId ui_task_queue_id =
         task_runners_.GetUITaskRunner()->GetTaskQueueId();
 
-    task_runners_.GetUITaskRunner()->PostTask(
-        [ui_task_queue_id, callback, flow_identifier, frame_start_time,
-         frame_target_time, pause_secondary_tasks]() {
+    // The frame is due by its target time, so it runs ahead of bulk work
+    // such as platform messages that is already queued on the UI thread.
+    // They run right after it. Nothing the frame does depends on them having
+    // run, as the vsync could as well have fired before they were posted.
+    task_runners_.GetUITaskRunner()->PostTaskWithPriority(
+        [ui_task_queue_id, callback = std::move(callback), flow_identifier,
+         frame_start_time, frame_target_time, pause_secondary_tasks]() {
           FML_TRACE_EVENT("flutter", kVsyncTraceName, "StartTime",
                           frame_start_time, "TargetTime", frame_target_time);
           std::unique_ptr<FrameTimingsRecorder> frame_timings_recorder =
@@ -150,13 +154,13 @@ void VsyncWaiter::FireCallback(fml::TimePoint frame_start_time,
           if (pause_secondary_tasks) {
             ResumeDartMicroTasks(ui_task_queue_id);
           }
-        });
+        },
+        fml::TaskPriority::kFrameCritical, frame_target_time);
   }
 
-  for (auto& secondary_callback : secondary_callbacks) {
-    task_runners_.GetUITaskRunner()->PostTaskForTime(
-        std::move(secondary_callback), frame_start_time);
-  }
+  // Posted together so that the UI thread is woken up once for all of them.
+  task_runners_.GetUITaskRunner()->PostTasksForTime(
+      std::move(secondary_callbacks), frame_start_time);
 }
 
 void VsyncWaiter::PauseDartMicroTasks() {
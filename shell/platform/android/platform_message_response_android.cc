@@ -4,7 +4,6 @@
 
 #include "flutter/shell/platform/android/platform_message_response_android.h"
 
-#include "flutter/fml/make_copyable.h"
 #include "flutter/shell/platform/android/jni/platform_view_android_jni.h"
 
 namespace flutter {
@@ -23,23 +22,23 @@ PlatformMessageResponseAndroid::~PlatformMessageResponseAndroid() = default;
 void PlatformMessageResponseAndroid::Complete(
     std::unique_ptr<fml::Mapping> data) {
   platform_task_runner_->PostTask(
-      fml::MakeCopyable([response_id = response_id_,  //
-                         data = std::move(data),      //
-                         jni_facade = jni_facade_]() mutable {
+      [response_id = response_id_,  //
+       data = std::move(data),      //
+       jni_facade = jni_facade_]() mutable {
         jni_facade->FlutterViewHandlePlatformMessageResponse(response_id,
                                                              std::move(data));
-      }));
+      });
 }
 
 // |flutter::PlatformMessageResponse|
 void PlatformMessageResponseAndroid::CompleteEmpty() {
   platform_task_runner_->PostTask(
-      fml::MakeCopyable([response_id = response_id_,  //
-                         jni_facade = jni_facade_     //
+      [response_id = response_id_,  //
+       jni_facade = jni_facade_     //
   ]() {
         // Make the response call into Java.
         jni_facade->FlutterViewHandlePlatformMessageResponse(response_id,
                                                              nullptr);
-      }));
+      });
 }
 }  // namespace flutter
@@ -16,15 +16,14 @@ PlatformMessageResponseDarwin::~PlatformMessageResponseDarwin() = default;
 
 void PlatformMessageResponseDarwin::Complete(std::unique_ptr<fml::Mapping> data) {
   fml::RefPtr<PlatformMessageResponseDarwin> self(this);
-  platform_task_runner_->PostTask(fml::MakeCopyable([self, data = std::move(data)]() mutable {
+  platform_task_runner_->PostTask([self, data = std::move(data)]() mutable {
     self->callback_.get()(CopyMappingPtrToNSData(std::move(data)));
-  }));
+  });
 }
 
 void PlatformMessageResponseDarwin::CompleteEmpty() {
   fml::RefPtr<PlatformMessageResponseDarwin> self(this);
-  platform_task_runner_->PostTask(
-      fml::MakeCopyable([self]() mutable { self->callback_.get()(nil); }));
+  platform_task_runner_->PostTask([self]() { self->callback_.get()(nil); });
 }
 
 }  // namespace flutter
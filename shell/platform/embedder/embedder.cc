@@ -43,6 +43,7 @@ extern const intptr_t kPlatformStrongDillSize;
 #include "flutter/fml/make_copyable.h"
 #include "flutter/fml/message_loop.h"
 #include "flutter/fml/paths.h"
+#include "flutter/fml/task_queue_statistics.h"
 #include "flutter/fml/trace_event.h"
 #include "flutter/shell/common/rasterizer.h"
 #include "flutter/shell/common/switches.h"
@@ -990,6 +991,8 @@ FlutterEngineResult FlutterEngineInitialize(size_t version,
   settings.assets_path = args->assets_path;
   settings.leak_vm = !SAFE_ACCESS(args, shutdown_dart_vm_when_done, false);
   settings.old_gen_heap_size = SAFE_ACCESS(args, dart_old_gen_heap_size, -1);
+  settings.raster_cache_max_bytes =
+      SAFE_ACCESS(args, raster_cache_max_bytes, 0);
 
   if (!flutter::DartVM::IsRunningPrecompiledCode()) {
     // Verify the assets path contains Dart 2 kernel assets.
@@ -2357,6 +2360,65 @@ FlutterEngineResult FlutterEngineNotifyDisplayUpdate(
   }
 }
 
+static void CopyDurationHistogram(const fml::DurationHistogram& histogram,
+                                  FlutterTaskDurationHistogram* out) {
+  static_assert(FLUTTER_TASK_DURATION_HISTOGRAM_BUCKET_COUNT ==
+                fml::DurationHistogram::kBucketCount);
+  const auto snapshot = histogram.GetSnapshot();
+  out->count = snapshot.count;
+  out->total_micros = snapshot.total_micros;
+  out->max_micros = snapshot.max_micros;
+  for (size_t i = 0; i < snapshot.buckets.size(); i++) {
+    out->buckets[i] = snapshot.buckets[i];
+  }
+}
+
+FlutterEngineResult FlutterEngineGetTaskQueueStatistics(
+    FLUTTER_API_SYMBOL(FlutterEngine) raw_engine,
+    FlutterNativeThreadType thread_type,
+    FlutterTaskQueueStatistics* statistics) {
+  auto engine = reinterpret_cast<flutter::EmbedderEngine*>(raw_engine);
+  if (engine == nullptr || !engine->IsValid()) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Engine was invalid.");
+  }
+
+  if (statistics == nullptr || !STRUCT_HAS_MEMBER(statistics, run_duration)) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "Invalid task queue statistics specified.");
+  }
+
+  const auto& task_runners = engine->GetTaskRunners();
+  fml::RefPtr<fml::TaskRunner> task_runner;
+  switch (thread_type) {
+    case kFlutterNativeThreadTypePlatform:
+      task_runner = task_runners.GetPlatformTaskRunner();
+      break;
+    case kFlutterNativeThreadTypeRender:
+      task_runner = task_runners.GetRasterTaskRunner();
+      break;
+    case kFlutterNativeThreadTypeUI:
+      task_runner = task_runners.GetUITaskRunner();
+      break;
+    default:
+      return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                                "Unsupported thread type specified.");
+  }
+
+  const fml::TaskQueueStatistics* task_queue_statistics =
+      task_runner ? task_runner->GetTaskQueueStatistics() : nullptr;
+  if (task_queue_statistics == nullptr) {
+    return LOG_EMBEDDER_ERROR(
+        kInvalidArguments,
+        "The task runner of the thread was provided by the embedder.");
+  }
+
+  CopyDurationHistogram(task_queue_statistics->queue_latency(),
+                        &statistics->queue_latency);
+  CopyDurationHistogram(task_queue_statistics->run_duration(),
+                        &statistics->run_duration);
+  return kSuccess;
+}
+
 FlutterEngineResult FlutterEngineGetProcAddresses(
     FlutterEngineProcTable* table) {
   if (!table) {
@@ -2407,6 +2469,7 @@ FlutterEngineResult FlutterEngineGetProcAddresses(
   SET_PROC(PostCallbackOnAllNativeThreads,
            FlutterEnginePostCallbackOnAllNativeThreads);
   SET_PROC(NotifyDisplayUpdate, FlutterEngineNotifyDisplayUpdate);
+  SET_PROC(GetTaskQueueStatistics, FlutterEngineGetTaskQueueStatistics);
 #undef SET_PROC
 
   return kSuccess;
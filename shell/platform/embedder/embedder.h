@@ -933,6 +933,40 @@ typedef struct {
   size_t identifier;
 } FlutterTaskRunnerDescription;
 
+/// The kind of cores an engine managed thread should run on. Many SoCs pair
+/// fast "big" cores with slower, more power efficient "little" ones. If all the
+/// cores of the system run at the same speed, this is ignored.
+typedef enum {
+  /// The thread may run on any core.
+  kFlutterCpuAffinityAny,
+  /// The thread may only run on the fastest cores.
+  kFlutterCpuAffinityPerformance,
+  /// The thread may only run on the slowest cores.
+  kFlutterCpuAffinityEfficiency,
+  /// The thread may run on any core but the fastest ones.
+  kFlutterCpuAffinityNotPerformance,
+} FlutterCpuAffinity;
+
+/// Scheduling hints for a thread created and managed by the engine. These are
+/// currently only applied on Linux and Android, where they require the
+/// appropriate privileges. Hints that cannot be applied are logged and
+/// otherwise ignored.
+typedef struct {
+  /// The size of this struct. Must be sizeof(FlutterThreadSchedulingConfig).
+  size_t struct_size;
+  /// The cores the thread may run on, with bit i set for core i. Zero means
+  /// that the thread may run on any core.
+  uint64_t cpu_mask;
+  /// Further restricts the cores the thread may run on. If the `cpu_mask`
+  /// has no core of this kind, the `cpu_mask` is used as is.
+  FlutterCpuAffinity cpu_affinity;
+  /// The nice value of the thread, in [-20, 19]. Zero leaves it unchanged.
+  int32_t nice;
+  /// If positive, the thread is scheduled with the real-time `SCHED_FIFO`
+  /// policy at this priority, in [1, 99]. Zero leaves the policy unchanged.
+  int32_t realtime_priority;
+} FlutterThreadSchedulingConfig;
+
 typedef struct {
   /// The size of this struct. Must be sizeof(FlutterCustomTaskRunners).
   size_t struct_size;
@@ -946,6 +980,14 @@ typedef struct {
   /// and platform task runners. This makes the Flutter engine use the same
   /// thread for both task runners.
   const FlutterTaskRunnerDescription* render_task_runner;
+  /// Optional scheduling hints for the engine managed UI thread.
+  const FlutterThreadSchedulingConfig* ui_thread_config;
+  /// Optional scheduling hints for the raster thread. These are only used if
+  /// the engine creates that thread, that is, if no `render_task_runner` is
+  /// specified.
+  const FlutterThreadSchedulingConfig* raster_thread_config;
+  /// Optional scheduling hints for the engine managed IO thread.
+  const FlutterThreadSchedulingConfig* io_thread_config;
 } FlutterCustomTaskRunners;
 
 typedef struct {
@@ -1315,6 +1357,34 @@ typedef enum {
 typedef void (*FlutterNativeThreadCallback)(FlutterNativeThreadType type,
                                             void* user_data);
 
+/// The number of buckets of a `FlutterTaskDurationHistogram`.
+#define FLUTTER_TASK_DURATION_HISTOGRAM_BUCKET_COUNT 24
+
+/// A histogram of task durations with power of two buckets.
+typedef struct {
+  /// The number of recorded durations.
+  uint64_t count;
+  /// The sum of the recorded durations in microseconds.
+  int64_t total_micros;
+  /// The longest recorded duration in microseconds.
+  int64_t max_micros;
+  /// `buckets[0]` counts durations under a microsecond and `buckets[i]` counts
+  /// durations in [2^(i-1), 2^i) microseconds. The last bucket also counts
+  /// every longer duration.
+  uint64_t buckets[FLUTTER_TASK_DURATION_HISTOGRAM_BUCKET_COUNT];
+} FlutterTaskDurationHistogram;
+
+typedef struct {
+  /// The size of this struct. Must be sizeof(FlutterTaskQueueStatistics).
+  size_t struct_size;
+  /// How long tasks waited past their target time before they started. For
+  /// tasks that were not delayed, this is the time from posting the task to
+  /// running it.
+  FlutterTaskDurationHistogram queue_latency;
+  /// How long tasks ran.
+  FlutterTaskDurationHistogram run_duration;
+} FlutterTaskQueueStatistics;
+
 /// AOT data source type.
 typedef enum {
   kFlutterEngineAOTDataSourceTypeElfPath
@@ -1589,6 +1659,12 @@ typedef struct {
   //
   // The first argument is the `user_data` from `FlutterEngineInitialize`.
   OnPreEngineRestartCallback on_pre_engine_restart_callback;
+
+  // The maximum number of bytes of images held by the raster cache. When the
+  // budget is exceeded, the entries that hold the most memory relative to
+  // the cost of re-rasterizing them are evicted first. A value of 0 means
+  // the raster cache is not limited by size.
+  size_t raster_cache_max_bytes;
 } FlutterProjectArgs;
 
 #ifndef FLUTTER_ENGINE_NO_PROTOTYPES
@@ -2251,6 +2327,32 @@ FlutterEngineResult FlutterEngineNotifyDisplayUpdate(
     const FlutterEngineDisplay* displays,
     size_t display_count);
 
+//------------------------------------------------------------------------------
+/// @brief      Gets histograms of how long the tasks of an engine managed
+///             thread waited in its queue and how long they ran.
+///
+///             Durations are only recorded if the engine was launched with
+///             the `--record-task-queue-statistics` command line switch, and
+///             only for threads whose task runner was not provided by the
+///             embedder.
+///
+/// @param[in]  engine       A running engine instance.
+/// @param[in]  thread_type  The thread to get statistics for. Only
+///                          `kFlutterNativeThreadTypePlatform`,
+///                          `kFlutterNativeThreadTypeRender` and
+///                          `kFlutterNativeThreadTypeUI` are supported.
+/// @param[out] statistics   The statistics to fill in. The `struct_size` field
+///                          must be set by the caller.
+///
+/// @return     The result of the call. `kInvalidArguments` is returned if the
+///             task runner of the thread was provided by the embedder.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEngineGetTaskQueueStatistics(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    FlutterNativeThreadType thread_type,
+    FlutterTaskQueueStatistics* statistics);
+
 #endif  // !FLUTTER_ENGINE_NO_PROTOTYPES
 
 // Typedefs for the function pointers in FlutterEngineProcTable.
@@ -2367,6 +2469,10 @@ typedef FlutterEngineResult (*FlutterEngineNotifyDisplayUpdateFnPtr)(
     FlutterEngineDisplaysUpdateType update_type,
     const FlutterEngineDisplay* displays,
     size_t display_count);
+typedef FlutterEngineResult (*FlutterEngineGetTaskQueueStatisticsFnPtr)(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    FlutterNativeThreadType thread_type,
+    FlutterTaskQueueStatistics* statistics);
 
 /// Function-pointer-based versions of the APIs above.
 typedef struct {
@@ -2411,6 +2517,7 @@ typedef struct {
   FlutterEnginePostCallbackOnAllNativeThreadsFnPtr
       PostCallbackOnAllNativeThreads;
   FlutterEngineNotifyDisplayUpdateFnPtr NotifyDisplayUpdate;
+  FlutterEngineGetTaskQueueStatisticsFnPtr GetTaskQueueStatistics;
 } FlutterEngineProcTable;
 
 //------------------------------------------------------------------------------
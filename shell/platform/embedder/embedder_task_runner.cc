@@ -20,17 +20,20 @@ EmbedderTaskRunner::EmbedderTaskRunner(DispatchTable table,
   FML_DCHECK(dispatch_table_.runs_task_on_current_thread_callback);
 }
 
-EmbedderTaskRunner::~EmbedderTaskRunner() = default;
+EmbedderTaskRunner::~EmbedderTaskRunner() {
+  // Idle tasks posted to this runner are kept in the placeholder queue.
+  fml::MessageLoopTaskQueues::GetInstance()->Dispose(placeholder_id_);
+}
 
 size_t EmbedderTaskRunner::GetEmbedderIdentifier() const {
   return embedder_identifier_;
 }
 
-void EmbedderTaskRunner::PostTask(const fml::closure& task) {
-  PostTaskForTime(task, fml::TimePoint::Now());
+void EmbedderTaskRunner::PostTask(fml::UniqueClosure task) {
+  PostTaskForTime(std::move(task), fml::TimePoint::Now());
 }
 
-void EmbedderTaskRunner::PostTaskForTime(const fml::closure& task,
+void EmbedderTaskRunner::PostTaskForTime(fml::UniqueClosure task,
                                          fml::TimePoint target_time) {
   if (!task) {
     return;
@@ -42,15 +45,50 @@ void EmbedderTaskRunner::PostTaskForTime(const fml::closure& task,
     // Release the lock before the jump via the dispatch table.
     std::scoped_lock lock(tasks_mutex_);
     baton = ++last_baton_;
-    pending_tasks_[baton] = task;
+    pending_tasks_[baton] = std::move(task);
   }
 
   dispatch_table_.post_task_callback(this, baton, target_time);
 }
 
-void EmbedderTaskRunner::PostDelayedTask(const fml::closure& task,
+void EmbedderTaskRunner::PostTasks(std::vector<fml::UniqueClosure> tasks) {
+  PostTasksForTime(std::move(tasks), fml::TimePoint::Now());
+}
+
+// The embedder is handed a single task that runs the whole batch, so that it
+// only needs to schedule one.
+void EmbedderTaskRunner::PostTasksForTime(std::vector<fml::UniqueClosure> tasks,
+                                          fml::TimePoint target_time) {
+  if (tasks.empty()) {
+    return;
+  }
+  PostTaskForTime(
+      [tasks = std::move(tasks)]() {
+        for (const auto& task : tasks) {
+          task();
+        }
+      },
+      target_time);
+}
+
+void EmbedderTaskRunner::PostDelayedTask(fml::UniqueClosure task,
                                          fml::TimeDelta delay) {
-  PostTaskForTime(task, fml::TimePoint::Now() + delay);
+  PostTaskForTime(std::move(task), fml::TimePoint::Now() + delay);
+}
+
+// The embedder decides the order in which its tasks run, so priorities are
+// not passed on.
+void EmbedderTaskRunner::PostTaskWithPriority(fml::UniqueClosure task,
+                                              fml::TaskPriority priority,
+                                              fml::TimePoint deadline) {
+  PostTask(std::move(task));
+}
+
+void EmbedderTaskRunner::PostDelayedTaskWithPriority(
+    fml::UniqueClosure task,
+    fml::TimeDelta delay,
+    fml::TaskPriority priority) {
+  PostDelayedTask(std::move(task), delay);
 }
 
 bool EmbedderTaskRunner::RunsTasksOnCurrentThread() {
@@ -58,7 +96,7 @@ bool EmbedderTaskRunner::RunsTasksOnCurrentThread() {
 }
 
 bool EmbedderTaskRunner::PostTask(uint64_t baton) {
-  fml::closure task;
+  fml::UniqueClosure task;
 
   {
     std::scoped_lock lock(tasks_mutex_);
@@ -67,7 +105,7 @@ bool EmbedderTaskRunner::PostTask(uint64_t baton) {
       FML_LOG(ERROR) << "Embedder attempted to post an unknown task.";
       return false;
     }
-    task = found->second;
+    task = std::move(found->second);
     pending_tasks_.erase(found);
 
     // Let go of the tasks mutex befor executing the task.
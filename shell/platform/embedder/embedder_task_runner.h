@@ -7,6 +7,7 @@
 
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 
 #include "flutter/fml/macros.h"
 #include "flutter/fml/task_runner.h"
@@ -76,18 +77,35 @@ class EmbedderTaskRunner final : public fml::TaskRunner {
   DispatchTable dispatch_table_;
   std::mutex tasks_mutex_;
   uint64_t last_baton_;
-  std::unordered_map<uint64_t, fml::closure> pending_tasks_;
+  std::unordered_map<uint64_t, fml::UniqueClosure> pending_tasks_;
   fml::TaskQueueId placeholder_id_;
 
   // |fml::TaskRunner|
-  void PostTask(const fml::closure& task) override;
+  void PostTask(fml::UniqueClosure task) override;
 
   // |fml::TaskRunner|
-  void PostTaskForTime(const fml::closure& task,
+  void PostTaskForTime(fml::UniqueClosure task,
                        fml::TimePoint target_time) override;
 
   // |fml::TaskRunner|
-  void PostDelayedTask(const fml::closure& task, fml::TimeDelta delay) override;
+  void PostTasks(std::vector<fml::UniqueClosure> tasks) override;
+
+  // |fml::TaskRunner|
+  void PostTasksForTime(std::vector<fml::UniqueClosure> tasks,
+                        fml::TimePoint target_time) override;
+
+  // |fml::TaskRunner|
+  void PostDelayedTask(fml::UniqueClosure task, fml::TimeDelta delay) override;
+
+  // |fml::TaskRunner|
+  void PostTaskWithPriority(fml::UniqueClosure task,
+                            fml::TaskPriority priority,
+                            fml::TimePoint deadline) override;
+
+  // |fml::TaskRunner|
+  void PostDelayedTaskWithPriority(fml::UniqueClosure task,
+                                   fml::TimeDelta delay,
+                                   fml::TaskPriority priority) override;
 
   // |fml::TaskRunner|
   bool RunsTasksOnCurrentThread() override;
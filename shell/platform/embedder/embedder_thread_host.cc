@@ -7,6 +7,8 @@
 #include "flutter/shell/platform/embedder/embedder_thread_host.h"
 
 #include <algorithm>
+#include <optional>
+#include <utility>
 
 #include "flutter/fml/message_loop.h"
 #include "flutter/shell/platform/embedder/embedder_struct_macros.h"
@@ -79,6 +81,67 @@ CreateEmbedderTaskRunner(const FlutterTaskRunnerDescription* description) {
                     SAFE_ACCESS(description, identifier, 0u))};
 }
 
+//------------------------------------------------------------------------------
+/// @brief      Attempts to read the scheduling hints an embedder specified for
+///             an engine managed thread. The boolean in the pair indicates
+///             whether the hints were valid. If not, engine launch must be
+///             aborted. If the embedder did not specify any hints, no
+///             configuration is returned.
+///
+/// @param[in]  config  The scheduling hints.
+///
+/// @return     A pair that returns whether the hints were valid and the thread
+///             configuration they describe, if any.
+///
+static std::pair<bool, std::optional<fml::Thread::ThreadConfig>>
+CreateThreadConfig(const FlutterThreadSchedulingConfig* config) {
+  if (config == nullptr) {
+    return {true, std::nullopt};
+  }
+
+  fml::Thread::ThreadConfig thread_config;
+  thread_config.cpu_mask = SAFE_ACCESS(config, cpu_mask, 0u);
+
+  switch (SAFE_ACCESS(config, cpu_affinity, kFlutterCpuAffinityAny)) {
+    case kFlutterCpuAffinityAny:
+      thread_config.cpu_affinity = fml::CpuAffinity::kAny;
+      break;
+    case kFlutterCpuAffinityPerformance:
+      thread_config.cpu_affinity = fml::CpuAffinity::kPerformance;
+      break;
+    case kFlutterCpuAffinityEfficiency:
+      thread_config.cpu_affinity = fml::CpuAffinity::kEfficiency;
+      break;
+    case kFlutterCpuAffinityNotPerformance:
+      thread_config.cpu_affinity = fml::CpuAffinity::kNotPerformance;
+      break;
+    default:
+      FML_LOG(ERROR) << "FlutterThreadSchedulingConfig.cpu_affinity was "
+                        "invalid.";
+      return {false, std::nullopt};
+  }
+
+  const int32_t nice = SAFE_ACCESS(config, nice, 0);
+  if (nice < -20 || nice > 19) {
+    FML_LOG(ERROR) << "FlutterThreadSchedulingConfig.nice was " << nice
+                   << ", it must be in [-20, 19].";
+    return {false, std::nullopt};
+  }
+  if (nice != 0) {
+    thread_config.nice = nice;
+  }
+
+  const int32_t realtime_priority = SAFE_ACCESS(config, realtime_priority, 0);
+  if (realtime_priority < 0 || realtime_priority > 99) {
+    FML_LOG(ERROR) << "FlutterThreadSchedulingConfig.realtime_priority was "
+                   << realtime_priority << ", it must be in [0, 99].";
+    return {false, std::nullopt};
+  }
+  thread_config.realtime_priority = realtime_priority;
+
+  return {true, thread_config};
+}
+
 std::unique_ptr<EmbedderThreadHost>
 EmbedderThreadHost::CreateEmbedderOrEngineManagedThreadHost(
     const FlutterCustomTaskRunners* custom_task_runners) {
@@ -152,9 +215,35 @@ EmbedderThreadHost::CreateEmbedderManagedThreadHost(
     }
   }
 
+  ThreadHost::ThreadHostConfig thread_host_config;
+  thread_host_config.name_prefix = kFlutterThreadName;
+  thread_host_config.type_mask = engine_thread_host_mask;
+
+  const std::pair<ThreadHost::Type, const FlutterThreadSchedulingConfig*>
+      thread_configs[] = {
+          {ThreadHost::Type::UI,
+           SAFE_ACCESS(custom_task_runners, ui_thread_config, nullptr)},
+          {ThreadHost::Type::RASTER,
+           SAFE_ACCESS(custom_task_runners, raster_thread_config, nullptr)},
+          {ThreadHost::Type::IO,
+           SAFE_ACCESS(custom_task_runners, io_thread_config, nullptr)},
+      };
+  for (const auto& [type, config] : thread_configs) {
+    auto thread_config_pair = CreateThreadConfig(config);
+    if (!thread_config_pair.first) {
+      // As with invalid task runners, don't fallback to defaults if the user
+      // tried to configure a thread but messed up.
+      return nullptr;
+    }
+    if (thread_config_pair.second) {
+      thread_host_config.type_configs[type] =
+          std::move(thread_config_pair.second.value());
+    }
+  }
+
   // Create a thread host with just the threads that need to be managed by the
   // engine. The embedder has provided the rest.
-  ThreadHost thread_host(kFlutterThreadName, engine_thread_host_mask);
+  ThreadHost thread_host(thread_host_config);
 
   // If the embedder has supplied a platform task runner, use that. If not, use
   // the current thread task runner.
@@ -278,6 +278,16 @@ void EmbedderConfigBuilder::SetRenderTaskRunner(
   project_args_.custom_task_runners = &custom_task_runners_;
 }
 
+void EmbedderConfigBuilder::SetUIThreadSchedulingConfig(
+    const FlutterThreadSchedulingConfig* config) {
+  if (config == nullptr) {
+    return;
+  }
+
+  custom_task_runners_.ui_thread_config = config;
+  project_args_.custom_task_runners = &custom_task_runners_;
+}
+
 void EmbedderConfigBuilder::SetPlatformMessageCallback(
     const std::function<void(const FlutterPlatformMessage*)>& callback) {
   context_.SetPlatformMessageCallback(callback);
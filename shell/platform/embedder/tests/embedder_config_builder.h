@@ -91,6 +91,8 @@ class EmbedderConfigBuilder {
 
   void SetRenderTaskRunner(const FlutterTaskRunnerDescription* runner);
 
+  void SetUIThreadSchedulingConfig(const FlutterThreadSchedulingConfig* config);
+
   void SetPlatformMessageCallback(
       const std::function<void(const FlutterPlatformMessage*)>& callback);
 
@@ -17,6 +17,7 @@
 #include "flutter/fml/paths.h"
 #include "flutter/fml/synchronization/count_down_latch.h"
 #include "flutter/fml/synchronization/waitable_event.h"
+#include "flutter/fml/task_queue_statistics.h"
 #include "flutter/fml/task_runner.h"
 #include "flutter/fml/thread.h"
 #include "flutter/fml/time/time_delta.h"
@@ -218,6 +219,34 @@ TEST(EmbedderTestNoFixture, CanGetCurrentTimeInNanoseconds) {
   ASSERT_LT((point2 - point1), fml::TimeDelta::FromMilliseconds(1));
 }
 
+TEST_F(EmbedderTest, CanSpecifyUIThreadSchedulingConfig) {
+  auto& context = GetEmbedderContext(EmbedderTestContextType::kSoftwareContext);
+  fml::AutoResetWaitableEvent latch;
+  context.AddIsolateCreateCallback([&latch]() { latch.Signal(); });
+  EmbedderConfigBuilder builder(context);
+  builder.SetSoftwareRendererConfig();
+  FlutterThreadSchedulingConfig config = {};
+  config.struct_size = sizeof(FlutterThreadSchedulingConfig);
+  config.cpu_affinity = kFlutterCpuAffinityPerformance;
+  builder.SetUIThreadSchedulingConfig(&config);
+  auto engine = builder.LaunchEngine();
+  ASSERT_TRUE(engine.is_valid());
+  latch.Wait();
+  engine.reset();
+}
+
+TEST_F(EmbedderTest, MustNotRunWithInvalidThreadSchedulingConfig) {
+  auto& context = GetEmbedderContext(EmbedderTestContextType::kSoftwareContext);
+  EmbedderConfigBuilder builder(context);
+  builder.SetSoftwareRendererConfig();
+  FlutterThreadSchedulingConfig config = {};
+  config.struct_size = sizeof(FlutterThreadSchedulingConfig);
+  config.nice = 20;
+  builder.SetUIThreadSchedulingConfig(&config);
+  auto engine = builder.LaunchEngine();
+  ASSERT_FALSE(engine.is_valid());
+}
+
 TEST_F(EmbedderTest, CanReloadSystemFonts) {
   auto& context = GetEmbedderContext(EmbedderTestContextType::kSoftwareContext);
   EmbedderConfigBuilder builder(context);
@@ -1053,6 +1082,33 @@ TEST_F(EmbedderTest, CanSendLowMemoryNotification) {
   ASSERT_EQ(FlutterEngineNotifyLowMemoryWarning(engine.get()), kSuccess);
 }
 
+TEST_F(EmbedderTest, CanGetTaskQueueStatistics) {
+  auto& context = GetEmbedderContext(EmbedderTestContextType::kSoftwareContext);
+
+  EmbedderConfigBuilder builder(context);
+  builder.SetSoftwareRendererConfig();
+  builder.AddCommandLineArgument("--record-task-queue-statistics");
+
+  auto engine = builder.LaunchEngine();
+
+  ASSERT_TRUE(engine.is_valid());
+
+  FlutterTaskQueueStatistics statistics = {};
+  statistics.struct_size = sizeof(FlutterTaskQueueStatistics);
+  ASSERT_EQ(FlutterEngineGetTaskQueueStatistics(
+                engine.get(), kFlutterNativeThreadTypeUI, &statistics),
+            kSuccess);
+  ASSERT_GT(statistics.queue_latency.count, 0u);
+  ASSERT_GT(statistics.run_duration.count, 0u);
+
+  ASSERT_EQ(FlutterEngineGetTaskQueueStatistics(
+                engine.get(), kFlutterNativeThreadTypeWorker, &statistics),
+            kInvalidArguments);
+
+  engine.reset();
+  fml::TaskQueueStatistics::SetRecordingEnabled(false);
+}
+
 TEST_F(EmbedderTest, CanPostTaskToAllNativeThreads) {
   UniqueEngine engine;
   size_t worker_count = 0;
@@ -8,6 +8,9 @@
 #include <lib/async/default.h>
 #include <lib/zx/time.h>
 
+#include <utility>
+#include <vector>
+
 #include "flutter/fml/message_loop_impl.h"
 
 namespace flutter_runner {
@@ -19,23 +22,59 @@ class CompatTaskRunner : public fml::TaskRunner {
     FML_DCHECK(forwarding_target_);
   }
 
-  void PostTask(const fml::closure& task) override {
-    async::PostTask(forwarding_target_, task);
+  void PostTask(fml::UniqueClosure task) override {
+    async::PostTask(forwarding_target_, std::move(task));
   }
 
-  void PostTaskForTime(const fml::closure& task,
+  void PostTaskForTime(fml::UniqueClosure task,
                        fml::TimePoint target_time) override {
     async::PostTaskForTime(
-        forwarding_target_, task,
+        forwarding_target_, std::move(task),
         zx::time(target_time.ToEpochDelta().ToNanoseconds()));
   }
 
-  void PostDelayedTask(const fml::closure& task,
+  void PostTasks(std::vector<fml::UniqueClosure> tasks) override {
+    for (auto& task : tasks) {
+      PostTask(std::move(task));
+    }
+  }
+
+  void PostTasksForTime(std::vector<fml::UniqueClosure> tasks,
+                        fml::TimePoint target_time) override {
+    for (auto& task : tasks) {
+      PostTaskForTime(std::move(task), target_time);
+    }
+  }
+
+  void PostDelayedTask(fml::UniqueClosure task,
                        fml::TimeDelta delay) override {
-    async::PostDelayedTask(forwarding_target_, task,
+    async::PostDelayedTask(forwarding_target_, std::move(task),
                            zx::duration(delay.ToNanoseconds()));
   }
 
+  // The async dispatcher has no notion of priorities, so tasks run in the
+  // order they are due regardless of theirs.
+  void PostTaskWithPriority(fml::UniqueClosure task,
+                            fml::TaskPriority priority,
+                            fml::TimePoint deadline) override {
+    PostTask(std::move(task));
+  }
+
+  void PostDelayedTaskWithPriority(fml::UniqueClosure task,
+                                   fml::TimeDelta delay,
+                                   fml::TaskPriority priority) override {
+    PostDelayedTask(std::move(task), delay);
+  }
+
+  // Nothing tells this runner when its thread is idle, so idle tasks run
+  // once their timeout has passed, as if the thread never became idle.
+  void PostIdleTask(const fml::IdleTask& task,
+                    fml::TimeDelta timeout) override {
+    PostDelayedTask([task]() { task(fml::TimePoint::Max()); }, timeout);
+  }
+
+  void RunIdleTasksUntil(fml::TimePoint deadline) override {}
+
   bool RunsTasksOnCurrentThread() override {
     return forwarding_target_ == async_get_default_dispatcher();
   }
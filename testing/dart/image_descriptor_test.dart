@@ -70,6 +70,72 @@ void main() {
     expect(codec.frameCount, 1);
   });
 
+  test('image descriptor - encoded - source rect', () async {
+    final Uint8List bytes = await _getSkiaResource('mandrill_512_q075.jpg').readAsBytes();
+    final ImmutableBuffer buffer = await ImmutableBuffer.fromUint8List(bytes);
+    final ImageDescriptor descriptor = await ImageDescriptor.encoded(buffer);
+
+    Codec codec = await descriptor.instantiateCodec(
+      sourceRect: const Rect.fromLTRB(100, 200, 300, 300),
+    );
+    FrameInfo frame = await codec.getNextFrame();
+    expect(frame.image.width, 200);
+    expect(frame.image.height, 100);
+
+    // The target size applies to the region, and the region is clipped to
+    // the image.
+    codec = await descriptor.instantiateCodec(
+      targetWidth: 25,
+      sourceRect: const Rect.fromLTRB(412, 0, 612, 100),
+    );
+    frame = await codec.getNextFrame();
+    expect(frame.image.width, 25);
+    expect(frame.image.height, 25);
+  });
+
+  test('image descriptor - source rect must be a region of the image', () async {
+    final Uint8List bytes = Uint8List.fromList(List<int>.filled(64, 0xFF));
+    final ImmutableBuffer buffer = await ImmutableBuffer.fromUint8List(bytes);
+    final ImageDescriptor descriptor = ImageDescriptor.raw(
+      buffer,
+      width: 4,
+      height: 4,
+      pixelFormat: PixelFormat.rgba8888,
+    );
+
+    for (final Rect sourceRect in const <Rect>[
+      Rect.fromLTRB(5, 0, 8, 4), // Outside of the image.
+      Rect.fromLTRB(1.5, 0, 1.5, 4), // Zero width.
+      Rect.fromLTRB(0, 3, 4, 1), // Negative height.
+    ]) {
+      Object? error;
+      try {
+        await descriptor.instantiateCodec(sourceRect: sourceRect);
+      } catch (e) {
+        error = e;
+      }
+      expect(error is ArgumentError, true);
+    }
+  });
+
+  test('image descriptor - raw - source rect', () async {
+    final Uint8List bytes = Uint8List.fromList(List<int>.filled(64, 0xFF));
+    final ImmutableBuffer buffer = await ImmutableBuffer.fromUint8List(bytes);
+    final ImageDescriptor descriptor = ImageDescriptor.raw(
+      buffer,
+      width: 4,
+      height: 4,
+      pixelFormat: PixelFormat.rgba8888,
+    );
+
+    final Codec codec = await descriptor.instantiateCodec(
+      sourceRect: const Rect.fromLTRB(1, 1, 3, 4),
+    );
+    final FrameInfo frame = await codec.getNextFrame();
+    expect(frame.image.width, 2);
+    expect(frame.image.height, 3);
+  });
+
   test('HEIC image', () async {
     final Uint8List bytes = await readFile('grill_chicken.heic');
     final ImmutableBuffer buffer = await ImmutableBuffer.fromUint8List(bytes);
@@ -245,6 +245,10 @@ def RunEngineBenchmarks(build_dir, filter):
 
   RunEngineExecutable(build_dir, 'ui_benchmarks', filter, icu_flags)
 
+  RunEngineExecutable(build_dir, 'display_list_benchmarks', filter, icu_flags)
+
+  RunEngineExecutable(build_dir, 'flow_benchmarks', filter, icu_flags)
+
   if IsLinux():
     RunEngineExecutable(build_dir, 'txt_benchmarks', filter, icu_flags)
 